@@ -23,6 +23,7 @@
 #include "mirtk/IOConfig.h"
 
 #include "mirtk/Matrix.h"
+#include "mirtk/Parallel.h"
 #include "mirtk/GenericImage.h"
 #include "mirtk/VoxelFunction.h"
 #include "mirtk/InterpolateImageFunction.h"
@@ -79,6 +80,8 @@ void PrintHelp(const char* name)
   cout << "                             Output background value zero by default or minimum average intensity minus 1. (default: 0)" << endl;
   cout << "  -interp <mode>             Interpolation mode, e.g., NN, Linear, BSpline, Cubic, Sinc. (default: Linear)" << endl;
   cout << "  -label <value>             Segmentation label of which to create an average probability map." << endl;
+  cout << "  -prefetch <n>              Maximum number of input images which are read and resampled" << endl;
+  cout << "                             concurrently while the previous images are added to the average. (default: 4)" << endl;
   PrintCommonOptions(cout);
   cout << endl;
 }
@@ -215,9 +218,22 @@ void Read(const string &image_name, const string    &imdof_name,
 #endif // HAVE_MIRTK_Transformation
 
 // -----------------------------------------------------------------------------
-struct AddVoxelValueToAverage : public VoxelFunction
+/// Input image resampled on the average image grid
+struct AverageInput
+{
+  int         _Index;  ///< Index of input image
+  InputImage  _Image;  ///< Input image
+  OutputImage _Values; ///< Weighted input values resampled on average image grid
+
+  #ifdef HAVE_MIRTK_Transformation
+    Transformation *_Transformation; ///< Image-to-average transformation
+  #endif
+};
+
+// -----------------------------------------------------------------------------
+struct ResampleVoxelValue : public VoxelFunction
 {
-  OutputImage        *_Average;
+  const OutputImage  *_Average;
   InputImageFunction *_Image;
   double              _Weight;
   int                 _Label;
@@ -228,7 +244,7 @@ struct AddVoxelValueToAverage : public VoxelFunction
     bool                  _Invert;
   #endif
 
-  void operator()(int i, int j, int k, int, OutputType *avg)
+  void operator()(int i, int j, int k, int, OutputType *value)
   {
     double x = i, y = j, z = k;
     _Average->ImageToWorld(x, y, z);
@@ -246,31 +262,48 @@ struct AddVoxelValueToAverage : public VoxelFunction
     _Image->Input()->WorldToImage(x, y, z);
     if (_Label > 0) {
       if (static_cast<int>(_Image->Evaluate(x, y, z)) == _Label) {
-        *avg += static_cast<OutputType>(_Weight);
+        *value = static_cast<OutputType>(_Weight);
+      } else {
+        *value = OutputType(0);
       }
     } else {
-      const OutputType bg = static_cast<OutputType>(_Average->GetBackgroundValueAsDouble());
-      if ((IsNaN(bg) && IsNaN(*avg)) || (*avg == bg)) {
-        *avg = static_cast<OutputType>(_Weight * _Image->Evaluate(x, y, z));
+      *value = static_cast<OutputType>(_Weight * _Image->Evaluate(x, y, z));
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+struct AddVoxelValueToAverage : public VoxelFunction
+{
+  OutputType _Background;
+  int        _Label;
+
+  void operator()(const OutputImage &, int, const OutputType *value, OutputType *avg)
+  {
+    if (_Label > 0) {
+      *avg += *value;
+    } else {
+      if ((IsNaN(_Background) && IsNaN(*avg)) || (*avg == _Background)) {
+        *avg  = *value;
       } else {
-        *avg += static_cast<OutputType>(_Weight * _Image->Evaluate(x, y, z));
+        *avg += *value;
       }
     }
   }
 };
 
 // -----------------------------------------------------------------------------
-void Add(OutputImage &average, InputImage &image, int label = -1,
-         #ifdef HAVE_MIRTK_Transformation
-           Transformation   *transformation = NULL,
-           bool              invert         = false,
-         #endif // HAVE_MIRTK_Transformation
-         OutputType        weight         = 1.0,
-         InterpolationMode interpolation  = Interpolation_Linear)
+void Resample(const OutputImage &average, AverageInput &input, int label = -1,
+              #ifdef HAVE_MIRTK_Transformation
+                bool            invert        = false,
+              #endif // HAVE_MIRTK_Transformation
+              OutputType        weight        = 1.0,
+              InterpolationMode interpolation = Interpolation_Linear)
 {
   if (label > 0) interpolation = Interpolation_NN;
-  AddVoxelValueToAverage add;
+  ResampleVoxelValue resample;
   #ifdef HAVE_MIRTK_Transformation
+    Transformation * const transformation = input._Transformation;
     GenericImage<double> disp;
     if (transformation && transformation->RequiresCachingOfDisplacements()) {
       disp.Initialize(average.Attributes(), 3);
@@ -278,19 +311,119 @@ void Add(OutputImage &average, InputImage &image, int label = -1,
       if (invert) transformation->Displacement(disp);
       else        transformation->InverseDisplacement(disp);
     }
-    add._Transformation = transformation;
-    add._Displacement   = (disp.IsEmpty() ? NULL : &disp);
-    add._Invert         = invert;
+    resample._Transformation = transformation;
+    resample._Displacement   = (disp.IsEmpty() ? NULL : &disp);
+    resample._Invert         = invert;
   #endif // HAVE_MIRTK_Transformation
-  add._Average = &average;
-  add._Weight  = weight;
-  add._Label   = label;
-  add._Image   = InputImageFunction::New(interpolation, &image);
-  add._Image->Initialize();
-  ParallelForEachVoxel(average.Attributes(), average, add);
-  delete add._Image;
+  resample._Average = &average;
+  resample._Weight  = weight;
+  resample._Label   = label;
+  resample._Image   = InputImageFunction::New(interpolation, &input._Image);
+  resample._Image->Initialize();
+  input._Values.Initialize(average.Attributes());
+  ParallelForEachVoxel(average.Attributes(), input._Values, resample);
+  delete resample._Image;
+}
+
+// -----------------------------------------------------------------------------
+void Add(OutputImage &average, const AverageInput &input, int label = -1)
+{
+  AddVoxelValueToAverage add;
+  add._Background = static_cast<OutputType>(average.GetBackgroundValueAsDouble());
+  add._Label      = label;
+  ParallelForEachVoxel(input._Values, average, add);
 }
 
+// -----------------------------------------------------------------------------
+/// First pipeline stage which reads the next input image and transformation
+struct ReadAverageInput
+{
+  int                 *_Next;
+  int                  _Number;
+  const Array<string> *_ImageName;
+  InputImage          *_Sequence;
+
+  #ifdef HAVE_MIRTK_Transformation
+    const Array<string> *_TransformationName;
+    const Array<bool>   *_Invert;
+  #endif
+
+  AverageInput *operator()(flow_control &fc) const
+  {
+    const int n = *_Next;
+    if (n >= _Number) {
+      fc.stop();
+      return NULL;
+    }
+    AverageInput *input = new AverageInput();
+    input->_Index = n;
+    if (_Sequence->IsEmpty()) {
+      #ifdef HAVE_MIRTK_Transformation
+        Read((*_ImageName)[n], (*_TransformationName)[n],
+             input->_Image, input->_Transformation, (*_Invert)[n]);
+      #else // HAVE_MIRTK_Transformation
+        input->_Image.Read((*_ImageName)[n].c_str());
+      #endif // HAVE_MIRTK_Transformation
+    } else {
+      _Sequence->GetFrame(input->_Image, n);
+      #ifdef HAVE_MIRTK_Transformation
+        input->_Transformation = NULL;
+      #endif
+    }
+    ++(*_Next);
+    return input;
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Second pipeline stage which resamples input images concurrently
+struct ResampleAverageInput
+{
+  const OutputImage       *_Average;
+  const Array<OutputType> *_Weight;
+  InterpolationMode        _Interpolation;
+  int                      _Label;
+
+  #ifdef HAVE_MIRTK_Transformation
+    const Array<bool> *_Invert;
+  #endif
+
+  AverageInput *operator()(AverageInput *input) const
+  {
+    const int n = input->_Index;
+    Resample(*_Average, *input, _Label,
+             #ifdef HAVE_MIRTK_Transformation
+               (*_Invert)[n],
+             #endif
+             (*_Weight)[n], _Interpolation);
+    input->_Image.Clear();
+    #ifdef HAVE_MIRTK_Transformation
+      Delete(input->_Transformation);
+    #endif
+    return input;
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Last pipeline stage which adds resampled images in input order
+struct AddAverageInput
+{
+  OutputImage *_Average;
+  int          _Number;
+  int          _Label;
+  bool         _Frames;
+
+  void operator()(AverageInput *input) const
+  {
+    Add(*_Average, *input, _Label);
+    if (verbose) {
+      cout << "Add " << (_Frames ? "frame " : "image ") << setw(3) << (input->_Index + 1)
+           << " out of " << _Number << "... done" << endl;
+    }
+    delete input;
+  }
+};
+
 // =============================================================================
 // Main
 // =============================================================================
@@ -367,6 +500,7 @@ int main(int argc, char **argv)
   bool               voxelwise       = false;
   int                label           = -1;
   int                margin          = -1;
+  int                prefetch        = 4;
   double             dx = .0, dy = .0, dz = .0;
 
   for (ARGUMENTS_AFTER(nposarg)) {
@@ -386,10 +520,12 @@ int main(int argc, char **argv)
     else if (OPTION("-margin"))    PARSE_ARGUMENT(margin);
     else if (OPTION("-label"))     PARSE_ARGUMENT(label);
     else if (OPTION("-interp"))    PARSE_ARGUMENT(interpolation);
+    else if (OPTION("-prefetch"))  PARSE_ARGUMENT(prefetch);
     else HANDLE_COMMON_OR_UNKNOWN_OPTION();
   }
 
   if (label > 0 && IsNaN(padding)) padding = .0;
+  if (prefetch < 1) FatalError("Invalid -prefetch argument, must be positive!");
 
   // ---------------------------------------------------------------------------
   // Collect (further) input image meta-data...
@@ -481,39 +617,39 @@ int main(int argc, char **argv)
   OutputImage average(fov);
   average = static_cast<OutputType>(padding);
   average.PutBackgroundValueAsDouble(padding);
-  for (int n = 0; n < nimages; ++n) {
-    if (sequence.IsEmpty()) {
-      if (verbose) {
-        cout << "Add image " << setw(3) << (n+1) << " out of " << nimages << "... ";
-        cout.flush();
-      }
-      #ifdef HAVE_MIRTK_Transformation
-        Read(image_name[n], imdof_name[n], image, imdof, imdof_invert[n]);
-      #else // HAVE_MIRTK_Transformation
-        image.Read(image_name[n].c_str());
-      #endif // HAVE_MIRTK_Transformation
-    } else {
-      if (verbose) {
-        cout << "Add frame " << setw(3) << (n+1) << " out of " << nimages << "... ";
-        cout.flush();
-      }
-      sequence.GetFrame(image, n);
-      #ifdef HAVE_MIRTK_Transformation
-        imdof = NULL;
-      #endif
-    }
-
-    Add(average, image, label, 
-        #ifdef HAVE_MIRTK_Transformation
-          imdof, imdof_invert[n],
-        #endif
-        image_weight[n], interpolation);
+  {
+    int next = 0;
+
+    ReadAverageInput read;
+    read._Next      = &next;
+    read._Number    = nimages;
+    read._ImageName = &image_name;
+    read._Sequence  = &sequence;
+
+    ResampleAverageInput resample;
+    resample._Average       = &average;
+    resample._Weight        = &image_weight;
+    resample._Interpolation = interpolation;
+    resample._Label         = label;
+
+    AddAverageInput add;
+    add._Average = &average;
+    add._Number  = nimages;
+    add._Label   = label;
+    add._Frames  = !sequence.IsEmpty();
 
     #ifdef HAVE_MIRTK_Transformation
-      Delete(imdof);
+      read._TransformationName = &imdof_name;
+      read._Invert             = &imdof_invert;
+      resample._Invert         = &imdof_invert;
     #endif
 
-    if (verbose) cout << " done" << endl;
+    // Read next input images while previous ones are being resampled and
+    // add resampled images to the average in input order
+    parallel_pipeline(static_cast<size_t>(prefetch),
+      make_filter<void,           AverageInput *>(filter::serial_in_order, read) &
+      make_filter<AverageInput *, AverageInput *>(filter::parallel,        resample) &
+      make_filter<AverageInput *, void          >(filter::serial_in_order, add));
   }
   if (wsum > .0) average /= wsum;
 
@@ -35,6 +35,7 @@ using namespace mirtk;
 
 char IntegrationMethod[32] = {"SS"};
 int  NumberOfSteps         = 128;
+bool SinglePrecision       = false;
 
 // =============================================================================
 // Help
@@ -56,10 +57,52 @@ void PrintHelp(const char *name)
   cout << "  -euler          Use forward Euler method." << endl;
   cout << "  -steps <int>    Number of integration steps (2^n in case of SS). "
                           << "(default: " << NumberOfSteps << ")" << endl;
+  cout << "  -float          Integrate velocities in single precision, which halves the" << endl;
+  cout << "                  memory needed for the intermediate vector fields. (default: off)" << endl;
   PrintCommonOptions(cout);
   cout << endl;
 }
 
+// =============================================================================
+// Auxiliaries
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Compute displacement field from velocity field and write it to file(s)
+template <class TReal>
+void ComputeAndWriteDisplacements(const GenericImage<TReal> &v,
+                                  const char *disp_fname, const char *dx_fname,
+                                  const char *dy_fname,   const char *dz_fname)
+{
+  // Instantiate filter which implements the desired integration method
+  unique_ptr<VelocityToDisplacementField<TReal> > vtod;
+
+  if (strcmp(IntegrationMethod, "SS") == 0) {
+    vtod.reset(new VelocityToDisplacementFieldSS<TReal>());
+  } else if (strcmp(IntegrationMethod, "RKE1") == 0 || strcmp(IntegrationMethod, "FORWARDEULER") == 0 || strcmp(IntegrationMethod, "EULER") == 0) {
+    vtod.reset(new VelocityToDisplacementFieldEuler<TReal>());
+  } else {
+    FatalError("Unknown integration method: " << IntegrationMethod);
+  }
+
+  // Compute displacement field
+  GenericImage<TReal> d;
+
+  vtod->Input(&v);
+  vtod->Output(&d);
+  vtod->NumberOfSteps(NumberOfSteps);
+  vtod->Run();
+
+  // Save output velocities
+  if (disp_fname) {
+    d.Write(disp_fname);
+  } else {
+    d.GetFrame(0).Write(dx_fname);
+    d.GetFrame(1).Write(dy_fname);
+    if (dz_fname) d.GetFrame(2).Write(dz_fname);
+  }
+}
+
 // =============================================================================
 // Main
 // =============================================================================
@@ -132,6 +175,8 @@ int main(int argc, char **argv)
       IntegrationMethod[4] = '\0';
     } else if (OPTION("-steps")) {
       NumberOfSteps = atoi(ARGUMENT);
+    } else if (OPTION("-float")) {
+      SinglePrecision = true;
     } else {
       HANDLE_COMMON_OR_UNKNOWN_OPTION();
     }
@@ -167,32 +212,13 @@ int main(int argc, char **argv)
     }
   }
 
-  // Instantiate filter which implements the desired integration method
-  unique_ptr<VelocityToDisplacementField<RealPixel> > vtod;
-
-  if (strcmp(IntegrationMethod, "SS") == 0) {
-    vtod.reset(new VelocityToDisplacementFieldSS<RealPixel>());
-  } else if (strcmp(IntegrationMethod, "RKE1") == 0 || strcmp(IntegrationMethod, "FORWARDEULER") == 0 || strcmp(IntegrationMethod, "EULER") == 0) {
-    vtod.reset(new VelocityToDisplacementFieldEuler<RealPixel>());
-  } else {
-    FatalError("Unknown integration method: " << IntegrationMethod);
-  }
-
-  // Compute displacement field
-  RealImage d;
-
-  vtod->Input(v.get());
-  vtod->Output(&d);
-  vtod->NumberOfSteps(NumberOfSteps);
-  vtod->Run();
-
-  // Save output velocities
-  if (disp_fname) {
-    d.Write(disp_fname);
+  // Compute and write displacement field
+  if (SinglePrecision) {
+    GenericImage<float> vf(*v);
+    v.reset();
+    ComputeAndWriteDisplacements(vf, disp_fname, dx_fname, dy_fname, dz_fname);
   } else {
-    d.GetFrame(0).Write(dx_fname);
-    d.GetFrame(1).Write(dy_fname);
-    if (dz_fname) d.GetFrame(2).Write(dz_fname);
+    ComputeAndWriteDisplacements(*v, disp_fname, dx_fname, dy_fname, dz_fname);
   }
 
   return 0;
@@ -80,6 +80,9 @@ void PrintHelp(const char *name)
   cout << "  -corrin <file>            Text file naming for each point in input1 the index of the corresponding" << endl;
   cout << "                            point in the second dataset input2, one index per line. (default: :option:`-corr`)" << endl;
   cout << "  -points                   Replace output vertex coordinates by first three spectral coordinates." << endl;
+  cout << "  -solver <name>            Sparse eigen solver: \"ARPACK\" or \"LOBPCG\". When the eigenmodes of a joint" << endl;
+  cout << "                            graph Laplacian are computed, the LOBPCG solver is initialized with the" << endl;
+  cout << "                            individual eigenmodes if available. (default: ARPACK if available)" << endl;
   PrintCommonOptions(cout);
   cout << endl;
 }
@@ -151,7 +154,9 @@ void Write(const char *fname, vtkPointSet *pointset, vtkPolyData *surface, bool
 int ComputeJointEigenmodes(vtkPolyData *target, const Array<int> &target_sample,
                            vtkPolyData *source, const Array<int> &source_sample,
                            const PointCorrespondence *corr, int k,
-                           Matrix &modes, Vector &freq)
+                           Matrix &modes, Vector &freq,
+                           EigenSolver solver = EigenSolver_Default,
+                           const Matrix *modes0 = NULL)
 {
   using SpectralDecomposition::SparseMatrix;
   // Set intra-mesh affinity weights
@@ -197,11 +202,13 @@ int ComputeJointEigenmodes(vtkPolyData *target, const Array<int> &target_sample,
   }
   // Compute graph Laplacian of joint connectivity graph
   SparseMatrix L(SparseMatrix::CCS);
+  Vector       D;
   L.Initialize(m + n, m + n, cols);
   delete[] cols;
-  NormalizedLaplacian(L, L);
+  Degree(D, L);
+  NormalizedLaplacian(L, L, NULL, &D);
   // Compute eigenmodes of joint graph Laplacian
-  return ComputeEigenmodes(L, k+1, modes, freq);
+  return ComputeEigenmodes(L, k+1, modes, freq, solver, &D, modes0);
 }
 
 // =============================================================================
@@ -242,6 +249,7 @@ int main(int argc, char *argv[])
   bool        compress    = true;
   bool        ascii       = false;
   bool        as_points   = false;
+  EigenSolver solver      = EigenSolver_Default;
 
   PointCorrespondence::TypeId ctype = PointCorrespondence::ClosestPoint;
   ParameterList               cparam;
@@ -270,6 +278,7 @@ int main(int argc, char *argv[])
       else cfeature_weight.push_back(1.0);
     }
     else if (OPTION("-points")) as_points = true;
+    else if (OPTION("-solver")) PARSE_ARGUMENT(solver);
     else if (OPTION("-compress"))    compress = true;
     else if (OPTION("-nocompress") ) compress = false;
     else if (OPTION("-ascii")  || OPTION("-nobinary")) ascii = true;
@@ -356,7 +365,8 @@ int main(int argc, char *argv[])
   Vector freq [2];
   for (int i = 0; i < ndatasets; ++i) {
     if (individual_analysis[i]) {
-      if (ComputeEigenmodes(surface[i], k, modes[i], freq[i]) < k) {
+      if (ComputeEigenmodes(surface[i], k, modes[i], freq[i],
+                            FeatureWeights(), FeatureWeights(), solver) < k) {
         FatalError("Failed to find " << k << " eigenmodes of dataset " << (i+1));
       }
       if (verbose) {
@@ -376,12 +386,23 @@ int main(int argc, char *argv[])
   if (ndatasets == 2) {
 
     // Adjust sign and order of individually computed eigenmodes
+    Matrix modes0;
     if (spectral_match) {
       Vector cost = MatchEigenmodes(surface[0]->GetPoints(), modes[0], freq[0],
                                         surface[1]->GetPoints(), modes[1], freq[1]);
 
       // TODO: Transform modes[1] using coherent point drift algorithm
 
+      // Initial estimate of joint eigenmodes
+      if (individual_analysis[0] && individual_analysis[1]) {
+        const int m = modes[0].Rows(), n = modes[1].Rows();
+        modes0.Initialize(m + n, min(modes[0].Cols(), modes[1].Cols()));
+        for (int c = 0; c < modes0.Cols(); ++c) {
+          for (int r = 0; r < m; ++r) modes0(r,     c) = modes[0](r, c);
+          for (int r = 0; r < n; ++r) modes0(m + r, c) = modes[1](r, c);
+        }
+      }
+
       // Add individual eigenmodes to output point data
       for (int i = 0; i < ndatasets; ++i) {
         SetEigenmodes(surface[i], modes[i], "eigenmodes");
@@ -423,7 +444,7 @@ int main(int argc, char *argv[])
     Vector freq;
     if (ComputeJointEigenmodes(target.Surface(), target_sample,
                                source.Surface(), source_sample,
-                               cmap.get(), k, modes, freq) < k) {
+                               cmap.get(), k, modes, freq, solver, &modes0) < k) {
       FatalError("Error: Failed to find " << k << " eigenmodes of joint graph Laplacian!");
     }
 
@@ -27,6 +27,8 @@
 #include "mirtk/DataStatistics.h"
 #include "mirtk/DataFunctions.h"
 
+#include <typeinfo>
+
 #if MIRTK_Image_WITH_VTK
 #  include "vtkDataSet.h"
 #  include "vtkSmartPointer.h"
@@ -72,6 +74,8 @@ void PrintHelp(const char *name)
   cout << "\n";
   cout << "Input options:\n";
   cout << "  -scalars <name>   Name of input point data array. (default: active SCALARS array)\n";
+  cout << "  -fuse, -nofuse    Whether to apply consecutive element-wise data masking and transformation\n";
+  cout << "                    operations in a single pass over the data sequence. (default: on)\n";
   cout << "\n";
   cout << "Data masking options:\n";
   cout << "  -even\n";
@@ -250,6 +254,8 @@ void PrintHelp(const char *name)
   cout << "      Print range of intensity values (i.e., max - min). (default: off)\n";
   cout << "  -percentile, -pct, -p <n>...\n";
   cout << "      Print n-th percentile. (default: none)\n";
+  cout << "  -median\n";
+  cout << "      Print median value, i.e., 50th percentile. (default: off)\n";
   cout << "  -lower-percentile-mean, -lpctavg <n>\n";
   cout << "      Print mean intensity of values less than or equal to the n-th percentile. (default: off)\n";
   cout << "  -upper-percentile-mean, -upctavg <n>\n";
@@ -341,6 +347,7 @@ int main(int argc, char **argv)
   const char *delimiter     = NULL;
   bool        print_header  = false;
   int         digits        = 5;
+  bool        fuse          = true;
 
   Array<string> header;
   Array<string> prefix;
@@ -356,6 +363,10 @@ int main(int argc, char **argv)
       #else
         FatalError("Cannot process -scalars of VTK file because MIRTK Image library was built without VTK!");
       #endif // MIRTK_Image_WITH_VTK
+    } else if (OPTION("-fuse")) {
+      fuse = true;
+    } else if (OPTION("-nofuse")) {
+      fuse = false;
     } else if (OPTION("-prefix")) {
       do {
         prefix.push_back(ARGUMENT);
@@ -700,6 +711,9 @@ int main(int argc, char **argv)
           exit(1);
         }
       } while (HAS_ARGUMENT);
+    } else if (OPTION("-median")) {
+      Array<string> names(1, "Median");
+      ops.push_back(unique_ptr<Op>(new Percentile(50, "Median", &names)));
     } else if (OPTION("-lower-percentile-mean") || OPTION("-lpctavg")) {
       do {
         int p;
@@ -792,8 +806,42 @@ int main(int argc, char **argv)
     out << endl;
   }
 
+  // Group consecutive element-wise operations to process each group in a single
+  // pass over the data; statistics and other operations which need to see the
+  // entire data sequence are processed separately, except for consecutive
+  // percentiles which are all selected at once
+  Array<unique_ptr<Op> > seqs;
+  Array<Op *>            pipeline;
+  for (size_t i = 0, j; i < ops.size(); i = j) {
+    j = i + 1;
+    if (fuse && dynamic_cast<ElementWiseOp *>(ops[i].get()) != nullptr) {
+      while (j < ops.size() && dynamic_cast<ElementWiseOp *>(ops[j].get()) != nullptr) ++j;
+      if (j - i > 1) {
+        ElementWiseOpSequence *seq = new ElementWiseOpSequence();
+        for (size_t k = i; k < j; ++k) {
+          seq->Add(dynamic_cast<ElementWiseOp *>(ops[k].get()));
+        }
+        seqs.push_back(unique_ptr<Op>(seq));
+        pipeline.push_back(seq);
+        continue;
+      }
+    } else if (typeid(*ops[i]) == typeid(Percentile)) {
+      while (j < ops.size() && typeid(*ops[j]) == typeid(Percentile)) ++j;
+      if (j - i > 1) {
+        PercentileSequence *seq = new PercentileSequence();
+        for (size_t k = i; k < j; ++k) {
+          seq->Add(dynamic_cast<Percentile *>(ops[k].get()));
+        }
+        seqs.push_back(unique_ptr<Op>(seq));
+        pipeline.push_back(seq);
+        continue;
+      }
+    }
+    pipeline.push_back(ops[i].get());
+  }
+
   // Process input data, either transform it or compute statistics from it
-  for (size_t i = 0; i < ops.size(); ++i) ops[i]->Process(n, data, mask);
+  for (size_t i = 0; i < pipeline.size(); ++i) pipeline[i]->Process(n, data, mask);
   delete[] mask;
 
   // Print image statistics
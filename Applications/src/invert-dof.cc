@@ -45,6 +45,11 @@ void PrintHelp(const char *name)
   cout << "Arguments:\n";
   cout << "  dofin    Rigid, affine, or non-rigid input transformation.\n";
   cout << "  dofout   Inverse of input transformation. (approximation)\n";
+  cout << "\n";
+  cout << "Optional arguments:\n";
+  cout << "  -flatten [<mm>]   Replace the levels of a multi-level B-spline FFD by a single FFD before\n";
+  cout << "                    inversion when the maximum displacement error does not exceed the\n";
+  cout << "                    given bound. (default: off, 0.01)\n";
   PrintStandardOptions(cout);
   cout << endl;
 }
@@ -62,8 +67,14 @@ int main(int argc, char **argv)
   const char *dofin_name  = POSARG(1);
   const char *dofout_name = POSARG(2);
 
+  double flatten = .0;
+
   for (ALL_OPTIONS) {
-    HANDLE_STANDARD_OR_UNKNOWN_OPTION();
+    if (OPTION("-flatten")) {
+      flatten = .01;
+      if (HAS_ARGUMENT) PARSE_ARGUMENT(flatten);
+    }
+    else HANDLE_STANDARD_OR_UNKNOWN_OPTION();
   }
 
   // Read transformation
@@ -90,9 +101,21 @@ int main(int argc, char **argv)
   else if (msvffd) msvffd->Invert();
   else if (mffd) {
 
+    // Replace local transformations by single flattened FFD
+    if (mffd->NumberOfLevels() > 1 && flatten > .0) {
+      if (!mffd->Flatten(flatten)) {
+        cerr << EXECNAME << ": Failed to flatten local transformations with maximum error " << flatten << " mm" << endl;
+        exit(1);
+      }
+      FreeFormTransformation *flat = new BSplineFreeFormTransformation3D(*mffd->Flattened());
+      mffd->Unflatten();
+      while (mffd->NumberOfLevels() > 0) delete mffd->PopLocalTransformation();
+      mffd->PushLocalTransformation(flat);
+    }
+
     // Check number of levels
     if (mffd->NumberOfLevels() > 1) {
-      cerr << EXECNAME << ": Inverting of FFDs with more than one level currently not implemented" << endl;
+      cerr << EXECNAME << ": Inverting of FFDs with more than one level currently not implemented, try -flatten" << endl;
       exit(1);
     }
 
@@ -124,31 +147,17 @@ int main(int argc, char **argv)
         BSplineFreeFormTransformation3D *affd1 = dynamic_cast<BSplineFreeFormTransformation3D *>(ffd1);
         BSplineFreeFormTransformation3D *affd2 = new BSplineFreeFormTransformation3D(*affd1);
 
-        // Evaluate inverse displacements
-        double x, y, z;
-
-        double *dx = new double[affd1->NumberOfDOFs() / 3];
-        double *dy = new double[affd1->NumberOfDOFs() / 3];
-        double *dz = new double[affd1->NumberOfDOFs() / 3];
-
-        int index = 0;
-        for (int k = 0; k < affd1->Z(); ++k)
-        for (int j = 0; j < affd1->Y(); ++j)
-        for (int i = 0; i < affd1->X(); ++i, ++index) {
-          x = i, y = j, z = k;
-          affd1->LatticeToWorld(x, y, z);
-          affd1->InverseDisplacement(x, y, z);
-          dx[index] = x;
-          dy[index] = y;
-          dz[index] = z;
+        // Evaluate inverse displacements at control points
+        GenericImage<double> disp(affd1->Attributes(), 3);
+        const int ninv = affd1->InverseDisplacement(disp);
+        if (ninv > 0 && verbose) {
+          cout << "Inverse did not converge at " << ninv << " control points" << endl;
         }
 
         // Interpolate inverse displacements
-        affd2->Interpolate(dx, dy, dz);
-
-        delete[] dx;
-        delete[] dy;
-        delete[] dz;
+        const int ncps = affd1->NumberOfCPs();
+        double *dx = disp.Data();
+        affd2->Interpolate(dx, dx + ncps, dx + ncps + ncps);
 
         ffd2 = affd2;
 
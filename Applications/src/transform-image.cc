@@ -27,6 +27,7 @@
 #include "mirtk/Transformation.h"
 #include "mirtk/HomogeneousTransformation.h"
 #include "mirtk/RigidTransformation.h"
+#include "mirtk/MultiLevelFreeFormTransformation.h"
 #include "mirtk/ImageTransformation.h"
 #include "mirtk/InterpolateImageFunction.h"
 
@@ -64,6 +65,11 @@ void PrintHelp(const char *name)
   cout << "  -St <value>      Time point of source image. (default: torigin)" << endl;
   cout << "  -invert          Invert transformation. (default: off)" << endl;
   cout << "  -2d              Project transformation to 2D, ignoring mapped z coordinate. (default: off)" << endl;
+  cout << "  -tile <n>        Maximum number of target slices (n >= 2) for which displacements are computed at once" << endl;
+  cout << "                   when the transformation requires caching of displacements, e.g., an SV FFD." << endl;
+  cout << "                   Reduces the memory needed for large target images. (default: all)" << endl;
+  cout << "  -flatten [<mm>]  Evaluate the levels of a multi-level B-spline FFD as a single FFD when the" << endl;
+  cout << "                   maximum displacement error does not exceed the given bound. (default: off, 0.01)" << endl;
   cout << endl;
   cout << "Interpolation modes:" << endl;
   for (int i = 0; i < Interpolation_Last; ++i) {
@@ -105,6 +111,8 @@ int main(int argc, char **argv)
   int  target_padding  = MIN_GREY;
   bool invert          = false;
   bool twod            = false;
+  int  tile_size       = 0;
+  double flatten       = .0;
 
   for (ALL_OPTIONS) {
     if      (OPTION("-dof")    ) dof_name       = ARGUMENT, dof_invert = false;
@@ -117,6 +125,16 @@ int main(int argc, char **argv)
     else if (OPTION("-St")     ) source_t       = atof(ARGUMENT);
     else if (OPTION("-invert") ) invert         = true;
     else if (OPTION("-2d")     ) twod           = true;
+    else if (OPTION("-tile")) {
+      PARSE_ARGUMENT(tile_size);
+      if (tile_size < 0 || tile_size == 1) {
+        FatalError("Tile size (-tile) must be at least 2 slices, or 0 for all slices");
+      }
+    }
+    else if (OPTION("-flatten")) {
+      flatten = .01;
+      if (HAS_ARGUMENT) PARSE_ARGUMENT(flatten);
+    }
     else if (OPTION("-interp")) {
       const char *arg = ARGUMENT;
       if (!FromString(arg, interpolation)) {
@@ -194,6 +212,15 @@ int main(int argc, char **argv)
     transformation.reset(Transformation::New(dofin_name));
   }
 
+  // Flatten local transformations
+  if (flatten > .0) {
+    MultiLevelFreeFormTransformation *mffd;
+    mffd = dynamic_cast<MultiLevelFreeFormTransformation *>(transformation.get());
+    if (mffd && mffd->NumberOfLevels() > 1 && !mffd->Flatten(flatten) && verbose) {
+      cout << "Local transformations cannot be flattened with error <= " << flatten << " mm" << endl;
+    }
+  }
+
   // Create image transformation filter
   ImageTransformation imagetransformation;
 
@@ -205,6 +232,7 @@ int main(int argc, char **argv)
   imagetransformation.Interpolator(interpolator.get());
   imagetransformation.Invert(invert);
   imagetransformation.TwoD(twod);
+  imagetransformation.TileSize(tile_size);
 
   // Transform source image
   imagetransformation.Run();
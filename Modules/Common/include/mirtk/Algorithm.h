@@ -30,6 +30,9 @@ namespace mirtk {
 
 using std::sort;
 using std::partial_sort;
+using std::nth_element;
+using std::unique;
+using std::lower_bound;
 using std::transform;
 using std::reverse;
 using std::shuffle;
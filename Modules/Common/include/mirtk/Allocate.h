@@ -20,8 +20,15 @@
 #ifndef MIRTK_Allocate_H
 #define MIRTK_Allocate_H
 
+#include "mirtk/Config.h"
 #include "mirtk/Stream.h"
 
+#include <cstdlib>
+#include <type_traits>
+#ifdef WINDOWS
+#  include <malloc.h>
+#endif
+
 
 namespace mirtk {
 
@@ -129,6 +136,39 @@ inline Type **PAllocate(int n)
   return matrix;
 }
 
+// =============================================================================
+// Aligned 1D array
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Allocate 1D array whose first element is aligned to the specified number
+/// of bytes (e.g., the size of a cache line) without initializing it
+///
+/// The memory must be freed using DeallocateAligned.
+template <class Type>
+inline void AllocateAligned(Type *&matrix, size_t n, size_t alignment = 64)
+{
+  static_assert(std::is_trivially_destructible<Type>::value,
+                "AllocateAligned: Type must be trivially destructible");
+  // Set pointer to NULL if memory size is not positive
+  if (n == 0) {
+    matrix = NULL;
+    return;
+  }
+  // Allocate data memory
+  void *p = NULL;
+  #ifdef WINDOWS
+    p = _aligned_malloc(n * sizeof(Type), alignment);
+  #else
+    if (posix_memalign(&p, alignment, n * sizeof(Type)) != 0) p = NULL;
+  #endif
+  if (p == NULL) {
+    cerr << "AllocateAligned: Failed to allocate " << (n * sizeof(Type)) << " bytes" << endl;
+    exit(1);
+  }
+  matrix = reinterpret_cast<Type *>(p);
+}
+
 // =============================================================================
 // 2D array
 // =============================================================================
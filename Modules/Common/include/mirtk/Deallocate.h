@@ -20,6 +20,13 @@
 #ifndef MIRTK_Deallocate_H
 #define MIRTK_Deallocate_H
 
+#include "mirtk/Config.h"
+
+#include <cstdlib>
+#ifdef WINDOWS
+#  include <malloc.h>
+#endif
+
 namespace mirtk {
 
 
@@ -39,6 +46,18 @@ inline void Deallocate(Type *&p)
   p = NULL;
 }
 
+/// Deallocate 1D array allocated by AllocateAligned
+template <typename Type>
+inline void DeallocateAligned(Type *&p)
+{
+  #ifdef WINDOWS
+    _aligned_free(p);
+  #else
+    free(p);
+  #endif
+  p = NULL;
+}
+
 /// Deallocate 2D array stored in contiguous memory block
 ///
 /// \param[in] matrix Previously allocated array or \c NULL.
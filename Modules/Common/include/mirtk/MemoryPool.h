@@ -0,0 +1,174 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MIRTK_MemoryPool_H
+#define MIRTK_MemoryPool_H
+
+#include "mirtk/Array.h"
+#include "mirtk/UnorderedMap.h"
+#include "mirtk/Stream.h"
+
+#include <cstddef>
+#include <mutex>
+
+
+namespace mirtk {
+
+
+/**
+ * Pool of aligned memory blocks grouped into size classes
+ *
+ * Memory blocks which are returned to the pool are kept for subsequent
+ * requests of the same size class instead of being freed. This avoids the
+ * page faults caused by repeatedly allocating and freeing large buffers of
+ * identical size, e.g., image data of temporary images of the same attributes
+ * created in each iteration of an optimization. The memory of a returned
+ * block is not initialized. Initializing new blocks in parallel ensures that
+ * the memory pages are first touched by the threads which later process them.
+ *
+ * The size of a block is rounded up to the next of eight size classes per
+ * power of two, i.e., at most 12.5% of a block is unused. The total size of
+ * the blocks kept by the pool for reuse is limited by MaxCachedBytes. The
+ * default limit can be set in MB by the environment variable
+ * MIRTK_MEMORY_POOL_MAX_CACHE. Call Clear when the sizes of the allocated
+ * blocks change, e.g., at the end of each resolution level of a registration.
+ *
+ * All functions are thread-safe. Statistics of the memory usage are printed
+ * to STDERR at program exit when the verbosity level is greater than one.
+ */
+class MemoryPool
+{
+  // ---------------------------------------------------------------------------
+  // Singleton
+private:
+
+  /// Constructor
+  MemoryPool();
+
+  /// Destructor
+  ~MemoryPool();
+
+  /// Copy constructor. Intentionally not implemented.
+  MemoryPool(const MemoryPool &);
+
+  /// Assignment operator. Intentionally not implemented.
+  void operator =(const MemoryPool &);
+
+public:
+
+  /// Singleton instance
+  ///
+  /// The instance is never destroyed such that memory can be returned to the
+  /// pool also by objects which are destroyed at program exit.
+  static MemoryPool &Instance();
+
+  // ---------------------------------------------------------------------------
+  // Data members
+private:
+
+  /// Mutex used to synchronize access to the pool
+  mutable std::mutex _Mutex;
+
+  /// Unused memory blocks of each size class
+  UnorderedMap<size_t, Array<void *> > _Cache;
+
+  /// Size class of each memory block in use
+  UnorderedMap<void *, size_t> _InUse;
+
+  /// Maximum total size of unused memory blocks kept for reuse
+  size_t _MaxCachedBytes;
+
+  /// Total size of unused memory blocks kept for reuse
+  size_t _CachedBytes;
+
+  /// Total size of memory blocks in use
+  size_t _BytesInUse;
+
+  /// Maximum total size of memory blocks in use
+  size_t _PeakBytesInUse;
+
+  /// Maximum total size of allocated memory blocks, i.e., in use and cached
+  size_t _PeakBytes;
+
+  /// Number of memory requests
+  size_t _NumberOfRequests;
+
+  /// Number of memory requests served by an unused memory block
+  size_t _NumberOfReuses;
+
+  /// Size class of memory block of given size in bytes
+  static size_t SizeClass(size_t);
+
+  // ---------------------------------------------------------------------------
+  // Memory management
+public:
+
+  /// Alignment of memory blocks in number of bytes
+  static const size_t Alignment = 64;
+
+  /// Default maximum total size of unused memory blocks kept for reuse
+  static const size_t DefaultMaxCachedBytes = size_t(256) << 20;
+
+  /// Get uninitialized memory block of at least the given size in bytes
+  void *Allocate(size_t);
+
+  /// Get uninitialized memory block for n elements of given type
+  template <class Type>
+  Type *Allocate(size_t n)
+  {
+    return reinterpret_cast<Type *>(Allocate(n * sizeof(Type)));
+  }
+
+  /// Return memory block to the pool
+  void Deallocate(void *);
+
+  /// Free unused memory blocks kept for reuse
+  void Clear();
+
+  /// Set maximum total size of unused memory blocks kept for reuse
+  void MaxCachedBytes(size_t);
+
+  /// Get maximum total size of unused memory blocks kept for reuse
+  size_t MaxCachedBytes() const;
+
+  // ---------------------------------------------------------------------------
+  // Statistics
+public:
+
+  /// Maximum total size of memory blocks in use
+  size_t PeakBytesInUse() const;
+
+  /// Maximum total size of allocated memory blocks, i.e., in use and cached
+  size_t PeakBytes() const;
+
+  /// Number of memory requests
+  size_t NumberOfRequests() const;
+
+  /// Number of memory requests served by an unused memory block
+  size_t NumberOfReuses() const;
+
+  /// Print memory usage statistics
+  void Print(ostream &) const;
+
+};
+
+
+} // namespace mirtk
+
+#endif // MIRTK_MemoryPool_H
@@ -25,6 +25,7 @@
 #include "mirtk/Stream.h"
 
 #include <memory>
+#include <functional>
 
 #ifdef HAVE_TBB
 // TBB includes windows header which defines min/max macros otherwise
@@ -36,8 +37,10 @@
 #  include <tbb/blocked_range.h>
 #  include <tbb/blocked_range2d.h>
 #  include <tbb/blocked_range3d.h>
+#  include <tbb/partitioner.h>
 #  include <tbb/parallel_for.h>
 #  include <tbb/parallel_reduce.h>
+#  include <tbb/pipeline.h>
 #  include <tbb/concurrent_queue.h>
 #  include <tbb/mutex.h>
 #  ifdef MIRTK_UNDEF_NOMINMAX
@@ -98,8 +101,14 @@ using tbb::task_scheduler_init;
 using tbb::blocked_range;
 using tbb::blocked_range2d;
 using tbb::blocked_range3d;
+using tbb::affinity_partitioner;
 using tbb::parallel_for;
 using tbb::parallel_reduce;
+using tbb::parallel_pipeline;
+using tbb::make_filter;
+using tbb::filter;
+using tbb::filter_t;
+using tbb::flow_control;
 using tbb::concurrent_queue;
 using tbb::mutex;
 using tbb::split;
@@ -210,18 +219,119 @@ public:
   const blocked_range<T> &cols() const { return _cols; }
 };
 
+/// Dummy partitioner which records the affinity of subranges to threads
+class affinity_partitioner {};
+
 /// parallel_for dummy template function which executes the body serially
 template <class Range, class Body>
 void parallel_for(const Range &range, const Body &body) {
   body(range);
 }
 
+/// parallel_for dummy template function which executes the body serially
+template <class Range, class Body>
+void parallel_for(const Range &range, const Body &body, affinity_partitioner &) {
+  body(range);
+}
+
 /// parallel_reduce dummy template function which executes the body serially
 template <class Range, class Body>
 void parallel_reduce(const Range &range, Body &body) {
   body(range);
 }
 
+/// parallel_reduce dummy template function which executes the body serially
+template <class Range, class Body>
+void parallel_reduce(const Range &range, Body &body, affinity_partitioner &) {
+  body(range);
+}
+
+/// Dummy flow control used to stop the input filter of a pipeline
+class flow_control
+{
+  bool _stopped;
+public:
+  flow_control() : _stopped(false) {}
+  void stop() { _stopped = true; }
+  bool is_pipeline_stopped() const { return _stopped; }
+};
+
+/// Dummy filter modes of a pipeline
+class filter
+{
+public:
+  enum mode { parallel, serial_in_order, serial_out_of_order, serial = serial_in_order };
+};
+
+/// Dummy filter of a pipeline which transforms an item of type T into U
+template <typename T, typename U>
+class filter_t
+{
+public:
+  std::function<U(T)> _body;
+  filter_t() {}
+  template <class Body> filter_t(const Body &body) : _body(body) {}
+  U operator ()(T item) const { return _body(item); }
+};
+
+/// Dummy input filter of a pipeline which generates items of type U
+template <typename U>
+class filter_t<void, U>
+{
+public:
+  std::function<U(flow_control &)> _body;
+  filter_t() {}
+  template <class Body> filter_t(const Body &body) : _body(body) {}
+  U operator ()(flow_control &fc) const { return _body(fc); }
+};
+
+/// Composition of two dummy pipeline filters
+template <typename T, typename V, typename U>
+struct filter_chain
+{
+  filter_t<T, V> _first;
+  filter_t<V, U> _second;
+  U operator ()(T item) const { return _second(_first(item)); }
+};
+
+/// Composition of dummy input filter with subsequent pipeline filter
+template <typename V, typename U>
+struct filter_chain<void, V, U>
+{
+  filter_t<void, V> _first;
+  filter_t<V,    U> _second;
+  U operator ()(flow_control &fc) const
+  {
+    V item = _first(fc);
+    if (fc.is_pipeline_stopped()) return U();
+    return _second(item);
+  }
+};
+
+/// Concatenate dummy pipeline filters
+template <typename T, typename V, typename U>
+filter_t<T, U> operator &(const filter_t<T, V> &first, const filter_t<V, U> &second)
+{
+  filter_chain<T, V, U> chain;
+  chain._first  = first;
+  chain._second = second;
+  return filter_t<T, U>(chain);
+}
+
+/// make_filter dummy template function which wraps the body in a filter
+template <typename T, typename U, class Body>
+filter_t<T, U> make_filter(filter::mode, const Body &body) {
+  return filter_t<T, U>(body);
+}
+
+/// parallel_pipeline dummy function which processes one item at a time
+inline void parallel_pipeline(size_t, const filter_t<void, void> &filters) {
+  flow_control fc;
+  do {
+    filters(fc);
+  } while (!fc.is_pipeline_stopped());
+}
+
 
 #endif // HAVE_TBB
 
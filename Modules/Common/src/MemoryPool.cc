@@ -0,0 +1,242 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mirtk/MemoryPool.h"
+
+#include "mirtk/Allocate.h"
+#include "mirtk/Deallocate.h"
+#include "mirtk/Options.h"
+#include "mirtk/String.h"
+
+#include <cstdlib>
+
+
+namespace mirtk {
+
+
+// =============================================================================
+// Singleton
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Print memory pool statistics at program exit in verbose mode
+static void PrintMemoryPoolStatistics()
+{
+  const MemoryPool &pool = MemoryPool::Instance();
+  if (verbose > 1 && pool.NumberOfRequests() > 0) pool.Print(cerr);
+}
+
+// -----------------------------------------------------------------------------
+/// Maximum total size of cached memory blocks set by environment variable
+static size_t MaxCachedBytesFromEnvironment()
+{
+  size_t n = MemoryPool::DefaultMaxCachedBytes;
+  const char *value = getenv("MIRTK_MEMORY_POOL_MAX_CACHE");
+  if (value && value[0] != '\0') {
+    double mb;
+    if (FromString(value, mb) && mb >= .0) {
+      n = static_cast<size_t>(mb * 1024.0 * 1024.0);
+    } else {
+      cerr << "Warning: Invalid MIRTK_MEMORY_POOL_MAX_CACHE value: " << value << endl;
+    }
+  }
+  return n;
+}
+
+// -----------------------------------------------------------------------------
+/// Create memory pool instance which is never destroyed
+static MemoryPool *NewMemoryPool(MemoryPool *pool)
+{
+  atexit(PrintMemoryPoolStatistics);
+  return pool;
+}
+
+// -----------------------------------------------------------------------------
+MemoryPool &MemoryPool::Instance()
+{
+  static MemoryPool *instance = NewMemoryPool(new MemoryPool());
+  return *instance;
+}
+
+// -----------------------------------------------------------------------------
+MemoryPool::MemoryPool()
+:
+  _MaxCachedBytes(MaxCachedBytesFromEnvironment()),
+  _CachedBytes(0),
+  _BytesInUse(0),
+  _PeakBytesInUse(0),
+  _PeakBytes(0),
+  _NumberOfRequests(0),
+  _NumberOfReuses(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+MemoryPool::~MemoryPool()
+{
+  Clear();
+}
+
+// =============================================================================
+// Memory management
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::SizeClass(size_t n)
+{
+  if (n == 0) n = 1;
+  // Largest power of two not greater than the requested size
+  size_t p = 1;
+  while ((p << 1) != 0 && (p << 1) <= n) p <<= 1;
+  // Round up to next multiple of an eighth of it
+  size_t step = p >> 3;
+  if (step < Alignment) step = Alignment;
+  return ((n + step - 1) / step) * step;
+}
+
+// -----------------------------------------------------------------------------
+void *MemoryPool::Allocate(size_t n)
+{
+  const size_t size = SizeClass(n);
+  char *p = NULL;
+  {
+    std::lock_guard<std::mutex> lock(_Mutex);
+    ++_NumberOfRequests;
+    auto cached = _Cache.find(size);
+    if (cached != _Cache.end() && !cached->second.empty()) {
+      p = reinterpret_cast<char *>(cached->second.back());
+      cached->second.pop_back();
+      _CachedBytes -= size;
+      ++_NumberOfReuses;
+    }
+  }
+  if (p == NULL) AllocateAligned(p, size, Alignment);
+  {
+    std::lock_guard<std::mutex> lock(_Mutex);
+    _InUse[p] = size;
+    _BytesInUse += size;
+    if (_BytesInUse > _PeakBytesInUse) {
+      _PeakBytesInUse = _BytesInUse;
+    }
+    if (_BytesInUse + _CachedBytes > _PeakBytes) {
+      _PeakBytes = _BytesInUse + _CachedBytes;
+    }
+  }
+  return p;
+}
+
+// -----------------------------------------------------------------------------
+void MemoryPool::Deallocate(void *p)
+{
+  if (p == NULL) return;
+  bool cache;
+  {
+    std::lock_guard<std::mutex> lock(_Mutex);
+    auto block = _InUse.find(p);
+    if (block == _InUse.end()) {
+      cerr << "MemoryPool::Deallocate: Memory was not allocated by this pool" << endl;
+      exit(1);
+    }
+    const size_t size = block->second;
+    _InUse.erase(block);
+    _BytesInUse -= size;
+    cache = (_CachedBytes + size <= _MaxCachedBytes);
+    if (cache) {
+      _Cache[size].push_back(p);
+      _CachedBytes += size;
+    }
+  }
+  if (!cache) DeallocateAligned(p);
+}
+
+// -----------------------------------------------------------------------------
+void MemoryPool::Clear()
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  for (auto it = _Cache.begin(); it != _Cache.end(); ++it) {
+    for (auto p = it->second.begin(); p != it->second.end(); ++p) {
+      DeallocateAligned(*p);
+    }
+  }
+  _Cache.clear();
+  _CachedBytes = 0;
+}
+
+// -----------------------------------------------------------------------------
+void MemoryPool::MaxCachedBytes(size_t n)
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  _MaxCachedBytes = n;
+}
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::MaxCachedBytes() const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  return _MaxCachedBytes;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::PeakBytesInUse() const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  return _PeakBytesInUse;
+}
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::PeakBytes() const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  return _PeakBytes;
+}
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::NumberOfRequests() const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  return _NumberOfRequests;
+}
+
+// -----------------------------------------------------------------------------
+size_t MemoryPool::NumberOfReuses() const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  return _NumberOfReuses;
+}
+
+// -----------------------------------------------------------------------------
+void MemoryPool::Print(ostream &os) const
+{
+  std::lock_guard<std::mutex> lock(_Mutex);
+  const double MB = 1024.0 * 1024.0;
+  const double reuse_rate = (_NumberOfRequests > 0 ? 100.0 * _NumberOfReuses / _NumberOfRequests : 0.);
+  os << "Memory pool: " << _NumberOfRequests << " allocations, "
+     << fixed << setprecision(1) << reuse_rate << "% reused, peak "
+     << _PeakBytesInUse / MB << " MB in use, peak "
+     << _PeakBytes      / MB << " MB allocated" << endl;
+  os.unsetf(ios::floatfield);
+  os.precision(6);
+}
+
+
+} // namespace mirtk
@@ -0,0 +1,118 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2016 Imperial College London
+ * Copyright 2016 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "mirtk/MemoryPool.h"
+using namespace mirtk;
+
+
+// =============================================================================
+// Memory management
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+TEST(MemoryPool, Alignment)
+{
+  MemoryPool &pool = MemoryPool::Instance();
+  for (size_t n = 1; n < 100000; n = 3 * n + 1) {
+    void *p = pool.Allocate(n);
+    EXPECT_EQ(0u, reinterpret_cast<size_t>(p) % MemoryPool::Alignment);
+    pool.Deallocate(p);
+  }
+  pool.Clear();
+}
+
+// -----------------------------------------------------------------------------
+TEST(MemoryPool, Reuse)
+{
+  MemoryPool &pool = MemoryPool::Instance();
+  pool.Clear();
+  const size_t max_cached_bytes = pool.MaxCachedBytes();
+  pool.MaxCachedBytes(MemoryPool::DefaultMaxCachedBytes);
+  const size_t reuses = pool.NumberOfReuses();
+  void *p = pool.Allocate(100000);
+  pool.Deallocate(p);
+  void *q = pool.Allocate(100000);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(reuses + 1, pool.NumberOfReuses());
+  pool.Deallocate(q);
+  pool.Clear();
+  q = pool.Allocate(100000);
+  EXPECT_EQ(reuses + 1, pool.NumberOfReuses());
+  pool.Deallocate(q);
+  pool.Clear();
+  pool.MaxCachedBytes(max_cached_bytes);
+}
+
+// -----------------------------------------------------------------------------
+TEST(MemoryPool, SizeClasses)
+{
+  MemoryPool &pool = MemoryPool::Instance();
+  pool.Clear();
+  const size_t max_cached_bytes = pool.MaxCachedBytes();
+  pool.MaxCachedBytes(MemoryPool::DefaultMaxCachedBytes);
+  const size_t reuses = pool.NumberOfReuses();
+  // 1000 and 1010 bytes are rounded up to the same size class of 1024 bytes
+  void *p = pool.Allocate(1000);
+  pool.Deallocate(p);
+  void *q = pool.Allocate(1010);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(reuses + 1, pool.NumberOfReuses());
+  pool.Deallocate(q);
+  // 1100 bytes belong to the next size class of 1152 bytes
+  q = pool.Allocate(1100);
+  EXPECT_NE(p, q);
+  EXPECT_EQ(reuses + 1, pool.NumberOfReuses());
+  pool.Deallocate(q);
+  // Smaller size classes are not reused for larger requests and vice versa
+  q = pool.Allocate(900);
+  EXPECT_NE(p, q);
+  EXPECT_EQ(reuses + 1, pool.NumberOfReuses());
+  pool.Deallocate(q);
+  pool.Clear();
+  pool.MaxCachedBytes(max_cached_bytes);
+}
+
+// -----------------------------------------------------------------------------
+TEST(MemoryPool, MaxCachedBytes)
+{
+  MemoryPool &pool = MemoryPool::Instance();
+  pool.Clear();
+  const size_t max_cached_bytes = pool.MaxCachedBytes();
+  const size_t reuses = pool.NumberOfReuses();
+  pool.MaxCachedBytes(0);
+  void *p = pool.Allocate(1024);
+  pool.Deallocate(p);
+  p = pool.Allocate(1024);
+  EXPECT_EQ(reuses, pool.NumberOfReuses());
+  pool.Deallocate(p);
+  pool.MaxCachedBytes(max_cached_bytes);
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
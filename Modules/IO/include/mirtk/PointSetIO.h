@@ -159,6 +159,40 @@ vtkSmartPointer<vtkPolyData> ReadOFF(const char *fname);
 /// @return Whether dataset was written successfully to the specified file.
 bool WriteOFF(const char *fname, vtkPolyData *polydata);
 
+// =============================================================================
+// Binary surface cache I/O functions
+// =============================================================================
+
+/// Read polygonal dataset from binary surface cache (.msc) file
+///
+/// The binary surface cache is a simple versioned file format intended for
+/// the fast reload of surface meshes with many point and cell data arrays by
+/// subsequent processing steps on the same machine. Point coordinates, cells,
+/// and data arrays are stored in native byte order as contiguous blocks which
+/// are aligned at 8 byte boundaries such that these can be read directly into
+/// the memory of the respective VTK arrays or mapped into memory.
+///
+/// Point and cell data arrays whose number of tuples does not match the number
+/// of points and cells, respectively, are skipped.
+///
+/// @param[in] fname  File name.
+/// @param[in] errmsg Whether to print error messages if any.
+///
+/// @return Polygonal dataset. Dataset is empty if file could not be read,
+///         e.g., because it was written on a machine with different byte order.
+vtkSmartPointer<vtkPolyData> ReadMSC(const char *fname, bool errmsg = false);
+
+/// Write polygonal dataset to binary surface cache (.msc) file
+///
+/// Point and cell data arrays of a type other than (unsigned) char, short, int,
+/// float, double, or vtkIdType are not saved.
+///
+/// @param[in] fname    File name.
+/// @param[in] polydata Polygonal dataset.
+///
+/// @return Whether dataset was written successfully to the specified file.
+bool WriteMSC(const char *fname, vtkPolyData *polydata);
+
 // =============================================================================
 // GIFTI I/O functions -- https://www.nitrc.org/projects/gifti/
 // =============================================================================
@@ -297,6 +331,21 @@ vtkSmartPointer<vtkCellArray> ReadGIFTITopology(const char     *fname,
 vtkSmartPointer<vtkPointData> ReadGIFTIPointData(const char *fname,
                                                  bool errmsg = false);
 
+/// Read selected point data arrays from GIFTI (.gii) file
+///
+/// The file is parsed once, keeping the encoded data of each array as text.
+/// Only the data of the selected arrays is then decoded, in parallel.
+///
+/// @param[in] fname  File name.
+/// @param[in] arrays Names of point data arrays to read. The name of a GIFTI
+///                   data array without "Name" meta data is its intent code.
+/// @param[in] errmsg Whether to print error messages if any.
+///
+/// @return Point data arrays or nullptr if file could not be read.
+vtkSmartPointer<vtkPointData> ReadGIFTIPointData(const char          *fname,
+                                                 const Array<string> &arrays,
+                                                 bool                 errmsg = false);
+
 /// Read polygonal dataset from GIFTI (.gii) file
 ///
 /// Standard GIFTI meta data is stored in the vtkInformation of the returned
@@ -331,6 +380,25 @@ vtkSmartPointer<vtkPolyData> ReadGIFTI(const char  *fname,
                                        vtkPolyData *surface = nullptr,
                                        bool         errmsg  = false);
 
+/// Read polygonal dataset with selected point data arrays from GIFTI (.gii) file
+///
+/// Data arrays with intent @c NIFTI_INTENT_POINTSET, @c NIFTI_INTENT_TRIANGLE,
+/// and @c NIFTI_INTENT_NODE_INDEX are always read. Other data arrays are only
+/// decoded when their name is contained in the given selection.
+///
+/// @param[in]     fname   File name.
+/// @param[in]     arrays  Names of point data arrays to read.
+/// @param[in,out] surface Polygonal dataset to which to add GIFTI data arrays.
+/// @param[in]     errmsg  Whether to print error messages if any.
+///
+/// @return Polygonal dataset. Dataset is empty if file could not be read.
+///
+/// @sa ReadGIFTI(const char *, vtkPolyData *, bool)
+vtkSmartPointer<vtkPolyData> ReadGIFTI(const char          *fname,
+                                       const Array<string> &arrays,
+                                       vtkPolyData         *surface = nullptr,
+                                       bool                 errmsg  = false);
+
 /// Write polygonal dataset to GIFTI ([.surf].gii) file
 ///
 /// @param[in] fname    File name. Based on the extension either all or only
@@ -26,6 +26,7 @@
 
 #include "vtkPoints.h"
 #include "vtkPointData.h"
+#include "vtkCellData.h"
 #include "vtkDataArray.h"
 #include "vtkCellArray.h"
 #include "vtkIdTypeArray.h"
@@ -61,6 +62,9 @@
 #include "brainsuite/dfsurface.h"
 
 #if MIRTK_IO_WITH_GIFTI
+  #include "mirtk/Array.h"
+  #include "mirtk/Algorithm.h"
+  #include "mirtk/Parallel.h"
   #include "mirtk/NiftiImageInfo.h"
   #include "gifti/gifti_io.h"
 #endif
@@ -91,7 +95,7 @@ vtkSmartPointer<vtkPointSet> ReadPointSet(const char *fname, int *ftype, bool ex
 {
   vtkSmartPointer<vtkPointSet> pointset;
   const string ext = Extension(fname);
-  if (ext == ".vtp" || ext == ".stl" || ext == ".ply" || ext == ".obj" || ext == ".dfs" || ext == ".off" || ext == ".gii") {
+  if (ext == ".vtp" || ext == ".stl" || ext == ".ply" || ext == ".obj" || ext == ".dfs" || ext == ".off" || ext == ".gii" || ext == ".msc") {
     pointset = ReadPolyData(fname);
   } else if (ext.length() == 4  && ext.substr(0, 3) == ".vt" && ext != ".vtk") {
     vtkSmartPointer<vtkXMLGenericDataObjectReader> reader;
@@ -121,7 +125,9 @@ bool WritePointSet(const char *fname, vtkPointSet *pointset, bool compress, bool
   if (polydata) return WritePolyData(fname, polydata, compress, ascii);
   const string ext = Extension(fname);
   int success = 0;
-  if (ext.length() == 4 && ext.substr(0, 3) == ".vt" && ext != ".vtk") {
+  if (ext == ".msc") {
+    cerr << "Error: Only polygonal datasets can be written to binary surface cache file!" << endl;
+  } else if (ext.length() == 4 && ext.substr(0, 3) == ".vt" && ext != ".vtk") {
     vtkSmartPointer<vtkXMLDataSetWriter> writer;
     writer = vtkSmartPointer<vtkXMLDataSetWriter>::New();
     SetVTKInput(writer, pointset);
@@ -174,6 +180,8 @@ vtkSmartPointer<vtkPolyData> ReadPolyData(const char *fname, int *ftype, bool ex
     polydata = ReadDFS(fname);
   } else if (ext == ".off") {
     polydata = ReadOFF(fname);
+  } else if (ext == ".msc") {
+    polydata = ReadMSC(fname, exit_on_failure);
   } else if (ext == ".gii") {
     #if MIRTK_IO_WITH_GIFTI
       polydata = ReadGIFTI(fname, nullptr, exit_on_failure);
@@ -237,6 +245,8 @@ bool WritePolyData(const char *fname, vtkPolyData *polydata, bool compress, bool
     success = WriteDFS(fname, polydata);
   } else if (ext == ".off") {
     success = WriteOFF(fname, polydata);
+  } else if (ext == ".msc") {
+    success = WriteMSC(fname, polydata);
   } else if (ext == ".gii") {
     #if MIRTK_IO_WITH_GIFTI
       success = WriteGIFTI(fname, polydata, compress, ascii);
@@ -537,6 +547,390 @@ bool WriteOFF(const char *fname, vtkPolyData *polydata)
   return !ofs.fail();
 }
 
+// =============================================================================
+// Binary surface cache I/O functions
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Magic number at the start of a binary surface cache file
+static const char MSC_MAGIC[8] = {'M', 'I', 'R', 'T', 'K', 'S', 'C', '\0'};
+
+/// Version of binary surface cache file format
+static const vtkTypeUInt32 MSC_VERSION = 1u;
+
+/// Byte order mark used to detect files written on a machine with different endianness
+static const vtkTypeUInt32 MSC_BYTE_ORDER = 0x01020304u;
+
+/// Alignment of data blocks in binary surface cache file in bytes
+static const size_t MSC_ALIGNMENT = 8;
+
+// -----------------------------------------------------------------------------
+/// Number of padding bytes following a block of given size
+inline size_t MSCPadding(size_t nbytes)
+{
+  const size_t r = nbytes % MSC_ALIGNMENT;
+  return (r == 0 ? 0 : MSC_ALIGNMENT - r);
+}
+
+// -----------------------------------------------------------------------------
+/// Write data block followed by zero padding
+static void WriteMSCBlock(ostream &os, const void *data, size_t nbytes)
+{
+  static const char zeros[MSC_ALIGNMENT] = {0};
+  if (nbytes > 0) os.write(reinterpret_cast<const char *>(data), nbytes);
+  const size_t npad = MSCPadding(nbytes);
+  if (npad > 0) os.write(zeros, npad);
+}
+
+// -----------------------------------------------------------------------------
+/// Read data block and skip padding
+static bool ReadMSCBlock(istream &is, void *data, size_t nbytes)
+{
+  if (nbytes > 0) is.read(reinterpret_cast<char *>(data), nbytes);
+  const size_t npad = MSCPadding(nbytes);
+  if (npad > 0) is.ignore(npad);
+  return !is.fail();
+}
+
+// -----------------------------------------------------------------------------
+/// Whether a point or cell data array can be stored in a binary surface cache
+static bool IsMSCDataArray(vtkDataArray *data)
+{
+  if (data == nullptr) return false;
+  switch (data->GetDataType()) {
+    case VTK_CHAR:
+    case VTK_UNSIGNED_CHAR:
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+    case VTK_INT:
+    case VTK_UNSIGNED_INT:
+    case VTK_FLOAT:
+    case VTK_DOUBLE:
+    case VTK_ID_TYPE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// Write cells of polygonal dataset to binary surface cache
+static void WriteMSCCells(ostream &os, vtkCellArray *cells)
+{
+  vtkTypeInt64 header[2] = {0, 0};
+  if (cells) {
+    header[0] = static_cast<vtkTypeInt64>(cells->GetNumberOfCells());
+    header[1] = static_cast<vtkTypeInt64>(cells->GetNumberOfConnectivityEntries());
+  }
+  WriteMSCBlock(os, header, sizeof(header));
+  if (header[1] > 0) {
+    const vtkIdType *ids = cells->GetPointer();
+    if (sizeof(vtkIdType) == sizeof(vtkTypeInt64)) {
+      WriteMSCBlock(os, ids, header[1] * sizeof(vtkTypeInt64));
+    } else {
+      Array<vtkTypeInt64> buffer(ids, ids + header[1]);
+      WriteMSCBlock(os, buffer.data(), buffer.size() * sizeof(vtkTypeInt64));
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// Print reason why binary surface cache file could not be read
+static void MSCError(const char *fname, const char *reason, bool errmsg)
+{
+  if (errmsg) {
+    cerr << "Error: Failed to read binary surface cache file " << fname << ": " << reason << endl;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// Read cells of polygonal dataset from binary surface cache
+static vtkSmartPointer<vtkCellArray>
+ReadMSCCells(istream &is, vtkIdType npoints, const char *fname, bool errmsg)
+{
+  vtkTypeInt64 header[2];
+  if (!ReadMSCBlock(is, header, sizeof(header))) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return nullptr;
+  }
+  if (header[0] < 0 || header[1] < header[0]) {
+    MSCError(fname, "Invalid number of cells", errmsg);
+    return nullptr;
+  }
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  if (header[0] == 0) {
+    if (header[1] > 0) is.ignore(header[1] * sizeof(vtkTypeInt64));
+    return cells;
+  }
+  vtkSmartPointer<vtkIdTypeArray> ids = vtkSmartPointer<vtkIdTypeArray>::New();
+  ids->SetNumberOfTuples(header[1]);
+  bool ok;
+  if (sizeof(vtkIdType) == sizeof(vtkTypeInt64)) {
+    ok = ReadMSCBlock(is, ids->GetPointer(0), header[1] * sizeof(vtkTypeInt64));
+  } else {
+    Array<vtkTypeInt64> buffer(header[1]);
+    ok = ReadMSCBlock(is, buffer.data(), buffer.size() * sizeof(vtkTypeInt64));
+    for (vtkTypeInt64 i = 0; i < header[1]; ++i) {
+      ids->SetValue(i, static_cast<vtkIdType>(buffer[i]));
+    }
+  }
+  if (!ok) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return nullptr;
+  }
+  // Validate cell connectivity
+  const vtkIdType *ptr = ids->GetPointer(0), *end = ptr + header[1];
+  for (vtkTypeInt64 n = 0; n < header[0]; ++n) {
+    if (ptr == end || *ptr < 0 || *ptr > end - ptr - 1) {
+      MSCError(fname, "Invalid number of cell points", errmsg);
+      return nullptr;
+    }
+    for (const vtkIdType *pts = ptr + 1; pts <= ptr + *ptr; ++pts) {
+      if (*pts < 0 || *pts >= npoints) {
+        MSCError(fname, "Invalid cell point index", errmsg);
+        return nullptr;
+      }
+    }
+    ptr += *ptr + 1;
+  }
+  if (ptr != end) {
+    MSCError(fname, "Size of cell connectivity array does not match number of cells", errmsg);
+    return nullptr;
+  }
+  cells->SetCells(header[0], ids);
+  return cells;
+}
+
+// -----------------------------------------------------------------------------
+/// Write point or cell data arrays to binary surface cache
+static void WriteMSCData(ostream &os, vtkDataSetAttributes *attr)
+{
+  Array<int> arrays;
+  for (int i = 0; i < attr->GetNumberOfArrays(); ++i) {
+    if (IsMSCDataArray(attr->GetArray(i))) arrays.push_back(i);
+  }
+  const vtkTypeInt64 narrays = static_cast<vtkTypeInt64>(arrays.size());
+  WriteMSCBlock(os, &narrays, sizeof(narrays));
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    vtkDataArray * const data = attr->GetArray(arrays[i]);
+    const char   * const name = data->GetName();
+    vtkTypeInt32 header[6];
+    header[0] = static_cast<vtkTypeInt32>(data->GetDataType());
+    header[1] = static_cast<vtkTypeInt32>(data->GetDataTypeSize());
+    header[2] = static_cast<vtkTypeInt32>(data->GetNumberOfComponents());
+    header[3] = static_cast<vtkTypeInt32>(attr->IsArrayAnAttribute(arrays[i]));
+    header[4] = static_cast<vtkTypeInt32>(name ? strlen(name) : 0);
+    header[5] = 0;
+    const vtkTypeInt64 ntuples = static_cast<vtkTypeInt64>(data->GetNumberOfTuples());
+    WriteMSCBlock(os, header,   sizeof(header));
+    WriteMSCBlock(os, &ntuples, sizeof(ntuples));
+    WriteMSCBlock(os, name, header[4]);
+    WriteMSCBlock(os, data->GetVoidPointer(0), ntuples * header[1] * header[2]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// Read point or cell data arrays from binary surface cache
+///
+/// Arrays whose number of tuples differs from the number of points or cells,
+/// respectively, are skipped.
+static bool ReadMSCData(istream &is, vtkDataSetAttributes *attr, vtkIdType ntuples,
+                        const char *fname, bool errmsg)
+{
+  vtkTypeInt64 narrays;
+  if (!ReadMSCBlock(is, &narrays, sizeof(narrays))) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return false;
+  }
+  if (narrays < 0) {
+    MSCError(fname, "Invalid number of data arrays", errmsg);
+    return false;
+  }
+  vtkTypeInt32 header[6];
+  vtkTypeInt64 n;
+  string  name;
+  for (vtkTypeInt64 i = 0; i < narrays; ++i) {
+    if (!ReadMSCBlock(is, header, sizeof(header)) || !ReadMSCBlock(is, &n, sizeof(n))) {
+      MSCError(fname, "Unexpected end of file", errmsg);
+      return false;
+    }
+    if (n < 0 || header[1] <= 0 || header[2] <= 0 || header[4] < 0) {
+      MSCError(fname, "Invalid data array header", errmsg);
+      return false;
+    }
+    name.resize(header[4]);
+    if (!ReadMSCBlock(is, &name[0], name.size())) {
+      MSCError(fname, "Unexpected end of file", errmsg);
+      return false;
+    }
+    const size_t nbytes = static_cast<size_t>(n) * header[1] * header[2];
+    if (n != static_cast<vtkTypeInt64>(ntuples)) {
+      if (errmsg) {
+        cerr << "Warning: Skipping data array " << (name.empty() ? "without name" : name)
+             << " in binary surface cache file " << fname << " with " << n
+             << " instead of " << ntuples << " tuples" << endl;
+      }
+      is.ignore(nbytes + MSCPadding(nbytes));
+      continue;
+    }
+    switch (header[0]) {
+      case VTK_CHAR: case VTK_UNSIGNED_CHAR:
+      case VTK_SHORT: case VTK_UNSIGNED_SHORT:
+      case VTK_INT: case VTK_UNSIGNED_INT:
+      case VTK_FLOAT: case VTK_DOUBLE:
+      case VTK_ID_TYPE: break;
+      default:
+        MSCError(fname, "Unsupported data array type", errmsg);
+        return false;
+    }
+    vtkSmartPointer<vtkDataArray> data = NewVTKDataArray(header[0]);
+    if (data->GetDataTypeSize() != header[1]) {
+      MSCError(fname, "Size of data array type does not match", errmsg);
+      return false;
+    }
+    data->SetNumberOfComponents(header[2]);
+    data->SetNumberOfTuples(ntuples);
+    if (!name.empty()) data->SetName(name.c_str());
+    if (!ReadMSCBlock(is, data->GetVoidPointer(0), nbytes)) {
+      MSCError(fname, "Unexpected end of file", errmsg);
+      return false;
+    }
+    const int idx = attr->AddArray(data);
+    if (header[3] >= 0 && header[3] < vtkDataSetAttributes::NUM_ATTRIBUTES) {
+      attr->SetActiveAttribute(idx, header[3]);
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadMSC(const char *fname, bool errmsg)
+{
+  vtkSmartPointer<vtkPolyData> polydata = vtkSmartPointer<vtkPolyData>::New();
+
+  ifstream ifs(fname, ios::in | ios::binary);
+  if (!ifs) {
+    MSCError(fname, "Cannot open file", errmsg);
+    return polydata;
+  }
+
+  // Read file header
+  char     magic[8];
+  vtkTypeUInt32 version[2];
+  if (!ReadMSCBlock(ifs, magic,   sizeof(magic)) ||
+      !ReadMSCBlock(ifs, version, sizeof(version))) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return polydata;
+  }
+  if (memcmp(magic, MSC_MAGIC, sizeof(magic)) != 0) {
+    MSCError(fname, "Invalid magic number", errmsg);
+    return polydata;
+  }
+  if (version[0] != MSC_VERSION) {
+    MSCError(fname, "Unsupported file format version", errmsg);
+    return polydata;
+  }
+  if (version[1] != MSC_BYTE_ORDER) {
+    MSCError(fname, "File was written on a machine with different byte order", errmsg);
+    return polydata;
+  }
+
+  // Read point coordinates
+  vtkTypeInt32 type[2];
+  vtkTypeInt64 npoints;
+  if (!ReadMSCBlock(ifs, type,     sizeof(type)) ||
+      !ReadMSCBlock(ifs, &npoints, sizeof(npoints))) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return polydata;
+  }
+  if ((type[0] != VTK_FLOAT && type[0] != VTK_DOUBLE) || npoints < 0) {
+    MSCError(fname, "Invalid point coordinates header", errmsg);
+    return polydata;
+  }
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(type[0]);
+  points->SetNumberOfPoints(npoints);
+  if (type[1] != points->GetData()->GetDataTypeSize()) {
+    MSCError(fname, "Size of point coordinates type does not match", errmsg);
+    return polydata;
+  }
+  if (!ReadMSCBlock(ifs, points->GetVoidPointer(0), 3 * npoints * type[1])) {
+    MSCError(fname, "Unexpected end of file", errmsg);
+    return polydata;
+  }
+
+  // Read cells
+  vtkSmartPointer<vtkCellArray> verts, lines, polys, strips;
+  if (!(verts  = ReadMSCCells(ifs, npoints, fname, errmsg))) return polydata;
+  if (!(lines  = ReadMSCCells(ifs, npoints, fname, errmsg))) return polydata;
+  if (!(polys  = ReadMSCCells(ifs, npoints, fname, errmsg))) return polydata;
+  if (!(strips = ReadMSCCells(ifs, npoints, fname, errmsg))) return polydata;
+  const vtkIdType ncells = verts ->GetNumberOfCells() + lines ->GetNumberOfCells()
+                         + polys ->GetNumberOfCells() + strips->GetNumberOfCells();
+
+  // Read point and cell data
+  vtkSmartPointer<vtkPointData> pd = vtkSmartPointer<vtkPointData>::New();
+  vtkSmartPointer<vtkCellData>  cd = vtkSmartPointer<vtkCellData >::New();
+  if (!ReadMSCData(ifs, pd, npoints, fname, errmsg)) return polydata;
+  if (!ReadMSCData(ifs, cd, ncells,  fname, errmsg)) return polydata;
+
+  // Assemble polygonal dataset
+  polydata->SetPoints(points);
+  if (verts ->GetNumberOfCells() > 0) polydata->SetVerts(verts);
+  if (lines ->GetNumberOfCells() > 0) polydata->SetLines(lines);
+  if (polys ->GetNumberOfCells() > 0) polydata->SetPolys(polys);
+  if (strips->GetNumberOfCells() > 0) polydata->SetStrips(strips);
+  polydata->GetPointData()->ShallowCopy(pd);
+  polydata->GetCellData ()->ShallowCopy(cd);
+  return polydata;
+}
+
+// -----------------------------------------------------------------------------
+bool WriteMSC(const char *fname, vtkPolyData *polydata)
+{
+  ofstream ofs(fname, ios::out | ios::binary | ios::trunc);
+  if (!ofs) return false;
+
+  // Write file header
+  const vtkTypeUInt32 version[2] = {MSC_VERSION, MSC_BYTE_ORDER};
+  WriteMSCBlock(ofs, MSC_MAGIC, sizeof(MSC_MAGIC));
+  WriteMSCBlock(ofs, version,   sizeof(version));
+
+  // Write point coordinates, converting other than floating point types to double
+  vtkPoints * const  points  = polydata->GetPoints();
+  const vtkTypeInt64 npoints = static_cast<vtkTypeInt64>(points ? points->GetNumberOfPoints() : 0);
+  const bool         convert = (points && points->GetDataType() != VTK_FLOAT
+                                       && points->GetDataType() != VTK_DOUBLE);
+  vtkTypeInt32 type[2] = {VTK_DOUBLE, static_cast<vtkTypeInt32>(sizeof(double))};
+  if (points && !convert) {
+    type[0] = static_cast<vtkTypeInt32>(points->GetDataType());
+    type[1] = static_cast<vtkTypeInt32>(points->GetData()->GetDataTypeSize());
+  }
+  WriteMSCBlock(ofs, type,     sizeof(type));
+  WriteMSCBlock(ofs, &npoints, sizeof(npoints));
+  if (convert) {
+    Array<double> coords(3 * npoints);
+    for (vtkTypeInt64 i = 0; i < npoints; ++i) {
+      points->GetPoint(i, &coords[3 * i]);
+    }
+    WriteMSCBlock(ofs, coords.data(), coords.size() * sizeof(double));
+  } else if (npoints > 0) {
+    WriteMSCBlock(ofs, points->GetVoidPointer(0), 3 * npoints * type[1]);
+  }
+
+  // Write cells
+  WriteMSCCells(ofs, polydata->GetVerts());
+  WriteMSCCells(ofs, polydata->GetLines());
+  WriteMSCCells(ofs, polydata->GetPolys());
+  WriteMSCCells(ofs, polydata->GetStrips());
+
+  // Write point and cell data
+  WriteMSCData(ofs, polydata->GetPointData());
+  WriteMSCData(ofs, polydata->GetCellData());
+
+  return !ofs.fail();
+}
+
 // =============================================================================
 // TetGen I/O functions
 // =============================================================================
@@ -906,6 +1300,69 @@ static void CopyDataArray(giiDataArray *dst, vtkDataArray *src)
   }
 }
 
+// -----------------------------------------------------------------------------
+/// Convert independent GIFTI data arrays to vtkDataArray instances in parallel
+struct CopyGiftiDataArrays
+{
+  const Array<const giiDataArray *>           *_Input;
+  const Array<vtkSmartPointer<vtkDataArray> > *_Output;
+  vtkIdTypeArray                              *_Indices;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    for (int i = re.begin(); i != re.end(); ++i) {
+      CopyDataArray((*_Output)[i], (*_Input)[i], _Indices);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Convert independent vtkDataArray instances to GIFTI data arrays in parallel
+struct CopyVtkDataArrays
+{
+  const Array<vtkDataArray *> *_Input;
+  giiDataArray               **_Output;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    for (int i = re.begin(); i != re.end(); ++i) {
+      CopyDataArray(_Output[i], (*_Input)[i]);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Decode Base64 encoded data of independent GIFTI data arrays in parallel
+struct DecodeGiftiDataArrays
+{
+  giiDataArray   **_DataArrays;
+  giiEncodedData  *_EncodedData;
+  int             *_Status;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    for (int i = re.begin(); i != re.end(); ++i) {
+      _Status[i] = gifti_decode_DA_data(_DataArrays[i], &_EncodedData[i]);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Encode data of independent GIFTI data arrays as Base64 text in parallel
+struct EncodeGiftiDataArrays
+{
+  giiDataArray   **_DataArrays;
+  giiEncodedData  *_EncodedData;
+  int             *_Status;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    for (int i = re.begin(); i != re.end(); ++i) {
+      _Status[i] = gifti_encode_DA_data(_DataArrays[i], &_EncodedData[i]);
+    }
+  }
+};
+
 // -----------------------------------------------------------------------------
 // vtkInformation keys of standard GIFTI meta data entries
 #define GiftiMetaDataKeyMacro(getter, name, type) \
@@ -1270,14 +1727,17 @@ GetPointData(const gifti_image *gim, vtkIdType npoints = 0, vtkIdTypeArray *indi
       exit(1);
     }
   }
-  bool ok = true;
-  vtkSmartPointer<vtkPointData> pd = vtkSmartPointer<vtkPointData>::New();
+  // Allocate output arrays
+  Array<const giiDataArray *>           input;
+  Array<vtkSmartPointer<vtkDataArray> > output;
+  input .reserve(gim->numDA);
+  output.reserve(gim->numDA);
   for (int i = 0; i < gim->numDA; ++i) {
-    giiDataArray *da = gim->darray[i];
+    const giiDataArray * const da = gim->darray[i];
     if (da->intent != NIFTI_INTENT_POINTSET &&
         da->intent != NIFTI_INTENT_TRIANGLE &&
         da->intent != NIFTI_INTENT_NODE_INDEX &&
-        da->num_dim > 0 && da->dims[0] > 0 && da->nvals > 0) {
+        da->num_dim > 0 && da->dims[0] > 0 && da->nvals > 0 && da->data) {
       const int ncomp = static_cast<int>(da->nvals / static_cast<long long>(da->dims[0]));
       vtkSmartPointer<vtkDataArray> data;
       data = NewVTKDataArray(GiftiDataTypeToVtk(da->datatype));
@@ -1288,91 +1748,176 @@ GetPointData(const gifti_image *gim, vtkIdType npoints = 0, vtkIdTypeArray *indi
           if (errmsg) {
             cerr << "Error: GIFTI array size does not match point set or node indices array size!" << endl;
           }
-          ok = false;
-          break;
+          return vtkSmartPointer<vtkPointData>::New();
         }
         data->SetNumberOfTuples(npoints);
       } else {
         data->SetNumberOfTuples(da->dims[0]);
       }
-      CopyDataArray(data, da, indices);
-      vtkInformation * const info = data->GetInformation();
-      CopyMetaData(info, da->meta);
-      if (info->Has(GiftiMetaData::NAME())) {
-        data->SetName(info->Get(GiftiMetaData::NAME()));
-      } else {
-        data->SetName(ToString(da->intent).c_str());
-      }
-      int idx = -1;
-      switch (da->intent) {
-        case NIFTI_INTENT_SHAPE: {
-          if (!pd->GetScalars()) idx = pd->SetScalars(data);
-        } break;
-        case NIFTI_INTENT_VECTOR: {
-          if (ncomp == 3) {
-            const string lname = ToLower(data->GetName());
-            if (lname == "normals" || lname == "normal") {
-              if (!pd->GetNormals()) idx = pd->SetNormals(data);
-            } else {
-              if (!pd->GetVectors()) idx = pd->SetVectors(data);
-            }
+      input .push_back(da);
+      output.push_back(data);
+    }
+  }
+
+  // Convert data arrays, each of which is written by a single thread only
+  CopyGiftiDataArrays copy;
+  copy._Input   = &input;
+  copy._Output  = &output;
+  copy._Indices = indices;
+  parallel_for(blocked_range<int>(0, static_cast<int>(output.size()), 1), copy);
+
+  // Add arrays with meta data to point data
+  vtkSmartPointer<vtkPointData> pd = vtkSmartPointer<vtkPointData>::New();
+  for (size_t i = 0; i < output.size(); ++i) {
+    const giiDataArray * const da   = input[i];
+    vtkDataArray       * const data = output[i];
+    vtkInformation     * const info = data->GetInformation();
+    CopyMetaData(info, da->meta);
+    if (info->Has(GiftiMetaData::NAME())) {
+      data->SetName(info->Get(GiftiMetaData::NAME()));
+    } else {
+      data->SetName(ToString(da->intent).c_str());
+    }
+    int idx = -1;
+    switch (da->intent) {
+      case NIFTI_INTENT_SHAPE: {
+        if (!pd->GetScalars()) idx = pd->SetScalars(data);
+      } break;
+      case NIFTI_INTENT_VECTOR: {
+        if (data->GetNumberOfComponents() == 3) {
+          const string lname = ToLower(data->GetName());
+          if (lname == "normals" || lname == "normal") {
+            if (!pd->GetNormals()) idx = pd->SetNormals(data);
+          } else {
+            if (!pd->GetVectors()) idx = pd->SetVectors(data);
           }
-        } break;
-      }
-      if (idx == -1) idx = pd->AddArray(data);
+        }
+      } break;
     }
+    if (idx == -1) idx = pd->AddArray(data);
   }
-  if (!ok) pd->Initialize();
   return pd;
 }
 
+// -----------------------------------------------------------------------------
+/// Read GIFTI file, optionally decoding only the selected point data arrays
+///
+/// Data arrays with intent @c NIFTI_INTENT_POINTSET, @c NIFTI_INTENT_TRIANGLE,
+/// and @c NIFTI_INTENT_NODE_INDEX are always read. Other data arrays are only
+/// read when their "Name" meta data entry, or the string representation of
+/// their intent code when no name is given, is contained in the selection.
+/// The file is parsed once, keeping the Base64 encoded data as text. Only the
+/// encoded data of the remaining data arrays is then decoded in parallel.
+static gifti_image *ReadGIFTIImage(const char *fname, const Array<string> *arrays = nullptr)
+{
+  giiEncodedData *enc = nullptr;
+  gifti_image *gim = gifti_read_image_encoded(fname, &enc);
+  if (gim == nullptr) return nullptr;
+  // Discard data arrays which are not selected
+  if (arrays) {
+    int n = 0;
+    for (int i = 0; i < gim->numDA; ++i) {
+      giiDataArray * const da = gim->darray[i];
+      bool selected = (da->intent == NIFTI_INTENT_POINTSET ||
+                       da->intent == NIFTI_INTENT_TRIANGLE ||
+                       da->intent == NIFTI_INTENT_NODE_INDEX);
+      if (!selected) {
+        const char *name = gifti_get_meta_value(&da->meta, GiftiMetaData::NAME()->GetName());
+        const string str = (name ? string(name) : ToString(da->intent));
+        selected = (find(arrays->begin(), arrays->end(), str) != arrays->end());
+      }
+      if (selected) {
+        gim->darray[n] = da;
+        enc[n] = enc[i];
+        ++n;
+      } else {
+        gifti_free_DataArray(da);
+        free(enc[i].data);
+      }
+    }
+    gim->numDA = n;
+  }
+  // Decode data of remaining data arrays
+  Array<int> status(gim->numDA, 0);
+  DecodeGiftiDataArrays decode;
+  decode._DataArrays  = gim->darray;
+  decode._EncodedData = enc;
+  decode._Status      = status.data();
+  parallel_for(blocked_range<int>(0, gim->numDA, 1), decode);
+  gifti_free_encoded_list(enc, gim->numDA);
+  if (find(status.begin(), status.end(), 1) != status.end()) {
+    gifti_free_image(gim);
+    return nullptr;
+  }
+  return gim;
+}
+
 // -----------------------------------------------------------------------------
 vtkSmartPointer<vtkPoints> ReadGIFTICoordinates(const char *fname, vtkInformation *info, bool errmsg)
 {
-  gifti_image *gim = gifti_read_image(fname, 1);
+  gifti_image *gim = ReadGIFTIImage(fname, nullptr);
   if (gim == nullptr) {
     if (errmsg) {
       cerr << "Error: Could not read GIFTI file: " << fname << endl;
     }
     return vtkSmartPointer<vtkPoints>::New();
   }
-  return GetPoints(gim, info, errmsg);
+  vtkSmartPointer<vtkPoints> points = GetPoints(gim, info, errmsg);
+  gifti_free_image(gim);
+  return points;
 }
 
 // -----------------------------------------------------------------------------
 vtkSmartPointer<vtkCellArray> ReadGIFTITopology(const char *fname, vtkInformation *info, bool errmsg)
 {
-  gifti_image *gim = gifti_read_image(fname, 1);
+  gifti_image *gim = ReadGIFTIImage(fname, nullptr);
   if (gim == nullptr) {
     if (errmsg) {
       cerr << "Error: Could not read GIFTI file: " << fname << endl;
     }
     return nullptr;
   }
-  return GetTriangles(gim, info, errmsg);
+  vtkSmartPointer<vtkCellArray> polys = GetTriangles(gim, info, errmsg);
+  gifti_free_image(gim);
+  return polys;
 }
 
 // -----------------------------------------------------------------------------
-vtkSmartPointer<vtkPointData> ReadGIFTIPointData(const char *fname, bool errmsg)
+static vtkSmartPointer<vtkPointData>
+ReadGIFTIPointData(const char *fname, const Array<string> *arrays, bool errmsg)
 {
-  gifti_image *gim = gifti_read_image(fname, 1);
+  gifti_image *gim = ReadGIFTIImage(fname, arrays);
   if (gim == nullptr) {
     if (errmsg) {
       cerr << "Error: Could not read GIFTI file: " << fname << endl;
     }
     return nullptr;
   }
-  return GetPointData(gim, 0, nullptr, errmsg);
+  vtkSmartPointer<vtkPointData> pd = GetPointData(gim, 0, nullptr, errmsg);
+  gifti_free_image(gim);
+  return pd;
 }
 
 // -----------------------------------------------------------------------------
-vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface, bool errmsg)
+vtkSmartPointer<vtkPointData> ReadGIFTIPointData(const char *fname, bool errmsg)
+{
+  return ReadGIFTIPointData(fname, nullptr, errmsg);
+}
+
+// -----------------------------------------------------------------------------
+vtkSmartPointer<vtkPointData> ReadGIFTIPointData(const char *fname, const Array<string> &arrays, bool errmsg)
+{
+  return ReadGIFTIPointData(fname, &arrays, errmsg);
+}
+
+// -----------------------------------------------------------------------------
+static vtkSmartPointer<vtkPolyData>
+ReadGIFTI(const char *fname, const Array<string> *arrays, vtkPolyData *surface, bool errmsg)
 {
   vtkSmartPointer<vtkPolyData> polydata = vtkSmartPointer<vtkPolyData>::New();
 
   // Read GIFTI
-  const int read_data = 1;
-  gifti_image *gim = gifti_read_image(fname, read_data);
+  gifti_image *gim = ReadGIFTIImage(fname, arrays);
   if (gim == nullptr) return polydata;
 
   // Convert geometry and topology arrays including their meta data
@@ -1389,6 +1934,7 @@ vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface,
       if (errmsg) {
         cerr << "Error: Cannot read GIFTI point data without input point set (e.g., from .coords.gii or .surf.gii file)!" << endl;
       }
+      gifti_free_image(gim);
       return polydata;
     }
   }
@@ -1402,6 +1948,7 @@ vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface,
       if (errmsg) {
         cerr << "Error: GIFTI topology array has invalid point index!" << endl;
       }
+      gifti_free_image(gim);
       return polydata;
     }
   }
@@ -1417,6 +1964,7 @@ vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface,
           cerr << "       - Number of points = " << npoints << endl;
           cerr << "       - Node index       = " << index << endl;
         }
+        gifti_free_image(gim);
         return polydata;
       }
     }
@@ -1504,6 +2052,19 @@ vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface,
   return polydata;
 }
 
+// -----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, vtkPolyData *surface, bool errmsg)
+{
+  return ReadGIFTI(fname, nullptr, surface, errmsg);
+}
+
+// -----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadGIFTI(const char *fname, const Array<string> &arrays,
+                                       vtkPolyData *surface, bool errmsg)
+{
+  return ReadGIFTI(fname, &arrays, surface, errmsg);
+}
+
 // -----------------------------------------------------------------------------
 static bool AddPoints(gifti_image *gim, vtkPoints *points, vtkInformation *info = nullptr)
 {
@@ -1630,7 +2191,11 @@ static bool AddTriangles(gifti_image *gim, vtkCellArray *triangles, vtkInformati
 }
 
 // -----------------------------------------------------------------------------
-static bool AddDataArray(gifti_image *gim, vtkDataArray *data, int attr = -1)
+/// Add GIFTI data array for given vtkDataArray
+///
+/// When @p copy is false, only the GIFTI data array is allocated and its data
+/// has to be converted by the caller using CopyDataArray afterwards.
+static bool AddDataArray(gifti_image *gim, vtkDataArray *data, int attr = -1, bool copy = true)
 {
   if (gifti_add_empty_darray(gim, 1) != 0) return false;
   giiDataArray *da = gim->darray[gim->numDA-1];
@@ -1665,7 +2230,7 @@ static bool AddDataArray(gifti_image *gim, vtkDataArray *data, int attr = -1)
   }
 
   // Convert and copy data
-  CopyDataArray(da, data);
+  if (copy) CopyDataArray(da, data);
 
   // Copy meta data from vtkDataArray information
   CopyMetaData(da->meta, data->GetInformation(), GiftiMetaData::KeysForDataArray(da->intent));
@@ -1680,8 +2245,10 @@ static bool AddDataArray(gifti_image *gim, vtkDataArray *data, int attr = -1)
 static bool AddPointData(gifti_image *gim, vtkPointData *pd)
 {
   const int numDA = gim->numDA;
+  Array<vtkDataArray *> arrays;
+  arrays.reserve(pd->GetNumberOfArrays());
   for (int i = 0; i < pd->GetNumberOfArrays(); ++i) {
-    if (!AddDataArray(gim, pd->GetArray(i), pd->IsArrayAnAttribute(i))) {
+    if (!AddDataArray(gim, pd->GetArray(i), pd->IsArrayAnAttribute(i), false)) {
       for (int j = numDA; j < gim->numDA; ++j) {
         gifti_free_DataArray(gim->darray[j]);
         gim->darray[j] = nullptr;
@@ -1689,7 +2256,12 @@ static bool AddPointData(gifti_image *gim, vtkPointData *pd)
       gim->numDA = numDA;
       return false;
     }
+    arrays.push_back(pd->GetArray(i));
   }
+  CopyVtkDataArrays copy;
+  copy._Input  = &arrays;
+  copy._Output = gim->darray + numDA;
+  parallel_for(blocked_range<int>(0, static_cast<int>(arrays.size()), 1), copy);
   return true;
 }
 
@@ -1787,9 +2359,26 @@ bool WriteGIFTI(const char *fname, vtkPolyData *polydata, bool compress, bool as
     gim->darray[i]->encoding = encoding;
   }
 
+  // Encode data of independent data arrays in parallel
+  giiEncodedData *enc = nullptr;
+  if (!ascii && gim->numDA > 0) {
+    enc = static_cast<giiEncodedData *>(calloc(gim->numDA, sizeof(giiEncodedData)));
+    Array<int> status(gim->numDA, 0);
+    EncodeGiftiDataArrays encode;
+    encode._DataArrays  = gim->darray;
+    encode._EncodedData = enc;
+    encode._Status      = status.data();
+    parallel_for(blocked_range<int>(0, gim->numDA, 1), encode);
+    if (find(status.begin(), status.end(), 1) != status.end()) {
+      gifti_free_encoded_list(enc, gim->numDA);
+      gifti_free_image(gim);
+      return false;
+    }
+  }
+
   // Write GIFTI file
-  const int write_data = 1;
-  bool success = (gifti_write_image(gim, fname, write_data) == 0);
+  bool success = (gifti_write_image_encoded(gim, fname, enc) == 0);
+  gifti_free_encoded_list(enc, gim->numDA);
   gifti_free_image(gim);
 
   return success;
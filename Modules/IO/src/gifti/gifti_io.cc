@@ -415,6 +415,110 @@ int gifti_write_image(gifti_image *gim, const char *fname, int write_data)
     return gxml_write_image(gim, fname, write_data);
 }
 
+/*----------------------------------------------------------------------
+ *! Read a GIFTI dataset, keeping the Base64 encoded Data of each DataArray.
+ *
+ *  The file is parsed once. ASCII and external Data are read as with
+ *  gifti_read_image, while the data pointer of DataArrays with Base64
+ *  (and possibly compressed) encoding remains NULL. The encoded text
+ *  of DataArray i is instead returned in (*enc)[i], to be decoded with
+ *  gifti_decode_DA_data. This allows the caller to decode only selected
+ *  DataArrays, and to decode independent DataArrays concurrently.
+ *
+ *  The list of numDA encoded Data must be freed with
+ *  gifti_free_encoded_list.
+ *
+ *  return an allocated gifti_image struct on success,
+ *         NULL on error
+*//*-------------------------------------------------------------------*/
+gifti_image * gifti_read_image_encoded( const char * fname,
+                                        giiEncodedData ** enc )
+{
+    if( !fname || !enc ) {
+        fprintf(stderr,"** gifti_read_image_encoded: missing %s\n",
+                fname ? "encoded list" : "filename");
+        return NULL;
+    }
+
+    gxml_set_verb(G.verb);
+
+    return gxml_read_image_encoded(fname, enc);
+}
+
+/*----------------------------------------------------------------------
+ *! Write a GIFTI dataset, using previously encoded Data.
+ *
+ *  The list of encoded Data has length gim->numDA. Base64 encoded Data
+ *  of DataArray i is written from enc[i] if its data pointer is not NULL,
+ *  and encoded while writing otherwise. The encoded Data must have been
+ *  created by gifti_encode_DA_data for the current encoding of the
+ *  DataArray.
+ *
+ *  return 0 on success
+ *         1 on error
+*//*-------------------------------------------------------------------*/
+int gifti_write_image_encoded(gifti_image *gim, const char *fname,
+                              const giiEncodedData * enc)
+{
+    if( !gim || !fname ) {
+        fprintf(stderr,"** gifti_write_image_encoded: missing %s\n",
+                gim ? "filename" : "gifti_image");
+        return 1;
+    }
+
+    gxml_set_verb(G.verb);
+
+    return gxml_write_image_encoded(gim, fname, enc);
+}
+
+/*----------------------------------------------------------------------
+ *! Decode Base64 (and possibly compressed) Data of a DataArray.
+ *
+ *  The data of the DataArray is allocated, decoded from the encoded
+ *  text, and byte swapped if needed. The encoded text is freed.
+ *
+ *  This function does not modify any global state, such that it can
+ *  be called concurrently for different DataArrays.
+ *
+ *  return 0 on success
+ *         1 on error
+*//*-------------------------------------------------------------------*/
+int gifti_decode_DA_data(giiDataArray * da, giiEncodedData * enc)
+{
+    return gxml_decode_DA_data(da, enc);
+}
+
+/*----------------------------------------------------------------------
+ *! Encode Data of a DataArray as Base64 text, compressed if the
+ *  encoding of the DataArray is GIFTI_ENCODING_B64GZ.
+ *
+ *  This function does not modify any global state, such that it can
+ *  be called concurrently for different DataArrays.
+ *
+ *  return 0 on success
+ *         1 on error
+*//*-------------------------------------------------------------------*/
+int gifti_encode_DA_data(const giiDataArray * da, giiEncodedData * enc)
+{
+    return gxml_encode_DA_data(da, enc);
+}
+
+/*----------------------------------------------------------------------
+ *! Free list of encoded Data.
+*//*-------------------------------------------------------------------*/
+int gifti_free_encoded_list(giiEncodedData * enc, int len)
+{
+    int c;
+
+    if( !enc ) return 0;
+
+    for( c = 0; c < len; c++ )
+        if( enc[c].data ) free(enc[c].data);
+    free(enc);
+
+    return 0;
+}
+
 
 /*----------------------------------------------------------------------
  *! free the gifti_image struct and all its contents
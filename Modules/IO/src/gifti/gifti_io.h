@@ -145,6 +145,15 @@ typedef struct {
     nvpairs           ex_atrs;    /* extra attributes                */
 } gifti_image;
 
+/* Base64 (and possibly zlib compressed) Data text of a DataArray, which is
+   kept by gifti_read_image_encoded and decoded by gifti_decode_DA_data, or
+   created by gifti_encode_DA_data and written by gifti_write_image_encoded */
+typedef struct {
+    long long   nalloc;           /* allocation length               */
+    long long   len;              /* length of encoded text          */
+    char      * data;             /* encoded text, null terminated   */
+} giiEncodedData;
+
 typedef struct {
     int verb;
 } gifti_globals;
@@ -171,6 +180,15 @@ int    gifti_write_image        (gifti_image *gim, const char *fname,
 gifti_image * gifti_create_image(int numDA, int intent, int dtype, int ndim,
                                  const int * dims, int alloc_data);
 
+/* deferred decoding/encoding of Data, independent for each DataArray */
+gifti_image * gifti_read_image_encoded(const char * fname,
+                                       giiEncodedData ** enc);
+int    gifti_write_image_encoded(gifti_image *gim, const char *fname,
+                                 const giiEncodedData * enc);
+int    gifti_decode_DA_data     (giiDataArray * da, giiEncodedData * enc);
+int    gifti_encode_DA_data     (const giiDataArray * da, giiEncodedData * enc);
+int    gifti_free_encoded_list  (giiEncodedData * enc, int len);
+
 /* end main interface protos */
 
 int    gifti_get_b64_check      (void);
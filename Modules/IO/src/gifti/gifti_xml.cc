@@ -22,12 +22,14 @@ namespace mirtk {
 
 #define GXML_MIN_BSIZE 2048
 #define GXML_DEF_BSIZE 32768
+#define GXML_MAX_CHUNK (1<<30)  /* max Base64 bytes converted at once */
 
 /* local prototypes */
 static int  append_to_cdata     (gxml_data *, const char *, int);
 static int  append_to_data      (gxml_data *, const char *, int);
 static int  append_to_data_ascii(gxml_data *, const char *, int);
 static int  append_to_data_b64  (gxml_data *, char*,long long,const char*, int);
+static int  append_to_encoded   (gxml_data *, const char *, int);
 /* 
 static int  append_to_data_b64gz(gxml_data *, const char *, int);
 */
@@ -44,6 +46,8 @@ static int  ename2type          (const char *);
 static int  epush               (gxml_data *, int, const char *, const char **);
 static int  epop                (gxml_data *, int, const char *);
 static int  free_xd_data        (gxml_data *);
+static int  grow_encoded_list   (gxml_data *);
+static int  is_encoded_b64      (const giiDataArray *);
 static int  get_label_attrs     (gxml_data *, const char **, int *, float *);
 static int  init_gxml_data      (gxml_data *, int, const int *, int);
 static int  partial_buf_size    (long long);
@@ -121,14 +125,16 @@ static int  gxml_write_preamble     (FILE *);
 static int  ewrite_text_ele         (int, const char *, const char *,
                                      int, int, FILE *);
 static int  ewrite_coordsys         (gxml_data *, giiCoordSystem *, FILE *);
-static int  ewrite_data             (gxml_data *, giiDataArray *, FILE *);
+static int  ewrite_data             (gxml_data *, giiDataArray *,
+                                     const giiEncodedData *, FILE *);
 static int  ewrite_data_line        (void *, int, long long, long long,
                                      int, FILE *);
 static int  ewrite_double_line      (double *, int, int, FILE *);
 static int  ewrite_int_attr         (const char *, int, int, int, FILE *);
 static int  ewrite_long_long_attr   (const char *, long long, int, int, FILE *);
 static int  ewrite_str_attr         (const char*, const char*, int, int, FILE*);
-static int  ewrite_darray           (gxml_data *, giiDataArray *, FILE *);
+static int  ewrite_darray           (gxml_data *, giiDataArray *,
+                                     const giiEncodedData *, FILE *);
 static int  ewrite_ex_atrs          (gxml_data *, nvpairs *, int, int, FILE *);
 static int  ewrite_LT               (gxml_data*, giiLabelTable*, int, FILE*);
 static int  ewrite_meta             (gxml_data *, giiMetaData *, FILE *);
@@ -175,7 +181,11 @@ static gxml_data GXD = {
     NULL,       /* xdata, xform buffer pointer                */
     NULL,       /* ddata, Data buffer pointer                 */
     NULL,       /* zdata, compression buffer pointer          */
-    NULL        /* gim, gifti_image *, for results            */
+    NULL,       /* gim, gifti_image *, for results            */
+
+    0,          /* defer, flag whether to keep encoded Data   */
+    NULL,       /* enc, encoded Data of each DA               */
+    0           /* enc_len, length of enc list                */
 };
 
 #ifndef HAVE_ZLIB  /* so we can print a callback message once per file */
@@ -494,6 +504,57 @@ int gxml_write_image(gifti_image * gim, const char * fname, int write_data)
 }
 
 
+/* read image, keeping the encoded text of Base64 Data of each DA in enc
+   (the list has length numDA of the returned image) */
+gifti_image * gxml_read_image_encoded(const char * fname,
+                                      giiEncodedData ** enc)
+{
+    gxml_data   * xd = &GXD;     /* point to global struct */
+    gifti_image * gim;
+
+    if( !enc ) {
+        fprintf(stderr,"** gxml_read_image_encoded: missing encoded list\n");
+        return NULL;
+    }
+    *enc = NULL;
+
+    xd->defer   = 1;
+    xd->enc     = NULL;
+    xd->enc_len = 0;
+
+    gim = gxml_read_image(fname, 1, NULL, 0);
+
+    if( gim ) *enc = xd->enc;
+    else      gifti_free_encoded_list(xd->enc, xd->enc_len);
+
+    xd->defer   = 0;
+    xd->enc     = NULL;
+    xd->enc_len = 0;
+
+    return gim;
+}
+
+
+/* write image, using the encoded Data of each DA in enc, if set
+   return 0 on success */
+int gxml_write_image_encoded(gifti_image * gim, const char * fname,
+                             const giiEncodedData * enc)
+{
+    gxml_data * xd = &GXD;     /* point to global struct */
+    int         rv;
+
+    xd->enc     = (giiEncodedData *)enc;
+    xd->enc_len = (enc && gim) ? gim->numDA : 0;
+
+    rv = gxml_write_image(gim, fname, 1);
+
+    xd->enc     = NULL;
+    xd->enc_len = 0;
+
+    return rv;
+}
+
+
 /*---------- accessor functions for user-controllable variables ----------*/
 /*----------     (one can pass -1 to set the default value)     ----------*/
 
@@ -1102,6 +1163,7 @@ static int push_darray(gxml_data * xd, const char ** attr)
     }
 
     if( gifti_add_empty_darray(xd->gim, 1) ) return 1;
+    if( xd->defer && grow_encoded_list(xd) ) return 1;
 
     da = xd->gim->darray[xd->gim->numDA-1];  /* get new pointer */
 
@@ -1173,7 +1235,8 @@ static int pop_darray(gxml_data * xd)
 #endif
 
         xd->gim->compressed = 1;   /* flag whether some data was compressed */
-    }
+    } else if( da->encoding == GIFTI_ENCODING_B64GZ && xd->defer )
+        xd->gim->compressed = 1;   /* to be uncompressed when decoded */
 
     /* possibly read data from an external file */
     if( da->ext_fname && *da->ext_fname )
@@ -1231,6 +1294,14 @@ static int push_data(gxml_data * xd)
         return 1;
     }
 
+    /* keep encoded text, decoded later by gxml_decode_DA_data */
+    if( xd->defer && is_encoded_b64(da) ) {
+        if( xd->verb > 3 )
+            fprintf(stderr,"-- deferring decoding of data[%d]\n",
+                    xd->gim->numDA-1);
+        return 0;
+    }
+
     if( update_partial_buffer(&xd->ddata, &xd->dlen, da->nbyper*da->nvals, 0) )
         return 1;
 
@@ -1599,6 +1670,9 @@ static int append_to_data(gxml_data * xd, const char * cdata, int len)
 {
     giiDataArray * da = xd->gim->darray[xd->gim->numDA-1]; /* current DA */
 
+    if( da && xd->defer && is_encoded_b64(da) )
+        return append_to_encoded(xd, cdata, len);
+
     if( !da || !xd->dlen || !xd->ddata || xd->dind < 0 ) {
         fprintf(stderr,"** A2D: bad setup (%p,%d,%p,%lld)\n",
                 (void *)da, xd->dlen, (void *)xd->ddata, xd->dind);
@@ -1724,6 +1798,225 @@ static int append_to_data_b64(gxml_data * xd, char * dest, long long tot_bytes,
     return 0;
 }
 
+/* append the encoded text of the latest darray to its encoded Data,
+ * which is decoded later (see gxml_decode_DA_data)
+ */
+static int append_to_encoded(gxml_data * xd, const char * cdata, int len)
+{
+    giiDataArray   * da  = xd->gim->darray[xd->gim->numDA-1]; /* current DA */
+    giiEncodedData * enc = xd->enc + xd->gim->numDA-1;
+    long long        nalloc;
+    char           * data;
+
+    if( xd->gim->numDA > xd->enc_len ) {
+        fprintf(stderr,"** A2E: missing encoded Data for DA[%d]\n",
+                xd->gim->numDA-1);
+        return 1;
+    }
+
+    if( enc->len + len + 1 > enc->nalloc ) {
+        if( enc->nalloc > 0 ) nalloc = 2 * enc->nalloc;
+        else {  /* initial guess of Base64 length */
+            nalloc = (da->nvals * da->nbyper + 2) / 3 * 4 + 1;
+            if( da->encoding == GIFTI_ENCODING_B64GZ ) nalloc /= 4;
+        }
+        if( nalloc < enc->len + len + 1 ) nalloc = enc->len + len + 1;
+
+        data = (char *)realloc(enc->data, nalloc);
+        if( !data ) {
+            fprintf(stderr,"** A2E: failed to alloc %lld bytes for DA[%d]\n",
+                    nalloc, xd->gim->numDA-1);
+            return 1;
+        }
+        enc->data   = data;
+        enc->nalloc = nalloc;
+    }
+
+    memcpy(enc->data + enc->len, cdata, len);
+    enc->len += len;
+    enc->data[enc->len] = '\0';
+
+    return 0;
+}
+
+/* make space for the encoded Data of each darray */
+static int grow_encoded_list(gxml_data * xd)
+{
+    giiEncodedData * enc;
+    int              nDA = xd->gim->numDA;
+
+    if( nDA <= xd->enc_len ) return 0;
+
+    enc = (giiEncodedData *)realloc(xd->enc, nDA*sizeof(giiEncodedData));
+    if( !enc ) {
+        fprintf(stderr,"** failed to alloc %d encoded Data\n", nDA);
+        return 1;
+    }
+    memset(enc + xd->enc_len, 0, (nDA - xd->enc_len)*sizeof(giiEncodedData));
+
+    xd->enc     = enc;
+    xd->enc_len = nDA;
+
+    return 0;
+}
+
+/* whether the Data of the darray is Base64 encoded */
+static int is_encoded_b64(const giiDataArray * da)
+{
+    return da->encoding == GIFTI_ENCODING_B64BIN ||
+           da->encoding == GIFTI_ENCODING_B64GZ;
+}
+
+/* decode the encoded Data of a darray, as in pop_darray
+ *
+ * A local gxml_data struct is used for the conversion, such that
+ * independent DataArrays can be decoded concurrently.
+ *
+ * return 0 on success
+ */
+int gxml_decode_DA_data(giiDataArray * da, giiEncodedData * enc)
+{
+    gxml_data   xd;             /* local struct, no global state */
+    long long   nbytes, blen, dlen, needed, off;
+    int         apply_len, chunk, swapsize, errs = 0;
+    char      * buf, * dest;
+
+    if( !da || !enc ) return 1;
+    if( !enc->data ) return 0;  /* nothing to decode */
+
+    if( !is_encoded_b64(da) || da->nvals <= 0 || da->nbyper <= 0 ) {
+        fprintf(stderr,"** GXML decode: bad encoding %d or size %lld x %d\n",
+                da->encoding, da->nvals, da->nbyper);
+        return 1;
+    }
+
+    memset(&xd, 0, sizeof(xd));
+    xd.verb      = GXD.verb;
+    xd.b64_check = GXD.b64_check;
+
+    nbytes = da->nvals * da->nbyper;
+
+    /* copy Base64 characters, possibly skipping invalid ones */
+    buf = (char *)malloc(enc->len + 1);
+    if( !buf ) {
+        fprintf(stderr,"** GXML decode: failed to alloc %lld bytes\n",
+                enc->len + 1);
+        return 1;
+    }
+    for( blen = 0, off = 0; off < enc->len; off += chunk ) {
+        chunk = (int)(enc->len - off < GXML_MAX_CHUNK ? enc->len - off
+                                                      : GXML_MAX_CHUNK);
+        xd.ddata = buf + blen;
+        xd.doff  = 0;
+        (void)copy_b64_data(&xd, enc->data + off, xd.ddata, chunk, &apply_len);
+        blen += apply_len;
+    }
+    free(enc->data);
+    enc->data   = NULL;
+    enc->len    = 0;
+    enc->nalloc = 0;
+
+    if( xd.b64_errors > 0 && xd.b64_check != GIFTI_B64_CHECK_NONE ) {
+        if( xd.b64_check == GIFTI_B64_CHECK_DETECT )
+            fprintf(stderr,"** bad base64 chars found in DataArray\n");
+        else
+            fprintf(stderr,"** %d bad base64 chars found in DataArray\n",
+                    xd.b64_errors);
+    }
+
+    /* number of decoded bytes, excluding padding */
+    blen = blen / 4 * 4;
+    dlen = blen / 4 * 3;
+    if( blen > 0 && buf[blen-1] == '=' ) dlen--;
+    if( blen > 1 && buf[blen-2] == '=' ) dlen--;
+
+    da->data = calloc(da->nvals, da->nbyper);
+    if( !da->data ) {
+        fprintf(stderr,"** GXML decode: failed to alloc %lld bytes\n",nbytes);
+        free(buf);
+        return 1;
+    }
+
+    if( da->encoding == GIFTI_ENCODING_B64GZ ) {
+        dest = (char *)malloc(dlen > 0 ? dlen : 1);
+        if( !dest ) {
+            fprintf(stderr,"** GXML decode: failed to alloc %lld bytes\n",
+                    dlen);
+            free(buf);
+            return 1;
+        }
+        needed = dlen;
+    } else {
+        dest   = (char *)da->data;
+        needed = nbytes;
+    }
+
+    /* convert to binary bytes */
+    for( off = 0; off < blen && needed > 0; off += chunk ) {
+        chunk = (int)(blen - off < GXML_MAX_CHUNK ? blen - off
+                                                  : GXML_MAX_CHUNK);
+        if( decode_b64(&xd, buf + off, chunk, dest + off / 4 * 3,
+                       &needed) < 0 ) {
+            errs++;
+            break;
+        }
+    }
+    free(buf);
+
+    if( da->encoding == GIFTI_ENCODING_B64GZ ) {
+#ifdef HAVE_ZLIB   /* for compiling, higher level test elsewhere */
+        uLongf outlen = nbytes;
+        int    rv = 0;
+
+        if( xd.verb > 2 )
+            fprintf(stderr,"-- uncompressing %lld bytes into %lld\n",
+                           dlen - needed, (long long)outlen);
+
+        if( !errs ) {
+            rv = uncompress((Bytef*)da->data, &outlen, (const Bytef*)dest,
+                            dlen - needed);
+            if( rv != Z_OK ) {
+                fprintf(stderr,"** uncompress fails for DataArray\n");
+                if( rv == Z_MEM_ERROR )
+                    fprintf(stderr,"   (zlib failure, not enough memory)\n");
+                else if ( rv == Z_BUF_ERROR )
+                    fprintf(stderr,"   (zlib failure, output buffer too short)\n");
+                else if ( rv == Z_DATA_ERROR )
+                    fprintf(stderr,"   (zlib failure, corrupted data)\n");
+                else
+                    fprintf(stderr,"   (zlib failure, unknown error %d)\n", rv);
+                errs++;
+            } else if( (long long)outlen != nbytes ) {
+                fprintf(stderr,"** uncompressed buf is %lld bytes, "
+                               "expected %lld\n", (long long)outlen, nbytes);
+                errs++;
+            }
+        }
+#else
+        fprintf(stderr,"** GXML decode: no ZLIB to uncompress with\n");
+        errs++;
+#endif
+        free(dest);
+    } else if( needed > 0 ) {
+        fprintf(stderr,"** GXML decode: missing %lld of %lld bytes\n",
+                needed, nbytes);
+        errs++;
+    }
+
+    if( errs ) return 1;
+
+    /* possibly perform byte-swapping on data */
+    gifti_datatype_sizes(da->datatype, NULL, &swapsize);
+    if( swapsize <= 0 ) {
+        fprintf(stderr,"** bad swapsize %d for dtype %d\n",
+                swapsize, da->datatype);
+        return 1;
+    }
+    (void)gifti_check_swap(da->data, da->endian, nbytes / swapsize, swapsize);
+
+    return 0;
+}
+
 /* Copy the base64 data to the dest buffer, possibly noting, counting
  * and/or skipping any invalid characters, based on b64_check.
  *
@@ -2621,7 +2914,8 @@ static int gxml_write_gifti(gxml_data * xd, FILE * fp)
         if( xd->verb > 0 ) fprintf(stderr,"** gifti_image, missing darray\n");
     } else {
         for( c = 0; c < gim->numDA; c++ )
-            ewrite_darray(xd, gim->darray[c], fp);
+            ewrite_darray(xd, gim->darray[c],
+                          c < xd->enc_len ? xd->enc + c : NULL, fp);
     }
     
     xd->depth--;
@@ -2630,7 +2924,8 @@ static int gxml_write_gifti(gxml_data * xd, FILE * fp)
     return 0;
 }
 
-static int ewrite_darray(gxml_data * xd, giiDataArray * da, FILE * fp)
+static int ewrite_darray(gxml_data * xd, giiDataArray * da,
+                         const giiEncodedData * enc, FILE * fp)
 {
     int  spaces = xd->indent * xd->depth;
     int  offset, c;
@@ -2671,7 +2966,7 @@ static int ewrite_darray(gxml_data * xd, giiDataArray * da, FILE * fp)
     ewrite_meta(xd, &da->meta, fp);
     for( c = 0; c < da->numCS; c++ )
         ewrite_coordsys(xd, da->coordsys[c], fp);
-    ewrite_data(xd, da, fp);
+    ewrite_data(xd, da, enc, fp);
     xd->depth--;
 
     fprintf(fp, "%*s</DataArray>\n", spaces, "");
@@ -2681,7 +2976,9 @@ static int ewrite_darray(gxml_data * xd, giiDataArray * da, FILE * fp)
 
 
 /* this depends on ind_ord, how to write out lines */
-static int ewrite_data(gxml_data * xd, giiDataArray * da, FILE * fp)
+/* (enc is the previously encoded Data, or NULL to encode it here) */
+static int ewrite_data(gxml_data * xd, giiDataArray * da,
+                       const giiEncodedData * enc, FILE * fp)
 {
     long long c, rows, cols;
     int       spaces = xd->indent * xd->depth;
@@ -2705,7 +3002,9 @@ static int ewrite_data(gxml_data * xd, giiDataArray * da, FILE * fp)
         fprintf(fp, "%*s<%s>", spaces, "", enames[GXML_ETYPE_DATA]);
 
     if( xd->dstore ) {
-        if( da->encoding == GIFTI_ENCODING_ASCII ) {
+        if( enc && enc->data && is_encoded_b64(da) ) {
+            fwrite(enc->data, 1, enc->len, fp);
+        } else if( da->encoding == GIFTI_ENCODING_ASCII ) {
             fprintf(fp, "\n");
             gifti_DA_rows_cols(da, &rows, &cols);  /* product will be nvals */
             for(c = 0; c < rows; c++ )
@@ -2793,6 +3092,107 @@ static int gxml_disp_b64_data(const char *mesg, const void *data, int len,
     return 0;
 }
 
+/* encode the Data of a darray as Base64 text, compressed first in case of
+ * GIFTI_ENCODING_B64GZ, as done by ewrite_data
+ *
+ * No global state is modified, such that independent DataArrays can be
+ * encoded concurrently.
+ *
+ * return 0 on success
+ */
+int gxml_encode_DA_data(const giiDataArray * da, giiEncodedData * enc)
+{
+    const unsigned char * dp;
+    unsigned char       * ep;
+    unsigned char         w, x, y, z;
+    char                * zbuf = NULL, * data;
+    long long             nbytes, slen, nalloc, c;
+    int                   rem;
+
+    if( !da || !enc ) return 1;
+
+    if( !is_encoded_b64(da) ) {
+        fprintf(stderr,"** GXML encode: encoding %d is not Base64\n",
+                da->encoding);
+        return 1;
+    }
+
+    enc->len = 0;
+    if( !da->data || da->nvals <= 0 || da->nbyper <= 0 ) return 0;
+
+    nbytes = da->nvals * da->nbyper;
+    dp     = (const unsigned char *)da->data;
+    slen   = nbytes;
+
+    if( da->encoding == GIFTI_ENCODING_B64GZ ) {
+#ifdef HAVE_ZLIB   /* for compiling, higher level test elsewhere */
+        uLongf blen = nbytes * 1.01 + 12; /* zlib.net */
+        int    rv = 0;
+
+        zbuf = (char *)malloc(blen);
+        if( !zbuf ) {
+            fprintf(stderr,"** GXML encode: failed to alloc %lld bytes\n",
+                    (long long)blen);
+            return 1;
+        }
+        rv = compress2((Bytef *)zbuf, &blen, (const Bytef*)da->data,
+                       nbytes, GXD.zlevel);
+        if( rv != Z_OK ) {
+            fprintf(stderr,"** zlib compression failure: ");
+            if( rv == Z_MEM_ERROR ) fprintf(stderr,"not enough memory\n");
+            else if( rv == Z_BUF_ERROR ) fprintf(stderr,"buffer too short\n");
+            else                    fprintf(stderr,"unknown error %d\n",rv);
+            free(zbuf);
+            return 1;
+        }
+        dp   = (const unsigned char *)zbuf;
+        slen = blen;
+#else
+        fprintf(stderr,"** GXML encode: no ZLIB to compress with\n");
+        return 1;
+#endif
+    }
+
+    /* allocate space for the Base64 text */
+    nalloc = (slen + 2) / 3 * 4 + 1;
+    if( enc->nalloc < nalloc ) {
+        data = (char *)realloc(enc->data, nalloc);
+        if( !data ) {
+            fprintf(stderr,"** GXML encode: failed to alloc %lld bytes\n",
+                    nalloc);
+            if( zbuf ) free(zbuf);
+            return 1;
+        }
+        enc->data   = data;
+        enc->nalloc = nalloc;
+    }
+    ep = (unsigned char *)enc->data;
+
+    /* first get all of the 3-byte blocks */
+    for( c = 0; c < slen/3; c++, dp += 3, ep += 4 ) {
+        GII_B64_encode3(dp[0], dp[1], dp[2], w, x, y, z);
+        ep[0] = w; ep[1] = x; ep[2] = y; ep[3] = z;
+    }
+
+    /* finish off the last bytes */
+    rem = slen % 3;
+    if( rem == 1 ) {
+        GII_B64_encode3(dp[0], 0, 0, w, x, y, z);
+        ep[0] = w; ep[1] = x; ep[2] = '='; ep[3] = '=';
+        ep += 4;
+    } else if ( rem == 2 ) {
+        GII_B64_encode3(dp[0], dp[1], 0, w, x, y, z);
+        ep[0] = w; ep[1] = x; ep[2] = y; ep[3] = '=';
+        ep += 4;
+    }
+    *ep = '\0';
+    enc->len = ep - (unsigned char *)enc->data;
+
+    if( zbuf ) free(zbuf);
+
+    return 0;
+}
+
 
 static int ewrite_coordsys(gxml_data * xd, giiCoordSystem * cs, FILE * fp)
 {
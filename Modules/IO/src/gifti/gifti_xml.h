@@ -112,6 +112,10 @@ typedef struct {
     char         * ddata;           /* I/O buffer xml->ddata->data  */
     char         * zdata;           /* zlib compression buffer      */
     gifti_image  * gim;             /* pointer to returning image   */
+
+    int              defer;         /* flag: keep encoded Data      */
+    giiEncodedData * enc;           /* encoded Data, per DA         */
+    int              enc_len;       /* length of enc list           */
 } gxml_data;
 
 /* protos */
@@ -122,6 +126,14 @@ gifti_image * gxml_read_image (const char * fname, int read_data,
 int           gxml_write_image(gifti_image * gim, const char * fname,
                                int write_data);
 
+gifti_image * gxml_read_image_encoded (const char * fname,
+                                       giiEncodedData ** enc);
+int           gxml_write_image_encoded(gifti_image * gim, const char * fname,
+                                       const giiEncodedData * enc);
+int           gxml_decode_DA_data     (giiDataArray * da, giiEncodedData * enc);
+int           gxml_encode_DA_data     (const giiDataArray * da,
+                                       giiEncodedData * enc);
+
 int   gxml_set_verb        ( int val );
 int   gxml_get_verb        ( void    );
 int   gxml_set_dstore      ( int val );
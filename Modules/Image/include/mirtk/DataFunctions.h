@@ -140,50 +140,84 @@ public:
   }
 };
 
+// -----------------------------------------------------------------------------
+/// Base class of element-wise data operations
+///
+/// Element-wise operations can be grouped into an ElementWiseOpSequence,
+/// which applies all operations of the group to a small block of data
+/// values while these are in cache before continuing with the next block.
+class ElementWiseOp : public Op
+{
+public:
+
+  /// Initialize operation before processing given data (not thread-safe!)
+  ///
+  /// Subclasses override this function to update parameters which are set by
+  /// a preceding operation such as a data statistic.
+  virtual void Initialize(int n, double *data, bool *mask = NULL) = 0;
+
+  /// Process data values in the specified index range
+  ///
+  /// \note The operation must have been initialized before.
+  virtual void operator()(const blocked_range<int> &) const = 0;
+};
+
 // -----------------------------------------------------------------------------
 /// Base class of element-wise data transformations
-class ElementWiseUnaryOp : public Op
+class ElementWiseUnaryOp : public ElementWiseOp
 {
 private:
 
   double *_Data;
   bool   *_Mask;
 
-public:
+protected:
 
-  // Called by TBB's parallel_for, for internal use only!
-  void operator()(const blocked_range<int> &re) const
+  /// Transform data values in the specified index range
+  ///
+  /// Called by ElementWiseOpImpl::operator() of the subclass which defines
+  /// Op such that the Op function is not called virtually and can be inlined.
+  template <class TOp>
+  static void Run(const TOp *op, const blocked_range<int> &re)
   {
-    double *data = _Data + re.begin();
-    if (_Mask) {
-      bool *mask = _Mask + re.begin();
+    const ElementWiseUnaryOp *self = op;
+    double *data = self->_Data + re.begin();
+    if (self->_Mask) {
+      bool *mask = self->_Mask + re.begin();
       for (int i = re.begin(); i != re.end(); ++i, ++data, ++mask) {
-        if (*mask) *data = this->Op(*data, *mask);
+        if (*mask) *data = op->TOp::Op(*data, *mask);
       }
     } else {
       bool mask = true;
       for (int i = re.begin(); i != re.end(); ++i, ++data) {
-        *data = this->Op(*data, mask);
+        *data = op->TOp::Op(*data, mask);
       }
     }
   }
 
+public:
+
   /// Transform data value and/or mask it by setting mask = false
   virtual double Op(double value, bool &) const = 0;
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int, double *data, bool *mask = NULL)
   {
     _Data = data;
     _Mask = mask;
-    // MUST be called in the base class which defines Op!
-    //parallel_for(blocked_range<int>(0, n), *this);
+  }
+
+  /// Process given data (not thread-safe!)
+  virtual void Process(int n, double *data, bool *mask = NULL)
+  {
+    this->Initialize(n, data, mask);
+    // Data is processed by ElementWiseOpImpl::Process of the subclass
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Base class of element-wise data transformations
-class ElementWiseBinaryOp : public Op
+class ElementWiseBinaryOp : public ElementWiseOp
 {
   /// Constant value to add
   mirtkPublicAttributeMacro(double, Constant);
@@ -205,49 +239,55 @@ protected:
   /// Constructor
   ElementWiseBinaryOp(const char *fname) : _Constant(.0), _FileName(fname) {}
 
-public:
-
-  // Called by TBB's parallel_for, for internal use only!
-  void operator()(const blocked_range<int> &re) const
+  /// Transform data values in the specified index range
+  ///
+  /// Called by ElementWiseOpImpl::operator() of the subclass which defines
+  /// Op such that the Op function is not called virtually and can be inlined.
+  template <class TOp>
+  static void Run(const TOp *op, const blocked_range<int> &re)
   {
-    double *data = _Data + re.begin();
-    if (_Other) {
-      double *other = _Other + re.begin();
-      if (_Mask) {
-        bool *mask = _Mask + re.begin();
+    const ElementWiseBinaryOp *self = op;
+    const double constant = self->_Constant;
+    double *data = self->_Data + re.begin();
+    if (self->_Other) {
+      double *other = self->_Other + re.begin();
+      if (self->_Mask) {
+        bool *mask = self->_Mask + re.begin();
         for (int i = re.begin(); i != re.end(); ++i) {
-          if (*mask) *data = this->Op(*data, *other, *mask);
+          if (*mask) *data = op->TOp::Op(*data, *other, *mask);
           ++data, ++other, ++mask;
         }
       } else {
         bool mask = true;
         for (int i = re.begin(); i != re.end(); ++i) {
-          *data = this->Op(*data, *other, mask);
+          *data = op->TOp::Op(*data, *other, mask);
           ++data, ++other;
         }
       }
     } else {
-      if (_Mask) {
-        bool *mask = _Mask + re.begin();
+      if (self->_Mask) {
+        bool *mask = self->_Mask + re.begin();
         for (int i = re.begin(); i != re.end(); ++i) {
-          if (*mask) *data = this->Op(*data, _Constant, *mask);
+          if (*mask) *data = op->TOp::Op(*data, constant, *mask);
           ++data, ++mask;
         }
       } else {
         bool mask = true;
         for (int i = re.begin(); i != re.end(); ++i) {
-          *data = this->Op(*data, _Constant, mask);
+          *data = op->TOp::Op(*data, constant, mask);
           ++data;
         }
       }
     }
   }
 
+public:
+
   /// Transform data value and/or mask it by setting mask = false
   virtual double Op(double value, double, bool &) const = 0;
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     _Data     = data;
     _Mask     = mask;
@@ -258,34 +298,120 @@ public:
         exit(1);
       }
     }
-    // MUST be called in the base class which defines Op!
-    //parallel_for(blocked_range<int>(0, n), *this);
+  }
+
+  /// Process given data (not thread-safe!)
+  virtual void Process(int n, double *data, bool *mask = NULL)
+  {
+    this->Initialize(n, data, mask);
+    // Data is processed by ElementWiseOpImpl::Process of the subclass
   }
 };
 
 // -----------------------------------------------------------------------------
-/// Compute element-wise absolute value
-class Abs : public ElementWiseUnaryOp
+/// Element-wise data operation whose Op function is defined by TOp
+///
+/// Implements operator() and Process of subclass TOp, which derives from
+/// ElementWiseUnaryOp or ElementWiseBinaryOp (TBase), such that its Op
+/// function is not called virtually and can be inlined.
+template <class TOp, class TBase>
+class ElementWiseOpImpl : public TBase
 {
+protected:
+
+  /// Constructor
+  ElementWiseOpImpl() {}
+
+  /// Constructor
+  template <class TArg>
+  ElementWiseOpImpl(TArg arg) : TBase(arg) {}
+
 public:
 
-  /// Transform data value and/or mask data value by setting *mask = false
-  virtual double Op(double value, bool &) const
+  // Called by TBB's parallel_for, for internal use only!
+  virtual void operator()(const blocked_range<int> &re) const
   {
-    return abs(value);
+    TBase::Run(static_cast<const TOp *>(this), re);
   }
 
   /// Process given data (not thread-safe!)
   virtual void Process(int n, double *data, bool *mask = NULL)
   {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    TBase::Process(n, data, mask);
+    parallel_for(blocked_range<int>(0, n), *static_cast<TOp *>(this));
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Sequence of element-wise data operations evaluated in a single pass
+///
+/// Instead of iterating over the entire data sequence once for each
+/// operation, all operations of the sequence are applied to a small block
+/// of data values which fits into the L1 cache before continuing with the
+/// next block. Operations which need to see the entire data sequence, such
+/// as a data statistic, cannot be part of a sequence and therefore delimit
+/// the groups of element-wise operations.
+///
+/// The operations are not owned by the sequence.
+class ElementWiseOpSequence : public Op
+{
+private:
+
+  Array<ElementWiseOp *> _Ops;
+
+  /// Number of data values processed by each operation in turn
+  static const int _BlockSize = 2048;
+
+public:
+
+  /// Append element-wise operation to sequence
+  void Add(ElementWiseOp *op)
+  {
+    _Ops.push_back(op);
+  }
+
+  /// Number of operations in sequence
+  int Size() const
+  {
+    return static_cast<int>(_Ops.size());
+  }
+
+  // Called by TBB's parallel_for, for internal use only!
+  void operator()(const blocked_range<int> &re) const
+  {
+    for (int begin = re.begin(), end; begin < re.end(); begin = end) {
+      end = min(begin + _BlockSize, re.end());
+      blocked_range<int> block(begin, end);
+      for (size_t j = 0; j < _Ops.size(); ++j) (*_Ops[j])(block);
+    }
+  }
+
+  /// Process given data (not thread-safe!)
+  virtual void Process(int n, double *data, bool *mask = NULL)
+  {
+    for (size_t j = 0; j < _Ops.size(); ++j) {
+      _Ops[j]->Initialize(n, data, mask);
+    }
+    parallel_for(blocked_range<int>(0, n, _BlockSize), *this);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Compute element-wise absolute value
+class Abs : public ElementWiseOpImpl<Abs, ElementWiseUnaryOp>
+{
+public:
+
+  /// Transform data value and/or mask data value by setting *mask = false
+  virtual double Op(double value, bool &) const
+  {
+    return abs(value);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise power
-class Pow : public ElementWiseUnaryOp
+class Pow : public ElementWiseOpImpl<Pow, ElementWiseUnaryOp>
 {
   mirtkPublicAttributeMacro(double, Exponent);
 
@@ -298,18 +424,11 @@ public:
   {
     return pow(value, _Exponent);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise exponential map
-class Exp : public ElementWiseUnaryOp
+class Exp : public ElementWiseOpImpl<Exp, ElementWiseUnaryOp>
 {
 public:
 
@@ -318,18 +437,11 @@ public:
   {
     return exp(value);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise logarithmic map
-class Log : public ElementWiseUnaryOp
+class Log : public ElementWiseOpImpl<Log, ElementWiseUnaryOp>
 {
   mirtkPublicAttributeMacro(double, Base);
   mirtkPublicAttributeMacro(double, Threshold);
@@ -344,18 +456,11 @@ public:
     if (value < _Threshold) value = _Threshold;
     return log(value) / log(_Base);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise binary logarithm
-class Lb : public ElementWiseUnaryOp
+class Lb : public ElementWiseOpImpl<Lb, ElementWiseUnaryOp>
 {
   mirtkPublicAttributeMacro(double, Threshold);
 
@@ -369,18 +474,11 @@ public:
     if (value < _Threshold) value = _Threshold;
     return log2(value);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise natural logarithm
-class Ln : public ElementWiseUnaryOp
+class Ln : public ElementWiseOpImpl<Ln, ElementWiseUnaryOp>
 {
   mirtkPublicAttributeMacro(double, Threshold);
 
@@ -394,18 +492,11 @@ public:
     if (value < _Threshold) value = _Threshold;
     return log(value);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Compute element-wise logarithm to base 10
-class Lg : public ElementWiseUnaryOp
+class Lg : public ElementWiseOpImpl<Lg, ElementWiseUnaryOp>
 {
   mirtkPublicAttributeMacro(double, Threshold);
 
@@ -419,153 +510,111 @@ public:
     if (value < _Threshold) value = _Threshold;
     return log10(value);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Element-wise addition
-class Add : public ElementWiseBinaryOp
+class Add : public ElementWiseOpImpl<Add, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  Add(double value) : ElementWiseBinaryOp(value) {}
+  Add(double value) : ElementWiseOpImpl(value) {}
 
   /// Constructor
-  Add(const char *fname) : ElementWiseBinaryOp(fname) {}
+  Add(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &) const
   {
     return value + constant;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Element-wise subtraction
-class Sub : public ElementWiseBinaryOp
+class Sub : public ElementWiseOpImpl<Sub, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  Sub(double value) : ElementWiseBinaryOp(value) {}
+  Sub(double value) : ElementWiseOpImpl(value) {}
 
   /// Constructor
-  Sub(const char *fname) : ElementWiseBinaryOp(fname) {}
+  Sub(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &) const
   {
     return value - constant;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Element-wise multiplication
-class Mul : public ElementWiseBinaryOp
+class Mul : public ElementWiseOpImpl<Mul, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  Mul(double value) : ElementWiseBinaryOp(value) {}
+  Mul(double value) : ElementWiseOpImpl(value) {}
 
   /// Constructor
-  Mul(const char *fname) : ElementWiseBinaryOp(fname) {}
+  Mul(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &) const
   {
     return value * constant;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Element-wise division
-class Div : public ElementWiseBinaryOp
+class Div : public ElementWiseOpImpl<Div, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  Div(double value) : ElementWiseBinaryOp(value) {}
+  Div(double value) : ElementWiseOpImpl(value) {}
 
   /// Constructor
-  Div(const char *fname) : ElementWiseBinaryOp(fname) {}
+  Div(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &) const
   {
     return (constant != .0 ? value / constant : numeric_limits<double>::quiet_NaN());
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Element-wise division
-class DivWithZero : public ElementWiseBinaryOp
+class DivWithZero : public ElementWiseOpImpl<DivWithZero, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  DivWithZero(const char *fname) : ElementWiseBinaryOp(fname) {}
+  DivWithZero(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &) const
   {
     return (constant != .0 ? value / constant : .0);
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask values
-class Mask : public ElementWiseBinaryOp
+class Mask : public ElementWiseOpImpl<Mask, ElementWiseBinaryOp>
 {
 public:
 
   /// Constructor
-  Mask(double value) : ElementWiseBinaryOp(value) {}
+  Mask(double value) : ElementWiseOpImpl(value) {}
 
   /// Constructor
-  Mask(const char *fname) : ElementWiseBinaryOp(fname) {}
+  Mask(const char *fname) : ElementWiseOpImpl(fname) {}
 
   /// Transform data value and/or mask data value by setting *mask = false
   virtual double Op(double value, double constant, bool &mask) const
@@ -576,18 +625,11 @@ public:
     }
     return value;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseBinaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask values below or above a specified lower/upper threshold
-class MaskOutsideInterval : public ElementWiseUnaryOp
+class MaskOutsideInterval : public ElementWiseOpImpl<MaskOutsideInterval, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -652,19 +694,18 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_LowerThresholdPointer) _LowerThreshold = *_LowerThresholdPointer;
     if (_UpperThresholdPointer) _UpperThreshold = *_UpperThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask values below, equal, or above a specified lower/upper threshold
-class MaskOutsideOpenInterval : public ElementWiseUnaryOp
+class MaskOutsideOpenInterval : public ElementWiseOpImpl<MaskOutsideOpenInterval, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -729,19 +770,18 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_LowerThresholdPointer) _LowerThreshold = *_LowerThresholdPointer;
     if (_UpperThresholdPointer) _UpperThreshold = *_UpperThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask values inside closed interval
-class MaskInsideInterval : public ElementWiseUnaryOp
+class MaskInsideInterval : public ElementWiseOpImpl<MaskInsideInterval, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -806,19 +846,18 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_LowerThresholdPointer) _LowerThreshold = *_LowerThresholdPointer;
     if (_UpperThresholdPointer) _UpperThreshold = *_UpperThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask values inside open interval
-class MaskInsideOpenInterval : public ElementWiseUnaryOp
+class MaskInsideOpenInterval : public ElementWiseOpImpl<MaskInsideOpenInterval, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -883,19 +922,18 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_LowerThresholdPointer) _LowerThreshold = *_LowerThresholdPointer;
     if (_UpperThresholdPointer) _UpperThreshold = *_UpperThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask even values (e.g., segmentation labels of right hemisphere; cf MAL 2012)
-class MaskEvenValues : public ElementWiseUnaryOp
+class MaskEvenValues : public ElementWiseOpImpl<MaskEvenValues, ElementWiseUnaryOp>
 {
 public:
 
@@ -905,18 +943,11 @@ public:
     if (static_cast<int>(value) % 2 == 0) mask = false;
     return value;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Mask odd values (e.g., segmentation labels of left hemisphere; cf MAL 2012)
-class MaskOddValues : public ElementWiseUnaryOp
+class MaskOddValues : public ElementWiseOpImpl<MaskOddValues, ElementWiseUnaryOp>
 {
 public:
 
@@ -926,18 +957,11 @@ public:
     if (static_cast<int>(value) % 2 == 1) mask = false;
     return value;
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
 /// Clamp values below or equal a given threshold value
-class LowerThreshold : public ElementWiseUnaryOp
+class LowerThreshold : public ElementWiseOpImpl<LowerThreshold, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, Threshold);
@@ -971,18 +995,17 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_ThresholdPointer) _Threshold = *_ThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Clamp values below or equal a given threshold value
-class UpperThreshold : public ElementWiseUnaryOp
+class UpperThreshold : public ElementWiseOpImpl<UpperThreshold, ElementWiseUnaryOp>
 {
   /// Upper threshold value
   mirtkPublicAttributeMacro(double, Threshold);
@@ -1016,18 +1039,17 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_ThresholdPointer) _Threshold = *_ThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Clamp values below or equal a given threshold value
-class Clamp : public ElementWiseUnaryOp
+class Clamp : public ElementWiseOpImpl<Clamp, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -1089,19 +1111,18 @@ public:
     return value;
   }
 
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
+  /// Initialize operation before processing given data (not thread-safe!)
+  virtual void Initialize(int n, double *data, bool *mask = NULL)
   {
     if (_LowerThresholdPointer) _LowerThreshold = *_LowerThresholdPointer;
     if (_UpperThresholdPointer) _UpperThreshold = *_UpperThresholdPointer;
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
+    ElementWiseUnaryOp::Initialize(n, data, mask);
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Set values to either one or zero
-class Binarize : public ElementWiseUnaryOp
+class Binarize : public ElementWiseOpImpl<Binarize, ElementWiseUnaryOp>
 {
   /// Lower threshold value
   mirtkPublicAttributeMacro(double, LowerThreshold);
@@ -1134,13 +1155,6 @@ public:
       }
     }
   }
-
-  /// Process given data (not thread-safe!)
-  virtual void Process(int n, double *data, bool *mask = NULL)
-  {
-    ElementWiseUnaryOp::Process(n, data, mask);
-    parallel_for(blocked_range<int>(0, n), *this);
-  }
 };
 
 // -----------------------------------------------------------------------------
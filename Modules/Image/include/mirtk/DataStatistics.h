@@ -26,7 +26,8 @@
 #include "mirtk/String.h"
 #include "mirtk/Stream.h"
 #include "mirtk/Array.h"
-#include "mirtk/Algorithm.h" // partial_sort
+#include "mirtk/Algorithm.h" // nth_element
+#include "mirtk/Parallel.h"
 
 
 namespace mirtk { namespace data { namespace statistic {
@@ -586,11 +587,126 @@ class Percentile : public Statistic
   /// Percentile rank computed as a side product
   mirtkReadOnlyAttributeMacro(double, Rank);
 
+  /// Maximum number of histogram bins used to select the order statistics
+  static const int _MaxBins = 65536;
+
+  /// Get (absolute) data value
+  template <class T>
+  static double DataValue(const T *data, int i, bool abs)
+  {
+    const double v = static_cast<double>(data[i]);
+    return (abs ? mirtk::abs(v) : v);
+  }
+
+  /// Whether data value is finite, i.e., neither NaN nor infinite
+  ///
+  /// Non-finite values are ignored by the percentile calculation as these
+  /// cannot be assigned to a histogram bin.
+  static bool IsFiniteValue(double v)
+  {
+    return !IsNaN(v) && !IsInf(v);
+  }
+
+  /// Determine number, range, and integrality of unmasked finite values
+  template <class T>
+  struct DataRange
+  {
+    const T    *_Data;
+    const bool *_Mask;
+    bool        _Abs;
+    int         _Count;
+    double      _Min;
+    double      _Max;
+    bool        _Integral;
+
+    DataRange(const T *data, const bool *mask, bool abs)
+    :
+      _Data(data), _Mask(mask), _Abs(abs), _Count(0),
+      _Min(numeric_limits<double>::infinity()), _Max(-_Min), _Integral(true)
+    {}
+
+    DataRange(const DataRange &other, split)
+    :
+      _Data(other._Data), _Mask(other._Mask), _Abs(other._Abs), _Count(0),
+      _Min(numeric_limits<double>::infinity()), _Max(-_Min), _Integral(true)
+    {}
+
+    void join(const DataRange &other)
+    {
+      _Count += other._Count;
+      if (other._Min < _Min) _Min = other._Min;
+      if (other._Max > _Max) _Max = other._Max;
+      _Integral = _Integral && other._Integral;
+    }
+
+    void operator ()(const blocked_range<int> &re)
+    {
+      double v;
+      for (int i = re.begin(); i != re.end(); ++i) {
+        if (!_Mask || _Mask[i]) {
+          v = DataValue(_Data, i, _Abs);
+          if (!IsFiniteValue(v)) continue;
+          if (v < _Min) _Min = v;
+          if (v > _Max) _Max = v;
+          if (_Integral && v != floor(v)) _Integral = false;
+          ++_Count;
+        }
+      }
+    }
+  };
+
+  /// Count unmasked finite values in equally sized bins
+  template <class T>
+  struct DataHistogram
+  {
+    const T    *_Data;
+    const bool *_Mask;
+    bool        _Abs;
+    double      _Min;
+    double      _Scale;
+    int         _Bins;
+    Array<int>  _Count;
+
+    DataHistogram(const T *data, const bool *mask, bool abs, double min, double scale, int bins)
+    :
+      _Data(data), _Mask(mask), _Abs(abs), _Min(min), _Scale(scale), _Bins(bins), _Count(bins, 0)
+    {}
+
+    DataHistogram(const DataHistogram &other, split)
+    :
+      _Data(other._Data), _Mask(other._Mask), _Abs(other._Abs),
+      _Min(other._Min), _Scale(other._Scale), _Bins(other._Bins), _Count(other._Bins, 0)
+    {}
+
+    void join(const DataHistogram &other)
+    {
+      for (int b = 0; b < _Bins; ++b) _Count[b] += other._Count[b];
+    }
+
+    /// Bin index of data value, monotonically increasing with the value
+    int Bin(double v) const
+    {
+      const int b = static_cast<int>((v - _Min) * _Scale);
+      return (b < 0 ? 0 : (b < _Bins ? b : _Bins - 1));
+    }
+
+    void operator ()(const blocked_range<int> &re)
+    {
+      double v;
+      for (int i = re.begin(); i != re.end(); ++i) {
+        if (!_Mask || _Mask[i]) {
+          v = DataValue(_Data, i, _Abs);
+          if (IsFiniteValue(v)) ++_Count[Bin(v)];
+        }
+      }
+    }
+  };
+
 public:
 
   Percentile(int p, const char *desc = NULL, const Array<string> *names = NULL)
   :
-    _P(p), _Rank(-1)
+    Statistic(desc, names), _P(p), _Rank(-1)
   {
     if (!desc) {
       _Description = ToString(p);
@@ -612,57 +728,141 @@ public:
 
   }
 
+  /// Calculate multiple percentiles of the same data at once
+  ///
+  /// The order statistics needed by all percentiles are selected after a single
+  /// parallel pass which counts the unmasked values in a histogram. When all
+  /// values are integral and span less than _MaxBins distinct values, e.g.,
+  /// for short or unsigned char images, each bin holds exactly one value and
+  /// the result is read off the cumulative counts without copying any data.
+  /// Otherwise, only the values of those bins which contain a requested order
+  /// statistic are copied and partially sorted.
+  ///
+  /// \param[in]  np    Number of percentiles.
+  /// \param[in]  p     Percentages of values that are lower than the percentiles.
+  /// \param[out] rank  Percentile ranks.
+  /// \param[out] value Percentile values.
+  /// \param[in]  n     Number of data values.
+  /// \param[in]  data  Data values.
+  /// \param[in]  mask  Mask of values to consider. NaN and infinite values are ignored.
+  /// \param[in]  abs   Whether to compute percentiles of absolute values.
   template <class T>
-  static double Calculate(int p, double &rank, int n, const T *data, const bool *mask = NULL)
+  static void Calculate(int np, const int *p, double *rank, double *value,
+                        int n, const T *data, const bool *mask = NULL, bool abs = false)
   {
-    // Determine number of unmasked values
-    int m = n;
-    if (mask) {
-      m = 0;
-      for (int i = 0; i < n; ++i) {
-        if (mask[i]) ++m;
-      }
-    }
+    const double nan = numeric_limits<double>::quiet_NaN();
+
+    // Determine number and range of unmasked values
+    DataRange<T> range(data, mask, abs);
+    parallel_reduce(blocked_range<int>(0, n), range);
+    const int m = range._Count;
 
     if (m == 0) {
-      rank = numeric_limits<double>::quiet_NaN();
-      return numeric_limits<double>::quiet_NaN();
+      for (int i = 0; i < np; ++i) rank[i] = value[i] = nan;
+      return;
     }
 
-    // Compute percentile rank
-    rank = (double(p) / 100.0) * double(m + 1);
-
-    // Split rank into integer and decimal components
-    int    k = int(rank);
-    double d = rank - k;
-
-    // Compute percentile value according to NIST method
+    // Compute percentile ranks and determine required order statistics
+    // according to NIST method
     // (cf. http://en.wikipedia.org/wiki/Percentile#Definition_of_the_NIST_method )
-    if (k == 0) {
-      return Min::Calculate(n, data, mask);
-    } else if (k >= m) {
-      return Max::Calculate(n, data, mask);
+    Array<int> order;
+    order.reserve(2 * np);
+    for (int i = 0; i < np; ++i) {
+      rank[i] = (double(p[i]) / 100.0) * double(m + 1);
+      const int k = int(rank[i]);
+      if      (k == 0) value[i] = range._Min;
+      else if (k >= m) value[i] = range._Max;
+      else {
+        order.push_back(k - 1);
+        order.push_back(k);
+      }
+    }
+    if (order.empty()) return;
+    sort(order.begin(), order.end());
+    order.erase(unique(order.begin(), order.end()), order.end());
+
+    // Count unmasked values in histogram bins
+    const double width = range._Max - range._Min;
+    const bool   exact = (range._Integral || width == .0) && width < double(_MaxBins);
+    int    bins  = 1;
+    double scale = .0;
+    if (exact) {
+      bins  = int(width) + 1;
+      scale = 1.0;
+    } else if (width > .0 && !IsInf(width)) {
+      bins  = max(1, min(m / 16, int(_MaxBins)));
+      scale = double(bins) / width;
+    }
+    DataHistogram<T> hist(data, mask, abs, range._Min, scale, bins);
+    parallel_reduce(blocked_range<int>(0, n), hist);
+
+    // Find bin of each order statistic and its offset within this bin
+    const int  no = static_cast<int>(order.size());
+    Array<int> bin(no), offset(no);
+    for (int j = 0, b = 0, c = 0; j < no; ++j) {
+      while (c + hist._Count[b] <= order[j]) c += hist._Count[b++];
+      bin   [j] = b;
+      offset[j] = order[j] - c;
+    }
+
+    // Select order statistics
+    Array<double> stat(no);
+    if (exact) {
+      for (int j = 0; j < no; ++j) stat[j] = range._Min + double(bin[j]);
     } else {
-      // Copy unmasked data only
-      double *v = new double[m];
-      if (mask) {
-        m = 0;
-        for (int i = 0; i < n; ++i) {
-          if (mask[i]) v[m++] = static_cast<double>(data[i]);
+      // Copy values of those bins which contain an order statistic
+      Array<int> start(bins, -1);
+      int size = 0;
+      for (int j = 0; j < no; ++j) {
+        if (start[bin[j]] == -1) {
+          start[bin[j]] = size;
+          size += hist._Count[bin[j]];
         }
-      } else {
-        for (int i = 0; i < n; ++i) {
-          v[i] = static_cast<double>(data[i]);
+      }
+      Array<int> next(start);
+      double *v = new double[size];
+      double  d;
+      int     b;
+      for (int i = 0; i < n; ++i) {
+        if (!mask || mask[i]) {
+          d = DataValue(data, i, abs);
+          if (!IsFiniteValue(d)) continue;
+          b = hist.Bin(d);
+          if (next[b] != -1) v[next[b]++] = d;
+        }
+      }
+      // Partially sort values of each bin up to the requested offsets
+      for (int j = 0, k = 0; j < no; j = k) {
+        double *first = v + start[bin[j]];
+        double *last  = first + hist._Count[bin[j]];
+        double *lower = first;
+        for (k = j; k < no && bin[k] == bin[j]; ++k) {
+          nth_element(lower, first + offset[k], last);
+          stat[k] = first[offset[k]];
+          lower = first + offset[k] + 1;
         }
       }
-      // Sort data below k + 1
-      partial_sort(v, v + k + 1, v + m);
-      // Compute percentile value
-      double percentile = v[k - 1] + d * (v[k] - v[k - 1]);
-      // Free (partially) sorted data copy
       delete[] v;
-      return percentile;
     }
+
+    // Interpolate percentile values
+    for (int i = 0; i < np; ++i) {
+      const int k = int(rank[i]);
+      if (0 < k && k < m) {
+        const double d = rank[i] - k;
+        const double a = stat[lower_bound(order.begin(), order.end(), k - 1) - order.begin()];
+        const double b = stat[lower_bound(order.begin(), order.end(), k    ) - order.begin()];
+        value[i] = a + d * (b - a);
+      }
+    }
+  }
+
+  template <class T>
+  static double Calculate(int p, double &rank, int n, const T *data, const bool *mask = NULL)
+  {
+    double value;
+    Calculate(1, &p, &rank, &value, n, data, mask);
+    return value;
   }
 
   template <class T>
@@ -677,6 +877,20 @@ public:
     Value(Calculate(_P, _Rank, n, data, mask));
   }
 
+  /// Evaluate multiple percentile statistics of the same data at once
+  static void Evaluate(const Array<Percentile *> &stats, int n, const double *data, const bool *mask = NULL)
+  {
+    const int     np = static_cast<int>(stats.size());
+    Array<int>    p(np);
+    Array<double> rank(np), value(np);
+    for (int i = 0; i < np; ++i) p[i] = stats[i]->_P;
+    Calculate(np, p.data(), rank.data(), value.data(), n, data, mask);
+    for (int i = 0; i < np; ++i) {
+      stats[i]->_Rank = rank[i];
+      stats[i]->Value(value[i]);
+    }
+  }
+
   // Add support for vtkDataArray
 #if MIRTK_Image_WITH_VTK
 
@@ -720,7 +934,7 @@ public:
 
   AbsPercentile(int p, const char *desc = NULL, const Array<string> *names = NULL)
   :
-    _P(p), _Rank(-1)
+    Statistic(desc, names), _P(p), _Rank(-1)
   {
     if (!desc) {
       _Description = ToString(p);
@@ -744,54 +958,9 @@ public:
   template <class T>
   static double Calculate(int p, double &rank, int n, const T *data, const bool *mask = NULL)
   {
-    // Determine number of unmasked values
-    int m = n;
-    if (mask) {
-      m = 0;
-      for (int i = 0; i < n; ++i) {
-        if (mask[i]) ++m;
-      }
-    }
-
-    if (m == 0) {
-      rank = numeric_limits<double>::quiet_NaN();
-      return numeric_limits<double>::quiet_NaN();
-    }
-
-    // Compute percentile rank
-    rank = (double(p) / 100.0) * double(m + 1);
-
-    // Split rank into integer and decimal components
-    int    k = int(rank);
-    double d = rank - k;
-
-    // Compute percentile value according to NIST method
-    // (cf. http://en.wikipedia.org/wiki/Percentile#Definition_of_the_NIST_method )
-    if (k == 0) {
-      return MinAbs::Calculate(n, data, mask);
-    } else if (k >= m) {
-      return MaxAbs::Calculate(n, data, mask);
-    } else {
-      // Copy unmasked data only
-      double *v = new double[m];
-      if (mask) {
-        m = 0;
-        for (int i = 0; i < n; ++i) {
-          if (mask[i]) v[m++] = abs(static_cast<double>(data[i]));
-        }
-      } else {
-        for (int i = 0; i < n; ++i) {
-          v[i] = abs(static_cast<double>(data[i]));
-        }
-      }
-      // Sort data below k + 1
-      partial_sort(v, v + k + 1, v + m);
-      // Compute percentile value
-      double percentile = v[k - 1] + d * (v[k] - v[k - 1]);
-      // Free (partially) sorted data copy
-      delete[] v;
-      return percentile;
-    }
+    double value;
+    Percentile::Calculate(1, &p, &rank, &value, n, data, mask, true);
+    return value;
   }
 
   template <class T>
@@ -835,6 +1004,37 @@ public:
 #endif
 };
 
+// -----------------------------------------------------------------------------
+/// Sequence of percentile statistics of the same data evaluated at once
+///
+/// The percentile statistics are not owned by the sequence.
+class PercentileSequence : public Op
+{
+private:
+
+  Array<Percentile *> _Stats;
+
+public:
+
+  /// Append percentile statistic to sequence
+  void Add(Percentile *stat)
+  {
+    _Stats.push_back(stat);
+  }
+
+  /// Number of percentile statistics in sequence
+  int Size() const
+  {
+    return static_cast<int>(_Stats.size());
+  }
+
+  /// Process given data
+  virtual void Process(int n, double *data, bool *mask = NULL)
+  {
+    Percentile::Evaluate(_Stats, n, data, mask);
+  }
+};
+
 // -----------------------------------------------------------------------------
 /// Lower percentile mean calculation
 class LowerPercentileMean : public Percentile
@@ -1038,8 +1238,11 @@ public:
   template <class T>
   static double Calculate(int p, int n, const T *data, const bool *mask = NULL)
   {
-    const double min = Percentile::Calculate(      p, n, data, mask);
-    const double max = Percentile::Calculate(100 - p, n, data, mask);
+    const int pcts[2] = {p, 100 - p};
+    double    rank[2], pctl[2];
+    Percentile::Calculate(2, pcts, rank, pctl, n, data, mask);
+    const double min = pctl[0];
+    const double max = pctl[1];
 
     int    m =  0;
     double v = .0, d;
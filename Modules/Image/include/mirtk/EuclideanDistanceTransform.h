@@ -50,7 +50,9 @@ protected:
   void edtComputeEDT_3D(char *, long *, long, long, long);
 
   /// Calculate the Vornoi diagram for anisotripic voxel sizes
-  int edtVornoiEDT_anisotropic(VoxelType *, long, double);
+  ///
+  /// The last two arguments are work arrays of the same size as the first.
+  int edtVornoiEDT_anisotropic(VoxelType *, long, double, float *, float *);
 
   /// Calculate 2D distance transform for anisotripic voxel sizes
   void edtComputeEDT_2D_anisotropic(const VoxelType *, VoxelType *, long, long, double, double);
@@ -58,6 +60,12 @@ protected:
   /// Calculate 3D distance transform for anisotripic voxel sizes
   void edtComputeEDT_3D_anisotropic(const VoxelType *, VoxelType *, long, long, long, double, double, double);
 
+  /// Parallel body computing the 2D distance transform of each slice
+  struct ComputeEDT_2D;
+
+  /// Parallel body solving the 1D problem for each column in z direction
+  struct ComputeEDT_1D;
+
 public:
 
   /// Default constructor
@@ -1157,6 +1157,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range<int> re(0, im2->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+    blocked_range<int> re(0, im2->GetNumberOfVoxels() / im2->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range<int> re(0, im2.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2.GetTSize()) {
+    ParallelForEachScalar(im1, im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+    blocked_range<int> re(0, im2.GetNumberOfVoxels() / im2.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -2767,6 +2927,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range<int> re(0, im2->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+    blocked_range<int> re(0, im2->GetNumberOfVoxels() / im2->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range<int> re(0, im2.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2.GetTSize()) {
+    ParallelForEachScalar(im1, im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+    blocked_range<int> re(0, im2.GetNumberOfVoxels() / im2.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody_1Const<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -4377,6 +4697,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, GenericI
   ParallelForEachVoxel(re, im1, im2, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range<int> re(0, im2->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+    blocked_range<int> re(0, im2->GetNumberOfVoxels() / im2->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(*im1, *im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range<int> re(0, im2.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im2.GetTSize()) {
+    ParallelForEachScalar(im1, im2, vf, ap);
+  } else {
+    BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(im1, im2, vf);
+    blocked_range<int> re(0, im2.GetNumberOfVoxels() / im2.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  BinaryForEachVoxelBody<T1, T2, VoxelFunc> body(im1, im2, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachbinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -1241,6 +1241,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, const GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, const GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -2935,6 +3095,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_8Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -4630,33 +4950,193 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
 }
 
 // -----------------------------------------------------------------------------
-// ParallelForEachVoxelIf
+// ParallelForEachVoxel with affinity partitioner
 // -----------------------------------------------------------------------------
 
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
 //
 // Image arguments by pointer
 //
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, OutsideFunc &of)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
 {
-  NonaryForEachVoxelIfBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, of);
+  NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
   blocked_range<int> re(0, im9->GetNumberOfVoxels());
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
-    parallel_reduce(re, body);
-    vf.join(body._VoxelFunc);
-    of.join(body._OutsideFunc);
-  } else {
-    parallel_for(re, body);
-  }
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
 }
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
 {
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxelIf
+// -----------------------------------------------------------------------------
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, OutsideFunc &of)
+{
+  NonaryForEachVoxelIfBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, of);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
+    parallel_reduce(re, body);
+    vf.join(body._VoxelFunc);
+    of.join(body._OutsideFunc);
+  } else {
+    parallel_for(re, body);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9)
+{
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
   ParallelForEachScalarIf<Domain>(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, of);
 }
 
@@ -6323,6 +6803,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -8017,6 +8657,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -9681,34 +10481,194 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range<int> &re, const Gene
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
 void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf)
 {
-  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf)
+{
+  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
 {
   NonaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -11405,6 +12365,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -13076,27 +14196,187 @@ void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1>
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf)
+{
+  NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
 {
   NonaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -14793,6 +16073,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -16487,6 +17927,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, GenericI
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range<int> re(0, im9->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+    blocked_range<int> re(0, im9->GetNumberOfVoxels() / im9->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, GenericImage<T9> *im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, *im9, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range<int> re(0, im9.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im9.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+  } else {
+    NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+    blocked_range<int> re(0, im9.GetNumberOfVoxels() / im9.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  NonaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, T9, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, im9, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class T9, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, GenericImage<T9> &im9, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachnonaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, im9, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
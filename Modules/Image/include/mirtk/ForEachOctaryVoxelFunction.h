@@ -1229,6 +1229,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, const GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, const GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -2911,6 +3071,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, const GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_7Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, const GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -4594,33 +4914,193 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
 }
 
 // -----------------------------------------------------------------------------
-// ParallelForEachVoxelIf
+// ParallelForEachVoxel with affinity partitioner
 // -----------------------------------------------------------------------------
 
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
 //
 // Image arguments by pointer
 //
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, OutsideFunc &of)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
 {
-  OctaryForEachVoxelIfBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, of);
+  OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
   blocked_range<int> re(0, im8->GetNumberOfVoxels());
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
-    parallel_reduce(re, body);
-    vf.join(body._VoxelFunc);
-    of.join(body._OutsideFunc);
-  } else {
-    parallel_for(re, body);
-  }
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
 }
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
 {
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxelIf
+// -----------------------------------------------------------------------------
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, OutsideFunc &of)
+{
+  OctaryForEachVoxelIfBody_6Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, of);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
+    parallel_reduce(re, body);
+    vf.join(body._VoxelFunc);
+    of.join(body._OutsideFunc);
+  } else {
+    parallel_for(re, body);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8)
+{
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
   ParallelForEachScalarIf<Domain>(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, of);
 }
 
@@ -6275,6 +6755,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -7927,34 +8567,194 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range<int> &re, const Gene
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
 void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf)
 {
-  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf)
+{
+  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
 {
   OctaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -9639,6 +10439,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -11298,27 +12258,187 @@ void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1>
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf)
+{
+  OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
 {
   OctaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -13003,6 +14123,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -14685,6 +15965,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, GenericI
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, im7, im8, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range<int> re(0, im8->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+    blocked_range<int> re(0, im8->GetNumberOfVoxels() / im8->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, GenericImage<T7> *im7, GenericImage<T8> *im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, *im7, *im8, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range<int> re(0, im8.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im8.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+  } else {
+    OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+    blocked_range<int> re(0, im8.GetNumberOfVoxels() / im8.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  OctaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, T7, T8, VoxelFunc> body(im1, im2, im3, im4, im5, im6, im7, im8, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, GenericImage<T7> &im7, GenericImage<T8> &im8, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachoctaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, im7, im8, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
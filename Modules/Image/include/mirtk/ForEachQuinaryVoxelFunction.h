@@ -1193,6 +1193,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -2839,6 +2999,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -4485,6 +4805,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -6108,27 +6588,187 @@ void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1>
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5)
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf)
+{
+  QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
 {
   QuinaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -7777,6 +8417,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -9423,6 +10223,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, GenericI
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range<int> re(0, im5->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+    blocked_range<int> re(0, im5->GetNumberOfVoxels() / im5->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range<int> re(0, im5.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im5.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, vf, ap);
+  } else {
+    QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+    blocked_range<int> re(0, im5.GetNumberOfVoxels() / im5.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  QuinaryForEachVoxelBody<T1, T2, T3, T4, T5, VoxelFunc> body(im1, im2, im3, im4, im5, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachquinaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
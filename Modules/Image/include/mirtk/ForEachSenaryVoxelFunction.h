@@ -1205,6 +1205,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, const GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, const GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -2863,6 +3023,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, const GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_5Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, const GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -4522,33 +4842,193 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
 }
 
 // -----------------------------------------------------------------------------
-// ParallelForEachVoxelIf
+// ParallelForEachVoxel with affinity partitioner
 // -----------------------------------------------------------------------------
 
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
 //
 // Image arguments by pointer
 //
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, OutsideFunc &of)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
 {
-  SenaryForEachVoxelIfBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, vf, of);
+  SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
   blocked_range<int> re(0, im6->GetNumberOfVoxels());
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
-    parallel_reduce(re, body);
-    vf.join(body._VoxelFunc);
-    of.join(body._OutsideFunc);
-  } else {
-    parallel_for(re, body);
-  }
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
 }
 
 // -----------------------------------------------------------------------------
-template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc, class OutsideFunc>
-void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6)
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
 {
-  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, const GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxelIf
+// -----------------------------------------------------------------------------
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, OutsideFunc &of)
+{
+  SenaryForEachVoxelIfBody_4Const<T1, T2, T3, T4, T5, T6, VoxelFunc, OutsideFunc, Domain> body(*im1, *im2, *im3, *im4, *im5, *im6, vf, of);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) {
+    parallel_reduce(re, body);
+    vf.join(body._VoxelFunc);
+    of.join(body._OutsideFunc);
+  } else {
+    parallel_for(re, body);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class Domain, class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc, class OutsideFunc>
+void ParallelForEachScalarIf(VoxelFunc vf, OutsideFunc of, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, const GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6)
+{
+  if (VoxelFunc::IsReduction() || OutsideFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
   ParallelForEachScalarIf<Domain>(*im1, *im2, *im3, *im4, *im5, *im6, vf, of);
 }
 
@@ -6179,6 +6659,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, const GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_3Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, const GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -7814,27 +8454,187 @@ void ParallelForEachVoxel(const blocked_range2d<int> &re, const GenericImage<T1>
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6)
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range2d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf)
+{
+  SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
+}
+
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, const GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
-void ParallelForEachVoxel(const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf)
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
 {
   SenaryForEachVoxelBody_2Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
-  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body); vf.join(body._VoxelFunc); }
-  else                            parallel_for   (re, body);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
-void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6)
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, const GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
 {
   if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
-  ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
 }
 
 // -----------------------------------------------------------------------------
@@ -9495,6 +10295,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, const Ge
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody_1Const<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, const GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
@@ -11153,6 +12113,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, GenericI
   ParallelForEachVoxel(re, im1, im2, im3, im4, im5, im6, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range<int> re(0, im6->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6->GetTSize()) {
+    ParallelForEachScalar(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+    blocked_range<int> re(0, im6->GetNumberOfVoxels() / im6->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(*im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(*im1, *im2, *im3, *im4, *im5, *im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> *im1, GenericImage<T2> *im2, GenericImage<T3> *im3, GenericImage<T4> *im4, GenericImage<T5> *im5, GenericImage<T6> *im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, *im1, *im2, *im3, *im4, *im5, *im6, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range<int> re(0, im6.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (im6.GetTSize()) {
+    ParallelForEachScalar(im1, im2, im3, im4, im5, im6, vf, ap);
+  } else {
+    SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+    blocked_range<int> re(0, im6.GetNumberOfVoxels() / im6.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  SenaryForEachVoxelBody<T1, T2, T3, T4, T5, T6, VoxelFunc> body(im1, im2, im3, im4, im5, im6, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class T1, class T2, class T3, class T4, class T5, class T6, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, GenericImage<T1> &im1, GenericImage<T2> &im2, GenericImage<T3> &im3, GenericImage<T4> &im4, GenericImage<T5> &im5, GenericImage<T6> &im6, affinity_partitioner &ap)
+{
+  if (VoxelFunc::IsReduction()) _foreachsenaryvoxelfunction_must_not_be_reduction();
+  ParallelForEachVoxel(attr, im1, im2, im3, im4, im5, im6, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
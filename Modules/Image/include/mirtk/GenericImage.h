@@ -66,13 +66,11 @@ public:
 
 protected:
 
-  /// Pointer array for access to image data
-  ///
-  /// \note The image data is stored in a contiguous memory block which can
-  ///       be alternatively referred to as 1D data array using \c _data.
-  VoxelType ****_matrix;
-
   /// Pointer to image data
+  ///
+  /// \note The image data is stored in a contiguous memory block aligned to
+  ///       the size of a cache line. Voxels are addressed using the strides
+  ///       of the image dimensions, no table of row pointers is allocated.
   VoxelType *_data;
 
   /// Whether image data memory itself is owned by this instance
@@ -81,8 +79,8 @@ protected:
   // ---------------------------------------------------------------------------
   // Construction/Destruction
 
-  /// Allocate image memory
-  void AllocateImage(VoxelType * = NULL);
+  /// Allocate image memory, initialized to zero unless second argument is false
+  void AllocateImage(VoxelType * = NULL, bool = true);
 
 public:
 
@@ -141,6 +139,13 @@ public:
   /// Initialize an image
   void Initialize(int, int, int = 1, int = 1, VoxelType *data = NULL);
 
+  /// Initialize an image without setting the voxel values
+  ///
+  /// The data memory is obtained from the MemoryPool and may still contain
+  /// the values of a previously destroyed image. Use this function instead
+  /// of Initialize for temporary images whose voxels are all overwritten.
+  void AllocateUninitialized(const ImageAttributes &, int = -1);
+
   /// Copy image data from 1D array
   void CopyFrom(const VoxelType *);
 
@@ -520,7 +525,7 @@ inline int GenericImage<VoxelType>::N() const
 template <class VoxelType>
 inline int GenericImage<VoxelType>::VoxelToIndex(int x, int y, int z, int t) const
 {
-  return static_cast<int>(&_matrix[t][z][y][x] - &_matrix[0][0][0][0]);
+  return x + _attr._x * (y + _attr._y * (z + _attr._z * t));
 }
 
 // =============================================================================
@@ -538,21 +543,21 @@ inline void GenericImage<VoxelType>::Put(int index, VoxelType val)
 template <class VoxelType>
 inline void GenericImage<VoxelType>::Put(int x, int y, VoxelType val)
 {
-  _matrix[0][0][y][x] = val;
+  _data[x + _attr._x * y] = val;
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::Put(int x, int y, int z, VoxelType val)
 {
-  _matrix[0][z][y][x] = val;
+  _data[x + _attr._x * (y + _attr._y * z)] = val;
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::Put(int x, int y, int z, int t, VoxelType val)
 {
-  _matrix[t][z][y][x] = val;
+  _data[VoxelToIndex(x, y, z, t)] = val;
 }
 
 // -----------------------------------------------------------------------------
@@ -566,7 +571,7 @@ inline VoxelType GenericImage<VoxelType>::Get(int index) const
 template <class VoxelType>
 inline VoxelType GenericImage<VoxelType>::Get(int x, int y, int z, int t) const
 {
-  return _matrix[t][z][y][x];
+  return _data[VoxelToIndex(x, y, z, t)];
 }
 
 // -----------------------------------------------------------------------------
@@ -587,14 +592,14 @@ inline const VoxelType &GenericImage<VoxelType>::operator ()(int index) const
 template <class VoxelType>
 inline VoxelType& GenericImage<VoxelType>::operator()(int x, int y, int z, int t)
 {
-  return _matrix[t][z][y][x];
+  return _data[VoxelToIndex(x, y, z, t)];
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline const VoxelType& GenericImage<VoxelType>::operator()(int x, int y, int z, int t) const
 {
-  return _matrix[t][z][y][x];
+  return _data[VoxelToIndex(x, y, z, t)];
 }
 
 // =============================================================================
@@ -631,21 +636,21 @@ inline void GenericImage<VoxelType>::PutAsDouble(int index, double val)
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsDouble(int x, int y, double val)
 {
-  _matrix[0][0][y][x] = voxel_cast<VoxelType>(val);
+  _data[x + _attr._x * y] = voxel_cast<VoxelType>(val);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsDouble(int x, int y, int z, double val)
 {
-  _matrix[0][z][y][x] = voxel_cast<VoxelType>(val);
+  _data[x + _attr._x * (y + _attr._y * z)] = voxel_cast<VoxelType>(val);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsDouble(int x, int y, int z, int t, double val)
 {
-  _matrix[t][z][y][x] = voxel_cast<VoxelType>(val);
+  _data[VoxelToIndex(x, y, z, t)] = voxel_cast<VoxelType>(val);
 }
 
 // -----------------------------------------------------------------------------
@@ -659,7 +664,7 @@ inline double GenericImage<VoxelType>::GetAsDouble(int index) const
 template <class VoxelType>
 inline double GenericImage<VoxelType>::GetAsDouble(int x, int y, int z, int t) const
 {
-  return voxel_cast<double>(_matrix[t][z][y][x]);
+  return voxel_cast<double>(_data[VoxelToIndex(x, y, z, t)]);
 }
 
 // -----------------------------------------------------------------------------
@@ -673,21 +678,21 @@ inline void GenericImage<VoxelType>::PutAsVector(int index, const Vector &value)
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsVector(int x, int y, const Vector &value)
 {
-  _matrix[0][0][y][x] = voxel_cast<VoxelType>(value);
+  _data[x + _attr._x * y] = voxel_cast<VoxelType>(value);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsVector(int x, int y, int z, const Vector &value)
 {
-  _matrix[0][z][y][x] = voxel_cast<VoxelType>(value);
+  _data[x + _attr._x * (y + _attr._y * z)] = voxel_cast<VoxelType>(value);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void GenericImage<VoxelType>::PutAsVector(int x, int y, int z, int t, const Vector &value)
 {
-  _matrix[t][z][y][x] = voxel_cast<VoxelType>(value);
+  _data[VoxelToIndex(x, y, z, t)] = voxel_cast<VoxelType>(value);
 }
 
 // -----------------------------------------------------------------------------
@@ -701,7 +706,7 @@ inline void GenericImage<VoxelType>::GetAsVector(Vector &value, int index) const
 template <class VoxelType>
 inline void GenericImage<VoxelType>::GetAsVector(Vector &value, int x, int y, int z, int t) const
 {
-  value = voxel_cast<Vector>(_matrix[t][z][y][x]);
+  value = voxel_cast<Vector>(_data[VoxelToIndex(x, y, z, t)]);
 }
 
 // -----------------------------------------------------------------------------
@@ -715,7 +720,7 @@ inline Vector GenericImage<VoxelType>::GetAsVector(int index) const
 template <class VoxelType>
 inline Vector GenericImage<VoxelType>::GetAsVector(int x, int y, int z, int t) const
 {
-  return voxel_cast<Vector>(_matrix[t][z][y][x]);
+  return voxel_cast<Vector>(_data[VoxelToIndex(x, y, z, t)]);
 }
 
 // =============================================================================
@@ -740,14 +745,14 @@ inline const VoxelType *GenericImage<VoxelType>::Data(int i) const
 template <class VoxelType>
 inline VoxelType *GenericImage<VoxelType>::Data(int x, int y, int z, int t)
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline const VoxelType *GenericImage<VoxelType>::Data(int x, int y, int z, int t) const
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
@@ -768,14 +773,14 @@ inline const void *GenericImage<VoxelType>::GetDataPointer(int i) const
 template <class VoxelType>
 inline void *GenericImage<VoxelType>::GetDataPointer(int x, int y, int z, int t)
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline const void *GenericImage<VoxelType>::GetDataPointer(int x, int y, int z, int t) const
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
@@ -835,14 +840,14 @@ inline void GenericImage<VoxelType>::GetMinMaxPad(VoxelType *min, VoxelType *max
 template <class VoxelType>
 inline VoxelType *GenericImage<VoxelType>::GetPointerToVoxels(int x, int y, int z, int t)
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline const VoxelType *GenericImage<VoxelType>::GetPointerToVoxels(int x, int y, int z, int t) const
 {
-  return &_matrix[t][z][y][x];
+  return _data + VoxelToIndex(x, y, z, t);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -21,17 +21,26 @@
 
 #include "mirtk/BaseImage.h" 
 #include "mirtk/VoxelCast.h"
-#include "mirtk/UnorderedMap.h"
+#include "mirtk/Array.h"
+#include "mirtk/Pair.h"
 
 namespace mirtk {
 
 
 /**
- * Hash class for N-D images
+ * Sparse class for N-D images
  *
- * This class implements N-D images based on hashmaps. It provides functions
- * for accessing, reading, writing and manipulating images. This class can
- * be used for images with arbitrary voxel types using templates.
+ * This class implements N-D images whose voxels are stored in blocks of
+ * (at most) 8x8x8 voxels which are allocated only once a voxel within the
+ * block is set to a value other than the default value. The memory used by
+ * sparse images such as segmentations of large domains is thus proportional
+ * to the number of blocks containing foreground voxels, and neighboring voxels
+ * are stored next to each other. It provides functions for accessing, reading,
+ * writing and manipulating images. This class can be used for images with
+ * arbitrary voxel types using templates.
+ *
+ * \note Put may allocate a new block and must therefore not be called
+ *       concurrently by multiple threads.
  */
 
 template <class TVoxel>
@@ -51,26 +60,73 @@ public:
   /// \note The VoxelType as well as the RealType may be a matrix/vector type!
   typedef typename voxel_info<VoxelType>::RealType RealType;
 
-  /// Data map (hashmap)
-  typedef UnorderedMap<int, VoxelType> DataMap;
-
-  /// Data map iterator
-  typedef typename DataMap::const_iterator DataIterator;
-
   /// Scalar type corresponding to voxel type
   typedef typename voxel_info<VoxelType>::ScalarType ScalarType;
 
+  /// Iterator over voxels whose value differs from the default value
+  ///
+  /// Dereferencing the iterator yields a pair of voxel index and value.
+  class DataIterator
+  {
+    const HashImage      *_Image;
+    int                   _Block;
+    int                   _Offset;
+    Pair<int, VoxelType>  _Voxel;
+
+    /// Move to next voxel with non-default value starting at current position
+    void Find();
+
+  public:
+
+    DataIterator(const HashImage *image, int block)
+    :
+      _Image(image), _Block(block), _Offset(0)
+    {
+      Find();
+    }
+
+    const Pair<int, VoxelType> &operator *() const { return  _Voxel; }
+    const Pair<int, VoxelType> *operator->() const { return &_Voxel; }
+
+    DataIterator &operator ++()
+    {
+      ++_Offset;
+      Find();
+      return *this;
+    }
+
+    bool operator ==(const DataIterator &rhs) const
+    {
+      return _Block == rhs._Block && _Offset == rhs._Offset;
+    }
+
+    bool operator !=(const DataIterator &rhs) const
+    {
+      return !(*this == rhs);
+    }
+  };
+
   // ---------------------------------------------------------------------------
   // Data members
 
 protected:
 
-  /// Pointer array for access to image data
+  /// Blocks of image data, NULL if no voxel within block was set
+  Array<VoxelType *> _Block;
+
+  /// Number of bits of voxel index within block along each spatial dimension
+  int _BlockBits[3];
+
+  /// Number of blocks along each dimension
+  int _NumberOfBlocks[4];
+
+  /// Value of voxels which were not set to another value
   ///
-  /// \note The image data is stored in a hash map
-  mirtkAttributeMacro(DataMap, Data);
-  /// \note Voxels that their value==DefaultValue are not stored
-  mirtkPublicAttributeMacro(VoxelType, DefaultValue);
+  /// \note Voxels that their value==DefaultValue are not iterated over
+  VoxelType _DefaultValue;
+
+  /// Number of voxels whose value differs from the default value
+  int _NumberOfNonDefaultVoxels;
 
   // ---------------------------------------------------------------------------
   // Construction/Destruction
@@ -78,6 +134,33 @@ protected:
   /// Allocate image memory
   void AllocateImage();
 
+  /// Free memory of all blocks
+  void FreeBlocks();
+
+  /// Recount voxels whose value differs from the default value
+  ///
+  /// Called after operations which modify the voxels of all blocks at once
+  /// instead of updating the count for each voxel as done by Put.
+  void CountNonDefaultVoxels();
+
+  /// Number of voxels per block
+  int BlockSize() const;
+
+  /// Index of block containing the specified voxel
+  int BlockIndex(int, int, int, int) const;
+
+  /// Offset of the specified voxel within its block
+  int BlockOffset(int, int, int) const;
+
+  /// Get specified block, allocate block if needed
+  VoxelType *AllocateBlock(int);
+
+  /// Index of voxel at given offset within block, -1 if outside image
+  int VoxelIndex(int, int) const;
+
+  /// Whether voxel is inside the image domain
+  bool IsInside(int, int, int, int) const;
+
   /// Function for not const pixel get access
   VoxelType Access(int);
 
@@ -118,6 +201,12 @@ public:
   /// Destructor
   ~HashImage();
 
+  /// Set value of voxels which were not set to another value
+  void DefaultValue(VoxelType);
+
+  /// Get value of voxels which were not set to another value
+  const VoxelType &DefaultValue() const;
+
   // ---------------------------------------------------------------------------
   // Initialization
 
@@ -184,11 +273,18 @@ public:
   // ---------------------------------------------------------------------------
   // Image data access
 
+  /// Iterator to first voxel whose value differs from the default value
   DataIterator Begin() const;
+
+  /// Iterator past last voxel whose value differs from the default value
   DataIterator End() const;
 
+  /// Number of voxels whose value differs from the default value
   int NumberOfNonDefaultVoxels() const;
 
+  /// Number of allocated blocks
+  int NumberOfAllocatedBlocks() const;
+
   /// Function for pixel get access
   VoxelType Get(int) const;
 
@@ -444,10 +540,75 @@ public:
 ////////////////////////////////////////////////////////////////////////////////
 
 // =============================================================================
-// Initialization
+// Construction/Destruction
 // =============================================================================
 
 // -----------------------------------------------------------------------------
+template <class VoxelType>
+inline int HashImage<VoxelType>::BlockSize() const
+{
+  return 1 << (_BlockBits[0] + _BlockBits[1] + _BlockBits[2]);
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline int HashImage<VoxelType>::BlockIndex(int x, int y, int z, int t) const
+{
+  return (x >> _BlockBits[0]) + _NumberOfBlocks[0] * (
+         (y >> _BlockBits[1]) + _NumberOfBlocks[1] * (
+         (z >> _BlockBits[2]) + _NumberOfBlocks[2] * t));
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline int HashImage<VoxelType>::BlockOffset(int x, int y, int z) const
+{
+  return  (x & ((1 << _BlockBits[0]) - 1))
+       | ((y & ((1 << _BlockBits[1]) - 1)) <<  _BlockBits[0])
+       | ((z & ((1 << _BlockBits[2]) - 1)) << (_BlockBits[0] + _BlockBits[1]));
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline VoxelType *HashImage<VoxelType>::AllocateBlock(int b)
+{
+  VoxelType *&block = _Block[b];
+  if (block == NULL) {
+    const int n = BlockSize();
+    block = new VoxelType[n];
+    for (int i = 0; i < n; ++i) block[i] = _DefaultValue;
+  }
+  return block;
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline int HashImage<VoxelType>::VoxelIndex(int b, int o) const
+{
+  const int x = ((b % _NumberOfBlocks[0]) << _BlockBits[0]) + (o & ((1 << _BlockBits[0]) - 1));
+  b /= _NumberOfBlocks[0], o >>= _BlockBits[0];
+  const int y = ((b % _NumberOfBlocks[1]) << _BlockBits[1]) + (o & ((1 << _BlockBits[1]) - 1));
+  b /= _NumberOfBlocks[1], o >>= _BlockBits[1];
+  const int z = ((b % _NumberOfBlocks[2]) << _BlockBits[2]) + o;
+  const int t =  (b / _NumberOfBlocks[2]);
+  if (x >= _attr._x || y >= _attr._y || z >= _attr._z) return -1;
+  return VoxelToIndex(x, y, z, t);
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline bool HashImage<VoxelType>::IsInside(int x, int y, int z, int t) const
+{
+  return 0 <= x && x < _attr._x && 0 <= y && y < _attr._y &&
+         0 <= z && z < _attr._z && 0 <= t && t < _NumberOfBlocks[3];
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+inline const VoxelType &HashImage<VoxelType>::DefaultValue() const
+{
+  return _DefaultValue;
+}
 
 // =============================================================================
 // Lattice
@@ -475,12 +636,10 @@ inline int HashImage<VoxelType>::VoxelToIndex(int x, int y, int z, int t) const
 template <class VoxelType>
 inline void HashImage<VoxelType>::Put(int index, VoxelType val)
 {
-  if(index>=0){
-    if(val==_DefaultValue){
-      _Data.erase(index);
-     }else{
-      _Data[index]=val;
-    }
+  if (0 <= index && index < _NumberOfVoxels) {
+    int x, y, z, t;
+    IndexToVoxel(index, x, y, z, t);
+    Put(x, y, z, t, val);
   }
 }
 
@@ -502,7 +661,20 @@ inline void HashImage<VoxelType>::Put(int x, int y, int z, VoxelType val)
 template <class VoxelType>
 inline void HashImage<VoxelType>::Put(int x, int y, int z, int t, VoxelType val)
 {
-  Put(VoxelToIndex(x, y, z, t) ,val);
+  if (!IsInside(x, y, z, t)) return;
+  const int  b     = BlockIndex(x, y, z, t);
+  VoxelType *block = _Block[b];
+  if (block == NULL) {
+    if (val == _DefaultValue) return;
+    block = AllocateBlock(b);
+  }
+  VoxelType &voxel = block[BlockOffset(x, y, z)];
+  if (voxel == _DefaultValue) {
+    if (val != _DefaultValue) ++_NumberOfNonDefaultVoxels;
+  } else {
+    if (val == _DefaultValue) --_NumberOfNonDefaultVoxels;
+  }
+  voxel = val;
 }
 
 // -----------------------------------------------------------------------------
@@ -514,44 +686,80 @@ inline VoxelType HashImage<VoxelType>::Access(int index)
 }
 
 // -----------------------------------------------------------------------------
+template <class VoxelType>
+void HashImage<VoxelType>::DataIterator::Find()
+{
+  const HashImage &image = *_Image;
+  const int nblocks = static_cast<int>(image._Block.size());
+  const int n       = image.BlockSize();
+  while (_Block < nblocks) {
+    const VoxelType *block = image._Block[_Block];
+    if (block) {
+      for (; _Offset < n; ++_Offset) {
+        if (block[_Offset] != image._DefaultValue) {
+          _Voxel.first = image.VoxelIndex(_Block, _Offset);
+          if (_Voxel.first >= 0) {
+            _Voxel.second = block[_Offset];
+            return;
+          }
+        }
+      }
+    }
+    ++_Block, _Offset = 0;
+  }
+  _Offset = 0;
+}
 
+// -----------------------------------------------------------------------------
 template <class VoxelType>
 inline typename HashImage<VoxelType>::DataIterator HashImage<VoxelType>::Begin() const
 {
-  return _Data.begin();
+  return DataIterator(this, 0);
 }
 
 // -----------------------------------------------------------------------------
-
 template <class VoxelType>
 inline typename HashImage<VoxelType>::DataIterator HashImage<VoxelType>::End() const
 {
-  return _Data.end();
+  return DataIterator(this, static_cast<int>(_Block.size()));
 }
 
 // -----------------------------------------------------------------------------
-
 template <class VoxelType>
-int HashImage<VoxelType>::NumberOfNonDefaultVoxels() const
+inline int HashImage<VoxelType>::NumberOfNonDefaultVoxels() const
 {
-  return _Data.size();
+  return _NumberOfNonDefaultVoxels;
 }
 
 // -----------------------------------------------------------------------------
+template <class VoxelType>
+int HashImage<VoxelType>::NumberOfAllocatedBlocks() const
+{
+  int n = 0;
+  for (size_t b = 0; b < _Block.size(); ++b) {
+    if (_Block[b]) ++n;
+  }
+  return n;
+}
 
+// -----------------------------------------------------------------------------
 template <class VoxelType>
 inline VoxelType HashImage<VoxelType>::Get(int index) const
 {
-  auto pos=_Data.find (index);
-  if ( pos == End() ) return _DefaultValue;
-  return voxel_cast<VoxelType>(pos->second);
+  if (index < 0 || index >= _NumberOfVoxels) return _DefaultValue;
+  int x, y, z, t;
+  IndexToVoxel(index, x, y, z, t);
+  return Get(x, y, z, t);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline VoxelType HashImage<VoxelType>::Get(int x, int y, int z, int t) const
 {
-  return Get(VoxelToIndex(x, y, z, t));
+  if (!IsInside(x, y, z, t)) return _DefaultValue;
+  const VoxelType *block = _Block[BlockIndex(x, y, z, t)];
+  if (block == NULL) return _DefaultValue;
+  return block[BlockOffset(x, y, z)];
 }
 
 // =============================================================================
@@ -569,21 +777,21 @@ inline void HashImage<VoxelType>::PutAsDouble(int index, double val)
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsDouble(int x, int y, double val)
 {
-  Put(VoxelToIndex(x, y, 0, 0), voxel_cast<VoxelType>(val));
+  Put(x, y, 0, 0, voxel_cast<VoxelType>(val));
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsDouble(int x, int y, int z, double val)
 {
-  Put(VoxelToIndex(x, y, z, 0), voxel_cast<VoxelType>(val));
+  Put(x, y, z, 0, voxel_cast<VoxelType>(val));
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsDouble(int x, int y, int z, int t, double val)
 {
-  Put(VoxelToIndex(x, y, z, t), voxel_cast<VoxelType>(val));
+  Put(x, y, z, t, voxel_cast<VoxelType>(val));
 }
 
 // -----------------------------------------------------------------------------
@@ -597,7 +805,7 @@ inline double HashImage<VoxelType>::GetAsDouble(int index) const
 template <class VoxelType>
 inline double HashImage<VoxelType>::GetAsDouble(int x, int y, int z, int t) const
 {
-  return voxel_cast<double>(Get(VoxelToIndex(x, y, z, t)));
+  return voxel_cast<double>(Get(x, y, z, t));
 }
 
 // -----------------------------------------------------------------------------
@@ -611,21 +819,21 @@ inline void HashImage<VoxelType>::PutAsVector(int index, const Vector &value)
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsVector(int x, int y, const Vector &value)
 {
-  Put(VoxelToIndex(x, y, 0, 0), voxel_cast<VoxelType>(value));
+  Put(x, y, 0, 0, voxel_cast<VoxelType>(value));
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsVector(int x, int y, int z, const Vector &value)
 {
-  Put(VoxelToIndex(x, y, z, 0), voxel_cast<VoxelType>(value));
+  Put(x, y, z, 0, voxel_cast<VoxelType>(value));
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 inline void HashImage<VoxelType>::PutAsVector(int x, int y, int z, int t, const Vector &value)
 {
-  Put(VoxelToIndex(x, y, z, t), voxel_cast<VoxelType>(value));
+  Put(x, y, z, t, voxel_cast<VoxelType>(value));
 }
 
 // -----------------------------------------------------------------------------
@@ -639,7 +847,7 @@ inline void HashImage<VoxelType>::GetAsVector(Vector &value, int index) const
 template <class VoxelType>
 inline void HashImage<VoxelType>::GetAsVector(Vector &value, int x, int y, int z, int t) const
 {
-  value = voxel_cast<Vector>(Get(VoxelToIndex(x, y, z, t)));
+  value = voxel_cast<Vector>(Get(x, y, z, t));
 }
 
 // -----------------------------------------------------------------------------
@@ -653,7 +861,7 @@ inline Vector HashImage<VoxelType>::GetAsVector(int index) const
 template <class VoxelType>
 inline Vector HashImage<VoxelType>::GetAsVector(int x, int y, int z, int t) const
 {
-  return voxel_cast<Vector>(Get(VoxelToIndex(x, y, z, t)));
+  return voxel_cast<Vector>(Get(x, y, z, t));
 }
 
 // =============================================================================
@@ -59,18 +59,63 @@ void HashImage<VoxelType>::AllocateImage()
   // Delete existing mask (if any)
   if (_maskOwner) Delete(_mask);
   // Free previously allocated memory
-  _Data.clear();
+  FreeBlocks();
   _DefaultValue = VoxelType();
+  // Divide image domain into blocks of at most 8x8x8 voxels
+  const int size[3] = {_attr._x, _attr._y, _attr._z};
+  int nblocks = max(_attr._t, 1);
+  for (int d = 0; d < 3; ++d) {
+    _BlockBits[d] = 0;
+    while (_BlockBits[d] < 3 && (1 << _BlockBits[d]) < size[d]) ++_BlockBits[d];
+    _NumberOfBlocks[d] = (size[d] + (1 << _BlockBits[d]) - 1) >> _BlockBits[d];
+    nblocks *= _NumberOfBlocks[d];
+  }
+  _NumberOfBlocks[3] = max(_attr._t, 1);
+  _Block.resize(nblocks, NULL);
 }
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
-HashImage<VoxelType>::HashImage(){}
+void HashImage<VoxelType>::FreeBlocks()
+{
+  for (size_t b = 0; b < _Block.size(); ++b) {
+    delete[] _Block[b];
+    _Block[b] = NULL;
+  }
+  _NumberOfNonDefaultVoxels = 0;
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+void HashImage<VoxelType>::CountNonDefaultVoxels()
+{
+  // Note: Voxels of partial blocks outside the image domain always have the
+  //       default value, which is assigned by AllocateBlock and updated
+  //       together with the default value of the image.
+  const int n = BlockSize();
+  _NumberOfNonDefaultVoxels = 0;
+  for (size_t b = 0; b < _Block.size(); ++b) {
+    const VoxelType *block = _Block[b];
+    if (block) {
+      for (int o = 0; o < n; ++o) {
+        if (block[o] != _DefaultValue) ++_NumberOfNonDefaultVoxels;
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+HashImage<VoxelType>::HashImage()
+{
+  AllocateImage();
+}
 
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 HashImage<VoxelType>::HashImage(const char *fname)
 {
+  AllocateImage();
   Read(fname);
 }
 
@@ -177,9 +222,28 @@ HashImage<VoxelType>::~HashImage()
 // -----------------------------------------------------------------------------
 template <class VoxelType> void HashImage<VoxelType>::Clear()
 {
-  _Data.clear();
+  FreeBlocks();
   if (_maskOwner) Delete(_mask);
   _attr = ImageAttributes();
+  AllocateImage();
+}
+
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+void HashImage<VoxelType>::DefaultValue(VoxelType value)
+{
+  // Voxels which were not set to another value read the new default value
+  const int n = BlockSize();
+  for (size_t b = 0; b < _Block.size(); ++b) {
+    VoxelType *block = _Block[b];
+    if (block) {
+      for (int o = 0; o < n; ++o) {
+        if (block[o] == _DefaultValue) block[o] = value;
+      }
+    }
+  }
+  _DefaultValue = value;
+  CountNonDefaultVoxels();
 }
 
 // =============================================================================
@@ -241,8 +305,7 @@ template <class VoxelType>
 void HashImage<VoxelType>::CopyFrom(const BaseImage &image)
 {
   if (this != &image) {
-    VoxelType value;
-    _Data.clear();
+    FreeBlocks();
     _DefaultValue  = VoxelType();
 
     for (int idx = 0; idx < _NumberOfVoxels; ++idx) {
@@ -266,7 +329,7 @@ void HashImage<VoxelType>::CopyFrom(const BaseImage &image)
 template <class VoxelType> template <class VoxelType2>
 void HashImage<VoxelType>::CopyFrom(const GenericImage<VoxelType2> &image)
 {
-  _Data.clear();
+  FreeBlocks();
   _DefaultValue  = VoxelType();
 
   for (int idx = 0; idx < _NumberOfVoxels; ++idx) {
@@ -290,10 +353,9 @@ void HashImage<VoxelType>::CopyFrom(const GenericImage<VoxelType2> &image)
 template <class VoxelType> template <class VoxelType2>
 void HashImage<VoxelType>::CopyFrom(const HashImage<VoxelType2> &image)
 {
-  _Data.clear();
+  FreeBlocks();
   _DefaultValue = voxel_cast<VoxelType>(image.DefaultValue());
 
-  VoxelType value;
   for ( auto it = image.Begin(); it != image.End(); ++it ){
     Put(it->first, voxel_cast<VoxelType>(it->second));
   }
@@ -327,7 +389,7 @@ void HashImage<VoxelType>::CopyTo(GenericImage<VoxelType2> &image) const
 template <class VoxelType>
 HashImage<VoxelType>& HashImage<VoxelType>::operator=(VoxelType scalar)
 {
-  _Data.clear();
+  FreeBlocks();
   _DefaultValue=scalar;
   return *this;
 }
@@ -368,6 +430,7 @@ HashImage<VoxelType>& HashImage<VoxelType>::operator=(const HashImage<VoxelType2
 {
   this->Initialize(image.GetImageAttributes());
   CopyFrom(image);
+  return *this;
 }
 
 // -----------------------------------------------------------------------------
@@ -376,7 +439,7 @@ bool HashImage<VoxelType>::operator==(const HashImage<VoxelType2> &image) const
 {
   if (this->GetImageAttributes() != image.GetImageAttributes()) return false;
   if (_DefaultValue != image.DefaultValue()) return false;
-  if (_Data.size() != image.NumberOfNonDefaultVoxels()) return false;
+  if (NumberOfNonDefaultVoxels() != image.NumberOfNonDefaultVoxels()) return false;
 
   int idx;
   for (int idx = 0; idx < _NumberOfVoxels; ++idx) {
@@ -772,12 +835,22 @@ template <> inline HashImage<double3x3> &HashImage<double3x3>::operator/=(const
 template <class VoxelType>
 HashImage<VoxelType>& HashImage<VoxelType>::operator+=(ScalarType scalar)
 {
+  const VoxelType default_value = _DefaultValue;
+  const int       n             = BlockSize();
   _DefaultValue += scalar;
-  for ( auto it = Begin(); it != End(); ++it ){
-    if (IsForeground(it->first)){
-      _Data[it->first] +=scalar;
+  for (int b = 0; b < static_cast<int>(_Block.size()); ++b) {
+    VoxelType *block = _Block[b];
+    if (block) {
+      for (int o = 0; o < n; ++o) {
+        if (block[o] == default_value) {
+          block[o] = _DefaultValue;
+        } else if (IsForeground(VoxelIndex(b, o))) {
+          block[o] += scalar;
+        }
+      }
     }
   }
+  CountNonDefaultVoxels();
   return *this;
 }
 
@@ -785,12 +858,22 @@ HashImage<VoxelType>& HashImage<VoxelType>::operator+=(ScalarType scalar)
 template <class VoxelType>
 HashImage<VoxelType>& HashImage<VoxelType>::operator-=(ScalarType scalar)
 {
+  const VoxelType default_value = _DefaultValue;
+  const int       n             = BlockSize();
   _DefaultValue -= scalar;
-  for ( auto it = Begin(); it != End(); ++it ){
-    if (IsForeground(it->first)){
-      _Data[it->first] -=scalar;
+  for (int b = 0; b < static_cast<int>(_Block.size()); ++b) {
+    VoxelType *block = _Block[b];
+    if (block) {
+      for (int o = 0; o < n; ++o) {
+        if (block[o] == default_value) {
+          block[o] = _DefaultValue;
+        } else if (IsForeground(VoxelIndex(b, o))) {
+          block[o] -= scalar;
+        }
+      }
     }
   }
+  CountNonDefaultVoxels();
   return *this;
 }
 
@@ -798,16 +881,26 @@ HashImage<VoxelType>& HashImage<VoxelType>::operator-=(ScalarType scalar)
 template <class VoxelType>
 HashImage<VoxelType>& HashImage<VoxelType>::operator*=(ScalarType scalar)
 {
+  const VoxelType default_value = _DefaultValue;
+  const int       n             = BlockSize();
   _DefaultValue *= scalar;
   if(scalar==0){
-    _Data.clear();
+    FreeBlocks();
   }else{
-    for ( auto it = Begin(); it != End(); ++it ){
-      if (IsForeground(it->first)){
-        _Data[it->first] *=scalar;
+    for (int b = 0; b < static_cast<int>(_Block.size()); ++b) {
+      VoxelType *block = _Block[b];
+      if (block) {
+        for (int o = 0; o < n; ++o) {
+          if (block[o] == default_value) {
+            block[o] = _DefaultValue;
+          } else if (IsForeground(VoxelIndex(b, o))) {
+            block[o] *= scalar;
+          }
+        }
       }
     }
   }
+  CountNonDefaultVoxels();
   return *this;
 }
 
@@ -816,15 +909,25 @@ template <class VoxelType>
 HashImage<VoxelType>& HashImage<VoxelType>::operator/=(ScalarType scalar)
 {
   if (scalar) {
+    const VoxelType default_value = _DefaultValue;
+    const int       n             = BlockSize();
     _DefaultValue /= scalar;
-    for ( auto it = Begin(); it != End(); ++it ){
-      if (IsForeground(it->first)){
-        _Data[it->first] /=scalar;
+    for (int b = 0; b < static_cast<int>(_Block.size()); ++b) {
+      VoxelType *block = _Block[b];
+      if (block) {
+        for (int o = 0; o < n; ++o) {
+          if (block[o] == default_value) {
+            block[o] = _DefaultValue;
+          } else if (IsForeground(VoxelIndex(b, o))) {
+            block[o] /= scalar;
+          }
+        }
       }
     }
   } else {
     cerr << "HashImage::operator/=: Division by zero" << endl;
   }
+  CountNonDefaultVoxels();
   return *this;
 }
 
@@ -913,26 +1016,19 @@ void HashImage<VoxelType>::PutBackgroundValueAsDouble(double value, bool thresho
   if (threshold) {
     const VoxelType bg = voxel_cast<VoxelType>(this->_bg);
 
-    bool changedValue=false;
-    if( _DefaultValue < bg){
-      changedValue=true;
-      _DefaultValue=bg;
-    }
+    // Voxels which were not set to another value read the new default value
+    if (_DefaultValue < bg) _DefaultValue = bg;
 
-    bool modify=false;
-    for ( auto it = Begin(); it != End();){
-      modify=(it->second < bg);
-      if(modify && changedValue){
-        // this erase also increases the iterator to the next element...
-        it = _Data.erase( it );
-      }else {
-        if(modify){
-          _Data[it->first]=bg;
+    const int n = BlockSize();
+    for (size_t b = 0; b < _Block.size(); ++b) {
+      VoxelType *block = _Block[b];
+      if (block) {
+        for (int o = 0; o < n; ++o) {
+          if (block[o] < bg) block[o] = bg;
         }
-        it++;
       }
     }
-
+    CountNonDefaultVoxels();
   }
 }
 
@@ -1013,12 +1109,22 @@ void HashImage<VoxelType>::PutMinMax(VoxelType min, VoxelType max)
   RealType slope = voxel_cast<RealType>(max  - min)  / voxel_cast<RealType>(max_val - min_val);
   RealType inter = voxel_cast<RealType>(min) - slope * voxel_cast<RealType>(min_val);
 
+  const VoxelType default_value = _DefaultValue;
+  const int       n             = BlockSize();
   _DefaultValue = inter + slope * _DefaultValue;
-  for ( auto it = Begin(); it != End(); ++it ){
-    if (IsForeground(it->first)) {
-      _Data[it->first]=static_cast<VoxelType>(inter + slope *it->second);
+  for (int b = 0; b < static_cast<int>(_Block.size()); ++b) {
+    VoxelType *block = _Block[b];
+    if (block) {
+      for (int o = 0; o < n; ++o) {
+        if (block[o] == default_value) {
+          block[o] = _DefaultValue;
+        } else if (IsForeground(VoxelIndex(b, o))) {
+          block[o] = static_cast<VoxelType>(inter + slope * block[o]);
+        }
+      }
     }
   }
+  CountNonDefaultVoxels();
 }
 
 template <> inline void HashImage<float3x3 >::PutMinMax(VoxelType, VoxelType)
@@ -23,6 +23,9 @@
 
 #include "mirtk/ImageToImage.h"
 
+#include "mirtk/Array.h"
+#include "mirtk/Matrix.h"
+
 
 namespace mirtk {
 
@@ -38,6 +41,13 @@ class InterpolateImageFunction;
  * voxel dimensions.  The new image intensity of the voxels is calculated by
  * interpolation of the old image intensities. Possible interpolation schemes
  * are nearest neighbor, linear, cubic spline and B-spline interpolation.
+ *
+ * Because both images are defined on regular lattices, the input voxel
+ * coordinates of the output voxels are an affine function of the output
+ * voxel indices. When the image axes are aligned, this map is separable and
+ * the input coordinates are looked up in per-axis tables. Otherwise, they are
+ * obtained from the affine map of output to input voxel coordinates without
+ * a conversion to world coordinates for each voxel.
  */
 template <class TVoxel>
 class Resampling : public ImageToImage<TVoxel>
@@ -68,6 +78,17 @@ class Resampling : public ImageToImage<TVoxel>
   /// Image function used to interpolate/extrapolate input
   mirtkPublicAggregateMacro(InterpolateImageFunction, Interpolator);
 
+protected:
+
+  /// Whether the map from output to input voxel coordinates is separable
+  bool _Separable;
+
+  /// Input voxel coordinates of output columns, rows, and slices if separable
+  Array<double> _MapX, _MapY, _MapZ;
+
+  /// Affine map from output to input voxel coordinates
+  Matrix _OutputToInput;
+
   // ---------------------------------------------------------------------------
   // Construction/Destruction
 
@@ -96,6 +117,9 @@ protected:
   /// Initialize filter output
   virtual void InitializeOutput();
 
+  /// Initialize map from output to input voxel coordinates
+  void InitializeMap();
+
 };
 
 
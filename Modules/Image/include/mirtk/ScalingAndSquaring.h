@@ -37,6 +37,12 @@ namespace mirtk {
  * The result is a diffeomorphic displacement field. Additionally, this filter
  * computes also the derivatives of the exponential map either with respect to
  * the spatial coordinate or the stationary velocity field itself.
+ *
+ * Each squaring step reads the displacements at the positions mapped to by
+ * the displacements of the previous step, which may belong to any voxel
+ * processed by another thread. The squaring can therefore not be done in
+ * place. Instead, the steps alternate between two buffers of each field.
+ * Using TReal=float halves the memory needed for these buffers.
  */
 template <class TReal>
 class ScalingAndSquaring : public Object
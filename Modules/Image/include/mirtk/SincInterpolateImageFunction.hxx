@@ -117,26 +117,32 @@ GenericSincInterpolateImageFunction<TImage>
 
   // Truncated Sinc using Hanning window, H(dx/R)*Sinc(dx), R=6 where
   // Sinc(dx) = sin(pi*dx)/(pi*dx), H(dx/R) = 0.5*(1+cos(pi*dx/R))
-  const int i1 = i - Kernel::Radius;
-  const int j1 = j - Kernel::Radius;
-  const int i2 = i + Kernel::Radius;
-  const int j2 = j + Kernel::Radius;
+  const int i0 = i - Kernel::Radius;
+  const int j0 = j - Kernel::Radius;
 
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wy, w;
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+
+  // Restrict kernel support to image domain
+  const int i1 = max(i0, 0);
+  const int j1 = max(j0, 0);
+  const int i2 = min(i + Kernel::Radius, this->Input()->X() - 1);
+  const int j2 = min(j + Kernel::Radius, this->Input()->Y() - 1);
+
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0);
 
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i0];
   for (j = j1; j <= j2; ++j) {
-    if (0 <= j && j < this->Input()->Y()) {
-      wy = Kernel::Lookup(Real(y - j));
-      for (i = i1; i <= i2; ++i) {
-        if (0 <= i && i < this->Input()->X()) {
-          w    = Kernel::Lookup(Real(x - i)) * wy;
-          val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
-          nrm += w;
-        }
-      }
+    row = voxel_cast<RealType>(0);
+    for (i = i1; i <= i2; ++i) {
+      row += wx[i - i0] * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
     }
+    val += wy[j - j0] * row;
+    nrm += wy[j - j0];
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -177,13 +183,15 @@ GenericSincInterpolateImageFunction<TImage>
   const int i2 = i + Kernel::Radius;
   const int j2 = j + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wy, w;
+  Real     fgw(0), bgw(0), w;
 
   for (j = j1; j <= j2; ++j) {
-    wy = Kernel::Lookup(Real(y - j));
     for (i = i1; i <= i2; ++i) {
-      w = Kernel::Lookup(Real(x - i)) * wy;
+      w = wx[i - i1] * wy[j - j1];
       if (this->Input()->IsInsideForeground(i, j, k, l)) {
         val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
         fgw += w;
@@ -226,17 +234,23 @@ GenericSincInterpolateImageFunction<TImage>
   const int i2 = i + Kernel::Radius;
   const int j2 = j + Kernel::Radius;
 
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wy, w;
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
 
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0);
+
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i1];
   for (j = j1; j <= j2; ++j) {
-    wy = Kernel::Lookup(Real(y - j));
+    row = voxel_cast<RealType>(0);
     for (i = i1; i <= i2; ++i) {
-      w    = Kernel::Lookup(Real(x - i)) * wy;
-      val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
-      nrm += w;
+      row += wx[i - i1] * voxel_cast<RealType>(input->Get(i, j, k, l));
     }
+    val += wy[j - j1] * row;
+    nrm += wy[j - j1];
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -275,13 +289,15 @@ GenericSincInterpolateImageFunction<TImage>
   const int i2 = i + Kernel::Radius;
   const int j2 = j + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wy, w;
+  Real     fgw(0), bgw(0), w;
 
   for (j = j1; j <= j2; ++j) {
-    wy = Kernel::Lookup(Real(y - j));
     for (i = i1; i <= i2; ++i) {
-      w = Kernel::Lookup(Real(x - i)) * wy;
+      w = wx[i - i1] * wy[j - j1];
       if (input->IsForeground(i, j, k, l)) {
         val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
         fgw += w;
@@ -327,33 +343,39 @@ GenericSincInterpolateImageFunction<TImage>
 
   // Truncated Sinc using Hanning window, H(dx/R)*Sinc(dx), R=6 where
   // Sinc(dx) = sin(pi*dx)/(pi*dx), H(dx/R) = 0.5*(1+cos(pi*dx/R))
-  const int i1 = i - Kernel::Radius;
-  const int j1 = j - Kernel::Radius;
-  const int k1 = k - Kernel::Radius;
-  const int i2 = i + Kernel::Radius;
-  const int j2 = j + Kernel::Radius;
-  const int k2 = k + Kernel::Radius;
-
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wz, wyz, w;
-
+  const int i0 = i - Kernel::Radius;
+  const int j0 = j - Kernel::Radius;
+  const int k0 = k - Kernel::Radius;
+
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+
+  // Restrict kernel support to image domain
+  const int i1 = max(i0, 0);
+  const int j1 = max(j0, 0);
+  const int k1 = max(k0, 0);
+  const int i2 = min(i + Kernel::Radius, this->Input()->X() - 1);
+  const int j2 = min(j + Kernel::Radius, this->Input()->Y() - 1);
+  const int k2 = min(k + Kernel::Radius, this->Input()->Z() - 1);
+
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0), wyz;
+
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i0];
   for (k = k1; k <= k2; ++k) {
-    if (0 <= k && k < this->Input()->Z()) {
-      wz = Kernel::Lookup(Real(z - k));
-      for (j = j1; j <= j2; ++j) {
-        if (0 <= j && j < this->Input()->Y()) {
-          wyz = Kernel::Lookup(Real(y - j)) * wz;
-          for (i = i1; i <= i2; ++i) {
-            if (0 <= i && i < this->Input()->X()) {
-              w    = Kernel::Lookup(Real(x - i)) * wyz;
-              val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
-              nrm += w;
-            }
-          }
-        }
+    for (j = j1; j <= j2; ++j) {
+      wyz = wy[j - j0] * wz[k - k0];
+      row = voxel_cast<RealType>(0);
+      for (i = i1; i <= i2; ++i) {
+        row += wx[i - i0] * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
       }
+      val += wyz * row;
+      nrm += wyz;
     }
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -396,15 +418,18 @@ GenericSincInterpolateImageFunction<TImage>
   const int j2 = j + Kernel::Radius;
   const int k2 = k + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wz, wyz, w;
+  Real     fgw(0), bgw(0), wyz, w;
 
   for (k = k1; k <= k2; ++k) {
-    wz = Kernel::Lookup(Real(z - k));
     for (j = j1; j <= j2; ++j) {
-      wyz = Kernel::Lookup(Real(y - j)) * wz;
+      wyz = wy[j - j1] * wz[k - k1];
       for (i = i1; i <= i2; ++i) {
-        w  = Kernel::Lookup(Real(x - i)) * wyz;
+        w  = wx[i - i1] * wyz;
         if (this->Input()->IsInsideForeground(i, j, k, l)) {
           val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
           fgw += w;
@@ -451,20 +476,27 @@ GenericSincInterpolateImageFunction<TImage>
   const int j2 = j + Kernel::Radius;
   const int k2 = k + Kernel::Radius;
 
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wz, wyz, w;
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
 
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0), wyz;
+
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i1];
   for (k = k1; k <= k2; ++k) {
-    wz = Kernel::Lookup(Real(z - k));
     for (j = j1; j <= j2; ++j) {
-      wyz = Kernel::Lookup(Real(y - j)) * wz;
+      wyz = wy[j - j1] * wz[k - k1];
+      row = voxel_cast<RealType>(0);
       for (i = i1; i <= i2; ++i) {
-        w    = Kernel::Lookup(Real(x - i)) * wyz;
-        val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
-        nrm += w;
+        row += wx[i - i1] * voxel_cast<RealType>(input->Get(i, j, k, l));
       }
+      val += wyz * row;
+      nrm += wyz;
     }
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -506,15 +538,18 @@ GenericSincInterpolateImageFunction<TImage>
   const int j2 = j + Kernel::Radius;
   const int k2 = k + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wz, wyz, w;
+  Real     fgw(0), bgw(0), wyz, w;
 
   for (k = k1; k <= k2; ++k) {
-    wz = Kernel::Lookup(Real(z - k));
     for (j = j1; j <= j2; ++j) {
-      wyz = Kernel::Lookup(Real(y - j)) * wz;
+      wyz = wy[j - j1] * wz[k - k1];
       for (i = i1; i <= i2; ++i) {
-        w = Kernel::Lookup(Real(x - i)) * wyz;
+        w = wx[i - i1] * wyz;
         if (input->IsForeground(i, j, k, l)) {
           val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
           fgw += w;
@@ -556,40 +591,46 @@ GenericSincInterpolateImageFunction<TImage>
 
   // Truncated Sinc using Hanning window, H(dx/R)*Sinc(dx), R=6 where
   // Sinc(dx) = sin(pi*dx)/(pi*dx), H(dx/R) = 0.5*(1+cos(pi*dx/R))
-  const int i1 = i - Kernel::Radius;
-  const int j1 = j - Kernel::Radius;
-  const int k1 = k - Kernel::Radius;
-  const int l1 = l - Kernel::Radius;
-  const int i2 = i + Kernel::Radius;
-  const int j2 = j + Kernel::Radius;
-  const int k2 = k + Kernel::Radius;
-  const int l2 = l + Kernel::Radius;
-
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wt, wzt, wyzt, w;
-
+  const int i0 = i - Kernel::Radius;
+  const int j0 = j - Kernel::Radius;
+  const int k0 = k - Kernel::Radius;
+  const int l0 = l - Kernel::Radius;
+
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+  Real wt[Kernel::KernelSize]; Kernel::Weights(Real(t - l), wt);
+
+  // Restrict kernel support to image domain
+  const int i1 = max(i0, 0);
+  const int j1 = max(j0, 0);
+  const int k1 = max(k0, 0);
+  const int l1 = max(l0, 0);
+  const int i2 = min(i + Kernel::Radius, this->Input()->X() - 1);
+  const int j2 = min(j + Kernel::Radius, this->Input()->Y() - 1);
+  const int k2 = min(k + Kernel::Radius, this->Input()->Z() - 1);
+  const int l2 = min(l + Kernel::Radius, this->Input()->T() - 1);
+
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0), wzt, wyzt;
+
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i0];
   for (l = l1; l <= l2; ++l) {
-    if (0 <= l && l < this->Input()->T()) {
-      wt = Kernel::Lookup(Real(t - l));
-      for (k = k1; k <= k2; ++k) {
-        if (0 <= k && k < this->Input()->Z()) {
-          wzt = Kernel::Lookup(Real(z - k)) * wt;
-          for (j = j1; j <= j2; ++j) {
-            if (0 <= j && j < this->Input()->Y()) {
-              wyzt = Kernel::Lookup(Real(y - j)) * wzt;
-              for (i = i1; i <= i2; ++i) {
-                if (0 <= i && i < this->Input()->X()) {
-                  w    = Kernel::Lookup(Real(x - i)) * wyzt;
-                  val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
-                  nrm += w;
-                }
-              }
-            }
-          }
+    for (k = k1; k <= k2; ++k) {
+      wzt = wz[k - k0] * wt[l - l0];
+      for (j = j1; j <= j2; ++j) {
+        wyzt = wy[j - j0] * wzt;
+        row  = voxel_cast<RealType>(0);
+        for (i = i1; i <= i2; ++i) {
+          row += wx[i - i0] * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
         }
+        val += wyzt * row;
+        nrm += wyzt;
       }
     }
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -631,17 +672,21 @@ GenericSincInterpolateImageFunction<TImage>
   const int k2 = k + Kernel::Radius;
   const int l2 = l + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+  Real wt[Kernel::KernelSize]; Kernel::Weights(Real(t - l), wt);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wt, wzt, wyzt, w;
+  Real     fgw(0), bgw(0), wzt, wyzt, w;
 
   for (l = l1; l <= l2; ++l) {
-    wt = Kernel::Lookup(Real(t - l));
     for (k = k1; k <= k2; ++k) {
-      wzt = Kernel::Lookup(Real(z - k)) * wt;
+      wzt = wz[k - k1] * wt[l - l1];
       for (j = j1; j <= j2; ++j) {
-        wyzt = Kernel::Lookup(Real(y - j)) * wzt;
+        wyzt = wy[j - j1] * wzt;
         for (i = i1; i <= i2; ++i) {
-          w = Kernel::Lookup(Real(x - i)) * wyzt;
+          w = wx[i - i1] * wyzt;
           if (this->Input()->IsInsideForeground(i, j, k, l)) {
             val += w * voxel_cast<RealType>(this->Input()->Get(i, j, k, l));
             fgw += w;
@@ -692,23 +737,31 @@ GenericSincInterpolateImageFunction<TImage>
   const int k2 = k + Kernel::Radius;
   const int l2 = l + Kernel::Radius;
 
-  RealType val = voxel_cast<RealType>(0);
-  Real     nrm(0), wt, wzt, wyzt, w;
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+  Real wt[Kernel::KernelSize]; Kernel::Weights(Real(t - l), wt);
 
+  // Sum weighted values along x first as kernel is separable
+  RealType val = voxel_cast<RealType>(0), row;
+  Real     nrm(0), nrmx(0), wzt, wyzt;
+
+  for (i = i1; i <= i2; ++i) nrmx += wx[i - i1];
   for (l = l1; l <= l2; ++l) {
-    wt = Kernel::Lookup(Real(t - l));
     for (k = k1; k <= k2; ++k) {
-      wzt = Kernel::Lookup(Real(z - k)) * wt;
+      wzt = wz[k - k1] * wt[l - l1];
       for (j = j1; j <= j2; ++j) {
-        wyzt = Kernel::Lookup(Real(y - j)) * wzt;
+        wyzt = wy[j - j1] * wzt;
+        row  = voxel_cast<RealType>(0);
         for (i = i1; i <= i2; ++i) {
-          w    = Kernel::Lookup(Real(x - i)) * wyzt;
-          val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
-          nrm += w;
+          row += wx[i - i1] * voxel_cast<RealType>(input->Get(i, j, k, l));
         }
+        val += wyzt * row;
+        nrm += wyzt;
       }
     }
   }
+  nrm *= nrmx;
 
   if (nrm) val /= nrm;
   else     val  = voxel_cast<RealType>(this->DefaultValue());
@@ -753,17 +806,21 @@ GenericSincInterpolateImageFunction<TImage>
   const int k2 = k + Kernel::Radius;
   const int l2 = l + Kernel::Radius;
 
+  Real wx[Kernel::KernelSize]; Kernel::Weights(Real(x - i), wx);
+  Real wy[Kernel::KernelSize]; Kernel::Weights(Real(y - j), wy);
+  Real wz[Kernel::KernelSize]; Kernel::Weights(Real(z - k), wz);
+  Real wt[Kernel::KernelSize]; Kernel::Weights(Real(t - l), wt);
+
   RealType val = voxel_cast<RealType>(0);
-  Real     fgw(0), bgw(0), wt, wzt, wyzt, w;
+  Real     fgw(0), bgw(0), wzt, wyzt, w;
 
   for (l = l1; l <= l2; ++l) {
-    wt = Kernel::Lookup(Real(t - l));
     for (k = k1; k <= k2; ++k) {
-      wzt = Kernel::Lookup(Real(z - k)) * wt;
+      wzt = wz[k - k1] * wt[l - l1];
       for (j = j1; j <= j2; ++j) {
-        wyzt = Kernel::Lookup(Real(y - j)) * wzt;
+        wyzt = wy[j - j1] * wzt;
         for (i = i1; i <= i2; ++i) {
-          w = Kernel::Lookup(Real(x - i)) * wyzt;
+          w = wx[i - i1] * wyzt;
           if (input->IsForeground(i, j, k, l)) {
             val += w * voxel_cast<RealType>(input->Get(i, j, k, l));
             fgw += w;
@@ -20,6 +20,7 @@
 
 #include "mirtk/Math.h"
 #include "mirtk/Stream.h"
+#include "mirtk/Parallel.h"
 
 #define EDT_MAX_IMAGE_DIMENSION 26754
 #define EDT_MAX_DISTANCE_SQUARED 2147329548
@@ -330,44 +331,16 @@ int EuclideanDistanceTransform<VoxelType>::edtVornoiEDT(long *f, long n)
 // -----------------------------------------------------------------------------
 // This is Procedure edtVornoiEDT() in tPAMI paper.
 template <class VoxelType>
-int EuclideanDistanceTransform<VoxelType>::edtVornoiEDT_anisotropic(VoxelType *f, long n, double w)
+int EuclideanDistanceTransform<VoxelType>
+::edtVornoiEDT_anisotropic(VoxelType *f, long n, double w, float *g, float *h)
 {
   const VoxelType max_dist2 = VoxelType(EDT_MAX_DISTANCE_SQUARED_ANISOTROPIC);
 
   long i, l, n_S;
   float a, b, c, v, lhs, rhs;
-  static int firstCall = 1;
-  static long size_gh = 0;
-  static float *g, *h;
 
-  /* this procedure is called often */
-  /* we keep static arrays to avoid frequent calls to malloc() */
-  /* the downside is that this memory is never freed, */
-  /* but it is not so much memory: max(nX,nY,nZ)*sizeof(long) */
-  /* need to check if arrays are sufficiently large */
-  if (n > size_gh && !firstCall) {
-    free(g);
-    free(h);
-    firstCall = 1;
-  }
-  /* malloc arrays if this is first call to procedure, or if arrays */
-  /* are too small and need to be reallocated */
-  if (firstCall) {
-    g = (float *)malloc(n * sizeof(float));
-    if (g == NULL) {
-      fprintf(stderr, "Error in edtVornoiEDT()\n");
-      fprintf(stderr, "Cannot malloc g\n");
-      exit(EXIT_FAILURE);
-    }
-    h = (float *)malloc(n * sizeof(float));
-    if (h == NULL) {
-      fprintf(stderr, "Error in edtVornoiEDT()\n");
-      fprintf(stderr, "Cannot malloc h\n");
-      exit(EXIT_FAILURE);
-    }
-    size_gh = n;
-    firstCall = 0;
-  }
+  /* arrays g and h of size n are allocated by the caller such that */
+  /* the 1D problems of different rows/columns can be solved concurrently */
 
   /* construct partial Vornoi diagram */
   /* this loop is lines 1-14 in Procedure edtVornoiEDT() in tPAMI paper */
@@ -452,6 +425,7 @@ void EuclideanDistanceTransform<VoxelType>
 
   const VoxelType *c;
   VoxelType d, *p, *q, *f;
+  float *g, *h;
 
   /* nXY is number of voxels in 2D image */
   const long nXY = nX * nY;
@@ -510,9 +484,11 @@ void EuclideanDistanceTransform<VoxelType>
   /* compute D_2 = squared EDT */
   /* solve 1D problem for each column (y direction) */
   f = (VoxelType *)malloc(nY * sizeof(VoxelType));
-  if (f == NULL) {
+  g = (float *)malloc(nY * sizeof(float));
+  h = (float *)malloc(nY * sizeof(float));
+  if (f == NULL || g == NULL || h == NULL) {
     fprintf(stderr, "Error in edtComputeEDT_2D()\n");
-    fprintf(stderr, "Cannot malloc f\n");
+    fprintf(stderr, "Cannot malloc f, g, or h\n");
     exit(EXIT_FAILURE);
   }
   for (long i = 0; i < nX; i++) {
@@ -524,7 +500,7 @@ void EuclideanDistanceTransform<VoxelType>
       *q = *p;
     }
     /* call edtVornoiEDT */
-    if (edtVornoiEDT_anisotropic(f, nY, wY)) {
+    if (edtVornoiEDT_anisotropic(f, nY, wY, g, h)) {
       p = edt + i;
       q = f;
       for (long j = 0; j < nY; j++, p += nX, q++) {
@@ -533,19 +509,88 @@ void EuclideanDistanceTransform<VoxelType>
     }
   }
   free(f);
+  free(g);
+  free(h);
 } /* edtComputeEDT_2D_anisotropic */
 
+// -----------------------------------------------------------------------------
+// Computes the 2D EDT of each plane (xy) of a 3D image
+template <class VoxelType>
+struct EuclideanDistanceTransform<VoxelType>::ComputeEDT_2D
+{
+  EuclideanDistanceTransform *_Filter;
+  VoxelType                  *_EDT;
+  long                        _nX, _nY;
+  double                      _wX, _wY;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    const long nXY = _nX * _nY;
+    for (int k = re.begin(); k != re.end(); ++k) {
+      _Filter->edtComputeEDT_2D_anisotropic(NULL, _EDT + k * nXY, _nX, _nY, _wX, _wY);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Solves the 1D problem for each column (z direction) of a 3D image
+template <class VoxelType>
+struct EuclideanDistanceTransform<VoxelType>::ComputeEDT_1D
+{
+  EuclideanDistanceTransform *_Filter;
+  VoxelType                  *_EDT;
+  long                        _nXY, _nZ;
+  double                      _wZ;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    VoxelType *p, *q, *f;
+    float *g, *h;
+    long k;
+
+    f = (VoxelType *)malloc(_nZ * sizeof(VoxelType));
+    g = (float *)malloc(_nZ * sizeof(float));
+    h = (float *)malloc(_nZ * sizeof(float));
+    if (f == NULL || g == NULL || h == NULL) {
+      fprintf(stderr, "Error in edtComputeEDT_3D()\n");
+      fprintf(stderr, "Cannot malloc f, g, or h\n");
+      exit(EXIT_FAILURE);
+    }
+    for (long i = re.begin(); i != re.end(); i++) {
+      /* fill array f with D_2 distances in column */
+      /* this is essentially line 4 in Procedure VoronoiEDT() in tPAMI paper */
+      p = _EDT + i;
+      q = f;
+      for (k = 0; k < _nZ; k++, p += _nXY, q++) {
+        *q = *p;
+      }
+      /* call edtVornoiEDT */
+      if (_Filter->edtVornoiEDT_anisotropic(f, _nZ, _wZ, g, h)) {
+        p = _EDT + i;
+        q = f;
+        for (k = 0; k < _nZ; k++, p += _nXY, q++) {
+          *p = *q;
+        }
+      }
+    }
+    free(f);
+    free(g);
+    free(h);
+  }
+};
+
 // -----------------------------------------------------------------------------
 // This procedure computes the squared EDT of a 3D binary image with anisotropic
-// voxels. See notes for edtComputeEDT_2D_anisotropic.
+// voxels. See notes for edtComputeEDT_2D_anisotropic. The planes and columns
+// are processed in parallel.
 template <class VoxelType>
 void EuclideanDistanceTransform<VoxelType>
 ::edtComputeEDT_3D_anisotropic(const VoxelType *img, VoxelType *edt,
                                long nX, long nY, long nZ, double wX, double wY, double wZ)
 {
   const VoxelType *c;
-  long i, k, nXY, nXYZ;
-  VoxelType *p, *q, *f;
+  long i, nXY, nXYZ;
+  VoxelType *p;
 
   /* nXY is number of voxels in each plane (xy) */
   /* nXYZ is number of voxels in 3D image */
@@ -564,37 +609,24 @@ void EuclideanDistanceTransform<VoxelType>
 
   /* compute D_2 */
   /* call edtComputeEDT_2D for each plane */
-  p = edt;
-  for (k = 0; k < nZ; k++, p += nXY) {
-    edtComputeEDT_2D_anisotropic(NULL, p, nX, nY, wX, wY);
-  }
+  ComputeEDT_2D planes;
+  planes._Filter = this;
+  planes._EDT    = edt;
+  planes._nX     = nX;
+  planes._nY     = nY;
+  planes._wX     = wX;
+  planes._wY     = wY;
+  parallel_for(blocked_range<int>(0, static_cast<int>(nZ)), planes);
 
   /* compute D_3 */
   /* solve 1D problem for each column (z direction) */
-  f = (VoxelType *)malloc(nZ * sizeof(VoxelType));
-  if (f == NULL) {
-    fprintf(stderr, "Error in edtComputeEDT_3D()\n");
-    fprintf(stderr, "Cannot malloc f\n");
-    exit(EXIT_FAILURE);
-  }
-  for (i = 0; i < nXY; i++) {
-    /* fill array f with D_2 distances in column */
-    /* this is essentially line 4 in Procedure VoronoiEDT() in tPAMI paper */
-    p = edt + i;
-    q = f;
-    for (k = 0; k < nZ; k++, p += nXY, q++) {
-      *q = *p;
-    }
-    /* call edtVornoiEDT */
-    if (edtVornoiEDT_anisotropic(f, nZ, wZ)) {
-      p = edt + i;
-      q = f;
-      for (k = 0; k < nZ; k++, p += nXY, q++) {
-        *p = *q;
-      }
-    }
-  }
-  free(f);
+  ComputeEDT_1D columns;
+  columns._Filter = this;
+  columns._EDT    = edt;
+  columns._nXY    = nXY;
+  columns._nZ     = nZ;
+  columns._wZ     = wZ;
+  parallel_for(blocked_range<int>(0, static_cast<int>(nXY)), columns);
 } /* edtComputeEDT_3D_anisotropic */
 
 // -----------------------------------------------------------------------------
@@ -626,12 +658,17 @@ void EuclideanDistanceTransform<VoxelType>::Run()
 			  output->Data(0, 0, 0, t),
 			  nx, ny, nz, dx, dy, dz);
 	  } else {
-		  for (int z = 0; z < nz; ++z) {
-			  edtComputeEDT_2D_anisotropic(
-          input ->Data(0, 0, z, t),
-				  output->Data(0, 0, z, t),
-				  nx, ny, dx, dy);
-		  }
+      if (input != output) {
+        memcpy(output->Data(0, 0, 0, t), input->Data(0, 0, 0, t), nx * ny * nz * sizeof(VoxelType));
+      }
+      ComputeEDT_2D slices;
+      slices._Filter = this;
+      slices._EDT    = output->Data(0, 0, 0, t);
+      slices._nX     = nx;
+      slices._nY     = ny;
+      slices._wX     = dx;
+      slices._wY     = dy;
+      parallel_for(blocked_range<int>(0, nz), slices);
 	  }
   }
 
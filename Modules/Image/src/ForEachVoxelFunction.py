@@ -1314,6 +1314,166 @@ void ParallelForEachVoxel(VoxelFunc vf, const blocked_range3d<int> &re, %(impara
   ParallelForEachVoxel(re, %(imargs)s, vf);
 }
 
+// -----------------------------------------------------------------------------
+// ParallelForEachVoxel with affinity partitioner
+// -----------------------------------------------------------------------------
+
+//
+// The affinity partitioner records which thread processed each subrange of
+// the image domain. Passing the same partitioner object to subsequent loops
+// over images of the same size, e.g., in each iteration of an optimization,
+// assigns each subrange again to the same thread, such that the voxel data
+// is still in this thread's cache and memory local to its processor.
+//
+
+//
+// Image arguments by pointer
+//
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachScalar(%(imparams_by_pointer)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  %(class_name1)s<%(T)s, VoxelFunc> body(%(impargs)s, vf);
+  blocked_range<int> re(0, %(refim)s->GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, %(imparams_by_pointer)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachScalar(%(impargs)s, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(%(imparams_by_pointer)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (%(refim)s->GetTSize()) {
+    ParallelForEachScalar(%(impargs)s, vf, ap);
+  } else {
+    %(class_name1)s<%(T)s, VoxelFunc> body(%(impargs)s, vf);
+    blocked_range<int> re(0, %(refim)s->GetNumberOfVoxels() / %(refim)s->GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, %(imparams_by_pointer)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachVoxel(%(impargs)s, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, %(imparams_by_pointer)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  %(class_name1)s<%(T)s, VoxelFunc> body(%(impargs)s, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, %(imparams_by_pointer)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachVoxel(attr, %(impargs)s, vf, ap);
+}
+
+//
+// Image arguments by reference
+//
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachScalar(%(imparams_by_reference)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  %(class_name1)s<%(T)s, VoxelFunc> body(%(imargs)s, vf);
+  blocked_range<int> re(0, %(refim)s.GetNumberOfVoxels());
+  if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+  else                            parallel_for   (re, body, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachScalar(VoxelFunc vf, %(imparams_by_reference)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachScalar(%(imargs)s, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(%(imparams_by_reference)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  if (%(refim)s.GetTSize()) {
+    ParallelForEachScalar(%(imargs)s, vf, ap);
+  } else {
+    %(class_name1)s<%(T)s, VoxelFunc> body(%(imargs)s, vf);
+    blocked_range<int> re(0, %(refim)s.GetNumberOfVoxels() / %(refim)s.GetT());
+    if (VoxelFunc::IsReduction()) { parallel_reduce(re, body, ap); vf.join(body._VoxelFunc); }
+    else                            parallel_for   (re, body, ap);
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, %(imparams_by_reference)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachVoxel(%(imargs)s, vf, ap);
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(const ImageAttributes &attr, %(imparams_by_reference)s, VoxelFunc &vf, affinity_partitioner &ap)
+{
+  %(class_name1)s<%(T)s, VoxelFunc> body(%(imargs)s, vf);
+  blocked_range3d<int> re(0, attr._z, 0, attr._y, 0, attr._x);
+  if (VoxelFunc::IsReduction()) {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_reduce(re, body, ap);
+    } else {
+      parallel_reduce(re, body, ap);
+    }
+    vf.join(body._VoxelFunc);
+  } else {
+    if (attr._dt) {
+      for (body._l = 0; body._l < attr._t; ++body._l) parallel_for(re, body, ap);
+    } else {
+      parallel_for(re, body, ap);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template <%(class_T)s, class VoxelFunc>
+void ParallelForEachVoxel(VoxelFunc vf, const ImageAttributes &attr, %(imparams_by_reference)s, affinity_partitioner &ap)
+{
+  %(assert_is_not_reduction)s
+  ParallelForEachVoxel(attr, %(imargs)s, vf, ap);
+}
+
 // -----------------------------------------------------------------------------
 // ParallelForEachVoxelIf
 // -----------------------------------------------------------------------------
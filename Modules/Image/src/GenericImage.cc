@@ -23,6 +23,8 @@
 
 #include "mirtk/Math.h"
 #include "mirtk/Memory.h"
+#include "mirtk/MemoryPool.h"
+#include "mirtk/Parallel.h"
 #include "mirtk/Path.h"
 #include "mirtk/Matrix3x3.h"
 #include "mirtk/VoxelCast.h"
@@ -46,6 +48,48 @@
 
 namespace mirtk {
 
+namespace GenericImageUtils {
+
+// -----------------------------------------------------------------------------
+/// Set all voxels of an image to the same value
+///
+/// The loop is parallelized over the spatial voxel index in the same way as
+/// ParallelForEachVoxel, and each subrange is set in all frames/channels of
+/// the image. When executed on newly allocated data memory, the memory pages
+/// are therefore first touched by the threads which subsequently process the
+/// same voxels, which places them in the memory local to these processors.
+template <class VoxelType>
+struct FillImageData
+{
+  VoxelType *_Data;
+  VoxelType  _Value;
+  int        _NumberOfSpatialVoxels;
+  int        _NumberOfFrames;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    VoxelType *data = _Data;
+    for (int l = 0; l < _NumberOfFrames; ++l, data += _NumberOfSpatialVoxels) {
+      for (int idx = re.begin(); idx != re.end(); ++idx) {
+        new (data + idx) VoxelType(_Value);
+      }
+    }
+  }
+
+  static void Run(VoxelType *data, const ImageAttributes &attr, VoxelType value)
+  {
+    FillImageData body;
+    body._Data                  = data;
+    body._Value                 = value;
+    body._NumberOfSpatialVoxels = attr.NumberOfSpatialPoints();
+    body._NumberOfFrames        = attr._t;
+    parallel_for(blocked_range<int>(0, body._NumberOfSpatialVoxels), body);
+  }
+};
+
+} // namespace GenericImageUtils
+using namespace GenericImageUtils;
+
 // =============================================================================
 // Construction/Destruction
 // =============================================================================
@@ -53,13 +97,12 @@ namespace mirtk {
 // -----------------------------------------------------------------------------
 // Note: Base class BaseImage must be initialized before calling this function!
 template <class VoxelType>
-void GenericImage<VoxelType>::AllocateImage(VoxelType *data)
+void GenericImage<VoxelType>::AllocateImage(VoxelType *data, bool init)
 {
   // Delete existing mask (if any)
   if (_maskOwner) Delete(_mask);
-  // Free previously allocated memory
-  Deallocate(_matrix, _data);
-  if (_dataOwner) Deallocate(_data);
+  // Return previously allocated memory to the pool
+  if (_dataOwner) MemoryPool::Instance().Deallocate(_data), _data = NULL;
   _dataOwner = false;
   // Initialize memory
   const int nvox = _attr.NumberOfLatticePoints();
@@ -68,10 +111,10 @@ void GenericImage<VoxelType>::AllocateImage(VoxelType *data)
       _data      = data;
       _dataOwner = false;
     } else {
-      _data      = CAllocate<VoxelType>(nvox);
+      _data      = MemoryPool::Instance().Allocate<VoxelType>(nvox);
       _dataOwner = true;
+      if (init) FillImageData<VoxelType>::Run(_data, _attr, VoxelType());
     }
-    Allocate(_matrix, _attr._x, _attr._y, _attr._z, _attr._t, _data);
   }
 }
 
@@ -79,7 +122,6 @@ void GenericImage<VoxelType>::AllocateImage(VoxelType *data)
 template <class VoxelType>
 GenericImage<VoxelType>::GenericImage()
 :
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -89,7 +131,6 @@ GenericImage<VoxelType>::GenericImage()
 template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(const char *fname)
 :
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -100,7 +141,6 @@ GenericImage<VoxelType>::GenericImage(const char *fname)
 template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(int x, int y, int z, int t, VoxelType *data)
 :
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -117,7 +157,6 @@ GenericImage<VoxelType>::GenericImage(int x, int y, int z, int t, VoxelType *dat
 template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(int x, int y, int z, int t, int n, VoxelType *data)
 :
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -140,7 +179,6 @@ template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(const ImageAttributes &attr, VoxelType *data)
 :
   BaseImage(attr),
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -152,7 +190,6 @@ template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(const ImageAttributes &attr, int n, VoxelType *data)
 :
   BaseImage(attr, n),
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
@@ -164,12 +201,11 @@ template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(const BaseImage &image)
 :
   BaseImage(image),
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
   // Initialize image
-  AllocateImage();
+  AllocateImage(NULL, false);
   // Copy/cast data
   VoxelType *ptr = _data;
   for (int idx = 0; idx < _NumberOfVoxels; ++idx, ++ptr) {
@@ -182,12 +218,11 @@ template <class VoxelType>
 GenericImage<VoxelType>::GenericImage(const GenericImage &image)
 :
   BaseImage(image),
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
   if (image._dataOwner) {
-    AllocateImage();
+    AllocateImage(NULL, false);
     memcpy(_data, image._data, _NumberOfVoxels * sizeof(VoxelType));
   } else {
     AllocateImage(const_cast<VoxelType *>(image.Data()));
@@ -199,11 +234,10 @@ template <class VoxelType> template <class VoxelType2>
 GenericImage<VoxelType>::GenericImage(const GenericImage<VoxelType2> &image)
 :
   BaseImage(image),
-  _matrix   (NULL),
   _data     (NULL),
   _dataOwner(false)
 {
-  AllocateImage();
+  AllocateImage(NULL, false);
   VoxelType        *ptr1 = this->Data();
   const VoxelType2 *ptr2 = image.Data();
   for (int idx = 0; idx < _NumberOfVoxels; ++idx) {
@@ -215,8 +249,7 @@ GenericImage<VoxelType>::GenericImage(const GenericImage<VoxelType2> &image)
 template <class VoxelType>
 GenericImage<VoxelType>::~GenericImage()
 {
-  Deallocate(_matrix, _data);
-  if (_dataOwner) Deallocate(_data);
+  if (_dataOwner) MemoryPool::Instance().Deallocate(_data), _data = NULL;
   if (_maskOwner) Delete(_mask);
 }
 
@@ -234,7 +267,7 @@ BaseImage *GenericImage<VoxelType>::Copy() const
 // -----------------------------------------------------------------------------
 template <class VoxelType> void GenericImage<VoxelType>::Initialize()
 {
-  if (_matrix) *this = VoxelType();
+  if (_data) *this = VoxelType();
 }
 
 // -----------------------------------------------------------------------------
@@ -287,6 +320,22 @@ void GenericImage<VoxelType>::Initialize(int x, int y, int z, int t, VoxelType *
   this->Initialize(x, y, z, t, 1, data);
 }
 
+// -----------------------------------------------------------------------------
+template <class VoxelType>
+void GenericImage<VoxelType>::AllocateUninitialized(const ImageAttributes &a, int n)
+{
+  // Initialize attributes
+  ImageAttributes attr(a);
+  if (n >= 1) attr._t = n, attr._dt = .0; // i.e., vector image with n components
+  // Initialize memory, keeping existing memory of same size
+  if (_attr._x != attr._x || _attr._y != attr._y || _attr._z != attr._z || _attr._t != attr._t) {
+    PutAttributes(attr);
+    AllocateImage(NULL, false);
+  } else {
+    PutAttributes(attr);
+  }
+}
+
 // -----------------------------------------------------------------------------
 template <class VoxelType>
 void GenericImage<VoxelType>::CopyFrom(const VoxelType *data)
@@ -304,7 +353,7 @@ void GenericImage<VoxelType>::CopyFrom(const BaseImage &image)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    _matrix[l][k][j][i] = voxel_cast<VoxelType>(image.GetAsVector(i, j, k, l));
+    _data[VoxelToIndex(i, j, k, l)] = voxel_cast<VoxelType>(image.GetAsVector(i, j, k, l));
   }
   if (_maskOwner) delete _mask;
   if (image.OwnsMask()) {
@@ -341,10 +390,7 @@ void GenericImage<VoxelType>::CopyFrom(const GenericImage &image)
 template <class VoxelType>
 GenericImage<VoxelType>& GenericImage<VoxelType>::operator=(VoxelType scalar)
 {
-  VoxelType *ptr = this->Data();
-  for (int idx = 0; idx < _NumberOfVoxels; ++idx) {
-    ptr[idx] = scalar;
-  }
+  if (_data) FillImageData<VoxelType>::Run(_data, _attr, scalar);
   return *this;
 }
 
@@ -373,8 +419,7 @@ GenericImage<VoxelType>& GenericImage<VoxelType>::operator=(const GenericImage &
 // -----------------------------------------------------------------------------
 template <class VoxelType> void GenericImage<VoxelType>::Clear()
 {
-  Deallocate(_matrix, _data);
-  if (_dataOwner) Deallocate(_data);
+  if (_dataOwner) MemoryPool::Instance().Deallocate(_data), _data = NULL;
   if (_maskOwner) Delete(_mask);
   _attr = ImageAttributes();
 }
@@ -403,7 +448,7 @@ void GenericImage<VoxelType>
   attr._xorigin = 0;
   attr._yorigin = 0;
   attr._zorigin = 0;
-  image.Initialize(attr);
+  image.AllocateUninitialized(attr);
 
   // Calculate position of first voxel in roi in original image
   x1 = 0;
@@ -426,7 +471,7 @@ void GenericImage<VoxelType>
   // Copy region
   for (j = 0; j < _attr._y; j++) {
     for (i = 0; i < _attr._x; i++) {
-      image._matrix[0][0][j][i] = _matrix[m][k][j][i];
+      image._data[image.VoxelToIndex(i, j, 0, 0)] = _data[VoxelToIndex(i, j, k, m)];
     }
   }
 }
@@ -480,7 +525,7 @@ void GenericImage<VoxelType>
   attr._xorigin = 0;
   attr._yorigin = 0;
   attr._zorigin = 0;
-  image.Initialize(attr);
+  image.AllocateUninitialized(attr);
 
   // Calculate position of first voxel in roi in original image
   x1 = i1;
@@ -502,7 +547,7 @@ void GenericImage<VoxelType>
     for (k = k1; k < k2; k++) {
       for (j = j1; j < j2; j++) {
         for (i = i1; i < i2; i++) {
-          image._matrix[l][k-k1][j-j1][i-i1] = _matrix[l][k][j][i];
+          image._data[image.VoxelToIndex(i-i1, j-j1, k-k1, l)] = _data[VoxelToIndex(i, j, k, l)];
         }
       }
     }
@@ -560,7 +605,7 @@ void GenericImage<VoxelType>
   attr._xorigin = 0;
   attr._yorigin = 0;
   attr._zorigin = 0;
-  image.Initialize(attr);
+  image.AllocateUninitialized(attr);
 
   // Calculate position of first voxel in roi in original image
   x1 = i1;
@@ -582,7 +627,7 @@ void GenericImage<VoxelType>
     for (k = k1; k < k2; k++) {
       for (j = j1; j < j2; j++) {
         for (i = i1; i < i2; i++) {
-          image._matrix[l-l1][k-k1][j-j1][i-i1] = _matrix[l][k][j][i];
+          image._data[image.VoxelToIndex(i-i1, j-j1, k-k1, l-l1)] = _data[VoxelToIndex(i, j, k, l)];
         }
       }
     }
@@ -631,14 +676,14 @@ void GenericImage<VoxelType>::GetFrame(GenericImage<VoxelType> &image, int l1, i
   ImageAttributes attr = this->Attributes();
   attr._t       = l2 - l1 + 1;
   attr._torigin = this->ImageToTime(l1);
-  image.Initialize(attr);
+  image.AllocateUninitialized(attr);
 
   // Copy region
   for (int l = l1; l <= l2; l++) {
     for (int k = 0; k < _attr._z; k++) {
       for (int j = 0; j < _attr._y; j++) {
         for (int i = 0; i < _attr._x; i++) {
-          image._matrix[l-l1][k][j][i] = _matrix[l][k][j][i];
+          image._data[image.VoxelToIndex(i, j, k, l-l1)] = _data[VoxelToIndex(i, j, k, l)];
         }
       }
     }
@@ -1316,7 +1361,7 @@ void GenericImage<VoxelType>::ReflectX()
   for (int z = 0; z < _attr._z; ++z)
   for (int y = 0; y < _attr._y; ++y)
   for (int x = 0; x < _attr._x / 2; ++x) {
-    swap(_matrix[t][z][y][x], _matrix[t][z][y][_attr._x-(x+1)]);
+    swap(_data[VoxelToIndex(x, y, z, t)], _data[VoxelToIndex(_attr._x-(x+1), y, z, t)]);
   }
 }
 
@@ -1328,7 +1373,7 @@ void GenericImage<VoxelType>::ReflectY()
   for (int z = 0; z < _attr._z; ++z)
   for (int y = 0; y < _attr._y / 2; ++y)
   for (int x = 0; x < _attr._x; ++x) {
-    swap(_matrix[t][z][y][x], _matrix[t][z][_attr._y-(y+1)][x]);
+    swap(_data[VoxelToIndex(x, y, z, t)], _data[VoxelToIndex(x, _attr._y-(y+1), z, t)]);
   }
 }
 
@@ -1340,7 +1385,7 @@ void GenericImage<VoxelType>::ReflectZ()
   for (int z = 0; z < _attr._z / 2; ++z)
   for (int y = 0; y < _attr._y; ++y)
   for (int x = 0; x < _attr._x; ++x) {
-    swap(_matrix[t][z][y][x], _matrix[t][_attr._z-(z+1)][y][x]);
+    swap(_data[VoxelToIndex(x, y, z, t)], _data[VoxelToIndex(x, y, _attr._z-(z+1), t)]);
   }
 }
 
@@ -1350,7 +1395,7 @@ void GenericImage<VoxelType>::FlipXY(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipXY which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory
   VoxelType ****matrix = Allocate<VoxelType>(_attr._y, _attr._x, _attr._z, _attr._t);
@@ -1360,7 +1405,7 @@ void GenericImage<VoxelType>::FlipXY(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[l][k][i][j] = _matrix[l][k][j][i];
+    matrix[l][k][i][j] = _data[VoxelToIndex(i, j, k, l)];
   }
 
   // Swap image dimensions
@@ -1372,16 +1417,13 @@ void GenericImage<VoxelType>::FlipXY(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._xorigin, _attr._yorigin);
 
-  // Reshape image matrix
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -1397,7 +1439,7 @@ void GenericImage<VoxelType>::FlipXZ(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipXZ which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory
   VoxelType ****matrix = Allocate<VoxelType>(_attr._z, _attr._y, _attr._x, _attr._t);
@@ -1407,7 +1449,7 @@ void GenericImage<VoxelType>::FlipXZ(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[l][i][j][k] = _matrix[l][k][j][i];
+    matrix[l][i][j][k] = _data[VoxelToIndex(i, j, k, l)];
   }
  
   // Swap image dimensions
@@ -1419,16 +1461,13 @@ void GenericImage<VoxelType>::FlipXZ(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._xorigin, _attr._zorigin);
 
-  // Reshape image data
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-  
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -1444,7 +1483,7 @@ void GenericImage<VoxelType>::FlipYZ(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipYZ which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory for flipped image
   VoxelType ****matrix = Allocate<VoxelType>(_attr._x, _attr._z, _attr._y, _attr._t);
@@ -1454,7 +1493,7 @@ void GenericImage<VoxelType>::FlipYZ(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[l][j][k][i] = _matrix[l][k][j][i];
+    matrix[l][j][k][i] = _data[VoxelToIndex(i, j, k, l)];
   }
 
   // Swap image dimensions
@@ -1466,16 +1505,13 @@ void GenericImage<VoxelType>::FlipYZ(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._yorigin, _attr._zorigin);
 
-  // Reshape image matrix
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-  
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -1491,7 +1527,7 @@ void GenericImage<VoxelType>::FlipXT(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipXT which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory
   VoxelType ****matrix = Allocate<VoxelType>(_attr._t, _attr._y, _attr._z, _attr._x);
@@ -1501,7 +1537,7 @@ void GenericImage<VoxelType>::FlipXT(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[i][k][j][l] = _matrix[l][k][j][i];
+    matrix[i][k][j][l] = _data[VoxelToIndex(i, j, k, l)];
   }
 
   // Swap image dimensions
@@ -1513,16 +1549,13 @@ void GenericImage<VoxelType>::FlipXT(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._xorigin, _attr._torigin);
 
-  // Reshape image matrix
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-  
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -1538,7 +1571,7 @@ void GenericImage<VoxelType>::FlipYT(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipYT which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory
   VoxelType ****matrix = Allocate<VoxelType>(_attr._x, _attr._t, _attr._z, _attr._y);
@@ -1547,7 +1580,7 @@ void GenericImage<VoxelType>::FlipYT(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[j][k][l][i] = _matrix[l][k][j][i];
+    matrix[j][k][l][i] = _data[VoxelToIndex(i, j, k, l)];
   }
 
   // Swap image dimensions
@@ -1559,16 +1592,13 @@ void GenericImage<VoxelType>::FlipYT(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._yorigin, _attr._torigin);
 
-  // Reshape image matrix
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-  
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -1584,7 +1614,7 @@ void GenericImage<VoxelType>::FlipZT(bool modifyOrigin)
 {
   // TODO: Implement BaseImage::FlipZT which flips the foreground mask (if any),
   //       adjusts the attributes, and updates the coordinate transformation matrices.
-  //       The subclass then only needs to reshape the image _matrix data itself.
+  //       The subclass then only needs to reshape the image _data itself.
 
   // Allocate memory
   VoxelType ****matrix = Allocate<VoxelType>(_attr._x, _attr._y, _attr._t, _attr._z);
@@ -1593,7 +1623,7 @@ void GenericImage<VoxelType>::FlipZT(bool modifyOrigin)
   for (int k = 0; k < _attr._z; ++k)
   for (int j = 0; j < _attr._y; ++j)
   for (int i = 0; i < _attr._x; ++i) {
-    matrix[k][l][j][i] = _matrix[l][k][j][i];
+    matrix[k][l][j][i] = _data[VoxelToIndex(i, j, k, l)];
   }
 
   // Swap image dimensions
@@ -1605,16 +1635,13 @@ void GenericImage<VoxelType>::FlipZT(bool modifyOrigin)
   // Swap origin coordinates
   if (modifyOrigin) swap(_attr._zorigin, _attr._torigin);
 
-  // Reshape image matrix
+  // Copy flipped image
   //
   // Attention: DO NOT just swap the pointers to the data elements as this
   //            changes the memory location of the image data. This is not
   //            predictable by users of the class which may still hold a pointer
   //            to the old memory and in particular complicates the synchronization
   //            of host and device memory in CUGenericImage used by CUDA code.
-  _matrix = Reshape(_matrix, _attr._x, _attr._y, _attr._z, _attr._t);
-  
-  // Copy flipped image
   CopyFrom(matrix[0][0][0]);
 
   // Deallocate memory
@@ -39,6 +39,7 @@ Resampling<VoxelType>::Resampling(double dx, double dy, double dz)
   _YSize = dy;
   _ZSize = dz;
   _Interpolator = NULL;
+  _Separable    = false;
 }
 
 // ---------------------------------------------------------------------------
@@ -52,6 +53,7 @@ Resampling<VoxelType>::Resampling(int x, int y, int z)
   _YSize = 0;
   _ZSize = 0;
   _Interpolator = NULL;
+  _Separable    = false;
 }
 
 // ---------------------------------------------------------------------------
@@ -65,6 +67,7 @@ Resampling<VoxelType>::Resampling(int x, int y, int z, double dx, double dy, dou
   _YSize = dy;
   _ZSize = dz;
   _Interpolator = NULL;
+  _Separable    = false;
 }
 
 // ---------------------------------------------------------------------------
@@ -84,6 +87,9 @@ void Resampling<VoxelType>::Initialize()
 
   // Initialize output image
   this->InitializeOutput();
+
+  // Initialize map from output to input voxel coordinates
+  this->InitializeMap();
 }
 
 // ---------------------------------------------------------------------------
@@ -131,6 +137,57 @@ void Resampling<VoxelType>::InitializeOutput()
   this->_Output->Initialize(attr);
 }
 
+// ---------------------------------------------------------------------------
+template <class VoxelType>
+void Resampling<VoxelType>::InitializeMap()
+{
+  const BaseImage * const input  = this->_Input;
+  const BaseImage * const output = this->_Output;
+
+  const Matrix &i2w = output->GetImageToWorldMatrix();
+  const Matrix &w2i = input ->GetWorldToImageMatrix();
+
+  // Map is separable when both coordinate conversions are. The off-diagonal
+  // matrix elements are then exactly zero and the table entries are identical
+  // to the coordinates obtained by converting each voxel individually.
+  _Separable = true;
+  for (int r = 0; r < 3; ++r)
+  for (int c = 0; c < 3; ++c) {
+    if (r != c && (i2w(r, c) != .0 || w2i(r, c) != .0)) _Separable = false;
+  }
+
+  double x, y, z;
+  if (_Separable) {
+    _MapX.resize(output->X());
+    for (int i = 0; i < output->X(); ++i) {
+      x = i, y = 0, z = 0;
+      output->ImageToWorld(x, y, z);
+      input ->WorldToImage(x, y, z);
+      _MapX[i] = x;
+    }
+    _MapY.resize(output->Y());
+    for (int j = 0; j < output->Y(); ++j) {
+      x = 0, y = j, z = 0;
+      output->ImageToWorld(x, y, z);
+      input ->WorldToImage(x, y, z);
+      _MapY[j] = y;
+    }
+    _MapZ.resize(output->Z());
+    for (int k = 0; k < output->Z(); ++k) {
+      x = 0, y = 0, z = k;
+      output->ImageToWorld(x, y, z);
+      input ->WorldToImage(x, y, z);
+      _MapZ[k] = z;
+    }
+  } else {
+    _MapX.clear();
+    _MapY.clear();
+    _MapZ.clear();
+  }
+
+  _OutputToInput = w2i * i2w;
+}
+
 // ---------------------------------------------------------------------------
 // Serial/Multi-threaded body of Resampling::Run method
 class ResamplingRun
@@ -141,6 +198,11 @@ public:
   const BaseImage          *_Input;
   BaseImage                *_Output;
   InterpolateImageFunction *_Interpolator;
+  const double             *_MapX;
+  const double             *_MapY;
+  const double             *_MapZ;
+  const Matrix             *_OutputToInput;
+  double                    _Inside[8];
   mutable int               _T;
 
   // -------------------------------------------------------------------------
@@ -150,6 +212,10 @@ public:
     _Input(NULL),
     _Output(NULL),
     _Interpolator(NULL),
+    _MapX(NULL),
+    _MapY(NULL),
+    _MapZ(NULL),
+    _OutputToInput(NULL),
     _T(0)
   {}
 
@@ -160,21 +226,60 @@ public:
     _Input(other._Input),
     _Output(other._Output),
     _Interpolator(other._Interpolator),
+    _MapX(other._MapX),
+    _MapY(other._MapY),
+    _MapZ(other._MapZ),
+    _OutputToInput(other._OutputToInput),
     _T(other._T)
-  {}
+  {
+    for (int n = 0; n < 8; ++n) _Inside[n] = other._Inside[n];
+  }
 
   // -------------------------------------------------------------------------
   /// Resamples the image within given output region for frame _T
   void operator() (const blocked_range3d<int> &r) const
   {
+    const double &x1 = _Inside[0], &y1 = _Inside[1], &z1 = _Inside[2], &t1 = _Inside[3];
+    const double &x2 = _Inside[4], &y2 = _Inside[5], &z2 = _Inside[6], &t2 = _Inside[7];
+    const double  t  = _T;
     double x, y, z;
-    for (int k = r.pages().begin(); k != r.pages().end(); ++k)
-    for (int j = r.rows ().begin(); j != r.rows ().end(); ++j)
-    for (int i = r.cols ().begin(); i != r.cols ().end(); ++i) {
-      x = i, y = j, z = k;
-      _Output->ImageToWorld(x, y, z);
-      _Input ->WorldToImage(x, y, z);
-      _Output->PutAsDouble(i, j, k, _T, _Interpolator->Evaluate(x, y, z, _T));
+    if (_MapX) {
+      // Look up input voxel coordinates in per-axis tables and decide whether
+      // interpolation requires boundary handling once per row
+      bool inside_z, inside_yz;
+      const bool inside_t = (t1 <= t && t <= t2);
+      for (int k = r.pages().begin(); k != r.pages().end(); ++k) {
+        z = _MapZ[k];
+        inside_z = inside_t && (z1 <= z && z <= z2);
+        for (int j = r.rows().begin(); j != r.rows().end(); ++j) {
+          y = _MapY[j];
+          inside_yz = inside_z && (y1 <= y && y <= y2);
+          for (int i = r.cols().begin(); i != r.cols().end(); ++i) {
+            x = _MapX[i];
+            if (inside_yz && x1 <= x && x <= x2) {
+              _Output->PutAsDouble(i, j, k, _T, _Interpolator->EvaluateInside(x, y, z, t));
+            } else {
+              _Output->PutAsDouble(i, j, k, _T, _Interpolator->EvaluateOutside(x, y, z, t));
+            }
+          }
+        }
+      }
+    } else {
+      // Step along output rows using the affine map of voxel coordinates
+      const Matrix &m = *_OutputToInput;
+      double x0, y0, z0;
+      for (int k = r.pages().begin(); k != r.pages().end(); ++k)
+      for (int j = r.rows ().begin(); j != r.rows ().end(); ++j) {
+        x0 = m(0, 1) * j + m(0, 2) * k + m(0, 3);
+        y0 = m(1, 1) * j + m(1, 2) * k + m(1, 3);
+        z0 = m(2, 1) * j + m(2, 2) * k + m(2, 3);
+        for (int i = r.cols().begin(); i != r.cols().end(); ++i) {
+          x = m(0, 0) * i + x0;
+          y = m(1, 0) * i + y0;
+          z = m(2, 0) * i + z0;
+          _Output->PutAsDouble(i, j, k, _T, _Interpolator->Evaluate(x, y, z, t));
+        }
+      }
     }
   }
 
@@ -202,9 +307,17 @@ void Resampling<VoxelType>::Run()
   this->Initialize();
 
   ResamplingRun body;
-  body._Input        = this->_Input;
-  body._Output       = this->_Output;
-  body._Interpolator = this->_Interpolator;
+  body._Input         = this->_Input;
+  body._Output        = this->_Output;
+  body._Interpolator  = this->_Interpolator;
+  body._OutputToInput = &_OutputToInput;
+  if (_Separable) {
+    body._MapX = _MapX.data();
+    body._MapY = _MapY.data();
+    body._MapZ = _MapZ.data();
+  }
+  _Interpolator->Inside(body._Inside[0], body._Inside[1], body._Inside[2], body._Inside[3],
+                        body._Inside[4], body._Inside[5], body._Inside[6], body._Inside[7]);
   body(blocked_range<int>(0, this->_Output->T()));
 
   this->Finalize();
@@ -44,154 +44,180 @@ class MultiThreadedResamplingWithPadding
   /// Time frame to transform
   int _t;
 
+  /// Affine map from output to input voxel coordinates
+  const Matrix *_Map;
+
+  /// Input voxel indices of output columns, rows, and slices if map is separable
+  const int *_U, *_V, *_W;
+
+  /// Input voxel fractions of output columns, rows, and slices if map is separable
+  const double *_DX, *_DY, *_DZ;
+
 public:
 
-  MultiThreadedResamplingWithPadding(ResamplingWithPadding<VoxelType> *filter, int t)
+  MultiThreadedResamplingWithPadding(ResamplingWithPadding<VoxelType> *filter, int t,
+                                     const Matrix *map,
+                                     const int *u, const int *v, const int *w,
+                                     const double *dx, const double *dy, const double *dz)
   :
     _Filter(filter),
     _PaddingValue(filter->PaddingValue()),
-    _t(t)
+    _t(t),
+    _Map(map),
+    _U(u), _V(v), _W(w),
+    _DX(dx), _DY(dy), _DZ(dz)
   {}
 
   void operator ()(const blocked_range<int> &r) const
   {
-    int    u, v, w, pad;
-    double val, sum, w1, w2, w3, w4, w5, w6, w7, w8, dx, dy, dz, x, y, z;
+    int    u, v, w;
+    double dx, dy, dz, x, y, z, x0, y0, z0;
 
-    const GenericImage<VoxelType> *input  = _Filter->Input();
-    GenericImage<VoxelType>       *output = _Filter->Output();
+    GenericImage<VoxelType> *output = _Filter->Output();
+    const Matrix            &m      = *_Map;
 
-    // TODO: Use InterpolateImageFunction::GetWithPadding instead
-
-    int l = _t;
     for (int k = r.begin(); k != r.end();    ++k)
-    for (int j = 0;         j < output->Y(); ++j)
-    for (int i = 0;         i < output->X(); ++i) {
-      x = i, y = j, z = k;
-      output->ImageToWorld(x, y, z);
-      input ->WorldToImage(x, y, z);
-
-      // Calculate integer fraction of points
-      u = ifloor(x);
-      v = ifloor(y);
-      w = ifloor(z);
-
-      // Calculate floating point fraction of points
-      dx = x - u;
-      dy = y - v;
-      dz = z - w;
-
-      // Calculate weights for trilinear interpolation
-      w1 = (1 - dx) * (1 - dy) * (1 - dz);
-      w2 = (1 - dx) * (1 - dy) * dz;
-      w3 = (1 - dx) * dy * (1 - dz);
-      w4 = (1 - dx) * dy * dz;
-      w5 = dx * (1 - dy) * (1 - dz);
-      w6 = dx * (1 - dy) * dz;
-      w7 = dx * dy * (1 - dz);
-      w8 = dx * dy * dz;
-
-      // Calculate trilinear interpolation, ignoring padded values
-      val = 0;
-      pad = 8;
-      sum = 0;
-      if ((u >= 0) && (u < input->X()) &&
-          (v >= 0) && (v < input->Y()) &&
-          (w >= 0) && (w < input->Z())) {
-        if (input->Get(u, v, w, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u, v, w, l) * w1;
-          sum += w1;
+    for (int j = 0;         j < output->Y(); ++j) {
+      x0 = m(0, 1) * j + m(0, 2) * k + m(0, 3);
+      y0 = m(1, 1) * j + m(1, 2) * k + m(1, 3);
+      z0 = m(2, 1) * j + m(2, 2) * k + m(2, 3);
+      for (int i = 0; i < output->X(); ++i) {
+        if (_U) {
+          u  = _U [i], v  = _V [j], w  = _W [k];
+          dx = _DX[i], dy = _DY[j], dz = _DZ[k];
+        } else {
+          x = m(0, 0) * i + x0;
+          y = m(1, 0) * i + y0;
+          z = m(2, 0) * i + z0;
+          u = ifloor(x), dx = x - u;
+          v = ifloor(y), dy = y - v;
+          w = ifloor(z), dz = z - w;
         }
-      } else {
+        output->PutAsDouble(i, j, k, _t, Interpolate(u, v, w, dx, dy, dz));
+      }
+    }
+  }
+
+  /// Trilinear interpolation of input at given voxel and fraction, ignoring padded values
+  double Interpolate(int u, int v, int w, double dx, double dy, double dz) const
+  {
+    int    pad;
+    double val, sum, w1, w2, w3, w4, w5, w6, w7, w8;
+
+    const GenericImage<VoxelType> *input = _Filter->Input();
+
+    const int l = _t;
+
+    // Calculate weights for trilinear interpolation
+    w1 = (1 - dx) * (1 - dy) * (1 - dz);
+    w2 = (1 - dx) * (1 - dy) * dz;
+    w3 = (1 - dx) * dy * (1 - dz);
+    w4 = (1 - dx) * dy * dz;
+    w5 = dx * (1 - dy) * (1 - dz);
+    w6 = dx * (1 - dy) * dz;
+    w7 = dx * dy * (1 - dz);
+    w8 = dx * dy * dz;
+
+    // Calculate trilinear interpolation, ignoring padded values
+    val = 0;
+    pad = 8;
+    sum = 0;
+    if ((u >= 0) && (u < input->X()) &&
+        (v >= 0) && (v < input->Y()) &&
+        (w >= 0) && (w < input->Z())) {
+      if (input->Get(u, v, w, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u, v, w, l) * w1;
+        sum += w1;
       }
-      if ((u   >= 0) && (u   < input->X()) &&
-          (v   >= 0) && (v   < input->Y()) &&
-          (w+1 >= 0) && (w+1 < input->Z())) {
-        if (input->Get(u, v, w+1, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u, v, w+1, l) * w2;
-          sum += w2;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u   >= 0) && (u   < input->X()) &&
+        (v   >= 0) && (v   < input->Y()) &&
+        (w+1 >= 0) && (w+1 < input->Z())) {
+      if (input->Get(u, v, w+1, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u, v, w+1, l) * w2;
+        sum += w2;
       }
-      if ((u   >= 0) && (u   < input->X()) &&
-          (v+1 >= 0) && (v+1 < input->Y()) &&
-          (w   >= 0) && (w   < input->Z())) {
-        if (input->Get(u, v+1, w, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u, v+1, w, l) * w3;
-          sum += w3;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u   >= 0) && (u   < input->X()) &&
+        (v+1 >= 0) && (v+1 < input->Y()) &&
+        (w   >= 0) && (w   < input->Z())) {
+      if (input->Get(u, v+1, w, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u, v+1, w, l) * w3;
+        sum += w3;
       }
-      if ((u   >= 0) && (u   < input->X()) &&
-          (v+1 >= 0) && (v+1 < input->Y()) &&
-          (w+1 >= 0) && (w+1 < input->Z())) {
-        if (input->Get(u, v+1, w+1, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u, v+1, w+1, l) * w4;
-          sum += w4;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u   >= 0) && (u   < input->X()) &&
+        (v+1 >= 0) && (v+1 < input->Y()) &&
+        (w+1 >= 0) && (w+1 < input->Z())) {
+      if (input->Get(u, v+1, w+1, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u, v+1, w+1, l) * w4;
+        sum += w4;
       }
-      if ((u+1 >= 0) && (u+1 < input->X()) &&
-          (v   >= 0) && (v   < input->Y()) &&
-          (w   >= 0) && (w   < input->Z())) {
-        if (input->Get(u+1, v, w, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u+1, v, w, l) * w5;
-          sum += w5;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u+1 >= 0) && (u+1 < input->X()) &&
+        (v   >= 0) && (v   < input->Y()) &&
+        (w   >= 0) && (w   < input->Z())) {
+      if (input->Get(u+1, v, w, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u+1, v, w, l) * w5;
+        sum += w5;
       }
-      if ((u+1 >= 0) && (u+1 < input->X()) &&
-          (v   >= 0) && (v   < input->Y()) &&
-          (w+1 >= 0) && (w+1 < input->Z())) {
-        if (input->Get(u+1, v, w+1, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u+1, v, w+1, l) * w6;
-          sum += w6;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u+1 >= 0) && (u+1 < input->X()) &&
+        (v   >= 0) && (v   < input->Y()) &&
+        (w+1 >= 0) && (w+1 < input->Z())) {
+      if (input->Get(u+1, v, w+1, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u+1, v, w+1, l) * w6;
+        sum += w6;
       }
-      if ((u+1 >= 0) && (u+1 < input->X()) &&
-          (v+1 >= 0) && (v+1 < input->Y()) &&
-          (w   >= 0) && (w   < input->Z())) {
-        if (input->Get(u+1, v+1, w, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u+1, v+1, w, l) * w7;
-          sum += w7;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u+1 >= 0) && (u+1 < input->X()) &&
+        (v+1 >= 0) && (v+1 < input->Y()) &&
+        (w   >= 0) && (w   < input->Z())) {
+      if (input->Get(u+1, v+1, w, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u+1, v+1, w, l) * w7;
+        sum += w7;
       }
-      if ((u+1 >= 0) && (u+1 < input->X()) &&
-          (v+1 >= 0) && (v+1 < input->Y()) &&
-          (w+1 >= 0) && (w+1 < input->Z())) {
-        if (input->Get(u+1, v+1, w+1, l) != _PaddingValue) {
-          pad--;
-          val += input->Get(u+1, v+1, w+1, l) * w8;
-          sum += w8;
-        }
-      } else {
+    } else {
+      pad--;
+    }
+    if ((u+1 >= 0) && (u+1 < input->X()) &&
+        (v+1 >= 0) && (v+1 < input->Y()) &&
+        (w+1 >= 0) && (w+1 < input->Z())) {
+      if (input->Get(u+1, v+1, w+1, l) != _PaddingValue) {
         pad--;
+        val += input->Get(u+1, v+1, w+1, l) * w8;
+        sum += w8;
       }
-      if (pad < 4) {
-        if (sum > 0) {
-          output->PutAsDouble(i, j, k, l, val / sum);
-        } else {
-          output->PutAsDouble(i, j, k, l, _PaddingValue);
-        }
+    } else {
+      pad--;
+    }
+    if (pad < 4) {
+      if (sum > 0) {
+        return val / sum;
       } else {
-        output->PutAsDouble(i, j, k, l, _PaddingValue);
+        return _PaddingValue;
       }
+    } else {
+      return _PaddingValue;
     }
   }
 };
@@ -244,6 +270,9 @@ void ResamplingWithPadding<VoxelType>::Initialize()
 
   // Initialize output image
   this->InitializeOutput();
+
+  // Initialize map from output to input voxel coordinates
+  this->InitializeMap();
 }
 
 // -----------------------------------------------------------------------------
@@ -254,8 +283,26 @@ void ResamplingWithPadding<VoxelType>::Run()
 
   this->Initialize();
 
+  // Precompute indices and interpolation weights along each axis
+  Array<int>    u, v, w;
+  Array<double> dx, dy, dz;
+  if (this->_Separable) {
+    u.resize(this->_MapX.size()), dx.resize(this->_MapX.size());
+    v.resize(this->_MapY.size()), dy.resize(this->_MapY.size());
+    w.resize(this->_MapZ.size()), dz.resize(this->_MapZ.size());
+    for (size_t i = 0; i < u.size(); ++i) u[i] = ifloor(this->_MapX[i]), dx[i] = this->_MapX[i] - u[i];
+    for (size_t j = 0; j < v.size(); ++j) v[j] = ifloor(this->_MapY[j]), dy[j] = this->_MapY[j] - v[j];
+    for (size_t k = 0; k < w.size(); ++k) w[k] = ifloor(this->_MapZ[k]), dz[k] = this->_MapZ[k] - w[k];
+  }
+
   for (int l = 0; l < this->_Output->T(); ++l) {
-    MultiThreadedResamplingWithPadding<VoxelType> body(this, l);
+    MultiThreadedResamplingWithPadding<VoxelType> body(this, l, &this->_OutputToInput,
+                                                       u .empty() ? NULL : u .data(),
+                                                       v .empty() ? NULL : v .data(),
+                                                       w .empty() ? NULL : w .data(),
+                                                       dx.empty() ? NULL : dx.data(),
+                                                       dy.empty() ? NULL : dy.data(),
+                                                       dz.empty() ? NULL : dz.data());
     parallel_for(blocked_range<int>(0, this->_Output->Z(), 1), body);
   }
 
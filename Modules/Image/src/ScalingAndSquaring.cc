@@ -727,6 +727,155 @@ struct ResampleOutput : public VoxelFunction
 };
 
 
+// -----------------------------------------------------------------------------
+/// Fused squaring step of displacement field and its (log) Jacobian determinant
+///
+/// Specialized body for linear interpolation which evaluates the trilinear
+/// interpolation weights once per voxel and uses them to update all fields.
+/// The image domain is processed in small tiles in order to make better use
+/// of the cache as neighboring voxels look up neighboring displacements.
+/// Voxels mapped outside the interior of the image domain are updated using
+/// the generic interpolators as before.
+template <class TReal>
+struct UpdateDisplacementAndDetJacobianLinear
+{
+  typedef GenericImage<TReal>                        ImageType;
+  typedef GenericInterpolateImageFunction<ImageType> Interpolator;
+
+  /// Number of image slices, rows, and columns of a tile, respectively
+  static const int _TileZ = 4, _TileY = 16, _TileX = 64;
+
+  const TReal        *_InputDisplacement;
+  TReal              *_OutputDisplacement;
+  const TReal        *_InputDetJacobian;
+  TReal              *_OutputDetJacobian;
+  const TReal        *_InputLogJacobian;
+  TReal              *_OutputLogJacobian;
+  const Interpolator *_Displacement;
+  const Interpolator *_DetJacobian;
+  const Interpolator *_LogJacobian;
+  int                 _X, _Y, _Z, _N, _SZ;
+
+  UpdateDisplacementAndDetJacobianLinear(const Interpolator *d,
+                                         const Interpolator *dj,
+                                         const Interpolator *lj,
+                                         ImageType *d_out,
+                                         ImageType *dj_out,
+                                         ImageType *lj_out)
+  :
+    _InputDisplacement (d ->Input()->Data()),
+    _OutputDisplacement(d_out->Data()),
+    _InputDetJacobian  (dj ? dj->Input()->Data() : NULL),
+    _OutputDetJacobian (dj ? dj_out->Data() : NULL),
+    _InputLogJacobian  (lj ? lj->Input()->Data() : NULL),
+    _OutputLogJacobian (lj ? lj_out->Data() : NULL),
+    _Displacement(d), _DetJacobian(dj), _LogJacobian(lj),
+    _X(d->Input()->X()), _Y(d->Input()->Y()), _Z(d->Input()->Z()),
+    _N(d->Input()->NumberOfSpatialVoxels()),
+    _SZ(_Z > 1 ? _X * _Y : 0)
+  {}
+
+  void Run() const
+  {
+    blocked_range3d<int> re(0, _Z, _TileZ, 0, _Y, _TileY, 0, _X, _TileX);
+    parallel_for(re, *this);
+  }
+
+  void operator ()(const blocked_range3d<int> &re) const
+  {
+    int    idx, i0, j0, k0, n;
+    double x, y, z;
+    TReal  wx, wy, wz, w[8], u[3], dj;
+
+    for (int k = re.pages().begin(); k != re.pages().end(); ++k)
+    for (int j = re.rows ().begin(); j != re.rows ().end(); ++j) {
+      idx = (k * _Y + j) * _X + re.cols().begin();
+      for (int i = re.cols().begin(); i != re.cols().end(); ++i, ++idx) {
+        x = i + static_cast<double>(_InputDisplacement[idx]);
+        y = j + static_cast<double>(_InputDisplacement[idx + _N]);
+        z = k + static_cast<double>(_InputDisplacement[idx + _N + _N]);
+        // Interior of image domain such that all eight neighbors exist
+        if (0. <= x && x < _X - 1 && 0. <= y && y < _Y - 1 &&
+            (_SZ ? (0. <= z && z < _Z - 1) : z == 0.)) {
+          i0 = static_cast<int>(x);
+          j0 = static_cast<int>(y);
+          k0 = static_cast<int>(z);
+          wx = static_cast<TReal>(x - i0);
+          wy = static_cast<TReal>(y - j0);
+          wz = static_cast<TReal>(z - k0);
+          w[0] = (TReal(1) - wx) * (TReal(1) - wy) * (TReal(1) - wz);
+          w[1] =             wx  * (TReal(1) - wy) * (TReal(1) - wz);
+          w[2] = (TReal(1) - wx) *             wy  * (TReal(1) - wz);
+          w[3] =             wx  *             wy  * (TReal(1) - wz);
+          w[4] = (TReal(1) - wx) * (TReal(1) - wy) *             wz;
+          w[5] =             wx  * (TReal(1) - wy) *             wz;
+          w[6] = (TReal(1) - wx) *             wy  *             wz;
+          w[7] =             wx  *             wy  *             wz;
+          n = (k0 * _Y + j0) * _X + i0;
+          for (int c = 0; c < 3; ++c, n += _N) {
+            u[c] = Interpolate(_InputDisplacement + n, w);
+          }
+          _OutputDisplacement[idx          ] = _InputDisplacement[idx          ] + u[0];
+          _OutputDisplacement[idx + _N     ] = _InputDisplacement[idx + _N     ] + u[1];
+          _OutputDisplacement[idx + _N + _N] = _InputDisplacement[idx + _N + _N] + u[2];
+          n = (k0 * _Y + j0) * _X + i0;
+          if (_InputDetJacobian) {
+            dj = max(TReal(.0001), Interpolate(_InputDetJacobian + n, w));
+            if (_InputLogJacobian) {
+              // Lorenzi et al. (2013), see UpdateJacobianBase::UpdateDetAndLog
+              _OutputLogJacobian[idx] = _InputLogJacobian[idx] + static_cast<TReal>(log(dj));
+              _OutputDetJacobian[idx] = static_cast<TReal>(exp(_OutputLogJacobian[idx]));
+            } else {
+              _OutputDetJacobian[idx] = _InputDetJacobian[idx] * dj;
+            }
+          } else if (_InputLogJacobian) {
+            _OutputLogJacobian[idx] = _InputLogJacobian[idx]
+                                    + max(TReal(-4), Interpolate(_InputLogJacobian + n, w));
+          }
+        // Otherwise, use generic interpolators which handle the boundary
+        } else {
+          double v[3] = {.0, .0, .0};
+          _Displacement->Evaluate(v, x, y, z);
+          _OutputDisplacement[idx          ] = _InputDisplacement[idx          ] + static_cast<TReal>(v[0]);
+          _OutputDisplacement[idx + _N     ] = _InputDisplacement[idx + _N     ] + static_cast<TReal>(v[1]);
+          _OutputDisplacement[idx + _N + _N] = _InputDisplacement[idx + _N + _N] + static_cast<TReal>(v[2]);
+          if (_InputDetJacobian) {
+            if (_DetJacobian->IsInside(x, y, z)) {
+              dj = static_cast<TReal>(max(.0001, _DetJacobian->EvaluateInside(x, y, z)));
+              if (_InputLogJacobian) {
+                _OutputLogJacobian[idx] = _InputLogJacobian[idx] + static_cast<TReal>(log(dj));
+                _OutputDetJacobian[idx] = static_cast<TReal>(exp(_OutputLogJacobian[idx]));
+              } else {
+                _OutputDetJacobian[idx] = _InputDetJacobian[idx] * dj;
+              }
+            } else {
+              _OutputDetJacobian[idx] = _InputDetJacobian[idx];
+              if (_InputLogJacobian) _OutputLogJacobian[idx] = _InputLogJacobian[idx];
+            }
+          } else if (_InputLogJacobian) {
+            if (_LogJacobian->IsInside(x, y, z)) {
+              _OutputLogJacobian[idx] = _InputLogJacobian[idx]
+                                      + static_cast<TReal>(max(-4.0, _LogJacobian->EvaluateInside(x, y, z)));
+            } else {
+              _OutputLogJacobian[idx] = _InputLogJacobian[idx];
+            }
+          }
+        }
+      }
+    }
+  }
+
+protected:
+
+  /// Trilinear interpolation of scalar field given precomputed weights
+  inline TReal Interpolate(const TReal *p, const TReal w[8]) const
+  {
+    const TReal *q = p + _SZ;
+    return w[0] * p[0] + w[1] * p[1] + w[2] * p[_X] + w[3] * p[_X + 1]
+         + w[4] * q[0] + w[5] * q[1] + w[6] * q[_X] + w[7] * q[_X + 1];
+  }
+};
+
 } // namespace ScalingAndSquaringUtils
 using namespace ScalingAndSquaringUtils;
 
@@ -1113,68 +1262,100 @@ void ScalingAndSquaring<TReal>::Run()
   ConvertToVoxelUnits3D<TReal> w2i(attr);
   ParallelForEachVoxel(attr, _InterimDisplacement, _InterimDisplacement, w2i);
 
-  // Do the squaring steps
+  // Use fused squaring step of displacements and (log) Jacobian determinants
+  // when linear interpolation is used; full Jacobian matrices are updated
+  // separately using the generic voxel function
+  const bool fused = (_Interpolation == Interpolation_Linear);
+  if (fused) jac_mode &= 1;
+
+  // Do the squaring steps, alternating between the intermediate images and
+  // the temporary (or output) images as input and output of each step
+  ImageType *src_disp   = _InterimDisplacement, *dst_disp   = disp;
+  ImageType *src_jac3x3 = _InterimJacobian,     *dst_jac3x3 = jac3x3;
+  ImageType *src_detjac = _InterimDetJacobian,  *dst_detjac = detjac;
+  ImageType *src_logjac = _InterimLogJacobian,  *dst_logjac = logjac;
+  ImageType *src_dofjac = _InterimJacobianDOFs, *dst_dofjac = dofjac;
+
   int n = _NumberOfSquaringSteps;
   while (n--) {
-    // (Re-)initialize interpolators
-    _Displacement                   ->Initialize();
-    if (_Jacobian    ) _Jacobian    ->Initialize();
-    if (_DetJacobian ) _DetJacobian ->Initialize();
-    if (_LogJacobian ) _LogJacobian ->Initialize();
-    if (_JacobianDOFs) _JacobianDOFs->Initialize();
+    // (Re-)initialize interpolators of current input images
+    _Displacement                   ->Input(src_disp),   _Displacement->Initialize();
+    if (_Jacobian    ) _Jacobian    ->Input(src_jac3x3), _Jacobian    ->Initialize();
+    if (_DetJacobian ) _DetJacobian ->Input(src_detjac), _DetJacobian ->Initialize();
+    if (_LogJacobian ) _LogJacobian ->Input(src_logjac), _LogJacobian ->Initialize();
+    if (_JacobianDOFs) _JacobianDOFs->Input(src_dofjac), _JacobianDOFs->Initialize();
     // Compute updates
-    {
+    if (fused) {
+      UpdateDisplacementAndDetJacobianLinear<TReal> update(_Displacement, _DetJacobian, _LogJacobian,
+                                                            dst_disp,     dst_detjac,   dst_logjac);
+      update.Run();
+    } else {
       UpdateDisplacement<DisplacementField> update(_Displacement);
-      ParallelForEachVoxel(attr, _InterimDisplacement, disp, update);
+      ParallelForEachVoxel(attr, src_disp, dst_disp, update);
     }
     switch (jac_mode) {
       case 1: {
         UpdateJacobian<JacobianField> update;
         update.Initialize(_Jacobian, NULL, NULL);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimJacobian, jac3x3, update);
+        ParallelForEachVoxel(attr, src_disp, src_jac3x3, dst_jac3x3, update);
       } break;
       case 2: {
         UpdateDetJacobian<JacobianField> update;
         update.Initialize(NULL, _DetJacobian, NULL);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimDetJacobian, detjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_detjac, dst_detjac, update);
       } break;
       case 3: {
         UpdateJacobianAndDet<JacobianField> update;
         update.Initialize(_Jacobian, _DetJacobian, NULL);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimJacobian, _InterimDetJacobian, jac3x3, detjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_jac3x3, src_detjac, dst_jac3x3, dst_detjac, update);
       } break;
       case 4: {
         UpdateLogJacobian<JacobianField> update;
         update.Initialize(NULL, NULL, _LogJacobian);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimLogJacobian, logjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_logjac, dst_logjac, update);
       } break;
       case 5: {
         UpdateJacobianAndLog<JacobianField> update;
         update.Initialize(_Jacobian, NULL, _LogJacobian);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimJacobian, _InterimLogJacobian, jac3x3, logjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_jac3x3, src_logjac, dst_jac3x3, dst_logjac, update);
       } break;
       case 6: {
         UpdateDetJacobianAndLog<JacobianField> update;
         update.Initialize(NULL, _DetJacobian, _LogJacobian);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimDetJacobian, _InterimLogJacobian, detjac, logjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_detjac, src_logjac, dst_detjac, dst_logjac, update);
       } break;
       case 7: {
         UpdateJacobianAndDetAndLog<JacobianField> update;
         update.Initialize(_Jacobian, _DetJacobian, _LogJacobian);
-        ParallelForEachVoxel(attr, _InterimDisplacement, _InterimJacobian, _InterimDetJacobian, _InterimLogJacobian, jac3x3, detjac, logjac, update);
+        ParallelForEachVoxel(attr, src_disp, src_jac3x3, src_detjac, src_logjac, dst_jac3x3, dst_detjac, dst_logjac, update);
       } break;
     }
     if (_InterimJacobianDOFs) {
       UpdateJacobianDOFs<JacobianField> update(_Jacobian, _JacobianDOFs);
-      ParallelForEachVoxel(attr, _InterimDisplacement, _InterimJacobianDOFs, dofjac, update);
+      ParallelForEachVoxel(attr, src_disp, src_dofjac, dst_dofjac, update);
     }
-    // Update intermediate output images
-    _InterimDisplacement                          ->CopyFrom(disp  ->Data());
-    if (_InterimJacobian    ) _InterimJacobian    ->CopyFrom(jac3x3->Data());
-    if (_InterimDetJacobian ) _InterimDetJacobian ->CopyFrom(detjac->Data());
-    if (_InterimLogJacobian ) _InterimLogJacobian ->CopyFrom(logjac->Data());
-    if (_InterimJacobianDOFs) _InterimJacobianDOFs->CopyFrom(dofjac->Data());
+    // Swap input and output buffers
+    swap(src_disp,   dst_disp);
+    swap(src_jac3x3, dst_jac3x3);
+    swap(src_detjac, dst_detjac);
+    swap(src_logjac, dst_logjac);
+    swap(src_dofjac, dst_dofjac);
+  }
+
+  // Copy result of last squaring step to intermediate images only if it
+  // was written to the temporary (or output) images after odd number of steps
+  if (src_disp != _InterimDisplacement) {
+    _InterimDisplacement                          ->CopyFrom(src_disp  ->Data());
+    if (_InterimJacobian    ) _InterimJacobian    ->CopyFrom(src_jac3x3->Data());
+    if (_InterimDetJacobian ) _InterimDetJacobian ->CopyFrom(src_detjac->Data());
+    if (_InterimLogJacobian ) _InterimLogJacobian ->CopyFrom(src_logjac->Data());
+    if (_InterimJacobianDOFs) _InterimJacobianDOFs->CopyFrom(src_dofjac->Data());
   }
+  _Displacement                   ->Input(_InterimDisplacement);
+  if (_Jacobian    ) _Jacobian    ->Input(_InterimJacobian);
+  if (_DetJacobian ) _DetJacobian ->Input(_InterimDetJacobian);
+  if (_LogJacobian ) _LogJacobian ->Input(_InterimLogJacobian);
+  if (_JacobianDOFs) _JacobianDOFs->Input(_InterimJacobianDOFs);
 
   // Convert final displacements back to world units if output requested
   if (_OutputDisplacement) {
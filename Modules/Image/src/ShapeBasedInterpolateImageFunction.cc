@@ -20,6 +20,8 @@
 #include "mirtk/ShapeBasedInterpolateImageFunction.h"
 
 #include "mirtk/Math.h"
+#include "mirtk/Array.h"
+#include "mirtk/Parallel.h"
 #include "mirtk/Resampling.h"
 #include "mirtk/EuclideanDistanceTransform.h"
 #include "mirtk/LinearInterpolateImageFunction.hxx"
@@ -34,6 +36,343 @@ namespace mirtk {
 MIRTK_Common_EXPORT extern int verbose;
 
 
+// =============================================================================
+// Auxiliaries
+// =============================================================================
+
+namespace ShapeBasedInterpolateImageFunctionUtils {
+
+
+// -----------------------------------------------------------------------------
+/// Bounding box of input voxels with value greater or equal a threshold
+struct ThresholdBoundingBox
+{
+  int i1, j1, k1, i2, j2, k2;
+
+  ThresholdBoundingBox()
+  :
+    i1(numeric_limits<int>::max()), j1(i1), k1(i1),
+    i2(-1), j2(-1), k2(-1)
+  {}
+
+  bool IsEmpty() const
+  {
+    return i2 < i1;
+  }
+
+  void Add(int i, int j, int k)
+  {
+    if (i < i1) i1 = i;
+    if (i > i2) i2 = i;
+    if (j < j1) j1 = j;
+    if (j > j2) j2 = j;
+    if (k < k1) k1 = k;
+    if (k > k2) k2 = k;
+  }
+
+  void Add(const ThresholdBoundingBox &other)
+  {
+    if (!other.IsEmpty()) {
+      Add(other.i1, other.j1, other.k1);
+      Add(other.i2, other.j2, other.k2);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Minimum and maximum input value used to interpolate each resampled voxel
+///
+/// When all these input values are above (below) a threshold, the interpolated
+/// signed distance is negative (positive) and the resampled voxel is known to
+/// be inside (outside) the shape of this threshold without interpolation.
+struct StencilRange
+{
+  const BaseImage *_Input;
+  const RealImage *_Output;
+  RealImage       *_Min;
+  RealImage       *_Max;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    const double inf = numeric_limits<double>::infinity();
+    double x, y, z, v, vmin, vmax;
+    int    i1, j1, k1, i2, j2, k2;
+    for (int l = 0; l < _Output->T(); ++l)
+    for (int k = re.begin(); k != re.end(); ++k)
+    for (int j = 0; j < _Output->Y(); ++j)
+    for (int i = 0; i < _Output->X(); ++i) {
+      x = i, y = j, z = k;
+      _Output->ImageToWorld(x, y, z);
+      _Input ->WorldToImage(x, y, z);
+      i1 = static_cast<int>(floor(x)), i2 = min(i1 + 1, _Input->X() - 1), i1 = max(i1, 0);
+      j1 = static_cast<int>(floor(y)), j2 = min(j1 + 1, _Input->Y() - 1), j1 = max(j1, 0);
+      k1 = static_cast<int>(floor(z)), k2 = min(k1 + 1, _Input->Z() - 1), k1 = max(k1, 0);
+      vmin = +inf, vmax = -inf;
+      for (int c = k1; c <= k2; ++c)
+      for (int b = j1; b <= j2; ++b)
+      for (int a = i1; a <= i2; ++a) {
+        v = _Input->GetAsDouble(a, b, c, l);
+        if (v < vmin) vmin = v;
+        if (v > vmax) vmax = v;
+      }
+      // Always interpolate when no input voxel is used
+      if (vmin > vmax) vmin = -inf, vmax = +inf;
+      _Min->PutAsDouble(i, j, k, l, vmin);
+      _Max->PutAsDouble(i, j, k, l, vmax);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Shape based interpolation of each threshold of the input image
+///
+/// The signed distance map of each thresholded input image is computed only
+/// within the bounding box of the voxels above the threshold plus a margin,
+/// and it is only interpolated at resampled voxels whose interpolation stencil
+/// contains input values both below and above the threshold. The highest
+/// threshold for which a resampled voxel is inside the shape is kept, which
+/// is equivalent to processing the thresholds in increasing order. Bodies
+/// handle different thresholds in parallel and are combined by max-reduction.
+class ShapeBasedThresholds
+{
+  typedef EuclideanDistanceTransform<RealPixel> DistanceTransformType;
+
+  /// Margin of input voxels around bounding box for which distances are computed
+  static const int _BoxMargin = 4;
+
+  /// Margin of input voxels around bounding box within which distances are resampled
+  static const int _MapMargin = 3;
+
+  const BaseImage                   *_Input;
+  const RealImage                   *_Output;
+  const RealImage                   *_Min;
+  const RealImage                   *_Max;
+  const Array<double>               *_Threshold;
+  const Array<ThresholdBoundingBox> *_BoundingBox;
+  const Array<double>               *_OutputX;
+  const Array<double>               *_OutputY;
+  const Array<double>               *_OutputZ;
+
+  // Scratch images of this body, reused for each threshold
+  RealImage _InputA, _InputB, _OutputA, _OutputB;
+  RealImage _DistanceMap;
+  RealImage _ResampledDistanceMap;
+  LinearInterpolateImageFunction _Interpolator;
+
+  // Input region of _DistanceMap and output region of _ResampledDistanceMap
+  int _bi1, _bj1, _bk1, _bi2, _bj2, _bk2;
+  int _ri1, _rj1, _rk1;
+
+public:
+
+  /// Highest threshold for which resampled voxel is inside the shape
+  RealImage _Label;
+
+  ShapeBasedThresholds(const BaseImage *input, const RealImage *output,
+                       const RealImage *vmin, const RealImage *vmax,
+                       const Array<double> *threshold,
+                       const Array<ThresholdBoundingBox> *bbox,
+                       const Array<double> *x, const Array<double> *y, const Array<double> *z)
+  :
+    _Input(input), _Output(output), _Min(vmin), _Max(vmax),
+    _Threshold(threshold), _BoundingBox(bbox),
+    _OutputX(x), _OutputY(y), _OutputZ(z)
+  {}
+
+  ShapeBasedThresholds(const ShapeBasedThresholds &other, split)
+  :
+    _Input(other._Input), _Output(other._Output),
+    _Min(other._Min), _Max(other._Max),
+    _Threshold(other._Threshold), _BoundingBox(other._BoundingBox),
+    _OutputX(other._OutputX), _OutputY(other._OutputY), _OutputZ(other._OutputZ)
+  {}
+
+  void join(ShapeBasedThresholds &other)
+  {
+    if (other._Label.IsEmpty()) return;
+    if (_Label.IsEmpty()) {
+      _Label = other._Label;
+      return;
+    }
+    const int n = _Label.NumberOfVoxels();
+    RealPixel       *label = _Label.Data();
+    const RealPixel *value = other._Label.Data();
+    for (int idx = 0; idx < n; ++idx) {
+      if (value[idx] > label[idx]) label[idx] = value[idx];
+    }
+  }
+
+  void operator ()(const blocked_range<int> &re)
+  {
+    for (int n = re.begin(); n != re.end(); ++n) Process(n);
+  }
+
+private:
+
+  /// Range of output indices whose input coordinates lie within [a, b]
+  static void OutputRange(const Array<double> &x, double a, double b, int &i1, int &i2)
+  {
+    const int n = static_cast<int>(x.size());
+    i1 = 0;
+    while (i1 < n && x[i1] < a) ++i1;
+    i2 = n - 1;
+    while (i2 >= i1 && x[i2] > b) --i2;
+  }
+
+  /// Interpolated signed distance at resampled voxel, computed on first use
+  ///
+  /// The distance map of the bounding box is interpolated at the input voxel
+  /// coordinates relative to the box, such that the interpolation weights are
+  /// identical to those of a distance map of the entire image. Coordinates
+  /// beyond a side of the box which is not at the image boundary are clamped
+  /// to the box, where the distance to the shape is positive.
+  double Distance(int i, int j, int k, int l)
+  {
+    RealPixel &d = _ResampledDistanceMap(i - _ri1, j - _rj1, k - _rk1, l);
+    if (IsNaN(d)) {
+      double x = i, y = j, z = k;
+      _Output->ImageToWorld(x, y, z);
+      _Input ->WorldToImage(x, y, z);
+      x -= _bi1, y -= _bj1, z -= _bk1;
+      if (_bi1 > 0)                 x = max(x, .0);
+      if (_bj1 > 0)                 y = max(y, .0);
+      if (_bk1 > 0)                 z = max(z, .0);
+      if (_bi2 < _Input->X() - 1) x = min(x, static_cast<double>(_bi2 - _bi1));
+      if (_bj2 < _Input->Y() - 1) y = min(y, static_cast<double>(_bj2 - _bj1));
+      if (_bk2 < _Input->Z() - 1) z = min(z, static_cast<double>(_bk2 - _bk1));
+      d = static_cast<RealPixel>(_Interpolator.Evaluate(x, y, z, l));
+    }
+    return d;
+  }
+
+  void Process(int n)
+  {
+    const double current = (*_Threshold)[n];
+    const ThresholdBoundingBox &bbox = (*_BoundingBox)[n];
+    int i, j, k, l;
+
+    // Output region within which interpolated distances may be non-positive
+    int ri1, ri2, rj1, rj2, rk1, rk2;
+    OutputRange(*_OutputX, bbox.i1 - _MapMargin, bbox.i2 + _MapMargin, ri1, ri2);
+    OutputRange(*_OutputY, bbox.j1 - _MapMargin, bbox.j2 + _MapMargin, rj1, rj2);
+    OutputRange(*_OutputZ, bbox.k1 - _MapMargin, bbox.k2 + _MapMargin, rk1, rk2);
+    if (ri2 < ri1 || rj2 < rj1 || rk2 < rk1) return;
+
+    // Input region for which signed distances are computed
+    _bi1 = max(0,               bbox.i1 - _BoxMargin);
+    _bj1 = max(0,               bbox.j1 - _BoxMargin);
+    _bk1 = max(0,               bbox.k1 - _BoxMargin);
+    _bi2 = min(_Input->X() - 1, bbox.i2 + _BoxMargin);
+    _bj2 = min(_Input->Y() - 1, bbox.j2 + _BoxMargin);
+    _bk2 = min(_Input->Z() - 1, bbox.k2 + _BoxMargin);
+
+    ImageAttributes box = _Input->Attributes();
+    box._x = _bi2 - _bi1 + 1;
+    box._y = _bj2 - _bj1 + 1;
+    box._z = _bk2 - _bk1 + 1;
+    box._xorigin = .5 * (_bi1 + _bi2);
+    box._yorigin = .5 * (_bj1 + _bj2);
+    box._zorigin = .5 * (_bk1 + _bk2);
+    _Input->ImageToWorld(box._xorigin, box._yorigin, box._zorigin);
+
+    // Threshold image
+    _InputA.Initialize(box);
+    _InputB.Initialize(box);
+    for (l = 0; l < box._t; ++l)
+    for (k = 0; k < box._z; ++k)
+    for (j = 0; j < box._y; ++j)
+    for (i = 0; i < box._x; ++i) {
+      if (_Input->GetAsDouble(_bi1 + i, _bj1 + j, _bk1 + k, l) < current) {
+        _InputA(i, j, k, l) = 0;
+        _InputB(i, j, k, l) = 1;
+      } else {
+        _InputA(i, j, k, l) = 1;
+        _InputB(i, j, k, l) = 0;
+      }
+    }
+
+    // Calculate EDT
+    DistanceTransformType edt(DistanceTransformType::DT_3D);
+    edt.Input (&_InputA);
+    edt.Output(&_OutputA);
+    edt.Run();
+    edt.Input (&_InputB);
+    edt.Output(&_OutputB);
+    edt.Run();
+
+    // Signed distance map of input box
+    _DistanceMap.Initialize(box);
+    const int nbox = _DistanceMap.NumberOfVoxels();
+    const RealPixel *a = _OutputA.Data();
+    const RealPixel *b = _OutputB.Data();
+    RealPixel       *d = _DistanceMap.Data();
+    for (int idx = 0; idx < nbox; ++idx) {
+      d[idx] = sqrt(a[idx]) - sqrt(b[idx]);
+    }
+
+    // Linear Interpolate distance map where needed, including the neighbors
+    // of the output region which vote when the distance is zero
+    const int X = _Output->X(), Y = _Output->Y(), Z = _Output->Z();
+    _Interpolator.Input(&_DistanceMap);
+    _Interpolator.Initialize();
+
+    _ri1 = max(0, ri1 - 1);
+    _rj1 = max(0, rj1 - 1);
+    _rk1 = max(0, rk1 - 1);
+    _ResampledDistanceMap.Initialize(min(X - 1, ri2 + 1) - _ri1 + 1,
+                                     min(Y - 1, rj2 + 1) - _rj1 + 1,
+                                     min(Z - 1, rk2 + 1) - _rk1 + 1, _Output->T());
+    _ResampledDistanceMap = numeric_limits<RealPixel>::quiet_NaN();
+
+    // Label resampled voxels inside the shape, if zero let the neighbor vote.
+    double dist, sum, sumcount;
+    for (l = 0; l < _Output->T(); ++l)
+    for (k = rk1; k <= rk2; ++k)
+    for (j = rj1; j <= rj2; ++j)
+    for (i = ri1; i <= ri2; ++i) {
+      if (current <= _Min->Get(i, j, k, l) || current > _Max->Get(i, j, k, l)) continue;
+      dist = Distance(i, j, k, l);
+      if (dist > .0) continue;
+      if (dist == .0) {
+        sum = .0, sumcount = .0;
+        if (i > 0) {
+          sum += Distance(i-1, j, k, l);
+          ++sumcount;
+        } else if (i < X - 1) {
+          sum += Distance(i+1, j, k, l);
+          ++sumcount;
+        }
+        if (j > 0) {
+          sum += Distance(i, j-1, k, l);
+          ++sumcount;
+        } else if (j < Y - 1) {
+          sum += Distance(i, j+1, k, l);
+          ++sumcount;
+        }
+        if (k > 0) {
+          sum += Distance(i, j, k-1, l);
+          ++sumcount;
+        } else if (k < Z - 1) {
+          sum += Distance(i, j, k+1, l);
+          ++sumcount;
+        }
+        sum = sum/sumcount;
+        if (sum > .0) continue;
+      }
+      if (_Label.IsEmpty()) {
+        _Label.Initialize(_Output->Attributes());
+        _Label = -numeric_limits<RealPixel>::infinity();
+      }
+      if (current > _Label(i, j, k, l)) _Label(i, j, k, l) = static_cast<RealPixel>(current);
+    }
+  }
+};
+
+
+} // namespace ShapeBasedInterpolateImageFunctionUtils
+
+using namespace ShapeBasedInterpolateImageFunctionUtils;
+
 // =============================================================================
 // Construction/Destruction
 // =============================================================================
@@ -210,8 +549,6 @@ void ShapeBasedInterpolateImageFunction::Refine()
 // ----------------------------------------------------------------------------
 void ShapeBasedInterpolateImageFunction::Initialize(bool coeff)
 {
-  typedef EuclideanDistanceTransform<RealPixel> DistanceTransformType;
-
   // Initialize base class
   InterpolateImageFunction::Initialize(coeff);
 
@@ -220,7 +557,7 @@ void ShapeBasedInterpolateImageFunction::Initialize(bool coeff)
   double xaxis[3], yaxis[3], zaxis[3];
   double new_xsize, new_ysize, new_zsize;
   double old_xsize, old_ysize, old_zsize;
-  double min, max, current, sum, sumcount;
+  double min, max, current;
 
   // Determine minimum voxel size
   Input()->GetPixelSize(&xsize, &ysize, &zsize);
@@ -230,10 +567,6 @@ void ShapeBasedInterpolateImageFunction::Initialize(bool coeff)
   if (size > 1) size = 1;
   cerr << "Create images with isotropic voxel size (in mm): "<< size << endl;
 
-  // Create _rinput _rdmap
-  _dmap   = RealImage(Input()->Attributes());
-  _tinput = RealImage(Input()->Attributes());
-
   // Determine the old dimensions of the image
   Input()->GetPixelSize(&old_xsize, &old_ysize, &old_zsize);
 
@@ -264,160 +597,119 @@ void ShapeBasedInterpolateImageFunction::Initialize(bool coeff)
 
   // Allocate new image
   _rinput = RealImage(new_x, new_y, new_z, Input()->T());
-  _rdmap  = RealImage(new_x, new_y, new_z, Input()->T());
-  _rcdmap = RealImage(new_x, new_y, new_z, Input()->T());
 
   // Set new voxel size
   _rinput.PutPixelSize(new_xsize, new_ysize, new_zsize);
-  _rdmap .PutPixelSize(new_xsize, new_ysize, new_zsize);
-  _rcdmap.PutPixelSize(new_xsize, new_ysize, new_zsize);
 
   // Set new orientation
   Input()->GetOrientation(xaxis, yaxis, zaxis);
   _rinput.PutOrientation(xaxis, yaxis, zaxis);
-  _rdmap .PutOrientation(xaxis, yaxis, zaxis);
-  _rcdmap.PutOrientation(xaxis, yaxis, zaxis);
 
   // Set new origin
   _rinput.PutOrigin(Input()->GetOrigin());
-  _rdmap .PutOrigin(Input()->GetOrigin());
-  _rcdmap.PutOrigin(Input()->GetOrigin());
 
   // For every intensity value
   Input()->GetMinMaxAsDouble(&min, &max);
 
-  labelcount = 0;
+  // Count input voxels in [current, current + 1) and determine their bounding box
+  Array<int>                  count;
+  Array<ThresholdBoundingBox> bbox;
   for (current = min; current <= max; ++current) {
-    // Threshold
-    sumcount = .0;
-    for (l = 0; l < _tinput.T(); ++l)
-    for (k = 0; k < _tinput.Z(); ++k)
-    for (j = 0; j < _tinput.Y(); ++j)
-    for (i = 0; i < _tinput.X(); ++i) {
-      if (Input()->GetAsDouble(i, j, k, l) < current /* || Input()->GetAsDouble(i, j, k, l) > current */) {
-        _tinput(i, j, k, l) = 0;
-      } else {
-        _tinput(i, j, k, l) = 1;
-      }
-      if (Input()->GetAsDouble(i, j, k, l) >= current &&
-          Input()->GetAsDouble(i, j, k, l) <  current + 1.0) {
-        ++sumcount;
-      }
-    }
-
-    if (verbose && iround(current) % 20 == 0) {
-      if (max < current + 19.0) {
-        cout << "Doing outside DT for value >= : "<< current << " to " << max << endl;
-        cout << "Doing inside  DT for value >= : "<< current << " to " << max << endl;
-      } else {
-        cout << "Doing outside DT for value >= : "<< current << " to " << current + 19.0 << endl;
-        cout << "Doing inside  DT for value >= : "<< current << " to " << current + 19.0 << endl;
+    count.push_back(0);
+    bbox .push_back(ThresholdBoundingBox());
+  }
+  const int nbins = static_cast<int>(count.size());
+  for (l = 0; l < Input()->T(); ++l)
+  for (k = 0; k < Input()->Z(); ++k)
+  for (j = 0; j < Input()->Y(); ++j)
+  for (i = 0; i < Input()->X(); ++i) {
+    const double value = Input()->GetAsDouble(i, j, k, l);
+    if (min <= value) {
+      const int n = static_cast<int>(value - min);
+      if (n < nbins) {
+        ++count[n];
+        bbox[n].Add(i, j, k);
       }
     }
+  }
 
-    if (sumcount > .0) {
+  // Thresholds with non-empty interval and bounding box of voxels above them
+  Array<double>               threshold;
+  Array<ThresholdBoundingBox> threshold_bbox;
+  ThresholdBoundingBox        above;
+  for (int n = nbins - 1; n >= 0; --n) {
+    above.Add(bbox[n]);
+    bbox[n] = above;
+  }
+  labelcount = 0;
+  current    = min;
+  for (int n = 0; n < nbins; ++n, ++current) {
+    if (count[n] > 0) {
+      threshold     .push_back(current);
+      threshold_bbox.push_back(bbox[n]);
       ++labelcount;
-      // Dmap _tinput to _dmap
-      {
-        RealImage inputA, inputB, outputA, outputB;
-
-        // Default mode
-        DistanceTransformType edt(DistanceTransformType::DT_3D);
-
-        // Threshold image
-        inputA = _tinput;
-        inputB = _tinput;
-        for (l = 0; l < _tinput.T(); ++l)
-        for (k = 0; k < _tinput.Z(); ++k)
-        for (j = 0; j < _tinput.Y(); ++j)
-        for (i = 0; i < _tinput.X(); ++i) {
-          if (_tinput(i, j, k, l) > .5) {
-            inputA(i, j, k, l) = 1;
-            inputB(i, j, k, l) = 0;
-          } else {
-            inputA(i, j, k, l) = 0;
-            inputB(i, j, k, l) = 1;
-          }
-        }
-
-        // Calculate EDT
-        edt.Input (& inputA);
-        edt.Output(&outputA);
-        edt.Run();		  
-        edt.Input (& inputB);
-        edt.Output(&outputB);
-        edt.Run();
-
-        for (l = 0; l < _tinput.T(); ++l)
-        for (k = 0; k < _tinput.Z(); ++k)
-        for (j = 0; j < _tinput.Y(); ++j)
-        for (i = 0; i < _tinput.X(); ++i) {
-          _dmap(i, j, k, l)  = sqrt(outputA(i, j, k, l)) - sqrt(outputB(i, j, k, l));
-        }
-      }
-
-      // Linear Interpolate Dmap _dmap to _rdmap
-      {
-        double x, y, z, t;
-        LinearInterpolateImageFunction interpolator;
-        interpolator.Input(&_dmap);
-        interpolator.Initialize();
-
-        for (l = 0; l < _rdmap.T(); ++l)
-        for (k = 0; k < _rdmap.Z(); ++k)
-        for (j = 0; j < _rdmap.Y(); ++j)
-        for (i = 0; i < _rdmap.X(); ++i) {
-          x = i, y = j, z = k, t = l;
-          _rdmap.ImageToWorld(x, y, z);
-          _dmap .WorldToImage(x, y, z);
-          _rdmap.PutAsDouble(i, j, k, l, interpolator.Evaluate(x, y, z, t));
-        }
-      }
-
-      // Put value back to Resampled Image _rinput < 0 if _rinput == 0 let the neighbor vote.
-      {
-        for (l = 0; l < _rdmap.T(); ++l)
-        for (k = 0; k < _rdmap.Z(); ++k)
-        for (j = 0; j < _rdmap.Y(); ++j)
-        for (i = 0; i < _rdmap.X(); ++i) {
-          if (_rdmap.GetAsDouble(i, j, k, l) < .0) {
-            _rinput.PutAsDouble(i, j, k, l, current);
-          } else if (_rdmap.GetAsDouble(i, j, k, l) <= .0) {
-            sum = .0, sumcount = .0;
-            if (i > 0) {
-              sum += _rdmap.GetAsDouble(i-1, j, k, l);
-              ++sumcount;
-            } else if (i < _rinput.X() - 1) {
-              sum += _rdmap.GetAsDouble(i+1, j, k, l);
-              ++sumcount;
-            }
-            if (j > 0) {
-              sum += _rdmap.GetAsDouble(i, j-1, k, l);
-              ++sumcount;
-            } else if (j < _rinput.Y() - 1) {
-              sum += _rdmap.GetAsDouble(i, j+1, k, l);
-              ++sumcount;
-            }
-            if (k > 0) {
-              sum += _rdmap.GetAsDouble(i, j, k-1, l);
-              ++sumcount;
-            } else if (k < _rinput.Z() - 1) {
-              sum += _rdmap.GetAsDouble(i, j, k+1, l);
-              ++sumcount;
-            }
-            sum = sum/sumcount;
-            if (sum <= .0) {
-              _rinput.PutAsDouble(i, j, k, l, current);
-            }
-          }
-        }
-      }
     }
+  }
+  if (verbose) {
+    cout << "Doing outside and inside DT for " << labelcount << " values from " << min << " to " << max << endl;
+  }
 
-  } // End for
+  // Input voxel coordinates of resampled image columns, rows, and slices
+  Array<double> rx(_rinput.X()), ry(_rinput.Y()), rz(_rinput.Z());
+  for (i = 0; i < _rinput.X(); ++i) {
+    double x = i, y = 0, z = 0;
+    _rinput .ImageToWorld(x, y, z);
+    Input()->WorldToImage(x, y, z);
+    rx[i] = x;
+  }
+  for (j = 0; j < _rinput.Y(); ++j) {
+    double x = 0, y = j, z = 0;
+    _rinput .ImageToWorld(x, y, z);
+    Input()->WorldToImage(x, y, z);
+    ry[j] = y;
+  }
+  for (k = 0; k < _rinput.Z(); ++k) {
+    double x = 0, y = 0, z = k;
+    _rinput .ImageToWorld(x, y, z);
+    Input()->WorldToImage(x, y, z);
+    rz[k] = z;
+  }
+
+  // Range of input values used to interpolate each resampled voxel
+  RealImage vmin(_rinput.Attributes()), vmax(_rinput.Attributes());
+  StencilRange range;
+  range._Input  = Input();
+  range._Output = &_rinput;
+  range._Min    = &vmin;
+  range._Max    = &vmax;
+  parallel_for(blocked_range<int>(0, _rinput.Z()), range);
+
+  // Compute and resample signed distance maps of each threshold in parallel
+  // where the interpolation stencil is not entirely inside or outside the shape
+  ShapeBasedThresholds body(Input(), &_rinput, &vmin, &vmax, &threshold, &threshold_bbox, &rx, &ry, &rz);
+  parallel_reduce(blocked_range<int>(0, labelcount), body);
+
+  // Put highest threshold back to resampled image _rinput
+  const int nvox = _rinput.NumberOfVoxels();
+  const RealPixel *label = (body._Label.IsEmpty() ? NULL : body._Label.Data());
+  RealPixel       *value = _rinput.Data();
+  for (int idx = 0; idx < nvox; ++idx) {
+    // Highest threshold whose shape contains the entire interpolation stencil
+    const double m = vmin(idx);
+    int n = static_cast<int>(upper_bound(threshold.begin(), threshold.end(), m) - threshold.begin());
+    double v = (n > 0 ? threshold[n - 1] : .0);
+    if (label && label[idx] > v) v = label[idx];
+    value[idx] = static_cast<RealPixel>(v);
+  }
 
   // Refine to fix the union property
-  if (labelcount > 3 && labelcount < 50) Refine();
+  if (labelcount > 3 && labelcount < 50) {
+    _dmap   = RealImage(Input()->Attributes());
+    _tinput = RealImage(Input()->Attributes());
+    _rdmap  = RealImage(_rinput.Attributes());
+    _rcdmap = RealImage(_rinput.Attributes());
+    Refine();
+  }
 
   // Instantiate internal interpolator
   BaseImage *input = &_rinput;
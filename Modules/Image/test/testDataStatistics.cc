@@ -0,0 +1,136 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "mirtk/Array.h"
+#include "mirtk/Algorithm.h"
+#include "mirtk/DataStatistics.h"
+
+using namespace mirtk;
+using namespace mirtk::data::statistic;
+
+// ===========================================================================
+// Auxiliaries
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+/// Percentile of sorted values according to NIST method
+double SortedPercentile(const Array<double> &v, int p)
+{
+  const int    m    = static_cast<int>(v.size());
+  const double rank = (double(p) / 100.0) * double(m + 1);
+  const int    k    = int(rank);
+  if (k == 0) return v.front();
+  if (k >= m) return v.back();
+  return v[k-1] + (rank - k) * (v[k] - v[k-1]);
+}
+
+// ---------------------------------------------------------------------------
+/// Data values with non-finite values inserted in between
+Array<double> DataWithNonFiniteValues(const Array<double> &v)
+{
+  const double nan = numeric_limits<double>::quiet_NaN();
+  const double inf = numeric_limits<double>::infinity();
+  Array<double> data;
+  for (size_t i = 0; i < v.size(); ++i) {
+    if      (i % 7 == 0) data.push_back(nan);
+    else if (i % 7 == 3) data.push_back( inf);
+    else if (i % 7 == 5) data.push_back(-inf);
+    data.push_back(v[i]);
+  }
+  data.push_back(nan);
+  return data;
+}
+
+// ===========================================================================
+// Tests
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+TEST(Percentile, IntegralValues)
+{
+  Array<double> v;
+  for (int i = 0; i < 100; ++i) v.push_back(double((37 * i) % 50));
+  Array<double> data = v;
+  sort(v.begin(), v.end());
+  const int n = static_cast<int>(data.size());
+  for (int p = 0; p <= 100; p += 5) {
+    EXPECT_DOUBLE_EQ(SortedPercentile(v, p), Percentile::Calculate(p, n, data.data()));
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(Percentile, RealValues)
+{
+  Array<double> v;
+  for (int i = 0; i < 1000; ++i) v.push_back(sin(.1 * i) * exp(.001 * i));
+  Array<double> data = v;
+  sort(v.begin(), v.end());
+  const int n = static_cast<int>(data.size());
+  for (int p = 0; p <= 100; p += 5) {
+    EXPECT_DOUBLE_EQ(SortedPercentile(v, p), Percentile::Calculate(p, n, data.data()));
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(Percentile, IgnoreNonFiniteIntegralValues)
+{
+  Array<double> v;
+  for (int i = 0; i < 100; ++i) v.push_back(double((37 * i) % 50));
+  Array<double> data = DataWithNonFiniteValues(v);
+  sort(v.begin(), v.end());
+  const int n = static_cast<int>(data.size());
+  for (int p = 0; p <= 100; p += 5) {
+    EXPECT_DOUBLE_EQ(SortedPercentile(v, p), Percentile::Calculate(p, n, data.data()));
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(Percentile, IgnoreNonFiniteRealValues)
+{
+  Array<double> v;
+  for (int i = 0; i < 1000; ++i) v.push_back(sin(.1 * i) * exp(.001 * i));
+  Array<double> data = DataWithNonFiniteValues(v);
+  sort(v.begin(), v.end());
+  const int n = static_cast<int>(data.size());
+  for (int p = 0; p <= 100; p += 5) {
+    EXPECT_DOUBLE_EQ(SortedPercentile(v, p), Percentile::Calculate(p, n, data.data()));
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(Percentile, OnlyNonFiniteValues)
+{
+  const double nan = numeric_limits<double>::quiet_NaN();
+  const double inf = numeric_limits<double>::infinity();
+  const double data[] = { nan, inf, -inf, nan };
+  EXPECT_TRUE(IsNaN(Percentile::Calculate(50, 4, data)));
+}
+
+// ===========================================================================
+// Main
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,216 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "mirtk/GenericImage.h"
+#include "mirtk/HashImage.h"
+
+using namespace mirtk;
+
+// ===========================================================================
+// Auxiliaries
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+/// Set some voxels of image whose size is not a multiple of the block size
+void InitializeTestImage(HashGreyImage &image, GreyImage &ref)
+{
+  ImageAttributes attr;
+  attr._x = 11, attr._y = 7, attr._z = 5, attr._t = 2;
+  image.Initialize(attr);
+  ref  .Initialize(attr);
+  for (int idx = 0; idx < image.NumberOfVoxels(); idx += 3) {
+    const GreyPixel value = static_cast<GreyPixel>(idx % 5);
+    image.Put(idx, value);
+    ref  .Put(idx, value);
+  }
+}
+
+// ---------------------------------------------------------------------------
+/// Count voxels whose value differs from the default value
+int CountNonDefaultVoxels(const HashGreyImage &image)
+{
+  int n = 0;
+  for (int idx = 0; idx < image.NumberOfVoxels(); ++idx) {
+    if (image.Get(idx) != image.DefaultValue()) ++n;
+  }
+  return n;
+}
+
+// ---------------------------------------------------------------------------
+/// Compare hash image to generic image voxel by voxel
+void ExpectEqualImages(const GreyImage &ref, const HashGreyImage &image)
+{
+  ASSERT_EQ(ref.NumberOfVoxels(), image.NumberOfVoxels());
+  for (int l = 0; l < ref.T(); ++l)
+  for (int k = 0; k < ref.Z(); ++k)
+  for (int j = 0; j < ref.Y(); ++j)
+  for (int i = 0; i < ref.X(); ++i) {
+    EXPECT_EQ(ref(i, j, k, l), image.Get(i, j, k, l));
+    EXPECT_EQ(ref(i, j, k, l), image.Get(ref.VoxelToIndex(i, j, k, l)));
+  }
+  EXPECT_EQ(CountNonDefaultVoxels(image), image.NumberOfNonDefaultVoxels());
+}
+
+// ===========================================================================
+// Tests
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, PutGet)
+{
+  HashGreyImage image;
+  GreyImage     ref;
+  InitializeTestImage(image, ref);
+  ExpectEqualImages(ref, image);
+  // Reset voxel to default value
+  image.Put(3, 0);
+  ref  .Put(3, 0);
+  image.Put(3, 0);
+  ExpectEqualImages(ref, image);
+  // Overwrite non-default value
+  image.Put(6, 4, 1, 1, 7);
+  ref  .Put(6, 4, 1, 1, 7);
+  image.Put(6, 4, 1, 1, 8);
+  ref  .Put(6, 4, 1, 1, 8);
+  ExpectEqualImages(ref, image);
+}
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, OutsideImage)
+{
+  HashGreyImage image(11, 7, 5);
+  image.Put(-1, 1);
+  image.Put(image.NumberOfVoxels(), 1);
+  image.Put(11, 0, 0, 1);
+  image.Put(0, 7, 0, 1);
+  image.Put(0, 0, 5, 1);
+  image.Put(0, 0, 0, 1, 1);
+  image.Put(-1, 0, 0, 1);
+  EXPECT_EQ(0, image.NumberOfNonDefaultVoxels());
+  EXPECT_EQ(0, image.NumberOfAllocatedBlocks());
+  EXPECT_EQ(0, image.Get(-1));
+  EXPECT_EQ(0, image.Get(image.NumberOfVoxels()));
+  EXPECT_EQ(0, image.Get(11, 0, 0));
+  EXPECT_EQ(0, image.Get(0, 0, 0, 1));
+  EXPECT_EQ(0, image.Get(0, -1, 0));
+}
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, DefaultValue)
+{
+  HashGreyImage image;
+  GreyImage     ref;
+  InitializeTestImage(image, ref);
+  image.DefaultValue(2);
+  for (int idx = 0; idx < ref.NumberOfVoxels(); ++idx) {
+    if (ref.Get(idx) == 0) ref.Put(idx, 2);
+  }
+  ExpectEqualImages(ref, image);
+  image.DefaultValue(-1);
+  for (int idx = 0; idx < ref.NumberOfVoxels(); ++idx) {
+    if (ref.Get(idx) == 2) ref.Put(idx, -1);
+  }
+  ExpectEqualImages(ref, image);
+  image = GreyPixel(4);
+  ref   = GreyPixel(4);
+  ExpectEqualImages(ref, image);
+  EXPECT_EQ(0, image.NumberOfNonDefaultVoxels());
+}
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, ScalarArithmetic)
+{
+  HashGreyImage image;
+  GreyImage     ref;
+  InitializeTestImage(image, ref);
+  image += 3, ref += 3;
+  ExpectEqualImages(ref, image);
+  image -= 1, ref -= 1;
+  ExpectEqualImages(ref, image);
+  image *= 2, ref *= 2;
+  ExpectEqualImages(ref, image);
+  image /= 2, ref /= 2;
+  ExpectEqualImages(ref, image);
+  image *= 0, ref *= 0;
+  ExpectEqualImages(ref, image);
+  EXPECT_EQ(0, image.NumberOfNonDefaultVoxels());
+}
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, Copy)
+{
+  HashGreyImage image;
+  GreyImage     ref;
+  InitializeTestImage(image, ref);
+  image.DefaultValue(1);
+  for (int idx = 0; idx < ref.NumberOfVoxels(); ++idx) {
+    if (ref.Get(idx) == 0) ref.Put(idx, 1);
+  }
+  {
+    HashGreyImage copy(image);
+    EXPECT_EQ(image.DefaultValue(), copy.DefaultValue());
+    ExpectEqualImages(ref, copy);
+  }
+  {
+    HashGreyImage copy;
+    copy = image;
+    ExpectEqualImages(ref, copy);
+  }
+  {
+    HashGreyImage copy(ref);
+    ExpectEqualImages(ref, copy);
+  }
+  {
+    GreyImage copy;
+    image.CopyTo(copy);
+    for (int idx = 0; idx < ref.NumberOfVoxels(); ++idx) {
+      EXPECT_EQ(ref.Get(idx), copy.Get(idx));
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(HashImage, Iteration)
+{
+  HashGreyImage image;
+  GreyImage     ref;
+  InitializeTestImage(image, ref);
+  int n = 0;
+  for (HashGreyImage::DataIterator it = image.Begin(); it != image.End(); ++it, ++n) {
+    ASSERT_GE(it->first, 0);
+    ASSERT_LT(it->first, ref.NumberOfVoxels());
+    EXPECT_NE(image.DefaultValue(), it->second);
+    EXPECT_EQ(ref.Get(it->first), it->second);
+  }
+  EXPECT_EQ(image.NumberOfNonDefaultVoxels(), n);
+  EXPECT_EQ(CountNonDefaultVoxels(image), n);
+}
+
+// ===========================================================================
+// Main
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
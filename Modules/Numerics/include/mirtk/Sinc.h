@@ -60,6 +60,11 @@ public:
   /// Lookup Sinc function value
   MIRTKCU_API static Real Lookup(TReal);
 
+  /// Lookup Sinc function values at the KernelSize discrete positions
+  /// c - Radius, ..., c + Radius, given the offset x - c of the continuous
+  /// position x from the kernel center c
+  MIRTKCU_API static void Weights(TReal, TReal *);
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,6 +78,15 @@ inline TReal Sinc<TReal>::Lookup(TReal x)
   return LookupTable[iround(abs(x) * LookupTableSize)];
 }
 
+// -----------------------------------------------------------------------------
+template <class TReal>
+inline void Sinc<TReal>::Weights(TReal x, TReal *w)
+{
+  for (int a = 0; a < KernelSize; ++a) {
+    w[a] = Lookup(x + TReal(Radius - a));
+  }
+}
+
 
 } // namespace mirtk
 
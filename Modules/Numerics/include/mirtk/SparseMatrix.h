@@ -427,6 +427,38 @@ public:
   int Eigenvectors(Matrix &E, Vector &v, int k, const char *sigma = "LM",
                    int p = 0, double tol = .0, int maxit = 0, Vector *v0 = NULL) const;
 
+  /// Smallest eigenvalues and -vectors of self-adjoint matrix
+  ///
+  /// Uses the Locally Optimal Block Preconditioned Conjugate Gradient (LOBPCG)
+  /// method with Jacobi preconditioner to compute the eigenvectors corresponding
+  /// to the \p k algebraically smallest eigenvalues. The matrix A must be
+  /// self-adjoint with respect to the inner product <x, y> = x^T diag(b) y,
+  /// i.e., diag(b) A must be symmetric. This is for example the case for the
+  /// normalized graph Laplacian D^-1 (D - A) with b equal to the node degrees.
+  ///
+  /// Unlike ARPACK in shift-and-invert mode, this solver requires no matrix
+  /// factorization, evaluates the sparse matrix-vector products in parallel,
+  /// and can be initialized with approximate eigenvectors, e.g., those of a
+  /// similar matrix computed before.
+  ///
+  /// \param[out] E     Matrix of eigenvectors in columns. The eigenvectors are
+  ///                   normalized such that E^T diag(b) E = I.
+  /// \param[out] v     Eigenvalues in ascending order.
+  /// \param[in]  k     Number of requested eigenvalues.
+  /// \param[in]  b     Weights of inner product. If \c NULL, the matrix must be symmetric.
+  /// \param[in]  E0    Initial eigenvectors in columns, missing columns are
+  ///                   initialized with random vectors. Can be identical to \p E.
+  /// \param[in]  tol   Residual norm <= tol * max(1, |eigenvalue|).
+  /// \param[in]  maxit Maximum number of iterations.
+  ///
+  /// \returns Number of converged eigenvalues. Only the first eigenvectors up
+  ///          to this number have converged, though all \p k are returned.
+  ///          Zero and empty \p E and \p v if the weights \p b are not positive.
+  ///
+  /// \note Only implemented for real double precision sparse matrices.
+  int SmallestEigenvectors(Matrix &E, Vector &v, int k, const Vector *b = NULL,
+                           const Matrix *E0 = NULL, double tol = .0, int maxit = 0) const;
+
   // ---------------------------------------------------------------------------
   // I/O
 #if MIRTK_Numerics_WITH_MATLAB && defined(HAVE_MATLAB)
@@ -1653,7 +1685,7 @@ void GenericSparseMatrix<TEntry>::MultAv(TEntry v[], TEntry w[]) const
       for (int r = 0; r < _Rows; ++r) w[r] = zero;
       for (int c = 0; c < _Cols; ++c) {
         for (int i = _Col[c]; i != _Col[c+1]; ++i) {
-          w[_Row[c]] += _Data[i] * v[c];
+          w[_Row[i]] += _Data[i] * v[c];
         }
       }
     }
@@ -18,6 +18,7 @@
  */
 
 #include "mirtk/SparseMatrix.h"
+#include "mirtk/Parallel.h"
 
 #if MIRTK_Numerics_WITH_eigs
 #  include "mirtk/Arpack.h"
@@ -27,6 +28,7 @@
 #endif // MIRTK_Numerics_WITH_eigs
 
 #include <algorithm>
+#include <random>
 
 
 namespace mirtk {
@@ -300,6 +302,438 @@ int eigs(const GenericSparseMatrix<double> &A, Matrix *E, Vector &v,
   return nconv;
 }
 
+// =============================================================================
+// Block eigen solver
+// =============================================================================
+
+namespace SparseMatrixUtils {
+
+
+// -----------------------------------------------------------------------------
+/// Multiply CRS matrix by block of column vectors, i.e., Y = A X
+struct MultiplyBlock
+{
+  const int    *_Row;
+  const int    *_Col;
+  const double *_Data;
+  const double *_X;
+  double       *_Y;
+  size_t        _N;
+  int           _M;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    double y;
+    for (int r = re.begin(); r != re.end(); ++r) {
+      for (size_t c = 0, o = 0; c < static_cast<size_t>(_M); ++c, o += _N) {
+        y = .0;
+        for (int i = _Row[r]; i != _Row[r+1]; ++i) {
+          y += _Data[i] * _X[o + _Col[i]];
+        }
+        _Y[o + r] = y;
+      }
+    }
+  }
+
+  static void Run(const Array<int> &row, const Array<int> &col, const Array<double> &data,
+                  const double *X, double *Y, int n, int m)
+  {
+    MultiplyBlock body;
+    body._Row  = row .data();
+    body._Col  = col .data();
+    body._Data = data.data();
+    body._X    = X;
+    body._Y    = Y;
+    body._N    = static_cast<size_t>(n);
+    body._M    = m;
+    parallel_for(blocked_range<int>(0, n, 256), body);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Weighted inner products of two blocks of column vectors, i.e., G = X^T diag(b) Y
+struct BlockInnerProduct
+{
+  const double  *_X;
+  const double  *_Y;
+  const double  *_B;
+  size_t         _N;
+  int            _P;
+  int            _Q;
+  Array<double>  _G;
+
+  BlockInnerProduct(const double *X, const double *Y, const double *b, int n, int p, int q)
+  :
+    _X(X), _Y(Y), _B(b), _N(static_cast<size_t>(n)), _P(p), _Q(q), _G(p * q, .0)
+  {}
+
+  BlockInnerProduct(const BlockInnerProduct &other, split)
+  :
+    _X(other._X), _Y(other._Y), _B(other._B), _N(other._N),
+    _P(other._P), _Q(other._Q), _G(other._P * other._Q, .0)
+  {}
+
+  void join(const BlockInnerProduct &other)
+  {
+    for (size_t i = 0; i < _G.size(); ++i) _G[i] += other._G[i];
+  }
+
+  void operator ()(const blocked_range<int> &re)
+  {
+    const double *x, *y;
+    double        s;
+    const bool sym = (_X == _Y);
+    for (int i = 0; i < _P; ++i) {
+      x = _X + i * _N;
+      for (int j = (sym ? i : 0); j < _Q; ++j) {
+        y = _Y + j * _N, s = .0;
+        for (int r = re.begin(); r != re.end(); ++r) {
+          s += x[r] * _B[r] * y[r];
+        }
+        _G[i * _Q + j] += s;
+      }
+    }
+  }
+
+  static void Run(const double *X, const double *Y, const double *b,
+                  int n, int p, int q, Matrix &G)
+  {
+    BlockInnerProduct body(X, Y, b, n, p, q);
+    parallel_reduce(blocked_range<int>(0, n, 1024), body);
+    G.Initialize(p, q);
+    for (int i = 0; i < p; ++i)
+    for (int j = 0; j < q; ++j) {
+      G(i, j) = (X == Y && j < i ? body._G[j * q + i] : body._G[i * q + j]);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Linear combinations of block of column vectors, i.e., Y = X C(r0:r0+m, :)
+struct CombineBlock
+{
+  const double *_X;
+  const Matrix *_C;
+  double       *_Y;
+  size_t        _N;
+  int           _M;
+  int           _R0;
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    double *y;
+    for (int j = 0; j < _C->Cols(); ++j) {
+      y = _Y + j * _N;
+      for (int r = re.begin(); r != re.end(); ++r) y[r] = .0;
+      for (int i = 0; i < _M; ++i) {
+        const double  c = _C->Get(_R0 + i, j);
+        const double *x = _X + i * _N;
+        for (int r = re.begin(); r != re.end(); ++r) y[r] += c * x[r];
+      }
+    }
+  }
+
+  static void Run(const double *X, int n, int m, const Matrix &C, int r0, double *Y)
+  {
+    CombineBlock body;
+    body._X  = X;
+    body._C  = &C;
+    body._Y  = Y;
+    body._N  = static_cast<size_t>(n);
+    body._M  = m;
+    body._R0 = r0;
+    parallel_for(blocked_range<int>(0, n, 1024), body);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Rayleigh-Ritz procedure for subspace spanned by the columns of S
+///
+/// \param[in]  S     Column-major n x m matrix whose columns span the subspace.
+/// \param[in]  AS    Product of sparse matrix and S.
+/// \param[in]  b     Weights of inner product.
+/// \param[in]  n     Number of rows.
+/// \param[in]  m     Number of columns.
+/// \param[out] C     Coefficients of Ritz vectors, i.e., S C.
+/// \param[out] theta Ritz values in ascending order.
+///
+/// \returns Number of Ritz vectors, i.e., numerical rank of S.
+int RayleighRitz(const double *S, const double *AS, const double *b,
+                 int n, int m, Matrix &C, Vector &theta)
+{
+  Matrix GB, GA;
+  BlockInnerProduct::Run(S, S,  b, n, m, m, GB);
+  BlockInnerProduct::Run(S, AS, b, n, m, m, GA);
+
+  // Scale basis vectors to unit norm to improve condition of Gram matrix
+  Vector s(m);
+  for (int i = 0; i < m; ++i) {
+    s(i) = (GB(i, i) > .0 ? 1.0 / sqrt(GB(i, i)) : .0);
+  }
+  for (int i = 0; i < m; ++i)
+  for (int j = i; j < m; ++j) {
+    GB(i, j) = GB(j, i) = s(i) * s(j) * GB(i, j);
+    GA(i, j) = GA(j, i) = s(i) * s(j) * .5 * (GA(i, j) + GA(j, i));
+  }
+
+  // Orthonormal basis of subspace, discarding linearly dependent directions
+  Matrix Q;
+  Vector lambda;
+  GB.SymmetricEigen(Q, lambda);
+  const double eps = 1e-10 * lambda(m-1);
+  int r = 0;
+  for (int i = 0; i < m; ++i) {
+    if (lambda(i) > eps) ++r;
+  }
+  if (r == 0) return 0;
+  Matrix T(m, r);
+  for (int i = m - r, j = 0; j < r; ++i, ++j) {
+    const double scale = 1.0 / sqrt(lambda(i));
+    for (int k = 0; k < m; ++k) T(k, j) = scale * Q(k, i);
+  }
+
+  // Ritz values and vectors of projected matrix
+  Matrix H = T.Transposed() * GA * T;
+  for (int i = 0; i < r; ++i)
+  for (int j = i + 1; j < r; ++j) {
+    H(i, j) = H(j, i) = .5 * (H(i, j) + H(j, i));
+  }
+  Matrix Y;
+  H.SymmetricEigen(Y, theta);
+  C = T * Y;
+  for (int i = 0; i < m; ++i) C.ScaleRow(i, s(i));
+  return r;
+}
+
+// -----------------------------------------------------------------------------
+/// Solve eigenproblem of small matrix using dense eigen decomposition
+int DenseSmallestEigenvectors(const Array<int> &row, const Array<int> &col,
+                              const Array<double> &data, const Array<double> &b,
+                              Matrix &E, Vector &v, int k)
+{
+  const int n = static_cast<int>(b.size());
+  Matrix M(n, n);
+  for (int r = 0; r < n; ++r) {
+    for (int i = row[r]; i != row[r+1]; ++i) {
+      M(r, col[i]) += sqrt(b[r]) * data[i] / sqrt(b[col[i]]);
+    }
+  }
+  for (int r = 0; r < n; ++r)
+  for (int c = r + 1; c < n; ++c) {
+    M(r, c) = M(c, r) = .5 * (M(r, c) + M(c, r));
+  }
+  Matrix Q;
+  Vector lambda;
+  M.SymmetricEigen(Q, lambda);
+  E.Initialize(n, k);
+  v.Initialize(k);
+  for (int j = 0; j < k; ++j) {
+    for (int r = 0; r < n; ++r) E(r, j) = Q(r, j) / sqrt(b[r]);
+    v(j) = lambda(j);
+  }
+  return k;
+}
+
+
+} // namespace SparseMatrixUtils
+using namespace SparseMatrixUtils;
+
+// -----------------------------------------------------------------------------
+int lobpcg(const GenericSparseMatrix<double> &A, Matrix &E, Vector &v, int k,
+           const Vector *b, const Matrix *E0, double tol, int maxit)
+{
+  if (A.Cols() != A.Rows()) {
+    cerr << "lobpcg: Matrix must be square" << endl;
+    exit(1);
+  }
+  const int n = A.Rows();
+  if (k <= 0 || k > n) {
+    cerr << "lobpcg: Number of eigenvalues must be in [1, " << n << "]" << endl;
+    exit(1);
+  }
+  if (b && b->Rows() != n) {
+    cerr << "lobpcg: Weights of inner product must have " << n << " rows" << endl;
+    exit(1);
+  }
+  if (b == NULL && !A.IsSymmetric()) {
+    cerr << "lobpcg: Matrix must be symmetric when no weights of inner product given" << endl;
+    exit(1);
+  }
+  if (tol   <= .0) tol   = sqrt(numeric_limits<double>::epsilon());
+  if (maxit <=  0) maxit = 1000;
+
+  MIRTK_START_TIMING();
+
+  // Compressed rows of sparse matrix for parallel matrix-vector products
+  int    *ptr, *idx;
+  double *val;
+  const int nnz = A.GetRawData(ptr, idx, val);
+  Array<int>    row(n + 1, 0), col(nnz);
+  Array<double> data(nnz);
+  if (A.Layout() == GenericSparseMatrix<double>::CRS) {
+    std::copy(ptr, ptr + n + 1, row.begin());
+    std::copy(idx, idx + nnz,   col.begin());
+    std::copy(val, val + nnz,   data.begin());
+  } else {
+    // Note: ptr are the row indices and idx the column offsets in this case
+    for (int i = 0; i < nnz; ++i) ++row[ptr[i] + 1];
+    for (int r = 0; r < n; ++r) row[r+1] += row[r];
+    Array<int> pos(row.begin(), row.end() - 1);
+    for (int c = 0; c < n; ++c) {
+      for (int i = idx[c]; i != idx[c+1]; ++i) {
+        const int j = pos[ptr[i]]++;
+        col [j] = c;
+        data[j] = val[i];
+      }
+    }
+  }
+
+  // Weights of inner product
+  Array<double> w(n, 1.0);
+  if (b) {
+    for (int r = 0; r < n; ++r) {
+      w[r] = b->Get(r);
+      if (w[r] <= .0) {
+        cerr << "lobpcg: Weights of inner product must be positive" << endl;
+        E.Clear();
+        v.Clear();
+        return 0;
+      }
+    }
+  }
+
+  // Solve small eigenproblem directly
+  const int nb = min(n, k + max(2, k / 4));
+  if (3 * nb >= n) {
+    return DenseSmallestEigenvectors(row, col, data, w, E, v, k);
+  }
+
+  // Jacobi preconditioner
+  Array<double> M(n, 1.0);
+  for (int r = 0; r < n; ++r) {
+    for (int i = row[r]; i != row[r+1]; ++i) {
+      if (col[i] == r && data[i] > .0) M[r] = 1.0 / data[i];
+    }
+  }
+
+  // Subspace basis [X W P] and product with sparse matrix
+  const size_t  N = static_cast<size_t>(n);
+  Array<double> S(3 * nb * N), AS(3 * nb * N);
+  Array<double> P(nb * N), AP(nb * N), R(nb * N);
+  double       *X = S.data(), *AX = AS.data();
+
+  // Initial block of vectors
+  int c0 = 0;
+  if (E0 && E0->Rows() == n) {
+    c0 = min(E0->Cols(), nb);
+    std::copy(E0->RawPointer(), E0->RawPointer() + c0 * N, X);
+  }
+  std::mt19937 gen;
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (size_t i = c0 * N; i < nb * N; ++i) X[i] = dist(gen);
+
+  // Replace linearly dependent initial vectors by random vectors
+  Matrix C;
+  Vector theta;
+  int nx = 0;
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    MultiplyBlock::Run(row, col, data, X, AX, n, nb);
+    nx = RayleighRitz(X, AX, w.data(), n, nb, C, theta);
+    if (nx == nb) break;
+    if (nx > 0) {
+      CombineBlock::Run(X, n, nb, C, 0, R.data());
+      std::copy(R.begin(), R.begin() + nx * N, X);
+    }
+    for (size_t i = nx * N; i < nb * N; ++i) X[i] = dist(gen);
+  }
+  if (nx < nb) {
+    cerr << "lobpcg: Failed to find " << nb << " linearly independent initial vectors" << endl;
+    exit(1);
+  }
+  CombineBlock::Run(X,  n, nb, C(0, 0, nb, nb), 0, R.data());
+  std::copy(R.begin(), R.end(), X);
+  CombineBlock::Run(AX, n, nb, C(0, 0, nb, nb), 0, R.data());
+  std::copy(R.begin(), R.end(), AX);
+
+  // Iterate until the first k eigenpairs converged
+  Array<int> active;
+  active.reserve(nb);
+  Vector ritz;
+  int iter, nconv = 0, np = 0, na, m, rank;
+  for (iter = 0; iter < maxit; ++iter) {
+
+    // Residuals of current approximations
+    active.clear();
+    nconv = 0;
+    for (int j = 0; j < nb; ++j) {
+      const double *x  = X  + j * N;
+      const double *ax = AX + j * N;
+      double       *res = R.data() + j * N;
+      double norm = .0;
+      for (int r = 0; r < n; ++r) {
+        res[r] = ax[r] - theta(j) * x[r];
+        norm  += w[r] * res[r] * res[r];
+      }
+      if (sqrt(norm) > tol * max(1.0, abs(theta(j)))) {
+        active.push_back(j);
+      } else if (j == nconv && j < k) {
+        ++nconv;
+      }
+    }
+    if (nconv == k) break;
+    na = static_cast<int>(active.size());
+
+    // Preconditioned residuals of active eigenpairs
+    double *W = S.data() + nb * N, *AW = AS.data() + nb * N;
+    for (int a = 0; a < na; ++a) {
+      const double *res = R.data() + active[a] * N;
+      double       *z   = W + a * N;
+      for (int r = 0; r < n; ++r) z[r] = M[r] * res[r];
+    }
+    MultiplyBlock::Run(row, col, data, W, AW, n, na);
+
+    // Search directions of active eigenpairs
+    if (np > 0) {
+      for (int a = 0; a < na; ++a) {
+        std::copy(P .begin() + active[a] * N, P .begin() + (active[a] + 1) * N, W  + (na + a) * N);
+        std::copy(AP.begin() + active[a] * N, AP.begin() + (active[a] + 1) * N, AW + (na + a) * N);
+      }
+      m = nb + 2 * na;
+    } else {
+      m = nb + na;
+    }
+
+    // Rayleigh-Ritz procedure, dropping search directions if ill-conditioned
+    rank = RayleighRitz(S.data(), AS.data(), w.data(), n, m, C, ritz);
+    if (rank < nb && m > nb + na) {
+      m    = nb + na;
+      rank = RayleighRitz(S.data(), AS.data(), w.data(), n, m, C, ritz);
+    }
+    // Stop at breakdown with X and theta of the previous iteration
+    if (rank < nb) break;
+    theta = ritz;
+
+    // Update search directions and eigenvector approximations
+    const Matrix Cx = C(0, 0, m, nb);
+    CombineBlock::Run(W,  n, m - nb, Cx, nb, P .data());
+    CombineBlock::Run(AW, n, m - nb, Cx, nb, AP.data());
+    CombineBlock::Run(X,  n, m, Cx, 0, R.data());
+    std::copy(R.begin(), R.end(), X);
+    CombineBlock::Run(AX, n, m, Cx, 0, R.data());
+    std::copy(R.begin(), R.end(), AX);
+    np = nb;
+  }
+
+  // Copy eigenvectors and -values
+  E.Initialize(n, k);
+  v.Initialize(k);
+  std::copy(X, X + k * N, E.RawPointer());
+  for (int j = 0; j < k; ++j) v(j) = theta(j);
+
+  MIRTK_DEBUG_TIMING(5, "LOBPCG eigen decomposition (#iter=" << iter << ")");
+  return nconv;
+}
+
 // -----------------------------------------------------------------------------
 template <class TEntry>
 int GenericSparseMatrix<TEntry>
@@ -349,6 +783,22 @@ int GenericSparseMatrix<double>
   return eigs(*this, &E, v, k, sigma, p, tol, maxit, v0);
 }
 
+// -----------------------------------------------------------------------------
+template <class TEntry>
+int GenericSparseMatrix<TEntry>
+::SmallestEigenvectors(Matrix &, Vector &, int, const Vector *, const Matrix *, double, int) const
+{
+  cerr << "GenericSparseMatrix::SmallestEigenvectors: Only implemented for sparse double precision matrices" << endl;
+  exit(1);
+}
+
+template <>
+int GenericSparseMatrix<double>
+::SmallestEigenvectors(Matrix &E, Vector &v, int k, const Vector *b, const Matrix *E0, double tol, int maxit) const
+{
+  return lobpcg(*this, E, v, k, b, E0, tol, maxit);
+}
+
 // =============================================================================
 // Explicit template instantiations
 // =============================================================================
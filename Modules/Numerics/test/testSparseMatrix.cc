@@ -0,0 +1,227 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NumericsTest.h"
+
+#include "mirtk/Matrix.h"
+#include "mirtk/Vector.h"
+#include "mirtk/SparseMatrix.h"
+using namespace mirtk;
+
+// =============================================================================
+// Auxiliaries
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Graph Laplacian L = G D^-1 (D - A) of ring graph with extra chords
+///
+/// \param[out] L Graph Laplacian.
+/// \param[out] b Weights D/G of inner product w.r.t. which L is self-adjoint.
+/// \param[in]  n Number of nodes.
+/// \param[in]  g Whether to use non-uniform node weights G.
+void GraphLaplacian(SparseDoubleMatrix &L, Vector &b, int n, bool g)
+{
+  Matrix A(n, n);
+  for (int i = 0; i < n; ++i) {
+    const int j = (i + 1) % n;
+    const int k = (i + 7) % n;
+    A(i, j) = A(j, i) = 1.0 + .5 * sin(1.0 + i);
+    A(i, k) = A(k, i) = .1 + .05 * (i % 3);
+  }
+  Vector D(n), G(n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) D(i) += A(i, j);
+    G(i) = (g ? 1.0 + .5 * cos(.3 * i) : 1.0);
+  }
+  SparseDoubleMatrix::Entries *rows = new SparseDoubleMatrix::Entries[n];
+  for (int i = 0; i < n; ++i)
+  for (int j = 0; j < n; ++j) {
+    double l = (i == j ? D(i) : .0) - A(i, j);
+    if (l != .0) rows[i].push_back(MakePair(j, G(i) * l / D(i)));
+  }
+  L.Layout(SparseDoubleMatrix::CRS);
+  L.Initialize(n, n, rows);
+  delete[] rows;
+  b.Initialize(n);
+  for (int i = 0; i < n; ++i) b(i) = D(i) / G(i);
+}
+
+// -----------------------------------------------------------------------------
+/// Eigenvalues of self-adjoint sparse matrix computed by dense decomposition
+Vector DenseEigenvalues(const SparseDoubleMatrix &L, const Vector &b)
+{
+  const int n = L.Rows();
+  Matrix M(n, n);
+  for (int i = 0; i < n; ++i)
+  for (int j = 0; j < n; ++j) {
+    M(i, j) = sqrt(b(i)) * L.Get(i, j) / sqrt(b(j));
+  }
+  for (int i = 0; i < n; ++i)
+  for (int j = i + 1; j < n; ++j) {
+    M(i, j) = M(j, i) = .5 * (M(i, j) + M(j, i));
+  }
+  Matrix E;
+  Vector v;
+  M.SymmetricEigen(E, v);
+  return v;
+}
+
+// -----------------------------------------------------------------------------
+/// Check eigenpairs of sparse matrix computed by LOBPCG solver
+void CheckSmallestEigenvectors(const SparseDoubleMatrix &L, const Vector &b,
+                               const Matrix &E, const Vector &v, int k)
+{
+  const int n = L.Rows();
+  const Vector ref = DenseEigenvalues(L, b);
+  ASSERT_EQ(k, v.Rows());
+  ASSERT_EQ(n, E.Rows());
+  ASSERT_EQ(k, E.Cols());
+  for (int j = 0; j < k; ++j) {
+    EXPECT_NEAR(ref(j), v(j), 1e-6);
+    // Residual of eigenpair
+    for (int r = 0; r < n; ++r) {
+      double Le = .0;
+      for (int c = 0; c < n; ++c) Le += L.Get(r, c) * E(c, j);
+      EXPECT_NEAR(v(j) * E(r, j), Le, 1e-5);
+    }
+    // Orthonormality w.r.t. weighted inner product
+    for (int i = 0; i <= j; ++i) {
+      double dot = .0;
+      for (int r = 0; r < n; ++r) dot += b(r) * E(r, i) * E(r, j);
+      EXPECT_NEAR(i == j ? 1.0 : .0, dot, 1e-6);
+    }
+  }
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectors)
+{
+  const int k = 4;
+  SparseDoubleMatrix L;
+  Vector b;
+  Matrix E;
+  Vector v;
+  GraphLaplacian(L, b, 60, false);
+  L.SmallestEigenvectors(E, v, k, &b, NULL, 1e-8);
+  CheckSmallestEigenvectors(L, b, E, v, k);
+}
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectorsWithNodeWeights)
+{
+  const int k = 4;
+  SparseDoubleMatrix L;
+  Vector b;
+  Matrix E;
+  Vector v;
+  GraphLaplacian(L, b, 60, true);
+  L.SmallestEigenvectors(E, v, k, &b, NULL, 1e-8);
+  CheckSmallestEigenvectors(L, b, E, v, k);
+}
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectorsWarmStart)
+{
+  const int k = 4;
+  SparseDoubleMatrix L1, L2;
+  Vector b1, b2;
+  Matrix E;
+  Vector v;
+  GraphLaplacian(L1, b1, 60, false);
+  GraphLaplacian(L2, b2, 60, true);
+  L1.SmallestEigenvectors(E, v, k, &b1, NULL, 1e-8);
+  L2.SmallestEigenvectors(E, v, k, &b2, &E, 1e-8);
+  CheckSmallestEigenvectors(L2, b2, E, v, k);
+}
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectorsLinearlyDependentStart)
+{
+  const int k = 4;
+  SparseDoubleMatrix L;
+  Vector b;
+  Matrix E0(60, k), E;
+  Vector v;
+  GraphLaplacian(L, b, 60, true);
+  for (int j = 0; j < k; ++j)
+  for (int r = 0; r < 60; ++r) {
+    E0(r, j) = 1.0;
+  }
+  L.SmallestEigenvectors(E, v, k, &b, &E0, 1e-8);
+  CheckSmallestEigenvectors(L, b, E, v, k);
+}
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectorsBreakdown)
+{
+  // Scaled such that products with the residuals overflow, causing a
+  // breakdown of the Rayleigh-Ritz procedure in the first iteration
+  const int    k     = 4;
+  const double scale = -1e160;
+  SparseDoubleMatrix L;
+  Vector b;
+  Matrix E;
+  Vector v;
+  GraphLaplacian(L, b, 60, false);
+  L *= scale;
+  EXPECT_EQ(0, L.SmallestEigenvectors(E, v, k, &b, NULL, 1e-8));
+  ASSERT_EQ(k, v.Rows());
+  ASSERT_EQ(60, E.Rows());
+  ASSERT_EQ(k, E.Cols());
+  // Returned eigenvalues are the Rayleigh quotients of returned eigenvectors
+  for (int j = 0; j < k; ++j) {
+    double q = .0;
+    for (int r = 0; r < 60; ++r) {
+      double Le = .0;
+      for (int c = 0; c < 60; ++c) Le += (L.Get(r, c) / scale) * E(c, j);
+      q += b(r) * E(r, j) * Le;
+    }
+    EXPECT_NEAR(q, v(j) / scale, 1e-9);
+    if (j > 0) EXPECT_LE(v(j - 1), v(j));
+  }
+}
+
+// -----------------------------------------------------------------------------
+TEST(SparseMatrix, SmallestEigenvectorsNonPositiveWeights)
+{
+  SparseDoubleMatrix L;
+  Vector b;
+  Matrix E;
+  Vector v;
+  GraphLaplacian(L, b, 60, false);
+  b(7) = .0;
+  EXPECT_EQ(0, L.SmallestEigenvectors(E, v, 4, &b));
+  EXPECT_EQ(0, E.Cols());
+  EXPECT_EQ(0, v.Rows());
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
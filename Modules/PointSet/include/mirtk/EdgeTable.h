@@ -90,6 +90,11 @@ public:
 
   /// Get start and end pointer into list of adjacent nodes (thread-safe)
   void GetAdjacentPoints(int, const int *&, const int *&) const;
+
+protected:
+
+  /// Add undirected edge to adjacency lists unless present already
+  void AddEdge(Entries *, vtkIdType, vtkIdType);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
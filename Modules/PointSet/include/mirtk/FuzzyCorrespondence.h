@@ -64,6 +64,10 @@ protected:
   /// Minimum correspondence weight (i.e., threshold used to truncate radial weight function)
   mirtkPublicAttributeMacro(double, MinWeight);
 
+  /// Minimum normalized correspondence weight (i.e., threshold below which
+  /// weights are removed from the sparse matrix after the normalization)
+  mirtkPublicAttributeMacro(double, MinNormalizedWeight);
+
   /// Weight matrix of fuzzy point correspondences
   mirtkReadOnlyAttributeMacro(WeightMatrix, Weight);
 
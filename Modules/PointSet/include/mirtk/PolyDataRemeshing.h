@@ -50,6 +50,9 @@ class PolyDataRemeshing : public PolyDataFilter
 {
   mirtkObjectMacro(PolyDataRemeshing);
 
+  friend class PolyDataRemeshingMeltingPriorities;
+  friend class PolyDataRemeshingBisectionFlags;
+
   // ---------------------------------------------------------------------------
   // Types
 
@@ -255,6 +258,12 @@ private:
   /// Get squared maximum length for specified edge
   double SquaredMaxEdgeLength(vtkIdType, vtkIdType) const;
 
+  /// Determine which edges of (transformed) triangle to bisect
+  ///
+  /// @return Bit mask, where bit i is set if the edge from the i-th to the
+  ///         (i+1)-th triangle corner is to be bisected.
+  int EdgesToBisect(vtkIdType) const;
+
   // ---------------------------------------------------------------------------
   // Local remeshing operations
 protected:
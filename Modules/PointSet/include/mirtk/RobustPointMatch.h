@@ -72,6 +72,10 @@ class RobustPointMatch : public FuzzyCorrespondence
   /// Cluster for outliers in source (i.e., centroid of target points!)
   mirtkReadOnlyAttributeMacro(Point, SourceOutlierCluster);
 
+  /// Lists of non-zero weights of each compressed row/column of the weight
+  /// matrix, kept to reuse the allocated memory in the next annealing step
+  mirtkAttributeMacro(Array<WeightMatrix::Entries>, WeightEntries);
+
   // ---------------------------------------------------------------------------
   // Construction/Destruction
 public:
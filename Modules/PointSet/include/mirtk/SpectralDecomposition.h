@@ -22,6 +22,7 @@
 
 #include "mirtk/Pair.h"
 #include "mirtk/Array.h"
+#include "mirtk/String.h"
 #include "mirtk/PointSet.h"
 #include "mirtk/Vector.h"
 #include "mirtk/Matrix.h"
@@ -51,6 +52,14 @@ typedef Array<Pair<int, double> >    FeatureWeights;
 
 const double EPSILON = 1e-6;
 
+/// Enumeration of available sparse eigen solvers
+enum EigenSolver
+{
+  EigenSolver_Default, ///< ARPACK if available and LOBPCG otherwise
+  EigenSolver_ARPACK,  ///< Implicitly restarted Arnoldi method in shift-and-invert mode
+  EigenSolver_LOBPCG   ///< Locally optimal block preconditioned conjugate gradient method
+};
+
 // =============================================================================
 // Bipartite graph matching / Optimal assignment problem
 // =============================================================================
@@ -307,6 +316,36 @@ void Laplacian(SparseMatrix &L, vtkPolyData *dataset,
                FeatureWeights edge_weights = FeatureWeights(),
                FeatureWeights node_weights = FeatureWeights());
 
+/// Compute general graph Laplacian and node degrees
+///
+/// \param[out] L            General graph Laplacian matrix.
+/// \param[out] D            Node degrees, i.e., main diagonal of degree matrix.
+///                          Without node weights, the Laplacian is self-adjoint
+///                          w.r.t. the inner product weighted by these.
+/// \param[in]  dataset      Surface mesh or contour with optional extra
+///                          feature arrays used as edge and/or node weights.
+/// \param[in]  edge_weights Weights of edge features if any (cf. EdgeWeights).
+/// \param[in]  node_weights Weights of node features if any (cf. NodeWeights).
+void Laplacian(SparseMatrix &L, Vector &D, vtkPolyData *dataset,
+               FeatureWeights edge_weights = FeatureWeights(),
+               FeatureWeights node_weights = FeatureWeights());
+
+/// Compute general graph Laplacian, node degrees, and node weights
+///
+/// \param[out] L            General graph Laplacian matrix L = G D^-1 (D - A).
+///                          It is self-adjoint w.r.t. the inner product
+///                          weighted by D/G (cf. ComputeEigenmodes).
+/// \param[out] D            Node degrees, i.e., main diagonal of degree matrix.
+/// \param[out] G            Node weights, i.e., main diagonal of G. Empty when
+///                          no node weights are used, i.e., G = I.
+/// \param[in]  dataset      Surface mesh or contour with optional extra
+///                          feature arrays used as edge and/or node weights.
+/// \param[in]  edge_weights Weights of edge features if any (cf. EdgeWeights).
+/// \param[in]  node_weights Weights of node features if any (cf. NodeWeights).
+void Laplacian(SparseMatrix &L, Vector &D, Vector &G, vtkPolyData *dataset,
+               FeatureWeights edge_weights = FeatureWeights(),
+               FeatureWeights node_weights = FeatureWeights());
+
 // =============================================================================
 // Spectral decomposition
 // =============================================================================
@@ -315,13 +354,24 @@ void Laplacian(SparseMatrix &L, vtkPolyData *dataset,
 ///
 /// This function performs a spectral analysis of the given graph Laplacian matrix.
 ///
-/// \param[in]  L General graph Laplacian matrix.
-/// \param[in]  k Number of spectral components.
-/// \param[out] m Eigenmodes of \c d, i.e., spectral coordinates.
-/// \param[out] v Eigenvalues of \c d, i.e., resonance frequencies.
+/// \param[in]  L      General graph Laplacian matrix.
+/// \param[in]  k      Number of spectral components.
+/// \param[out] m      Eigenmodes of \c d, i.e., spectral coordinates.
+/// \param[out] v      Eigenvalues of \c d, i.e., resonance frequencies.
+/// \param[in]  solver Sparse eigen solver.
+/// \param[in]  D      Weights of the inner product w.r.t. which L is
+///                    self-adjoint. These are the node degrees D for the
+///                    graph Laplacian L = I - D^-1 A, and D/G for the
+///                    Laplacian L = G D^-1 (D - A) with node weights G.
+///                    Required by the LOBPCG solver when L is not symmetric.
+/// \param[in]  m0     Approximate eigenmodes used as initial estimate by the
+///                    LOBPCG solver, e.g., those of a previously processed
+///                    subject or interpolated from a coarser mesh.
 ///
 /// \returns Actual number of spectral components found.
-int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v);
+int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v,
+                      EigenSolver solver = EigenSolver_Default,
+                      const Vector *D = NULL, const Matrix *m0 = NULL);
 
 /// Compute spectral components
 ///
@@ -335,11 +385,16 @@ int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v);
 /// \param[out] v   Eigenvalues of \c d, i.e., resonance frequencies.
 /// \param[in]  ew  Weights of edge features if any (cf. EdgeWeights).
 /// \param[in]  nw  Weights of node features if any (cf. NodeWeights).
+/// \param[in]  s   Sparse eigen solver.
+/// \param[in]  m0  Approximate eigenmodes used as initial estimate by the
+///                 LOBPCG solver. Must have one row per point of \p d.
 ///
 /// \returns Actual number of spectral components found.
 int ComputeEigenmodes(vtkPolyData *d, int k, Matrix &m, Vector &v,
                       FeatureWeights ew = FeatureWeights(),
-                      FeatureWeights nw = FeatureWeights());
+                      FeatureWeights nw = FeatureWeights(),
+                      EigenSolver s = EigenSolver_Default,
+                      const Matrix *m0 = NULL);
 
 /// Compute spectral components
 ///
@@ -465,6 +520,35 @@ int ComputeEigenmodes(vtkPolyData *d1, vtkPolyData *d2, int k,
                       FeatureWeights nw = FeatureWeights());
 
 
-} } // namespace mirtk::SpectralDecomposition
+} // namespace SpectralDecomposition
+
+// -----------------------------------------------------------------------------
+template <>
+inline string ToString(const SpectralDecomposition::EigenSolver &s, int w, char c, bool left)
+{
+  const char *str;
+  switch (s) {
+    case SpectralDecomposition::EigenSolver_Default: str = "Default"; break;
+    case SpectralDecomposition::EigenSolver_ARPACK:  str = "ARPACK"; break;
+    case SpectralDecomposition::EigenSolver_LOBPCG:  str = "LOBPCG"; break;
+    default:                                         str = "Unknown"; break;
+  }
+  return ToString(str, w, c, left);
+}
+
+// -----------------------------------------------------------------------------
+template <>
+inline bool FromString(const char *str, SpectralDecomposition::EigenSolver &s)
+{
+  string lstr = ToLower(str);
+  if      (lstr == "default") s = SpectralDecomposition::EigenSolver_Default;
+  else if (lstr == "arpack" ) s = SpectralDecomposition::EigenSolver_ARPACK;
+  else if (lstr == "lobpcg" ) s = SpectralDecomposition::EigenSolver_LOBPCG;
+  else return false;
+  return true;
+}
+
+
+} // namespace mirtk
 
 #endif // MIRTK_SpectralDecomposition_H
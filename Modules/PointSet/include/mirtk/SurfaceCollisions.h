@@ -31,6 +31,7 @@
 
 class vtkPolyData;
 class vtkDataArray;
+class vtkCellArray;
 
 
 namespace mirtk {
@@ -177,6 +178,16 @@ public:
   typedef CollisionsSet::const_iterator CollisionsIterator;
   typedef Array<CollisionsSet>          CollisionsArray;
 
+  /// Node of axis-aligned bounding box hierarchy of triangular faces
+  struct BVHNode
+  {
+    double _Bounds[6]; ///< Bounds of triangle corners (x0, x1, y0, y1, z0, z1)
+    int    _Left;      ///< Index of left  child node or -1 if leaf node
+    int    _Right;     ///< Index of right child node or -1 if leaf node
+    int    _First;     ///< Index of first leaf cell in BVHCellIds
+    int    _Count;     ///< Number of leaf cells
+  };
+
   // ---------------------------------------------------------------------------
   // Attributes
 private:
@@ -245,6 +256,21 @@ private:
   /// \note Only non-empty after Run when _StoreCollisionDetails is \c true.
   mirtkReadOnlyAttributeMacro(CollisionsArray, Collisions);
 
+  /// Bounding volume hierarchy of triangular faces used to find nearby faces
+  ///
+  /// The hierarchy is built by the first Run and only refitted to the moved
+  /// points by subsequent runs as long as the triangles are unchanged.
+  mirtkReadOnlyAttributeMacro(Array<BVHNode>, BVH);
+
+  /// IDs of triangles referenced by leaf nodes of bounding volume hierarchy
+  mirtkReadOnlyAttributeMacro(Array<int>, BVHCellIds);
+
+  /// Triangles from which bounding volume hierarchy was built
+  vtkSmartPointer<vtkCellArray> _BVHPolys;
+
+  /// Modification time of triangles when bounding volume hierarchy was built
+  unsigned long _BVHPolysMTime;
+
   // ---------------------------------------------------------------------------
   // Construction/destruction
 private:
@@ -270,6 +296,9 @@ protected:
   /// Initialize filter execution
   void Initialize();
 
+  /// Build bounding volume hierarchy of triangles or refit it to moved points
+  void UpdateBVH();
+
 public:
 
   /// Detect self-collisions of input surface
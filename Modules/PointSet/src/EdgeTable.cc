@@ -27,6 +27,8 @@
 #include "vtkSmartPointer.h"
 #include "vtkGenericCell.h"
 #include "vtkDataSet.h"
+#include "vtkPolyData.h"
+#include "vtkCellType.h"
 
 
 namespace mirtk {
@@ -57,6 +59,21 @@ EdgeTable::~EdgeTable()
 {
 }
 
+// -----------------------------------------------------------------------------
+inline void EdgeTable::AddEdge(Entries *entries, vtkIdType ptId1, vtkIdType ptId2)
+{
+  Entries::const_iterator entry;
+  for (entry = entries[ptId1].begin(); entry != entries[ptId1].end(); ++entry) {
+    if (entry->first == ptId2) return;
+  }
+  // Symmetric entries such that AdjacentPoints is efficient
+  ++_NumberOfEdges; // edgeId + 1 such that entries are non-zero
+  entries[ptId1].push_back(MakePair(static_cast<int>(ptId2), _NumberOfEdges));
+  if (ptId1 != ptId2) {
+    entries[ptId2].push_back(MakePair(static_cast<int>(ptId1), _NumberOfEdges));
+  }
+}
+
 // -----------------------------------------------------------------------------
 void EdgeTable::Initialize(vtkDataSet *mesh)
 {
@@ -71,13 +88,30 @@ void EdgeTable::Initialize(vtkDataSet *mesh)
 
   vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
 
-  Entries::const_iterator entry;
-  vtkIdType cellId, edgeId, ptId1, ptId2;
+  vtkPolyData * const poly = vtkPolyData::SafeDownCast(mesh);
+
+  vtkIdType cellId, edgeId, ptId1, ptId2, npts, *pts;
   int numCellEdges, numEdgePts;
-  bool new_edge;
   vtkCell *edge;
 
   for (cellId = 0; cellId < numCells; ++cellId) {
+    // Read edges of polygons of surface mesh directly from cell array
+    if (poly) {
+      switch (poly->GetCellType(cellId)) {
+        case VTK_TRIANGLE: case VTK_QUAD: case VTK_POLYGON:
+          poly->GetCellPoints(cellId, npts, pts);
+          for (vtkIdType i = 0; i < npts; ++i) {
+            AddEdge(entries, pts[i], pts[(i + 1) % npts]);
+          }
+          continue;
+        // Cells without edges, cf. vtkLine::GetNumberOfEdges
+        case VTK_EMPTY_CELL: case VTK_VERTEX: case VTK_POLY_VERTEX:
+        case VTK_LINE: case VTK_POLY_LINE:
+          continue;
+        default: break;
+      }
+    }
+    // Otherwise, use generic cell interface
     mesh->GetCell(cellId, cell);
     numCellEdges = cell->GetNumberOfEdges();
     for (edgeId = 0; edgeId < numCellEdges; ++edgeId) {
@@ -88,23 +122,7 @@ void EdgeTable::Initialize(vtkDataSet *mesh)
           ptId1 = edge->PointIds->GetId(0);
           for (int i = 1; i < numEdgePts; ++i, ptId1 = ptId2) {
             ptId2 = edge->PointIds->GetId(i);
-            new_edge = true;
-            for (entry = entries[ptId1].begin(); entry != entries[ptId1].end(); ++entry) {
-              if (entry->first == ptId2) {
-                new_edge = false;
-                break;
-              }
-            }
-            if (new_edge) {
-              // Symmetric entries such that AdjacentPoints is efficient
-              ++_NumberOfEdges; // edgeId + 1 such that entries are non-zero
-              if (ptId1 == ptId2) {
-                entries[ptId1].push_back(MakePair(static_cast<int>(ptId2), _NumberOfEdges));
-              } else {
-                entries[ptId1].push_back(MakePair(static_cast<int>(ptId2), _NumberOfEdges));
-                entries[ptId2].push_back(MakePair(static_cast<int>(ptId1), _NumberOfEdges));
-              }
-            }
+            AddEdge(entries, ptId1, ptId2);
           }
         }
       } else {
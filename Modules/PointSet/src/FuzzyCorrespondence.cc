@@ -136,9 +136,10 @@ using namespace FuzzyCorrespondenceUtils;
 // -----------------------------------------------------------------------------
 FuzzyCorrespondence::FuzzyCorrespondence()
 :
-  _MinWeight    (0.001),
-  _GaussianNoise(-1.0) // -1: Set to default in Initialize
-                       //  0: Do not add any Gaussian noise
+  _MinWeight          (0.001),
+  _MinNormalizedWeight(1e-6),
+  _GaussianNoise      (-1.0) // -1: Set to default in Initialize
+                             //  0: Do not add any Gaussian noise
 {
 }
 
@@ -148,6 +149,7 @@ FuzzyCorrespondence
 :
   PointCorrespondence(other),
   _MinWeight          (other._MinWeight),
+  _MinNormalizedWeight(other._MinNormalizedWeight),
   _Weight             (other._Weight),
   _InputTargetClusters(other._InputTargetClusters),
   _InputSourceClusters(other._InputSourceClusters),
@@ -175,6 +177,10 @@ bool FuzzyCorrespondence::Set(const char *name, const char *value)
   if (strcmp(name, "Correspondence noise") == 0) {
     return FromString(value, _GaussianNoise);
   }
+  // Threshold below which normalized weights are removed
+  if (strcmp(name, "Minimum normalized weight") == 0) {
+    return FromString(value, _MinNormalizedWeight);
+  }
   return PointCorrespondence::Set(name, value);
 }
 
@@ -182,7 +188,8 @@ bool FuzzyCorrespondence::Set(const char *name, const char *value)
 ParameterList FuzzyCorrespondence::Parameter() const
 {
   ParameterList params = PointCorrespondence::Parameter();
-  Insert(params, "Correspondence noise", ToString(_GaussianNoise));
+  Insert(params, "Correspondence noise",      ToString(_GaussianNoise));
+  Insert(params, "Minimum normalized weight", ToString(_MinNormalizedWeight));
   return params;
 }
 
@@ -310,7 +317,7 @@ void FuzzyCorrespondence::NormalizeWeights()
 {
   if (_Weight.Rows() == _M && _Weight.Cols() == _N) return;
   MIRTK_START_TIMING();
-  FuzzyCorrespondenceUtils::NormalizeWeights(_Weight, _M, _N);
+  FuzzyCorrespondenceUtils::NormalizeWeights(_Weight, _M, _N, 10, .0, _MinNormalizedWeight);
   MIRTK_DEBUG_TIMING(6, "normalization of correspondence weights (" << _M << "x" << _N << ")");
 }
 
@@ -19,6 +19,7 @@
 
 #include "FuzzyCorrespondenceUtils.h"
 
+#include "mirtk/Array.h"
 #include "mirtk/Parallel.h"
 #include "mirtk/Profiling.h"
 
@@ -31,163 +32,188 @@ namespace mirtk { namespace FuzzyCorrespondenceUtils {
 // =============================================================================
 
 // -----------------------------------------------------------------------------
-struct NormalizeRows
+/// Single sweep over the compressed rows (CRS) or columns (CCS) of the weight
+/// matrix, which normalizes the outer dimension given the current scaling
+/// factors of the inner dimension, and at the same time accumulates the sums
+/// of the scaled weights along the inner dimension needed to normalize it next
+///
+/// The weights themselves are only modified once all iterations are done,
+/// i.e., the i-th non-zero entry in outer row/column o and inner column/row
+/// c is (_Data[i] * _OuterScale[o] * _InnerScale[c]).
+class SinkhornSweep
 {
-  WeightMatrix *_Weight;
-
-  void operator()(const blocked_range<int> &rows) const
-  {
-    double wsum;
-    for (int r = rows.begin(); r != rows.end(); ++r) {
-      wsum = _Weight->RowSum(r);
-      _Weight->ScaleRow(r, 1.0 / wsum);
-    }
-  }
-
-  static void Run(WeightMatrix &weight, int m = -1)
-  {
-    if (m < 0) m = weight.Rows();
-    NormalizeRows body;
-    body._Weight = &weight;
-    MIRTK_START_TIMING();
-    parallel_for(blocked_range<int>(0, m), body);
-    MIRTK_DEBUG_TIMING(7, "row normalization");
-  }
-};
-
-// -----------------------------------------------------------------------------
-struct NormalizeCols
-{
-  WeightMatrix *_Weight;
-
-  void operator()(const blocked_range<int> &cols) const
-  {
-    double wsum;
-    for (int c = cols.begin(); c != cols.end(); ++c) {
-      wsum = _Weight->ColumnSum(c);
-      _Weight->ScaleColumn(c, 1.0 / wsum);
-    }
-  }
-
-  static void Run(WeightMatrix &weight, int n = -1)
-  {
-    if (n < 0) n = weight.Cols();
-    NormalizeCols body;
-    body._Weight = &weight;
-    MIRTK_START_TIMING();
-    parallel_for(blocked_range<int>(0, n), body);
-    MIRTK_DEBUG_TIMING(7, "col normalization");
-  }
-};
-
-// -----------------------------------------------------------------------------
-class RowNormalizationError
-{
-  WeightMatrix *_Weight;
-  double        _Error;
+  const int                     *_Start;
+  const int                     *_Index;
+  const WeightMatrix::EntryType *_Data;
+  int                            _NumberOfOuter;
+  int                            _NumberOfInner;
+  const double                  *_InnerScale;
+  const double                  *_OuterScale;
+  double                        *_NewOuterScale;
 
 public:
 
-  RowNormalizationError(WeightMatrix *weight = NULL)
+  Array<double> _InnerSum; ///< Sums of scaled weights along inner dimension
+  double        _Error;    ///< Sum of squared errors of outer sums before normalization
+
+  SinkhornSweep(const int *start, const int *index, const WeightMatrix::EntryType *data,
+                int nouter, int ninner, const double *b, const double *a, double *new_a)
   :
-    _Weight(weight), _Error(.0)
+    _Start(start), _Index(index), _Data(data),
+    _NumberOfOuter(nouter), _NumberOfInner(ninner),
+    _InnerScale(b), _OuterScale(a), _NewOuterScale(new_a),
+    _Error(.0)
   {}
 
-  RowNormalizationError(const RowNormalizationError &lhs, split)
+  SinkhornSweep(const SinkhornSweep &lhs, split)
   :
-    _Weight(lhs._Weight), _Error(.0)
+    _Start(lhs._Start), _Index(lhs._Index), _Data(lhs._Data),
+    _NumberOfOuter(lhs._NumberOfOuter), _NumberOfInner(lhs._NumberOfInner),
+    _InnerScale(lhs._InnerScale), _OuterScale(lhs._OuterScale),
+    _NewOuterScale(lhs._NewOuterScale),
+    _InnerSum(lhs._InnerSum.size(), .0),
+    _Error(.0)
   {}
 
-  void join(const RowNormalizationError &rhs)
+  void join(const SinkhornSweep &rhs)
   {
+    for (size_t c = 0; c < _InnerSum.size(); ++c) _InnerSum[c] += rhs._InnerSum[c];
     _Error += rhs._Error;
   }
 
   void operator()(const blocked_range<int> &re)
   {
-    for (int i = re.begin(); i != re.end(); ++i) {
-      _Error += pow(1.0 - _Weight->RowSum(i), 2);
+    double s, a;
+    for (int o = re.begin(); o != re.end(); ++o) {
+      a = _OuterScale[o];
+      if (_NewOuterScale && o < _NumberOfOuter) {
+        s = .0;
+        for (int i = _Start[o]; i != _Start[o+1]; ++i) {
+          s += _Data[i] * _InnerScale[_Index[i]];
+        }
+        _Error += pow(1.0 - a * s, 2);
+        if (s > .0) a = 1.0 / s;
+        _NewOuterScale[o] = a;
+      }
+      for (int i = _Start[o]; i != _Start[o+1]; ++i) {
+        if (_Index[i] < _NumberOfInner) _InnerSum[_Index[i]] += a * _Data[i];
+      }
     }
   }
 
-  static double Run(WeightMatrix &weight, int m = -1)
+  /// Perform sweep over [0, nouter) outer rows/columns, where only the first
+  /// m are normalized and the sums of only the first n inner ones computed
+  ///
+  /// \param[in]     weight Weight matrix.
+  /// \param[in]     m      Number of outer rows/columns to normalize.
+  /// \param[in]     n      Number of inner columns/rows to normalize.
+  /// \param[in,out] b      Scaling factors of inner dimension. The first n
+  ///                       are updated using the computed inner sums.
+  /// \param[in]     a      Current scaling factors of outer dimension.
+  /// \param[out]    new_a  New scaling factors of outer dimension.
+  ///                       When \c NULL, the outer dimension is not normalized.
+  ///
+  /// \returns Mean squared error of outer sums before normalization.
+  static double Run(WeightMatrix &weight, int m, int n,
+                    double *b, const double *a, double *new_a)
   {
-    if (m < 0) m = weight.Rows();
-    RowNormalizationError body(&weight);
+    int *row, *col;
+    WeightMatrix::EntryType *data;
+    weight.GetRawData(row, col, data);
+    const bool crs = (weight.Layout() == WeightMatrix::CRS);
+    const int nouter = (crs ? weight.Rows() : weight.Cols());
+    SinkhornSweep body(crs ? row : col, crs ? col : row, data, m, n, b, a, new_a);
+    body._InnerSum.resize(n, .0);
     MIRTK_START_TIMING();
-    parallel_reduce(blocked_range<int>(0, m), body);
-    MIRTK_DEBUG_TIMING(7, "evaluating row normalization error");
-    return body._Error / m;
+    parallel_reduce(blocked_range<int>(0, nouter), body);
+    for (int c = 0; c < n; ++c) {
+      if (body._InnerSum[c] > .0) b[c] = 1.0 / body._InnerSum[c];
+    }
+    MIRTK_DEBUG_TIMING(7, "Sinkhorn sweep");
+    return (m > 0 ? body._Error / m : .0);
   }
 };
 
 // -----------------------------------------------------------------------------
-class ColumnNormalizationError
+/// Scale weights by the final scaling factors and set those below a threshold to zero
+struct ScaleWeights
 {
-  WeightMatrix *_Weight;
-  double        _Error;
-
-public:
-
-  ColumnNormalizationError(WeightMatrix *weight = NULL)
-  :
-    _Weight(weight), _Error(.0)
-  {}
-
-  ColumnNormalizationError(const ColumnNormalizationError &lhs, split)
-  :
-    _Weight(lhs._Weight), _Error(.0)
-  {}
-
-  void join(const ColumnNormalizationError &rhs)
+  const int               *_Start;
+  const int               *_Index;
+  WeightMatrix::EntryType *_Data;
+  const double            *_OuterScale;
+  const double            *_InnerScale;
+  double                   _MinWeight;
+
+  void operator()(const blocked_range<int> &re) const
   {
-    _Error += rhs._Error;
-  }
-
-  void operator()(const blocked_range<int> &re)
-  {
-    for (int i = re.begin(); i != re.end(); ++i) {
-      _Error += pow(1.0 - _Weight->ColumnSum(i), 2);
+    double w;
+    for (int o = re.begin(); o != re.end(); ++o) {
+      for (int i = _Start[o]; i != _Start[o+1]; ++i) {
+        w = _Data[i] * _OuterScale[o] * _InnerScale[_Index[i]];
+        _Data[i] = static_cast<WeightMatrix::EntryType>(w < _MinWeight ? .0 : w);
+      }
     }
   }
-
-  static double Run(WeightMatrix &weight, int n = -1)
-  {
-    if (n < 0) n = weight.Cols();
-    ColumnNormalizationError body(&weight);
-    MIRTK_START_TIMING();
-    parallel_reduce(blocked_range<int>(0, n), body);
-    MIRTK_DEBUG_TIMING(7, "evaluating col normalization error");
-    return body._Error / n;
-  }
 };
 
 // -----------------------------------------------------------------------------
-void NormalizeWeights(WeightMatrix &weight, int m, int n, int maxit, double maxerr)
+void NormalizeWeights(WeightMatrix &weight, int m, int n, int maxit, double maxerr, double minw)
 {
-  // Precompute column/row indices
-  weight.Index();
-  // Iterative row and column normalization
+  if (m < 0) m = weight.Rows();
+  if (n < 0) n = weight.Cols();
+
+  // Number of outer (i.e., compressed) and inner rows/columns to normalize
+  const bool crs    = (weight.Layout() == WeightMatrix::CRS);
+  const int  nouter = (crs ? weight.Rows() : weight.Cols());
+  const int  ninner = (crs ? weight.Cols() : weight.Rows());
+  const int  mouter = (crs ? m : n);
+  const int  minner = (crs ? n : m);
+
+  // Scaling factors of outer and inner rows/columns
+  Array<double> a(nouter, 1.0), new_a(nouter, 1.0), b(ninner, 1.0);
+
+  // Iterative row and column normalization, where each sweep over the
+  // non-zero entries normalizes the outer followed by the inner dimension
   if (maxerr <= .0) {
+    // Order of normalization: columns, then rows
+    if (crs) SinkhornSweep::Run(weight, mouter, minner, &b[0], &a[0], NULL);
     for (int i = 0; i < maxit; ++i) {
-      NormalizeCols::Run(weight, n);
-      NormalizeRows::Run(weight, m);
+      SinkhornSweep::Run(weight, mouter, (crs && i == maxit - 1 ? 0 : minner), &b[0], &a[0], &new_a[0]);
+      a.swap(new_a);
     }
+    // Last sweep in case of CCS layout normalized inner dimension, i.e., rows
   } else {
-    if (weight.Layout() == WeightMatrix::CRS) {
-      for (int i = 0; i < maxit; ++i) {
-        NormalizeRows::Run(weight, m);
-        NormalizeCols::Run(weight, n);
-        if (RowNormalizationError::Run(weight, m) < maxerr) break;
-      }
-    } else {
-      for (int i = 0; i < maxit; ++i) {
-        NormalizeCols::Run(weight, n);
-        NormalizeRows::Run(weight, m);
-        if (ColumnNormalizationError::Run(weight, n) < maxerr) break;
+    // Order of normalization: outer, then inner until outer sums are close to one
+    for (int i = 0; i < maxit; ++i) {
+      Array<double> prev_b(b);
+      const double error = SinkhornSweep::Run(weight, mouter, minner, &b[0], &a[0], &new_a[0]);
+      if (i > 0 && error < maxerr) {
+        b.swap(prev_b);
+        break;
       }
+      a.swap(new_a);
     }
   }
+
+  // Scale non-zero entries and remove insignificant ones
+  int *row, *col;
+  WeightMatrix::EntryType *data;
+  weight.GetRawData(row, col, data);
+  ScaleWeights body;
+  body._Start      = (crs ? row : col);
+  body._Index      = (crs ? col : row);
+  body._Data       = data;
+  body._OuterScale = &a[0];
+  body._InnerScale = &b[0];
+  body._MinWeight  = minw;
+  MIRTK_START_TIMING();
+  parallel_for(blocked_range<int>(0, nouter), body);
+  if (minw > .0) {
+    weight.ClearIndex();
+    weight.RemoveZeros();
+  }
+  MIRTK_DEBUG_TIMING(7, "scaling of normalized weights");
 }
 
 
@@ -35,8 +35,10 @@ typedef FuzzyCorrespondence::WeightMatrix WeightMatrix;
 /// \param[in]     maxerr  Maximum squared error. If non-positive, the maximum
 ///                        number of iterations is performed. This may be
 ///                        considerably faster than always checking the error.
+/// \param[in]     minw    Normalized weights below this threshold are removed
+///                        from the sparse matrix.
 void NormalizeWeights(WeightMatrix &weight, int m = -1, int n = -1,
-                      int maxit = 10, double maxerr = .0);
+                      int maxit = 10, double maxerr = .0, double minw = .0);
 
 
 } } // namespace mirtk::FuzzyCorrespondenceUtils
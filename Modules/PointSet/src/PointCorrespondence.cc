@@ -561,12 +561,14 @@ void UpdateEigenmodes(const RegisteredPointSet         *target,
   }
   // Compute graph Laplacian of joint connectivity graph
   SparseMatrix L(SparseMatrix::CCS);
+  Vector       D;
   L.Initialize(m + n, m + n, cols);
-  NormalizedLaplacian(L, L);
+  Degree(D, L);
+  NormalizedLaplacian(L, L, NULL, &D);
   delete[] cols;
   // Compute eigenmodes of joint graph Laplacian
   Matrix eigenmodes;
-  if (ComputeEigenmodes(L, k+2, eigenmodes, eigenvalues) < k) {
+  if (ComputeEigenmodes(L, k+2, eigenmodes, eigenvalues, EigenSolver_Default, &D) < k) {
     cerr << "FiducialRegistrationError::UpdateEigenmodes: Failed to compute " << k << " eigenmodes" << endl;
     exit(1);
   }
@@ -22,6 +22,7 @@
 #include "mirtk/Vtk.h"
 #include "mirtk/Math.h"
 #include "mirtk/Memory.h"
+#include "mirtk/Array.h"
 #include "mirtk/Matrix3x3.h"
 #include "mirtk/EdgeTable.h"
 #include "mirtk/PolyDataSmoothing.h"
@@ -36,7 +37,6 @@
 #include "vtkDoubleArray.h"
 #include "vtkPolyDataNormals.h"
 #include "vtkCurvatures.h"
-#include "vtkIdList.h"
 
 #include "Eigen/Dense"
 #include "Eigen/Eigenvalues"
@@ -80,63 +80,107 @@ vtkSmartPointer<vtkDataArray> NewArray(const char *name, vtkIdType n, int c, boo
   return array;
 }
 
+// -----------------------------------------------------------------------------
+/// Faces adjacent to each undirected edge of a surface mesh
+///
+/// For each edge, the IDs of the first two adjacent faces in order of
+/// increasing face ID are stored together with the IDs of the edge points
+/// in the order in which these are connected by the first face. Edges which are
+/// not shared by exactly two faces have both face IDs set to -1.
+struct EdgeFaces
+{
+  Array<vtkIdType> _Face1;   ///< ID of first face adjacent to edge
+  Array<vtkIdType> _Face2;   ///< ID of second face adjacent to edge
+  Array<vtkIdType> _PtId1;   ///< ID of first edge point in first face
+  Array<vtkIdType> _PtId2;   ///< ID of second edge point in first face
+
+  void Initialize(vtkPolyData *surface, const EdgeTable &edgeTable)
+  {
+    const int nedges = edgeTable.NumberOfEdges();
+    _Face1.resize(nedges);
+    _Face2.resize(nedges);
+    _PtId1.resize(nedges);
+    _PtId2.resize(nedges);
+    Array<int> count(nedges, 0);
+    vtkIdType npts, *pts, ptId1, ptId2;
+    int       edgeId;
+    for (vtkIdType cellId = 0; cellId < surface->GetNumberOfCells(); ++cellId) {
+      surface->GetCellPoints(cellId, npts, pts);
+      for (vtkIdType i = 0; i < npts; ++i) {
+        ptId1  = pts[i];
+        ptId2  = pts[(i + 1) % npts];
+        edgeId = edgeTable.EdgeId(ptId1, ptId2);
+        if (edgeId < 0) continue;
+        switch (count[edgeId]++) {
+          case 0: {
+            _Face1[edgeId] = cellId;
+            _PtId1[edgeId] = ptId1;
+            _PtId2[edgeId] = ptId2;
+          } break;
+          case 1: _Face2[edgeId] = cellId; break;
+        }
+      }
+    }
+    for (int edgeId = 0; edgeId < nedges; ++edgeId) {
+      if (count[edgeId] != 2) _Face1[edgeId] = _Face2[edgeId] = -1;
+    }
+  }
+};
+
 // -----------------------------------------------------------------------------
 /// Compute curvature tensors for each undirected edge
 class ComputeEdgeTensors
 {
   vtkPolyData     *_Surface;
   vtkDataArray    *_Normals;
-  const EdgeTable *_EdgeTable;
+  const EdgeFaces *_EdgeFaces;
   double           _DistNorm;
   vtkDataArray    *_Tensors;
 
 public:
 
   /// Compute edge tensors for specified range of edges
-  void operator ()(const blocked_range<vtkIdType> &re) const
+  void operator ()(const blocked_range<int> &re) const
   {
-    vtkIdType npts, *pts, ptId1, ptId2, cellId1, cellId2;
+    vtkIdType ptId1, ptId2, cellId1, cellId2;
     double    d, p1[3], p2[3], e[3], n1[3], n2[3], dp, cp[3], beta, s, T[6];
 
-    vtkSmartPointer<vtkIdList> adjCellIds = vtkSmartPointer<vtkIdList>::New();
-
-    // Iterate over faces
-    for (cellId1 = re.begin(); cellId1 != re.end(); ++cellId1) {
-      _Surface->GetCellPoints(cellId1, npts, pts);
-      for (vtkIdType i = 0; i < npts; ++i) {
-        // Get edge points
-        ptId1 = pts[i];
-        ptId2 = pts[(i + 1) % npts];
-        // Process edge only if there is really just one other neighbour, i.e.,
-        // the edge has two adjacent faces with IDs cellId1 and cellId2, and
-        // when the edge was not visited before (ensured by cellId1 < cellId2)
-        _Surface->GetCellEdgeNeighbors(cellId1, ptId1, ptId2, adjCellIds);
-        if (adjCellIds->GetNumberOfIds() == 1 && cellId1 < (cellId2 = adjCellIds->GetId(0))) {
-          // Compute normalized edge vector
-          _Surface->GetPoint(ptId1, p1);
-          _Surface->GetPoint(ptId2, p2);
-          e[0] = p2[0] - p1[0];
-          e[1] = p2[1] - p1[1];
-          e[2] = p2[2] - p1[2];
-          d = vtkMath::Normalize(e);
-          // Compute signed angle of face normals
-          _Normals->GetTuple(cellId1, n1);
-          _Normals->GetTuple(cellId2, n2);
-          dp = max(-1.0, min(vtkMath::Dot(n1, n2), 1.0));
-          vtkMath::Cross(n1, n2, cp);
-          beta = sgn(vtkMath::Dot(cp, e)) * acos(dp);
-          // Compute upper triangular part of symmetric curvature tensor
-          s  = beta * d;
-          s /= _DistNorm; // Avoid too large numerics
-          T[0] = s * e[0] * e[0]; // ParaView compatible order:
-          T[1] = s * e[1] * e[1]; // XX, YY, ZZ, XY, YZ, XZ
-          T[2] = s * e[2] * e[2];
-          T[3] = s * e[0] * e[1];
-          T[4] = s * e[1] * e[2];
-          T[5] = s * e[0] * e[2];
-          _Tensors->SetTuple(_EdgeTable->EdgeId(ptId1, ptId2), T);
-        }
+    // Iterate over edges
+    for (int edgeId = re.begin(); edgeId != re.end(); ++edgeId) {
+      // Process edge only if it has exactly two adjacent faces, where the
+      // edge direction is determined by the face with the smaller ID
+      cellId1 = _EdgeFaces->_Face1[edgeId];
+      cellId2 = _EdgeFaces->_Face2[edgeId];
+      if (cellId1 < 0) {
+        memset(T, 0, 6 * sizeof(double));
+        _Tensors->SetTuple(edgeId, T);
+        continue;
       }
+      ptId1 = _EdgeFaces->_PtId1[edgeId];
+      ptId2 = _EdgeFaces->_PtId2[edgeId];
+      // Compute normalized edge vector
+      _Surface->GetPoint(ptId1, p1);
+      _Surface->GetPoint(ptId2, p2);
+      e[0] = p2[0] - p1[0];
+      e[1] = p2[1] - p1[1];
+      e[2] = p2[2] - p1[2];
+      d = vtkMath::Normalize(e);
+      // Compute signed angle of face normals
+      _Normals->GetTuple(cellId1, n1);
+      _Normals->GetTuple(cellId2, n2);
+      dp = max(-1.0, min(vtkMath::Dot(n1, n2), 1.0));
+      vtkMath::Cross(n1, n2, cp);
+      beta = sgn(vtkMath::Dot(cp, e)) * acos(dp);
+      // Compute upper triangular part of symmetric curvature tensor
+      s  = beta * d;
+      s /= _DistNorm; // Avoid too large numerics
+      T[0] = s * e[0] * e[0]; // ParaView compatible order:
+      T[1] = s * e[1] * e[1]; // XX, YY, ZZ, XY, YZ, XZ
+      T[2] = s * e[2] * e[2];
+      T[3] = s * e[0] * e[1];
+      T[4] = s * e[1] * e[2];
+      T[5] = s * e[0] * e[2];
+      _Tensors->SetTuple(edgeId, T);
     }
   }
 
@@ -147,13 +191,15 @@ public:
     tensors->SetName(PolyDataCurvature::TENSOR);
     tensors->SetNumberOfComponents(6);
     tensors->SetNumberOfTuples(edgeTable.NumberOfEdges());
+    EdgeFaces edgeFaces;
+    edgeFaces.Initialize(surface, edgeTable);
     ComputeEdgeTensors body;
-    body._EdgeTable = &edgeTable;
+    body._EdgeFaces = &edgeFaces;
     body._Surface   = surface;
     body._Normals   = surface->GetCellData()->GetNormals();
     body._DistNorm  = AverageEdgeLength(surface->GetPoints(), edgeTable);
     body._Tensors   = tensors;
-    parallel_for(blocked_range<vtkIdType>(0, surface->GetNumberOfCells()), body);
+    parallel_for(blocked_range<int>(0, edgeTable.NumberOfEdges()), body);
     return tensors;
   }
 };
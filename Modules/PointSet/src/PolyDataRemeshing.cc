@@ -23,6 +23,8 @@
 #include "mirtk/Vtk.h"
 #include "mirtk/Assert.h"
 #include "mirtk/Math.h"
+#include "mirtk/Array.h"
+#include "mirtk/Parallel.h"
 #include "mirtk/Profiling.h"
 #include "mirtk/PolyDataSmoothing.h"
 #include "mirtk/PointSetUtils.h"
@@ -439,6 +441,113 @@ inline double PolyDataRemeshing
   return _MaxEdgeLengthSquared;
 }
 
+// -----------------------------------------------------------------------------
+inline int PolyDataRemeshing::EdgesToBisect(vtkIdType cellId) const
+{
+  vtkIdType npts, *pts;
+  double    p1[3], p2[3], p3[3], n1[3], n2[3], n3[3], length2[3], min2[3], max2[3];
+  int       bisect[3];
+
+  _Output->GetCellPoints(cellId, npts, pts);
+  if (npts == 0) return 0; // cell marked as deleted (i.e., VTK_EMPTY_CELL)
+  mirtkAssert(npts == 3, "surface is triangulated");
+
+  // Get (transformed) point coordinates
+  GetPoint(pts[0], p1);
+  GetPoint(pts[1], p2);
+  GetPoint(pts[2], p3);
+
+  // Compute squared edge lengths
+  length2[0] = vtkMath::Distance2BetweenPoints(p1, p2);
+  length2[1] = vtkMath::Distance2BetweenPoints(p2, p3);
+  length2[2] = vtkMath::Distance2BetweenPoints(p3, p1);
+
+  // Get desired range of squared edge lengths
+  min2[0] = SquaredMinEdgeLength(pts[0], pts[1]);
+  min2[1] = SquaredMinEdgeLength(pts[1], pts[2]);
+  min2[2] = SquaredMinEdgeLength(pts[2], pts[0]);
+
+  max2[0] = SquaredMaxEdgeLength(pts[0], pts[1]);
+  max2[1] = SquaredMaxEdgeLength(pts[1], pts[2]);
+  max2[2] = SquaredMaxEdgeLength(pts[2], pts[0]);
+
+  // Determine which edges to bisect
+  bisect[0] = int(length2[0] > max2[0]);
+  bisect[1] = int(length2[1] > max2[1]);
+  bisect[2] = int(length2[2] > max2[2]);
+
+  if (_MaxFeatureAngle < 180.0 && (!bisect[0] || !bisect[1] || !bisect[2])) {
+    GetNormal(pts[0], n1);
+    GetNormal(pts[1], n2);
+    GetNormal(pts[2], n3);
+    if (!bisect[0] && length2[0] >= 2.0 * min2[0]) {
+      bisect[0] = int(1.0 - vtkMath::Dot(n1, n2) > _MaxFeatureAngleCos);
+    }
+    if (!bisect[1] && length2[1] >= 2.0 * min2[1]) {
+      bisect[1] = int(1.0 - vtkMath::Dot(n2, n3) > _MaxFeatureAngleCos);
+    }
+    if (!bisect[2] && length2[2] >= 2.0 * min2[2]) {
+      bisect[2] = int(1.0 - vtkMath::Dot(n3, n1) > _MaxFeatureAngleCos);
+    }
+  }
+
+  return bisect[0] | (bisect[1] << 1) | (bisect[2] << 2);
+}
+
+// =============================================================================
+// Parallel evaluation of cell attributes
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Compute melting priority of each cell
+///
+/// Only reads the output mesh and must therefore not be executed while
+/// cells are being modified by a local remeshing operation.
+class PolyDataRemeshingMeltingPriorities
+{
+  const PolyDataRemeshing *_Filter;
+  double                  *_Priority;
+
+public:
+
+  PolyDataRemeshingMeltingPriorities(const PolyDataRemeshing *filter, double *priority)
+  :
+    _Filter(filter), _Priority(priority)
+  {}
+
+  void operator ()(const blocked_range<vtkIdType> &re) const
+  {
+    for (vtkIdType cellId = re.begin(); cellId != re.end(); ++cellId) {
+      _Priority[cellId] = _Filter->MeltingPriority(cellId);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Determine which edges of each cell to bisect
+///
+/// Only reads the output mesh and must therefore not be executed while
+/// cells are being modified by a local remeshing operation.
+class PolyDataRemeshingBisectionFlags
+{
+  const PolyDataRemeshing *_Filter;
+  char                    *_Flags;
+
+public:
+
+  PolyDataRemeshingBisectionFlags(const PolyDataRemeshing *filter, char *flags)
+  :
+    _Filter(filter), _Flags(flags)
+  {}
+
+  void operator ()(const blocked_range<vtkIdType> &re) const
+  {
+    for (vtkIdType cellId = re.begin(); cellId != re.end(); ++cellId) {
+      _Flags[cellId] = static_cast<char>(_Filter->EdgesToBisect(cellId));
+    }
+  }
+};
+
 // =============================================================================
 // Local remeshing operations
 // =============================================================================
@@ -569,10 +678,20 @@ void PolyDataRemeshing::MeltingOfCells()
   cellIds->Allocate(20);
 
   // Initialize priority queue of cells to process
+  //
+  // The initial priorities are independent of each other and computed in
+  // parallel. Afterwards, the queue is only updated for the cells modified
+  // by each local melting operation.
+  const vtkIdType ncells = _Output->GetNumberOfCells();
+  Array<double> priority(ncells);
+  if (ncells > 0) {
+    PolyDataRemeshingMeltingPriorities eval(this, priority.data());
+    parallel_for(blocked_range<vtkIdType>(0, ncells), eval);
+  }
   _MeltingQueue = vtkSmartPointer<vtkPriorityQueue>::New();
-  for (cellId = 0; cellId < _Output->GetNumberOfCells(); ++cellId) {
-    double priority = MeltingPriority(cellId);
-    if (!IsInf(priority)) _MeltingQueue->Insert(priority, cellId);
+  _MeltingQueue->Allocate(ncells);
+  for (cellId = 0; cellId < ncells; ++cellId) {
+    if (!IsInf(priority[cellId])) _MeltingQueue->Insert(priority[cellId], cellId);
   }
 
   int num_triangle_melting_attempts = 0;
@@ -1201,9 +1320,7 @@ void PolyDataRemeshing::Subdivision()
 {
   MIRTK_START_TIMING();
 
-  int       bisect[3];
   vtkIdType npts, *pts;
-  double    p1[3], p2[3], p3[3], n1[3], n2[3], n3[3], length2[3], min2[3], max2[3];
 
   vtkSmartPointer<vtkCellArray> newPolys = vtkSmartPointer<vtkCellArray>::New();
   newPolys->Allocate(_Output->GetNumberOfCells());
@@ -1211,68 +1328,30 @@ void PolyDataRemeshing::Subdivision()
 
   // Get current number of cells (excl. newly added cells)
   const vtkIdType ncells = _Output->GetNumberOfCells();
+
+  // Determine which edges to bisect in parallel; the subdivision itself
+  // inserts new points and cells and is therefore performed sequentially
+  Array<char> bisect(ncells);
+  if (ncells > 0) {
+    PolyDataRemeshingBisectionFlags eval(this, bisect.data());
+    parallel_for(blocked_range<vtkIdType>(0, ncells), eval);
+  }
+
   for (vtkIdType cellId = 0; cellId < ncells; ++cellId) {
 
     _Output->GetCellPoints(cellId, npts, pts);
     if (npts == 0) continue; // cell marked as deleted (i.e., VTK_EMPTY_CELL)
-    mirtkAssert(npts == 3, "surface is triangulated");
-
-    // Get (transformed) point coordinates
-    GetPoint(pts[0], p1);
-    GetPoint(pts[1], p2);
-    GetPoint(pts[2], p3);
-
-    // Compute squared edge lengths
-    length2[0] = vtkMath::Distance2BetweenPoints(p1, p2);
-    length2[1] = vtkMath::Distance2BetweenPoints(p2, p3);
-    length2[2] = vtkMath::Distance2BetweenPoints(p3, p1);
-
-    // Get desired range of squared edge lengths
-    min2[0] = SquaredMinEdgeLength(pts[0], pts[1]);
-    min2[1] = SquaredMinEdgeLength(pts[1], pts[2]);
-    min2[2] = SquaredMinEdgeLength(pts[2], pts[0]);
-
-    max2[0] = SquaredMaxEdgeLength(pts[0], pts[1]);
-    max2[1] = SquaredMaxEdgeLength(pts[1], pts[2]);
-    max2[2] = SquaredMaxEdgeLength(pts[2], pts[0]);
-
-    // Determine which edges to bisect
-    bisect[0] = int(length2[0] > max2[0]);
-    bisect[1] = int(length2[1] > max2[1]);
-    bisect[2] = int(length2[2] > max2[2]);
-
-    if (_MaxFeatureAngle < 180.0 && (!bisect[0] || !bisect[1] || !bisect[2])) {
-      GetNormal(pts[0], n1);
-      GetNormal(pts[1], n2);
-      GetNormal(pts[2], n3);
-      if (!bisect[0] && length2[0] >= 2.0 * min2[0]) {
-        bisect[0] = int(1.0 - vtkMath::Dot(n1, n2) > _MaxFeatureAngleCos);
-      }
-      if (!bisect[1] && length2[1] >= 2.0 * min2[1]) {
-        bisect[1] = int(1.0 - vtkMath::Dot(n2, n3) > _MaxFeatureAngleCos);
-      }
-      if (!bisect[2] && length2[2] >= 2.0 * min2[2]) {
-        bisect[2] = int(1.0 - vtkMath::Dot(n3, n1) > _MaxFeatureAngleCos);
-      }
-    }
 
     // Perform subdivision
-    switch (bisect[0] + bisect[1] + bisect[2]) {
-      case 1:
-        if      (bisect[0]) Bisect(cellId, pts[0], pts[1], pts[2], points, newPolys);
-        else if (bisect[1]) Bisect(cellId, pts[1], pts[2], pts[0], points, newPolys);
-        else                Bisect(cellId, pts[2], pts[0], pts[1], points, newPolys);
-        break;
-      case 2:
-        if      (bisect[0] && bisect[1]) Trisect(cellId, pts[0], pts[1], pts[2], points, newPolys);
-        else if (bisect[1] && bisect[2]) Trisect(cellId, pts[1], pts[2], pts[0], points, newPolys);
-        else                             Trisect(cellId, pts[2], pts[0], pts[1], points, newPolys);
-        break;
-      case 3:
-        Quadsect(cellId, pts[0], pts[1], pts[2], points, newPolys);
-        break;
-      default:
-        newPolys->InsertNextCell(npts, pts);
+    switch (bisect[cellId]) {
+      case 1: Bisect (cellId, pts[0], pts[1], pts[2], points, newPolys); break;
+      case 2: Bisect (cellId, pts[1], pts[2], pts[0], points, newPolys); break;
+      case 4: Bisect (cellId, pts[2], pts[0], pts[1], points, newPolys); break;
+      case 3: Trisect(cellId, pts[0], pts[1], pts[2], points, newPolys); break;
+      case 6: Trisect(cellId, pts[1], pts[2], pts[0], points, newPolys); break;
+      case 5: Trisect(cellId, pts[2], pts[0], pts[1], points, newPolys); break;
+      case 7: Quadsect(cellId, pts[0], pts[1], pts[2], points, newPolys); break;
+      default: newPolys->InsertNextCell(npts, pts);
     }
   }
 
@@ -20,6 +20,7 @@
 #include "mirtk/PolyDataSmoothing.h"
 
 #include "mirtk/Math.h"
+#include "mirtk/Profiling.h"
 #include "mirtk/EdgeTable.h"
 #include "mirtk/Matrix3x3.h"
 #include "mirtk/Vector3.h"
@@ -52,7 +53,7 @@ namespace PolyDataSmoothingUtils {
 ///     SIGGRAPH’95 Proceedings, 18(3), 351–358.
 struct UniformWeightKernel
 {
-  double operator ()(vtkIdType, double [3], double [3]) const
+  double operator ()(vtkIdType, const double [3], const double [3]) const
   {
     return 1.0;
   }
@@ -68,7 +69,7 @@ public:
 
   InverseDistanceKernel(double sigma = .0) : _Sigma(sigma) {}
 
-  double operator ()(vtkIdType, double p0[3], double p1[3]) const
+  double operator ()(vtkIdType, const double p0[3], const double p1[3]) const
   {
     const double d = sqrt(vtkMath::Distance2BetweenPoints(p0, p1)) + _Sigma;
     return (d == .0 ? .0 : 1.0 / d);
@@ -85,7 +86,7 @@ public:
 
   GaussianKernel(double sigma = 1.0) : _Scale(- .5 / (sigma * sigma)) {}
 
-  double operator ()(vtkIdType, double p0[3], double p1[3]) const
+  double operator ()(vtkIdType, const double p0[3], const double p1[3]) const
   {
     return exp(_Scale * vtkMath::Distance2BetweenPoints(p0, p1));
   }
@@ -171,7 +172,7 @@ public:
   }
 
   /// Evaluate anisotropic Gaussian kernel centered at \c p0 at \c x=p1
-  double operator ()(vtkIdType ptId, double p0[3], double p1[3]) const
+  double operator ()(vtkIdType ptId, const double p0[3], const double p1[3]) const
   {
     Matrix3x3 T; // local geometry tensor, e.g., curvature tensor
     Vector3   x(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
@@ -215,59 +216,135 @@ public:
   }
 };
 
+// -----------------------------------------------------------------------------
+/// Contiguous copies of node positions and data values used by SmoothData
+///
+/// The node positions and the values of all data arrays to be smoothed are
+/// stored in two buffers each, one for the input and one for the output of
+/// the current iteration. These are swapped after each iteration instead of
+/// copying the output to the input vtkPoints/vtkDataArray instances.
+struct SmoothingBuffers
+{
+  vtkIdType     _NumberOfPoints;
+  Array<char>   _Mask;               ///< Whether node is modified (empty if all)
+  Array<double> _Points[2];          ///< Node positions (x, y, z) of each node
+  Array<double> _Data[2];            ///< Interleaved data values of each node
+  Array<int>    _Offset;             ///< Offset of first component of each array
+  Array<int>    _NumberOfComponents; ///< Number of components of each array
+  int           _Stride;             ///< Total number of data components per node
+  int           _Input;              ///< Index of input buffer
+
+  /// Copy node positions and data values to contiguous buffers
+  void Initialize(vtkDataArray *mask, vtkPoints *points,
+                  const PolyDataSmoothing::DataArrays &arrays, bool smooth_points)
+  {
+    _NumberOfPoints = points->GetNumberOfPoints();
+    _Input = 0;
+    if (mask) {
+      _Mask.resize(_NumberOfPoints);
+      for (vtkIdType ptId = 0; ptId < _NumberOfPoints; ++ptId) {
+        _Mask[ptId] = (mask->GetComponent(ptId, 0) != .0 ? 1 : 0);
+      }
+    } else {
+      _Mask.clear();
+    }
+    _Points[0].resize(3 * _NumberOfPoints);
+    for (vtkIdType ptId = 0; ptId < _NumberOfPoints; ++ptId) {
+      points->GetPoint(ptId, &_Points[0][3 * ptId]);
+    }
+    if (smooth_points) _Points[1].resize(_Points[0].size());
+    else               _Points[1].clear();
+    _Stride = 0;
+    _Offset            .resize(arrays.size());
+    _NumberOfComponents.resize(arrays.size());
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      _Offset[i]             = _Stride;
+      _NumberOfComponents[i] = arrays[i]->GetNumberOfComponents();
+      _Stride               += _NumberOfComponents[i];
+    }
+    _Data[0].resize(_Stride * _NumberOfPoints);
+    _Data[1].resize(_Data[0].size());
+    double *v = _Data[0].data();
+    for (vtkIdType ptId = 0; ptId < _NumberOfPoints; ++ptId) {
+      for (size_t i = 0; i < arrays.size(); ++i) {
+        for (int j = 0; j < _NumberOfComponents[i]; ++j, ++v) {
+          (*v) = arrays[i]->GetComponent(ptId, j);
+        }
+      }
+    }
+  }
+
+  /// Swap input and output buffers
+  void Swap()
+  {
+    if (!_Points[1].empty() || _Stride > 0) _Input = 1 - _Input;
+  }
+
+  /// Copy contiguous buffers of current input to output points and arrays
+  void Finalize(vtkPoints *points, const PolyDataSmoothing::DataArrays &arrays) const
+  {
+    if (points) {
+      const double *p = _Points[_Points[1].empty() ? 0 : _Input].data();
+      for (vtkIdType ptId = 0; ptId < _NumberOfPoints; ++ptId, p += 3) {
+        points->SetPoint(ptId, p);
+      }
+    }
+    const double *v = _Data[_Input].data();
+    for (vtkIdType ptId = 0; ptId < _NumberOfPoints; ++ptId) {
+      for (size_t i = 0; i < arrays.size(); ++i) {
+        for (int j = 0; j < _NumberOfComponents[i]; ++j, ++v) {
+          arrays[i]->SetComponent(ptId, j, *v);
+        }
+      }
+    }
+  }
+};
+
 // -----------------------------------------------------------------------------
 /// Smooth node position and/or data using the given node weighting kernel function
+///
+/// Operates on the contiguous buffers of SmoothingBuffers and the compressed
+/// adjacency lists of the EdgeTable, i.e., without any virtual vtkPoints and
+/// vtkDataArray function calls in the inner loops.
 template <class TKernel>
 struct SmoothData
 {
-  typedef PolyDataSmoothing::DataArrays DataArrays;
-
-  vtkDataArray     *_Mask;
+  const char       *_Mask;
   const EdgeTable  *_EdgeTable;
-  vtkPoints        *_InputPoints;
-  vtkPoints        *_OutputPoints;
-  const DataArrays *_InputArrays;
-  const DataArrays *_OutputArrays;
+  const double     *_InputPoints;
+  double           *_OutputPoints;
+  const double     *_InputData;
+  double           *_OutputData;
+  const int        *_Offset;
+  const int        *_NumberOfComponents;
+  int               _NumberOfArrays;
+  int               _Stride;
   TKernel           _WeightFunction;
   double            _Lambda;
   bool              _InclNodeItself;
 
   void operator ()(const blocked_range<vtkIdType> &re) const
   {
-    double        p[3] = {.0}, p0[3], p1[3], v[3], w, norm, alpha, beta;
-    vtkDataArray *ia, *oa;
+    double        p[3] = {.0}, w, norm, alpha, beta, dp;
+    const double *p0, *p1, *v0, *v1;
     const int    *adjPtIt, *adjPtEnd;
     vtkIdType     adjPtId;
-    size_t        i;
-    int           j;
-
-    const bool smooth_points = _OutputPoints != NULL;
-    const bool smooth_data   = _OutputArrays && !_InputArrays->empty();
+    int           i, j;
 
-    double **data = NULL, *sum;
-    if (smooth_data) {
-      data = new double *[_InputArrays->size()];
-      for (i = 0; i < _InputArrays->size(); ++i) {
-        data[i] = new double[(*_InputArrays)[i]->GetNumberOfComponents()];
-      }
-    }
+    Array<double> data(_Stride);
+    double * const sum = data.data();
 
     for (vtkIdType ptId = re.begin(); ptId != re.end(); ++ptId) {
-      _InputPoints->GetPoint(ptId, p0);
+      p0 = _InputPoints + 3 * ptId;
+      v0 = _InputData   + _Stride * ptId;
 
       // Copy position/data of masked points
-      if (_Mask && _Mask->GetComponent(ptId, 0) == .0) {
-        if (smooth_points) {
-          _OutputPoints->SetPoint(ptId, p0);
+      if (_Mask && _Mask[ptId] == 0) {
+        if (_OutputPoints) {
+          memcpy(_OutputPoints + 3 * ptId, p0, 3 * sizeof(double));
         }
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            ia = (*_InputArrays )[i];
-            oa = (*_OutputArrays)[i];
-            for (j = 0; j < oa->GetNumberOfComponents(); ++j) {
-              oa->SetComponent(ptId, j, ia->GetComponent(ptId, j));
-            }
-          }
+        if (_Stride > 0) {
+          memcpy(_OutputData + _Stride * ptId, v0, _Stride * sizeof(double));
         }
         continue;
       }
@@ -275,54 +352,45 @@ struct SmoothData
       // Initialize sums
       if (_InclNodeItself) {
         norm = (w = _WeightFunction(ptId, p0, p0));
-        if (smooth_points) {
-          p[0] = w * p0[0];
-          p[1] = w * p0[1];
-          p[2] = w * p0[2];
-        }
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            ia = (*_InputArrays )[i];
-            for (j = 0, sum = data[i]; j < ia->GetNumberOfComponents(); ++j, ++sum) {
-              (*sum) = w * ia->GetComponent(ptId, j);
-            }
-          }
+        p[0] = w * p0[0];
+        p[1] = w * p0[1];
+        p[2] = w * p0[2];
+        for (j = 0; j < _Stride; ++j) {
+          sum[j] = w * v0[j];
         }
       } else {
         norm = p[0] = p[1] = p[2] = .0;
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            ia = (*_InputArrays )[i];
-            memset(data[i], 0, ia->GetNumberOfComponents() * sizeof(double));
-          }
+        for (j = 0; j < _Stride; ++j) {
+          sum[j] = .0;
         }
       }
 
       // Weighted sum of input data
       for (_EdgeTable->GetAdjacentPoints(ptId, adjPtIt, adjPtEnd); adjPtIt != adjPtEnd; ++adjPtIt) {
         adjPtId = static_cast<vtkIdType>(*adjPtIt);
-        _InputPoints->GetPoint(adjPtId, p1);
+        p1 = _InputPoints + 3 * adjPtId;
+        v1 = _InputData   + _Stride * adjPtId;
         norm += (w = _WeightFunction(ptId, p0, p1));
-        if (smooth_points) {
-          p[0] += w * p1[0];
-          p[1] += w * p1[1];
-          p[2] += w * p1[2];
-        }
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            ia  = (*_InputArrays )[i];
-            sum = data[i];
-            if (ia->GetNumberOfComponents() == 3) {
-              ia->GetTuple(adjPtId, v);
-              if (vtkMath::Dot(sum, v) < .0) {
-                vtkMath::MultiplyScalar(v, -1.0);
-              }
-              vtkMath::MultiplyScalar(v, w);
-              vtkMath::Add(sum, v, sum);
+        p[0] += w * p1[0];
+        p[1] += w * p1[1];
+        p[2] += w * p1[2];
+        for (i = 0; i < _NumberOfArrays; ++i) {
+          double       * const s = sum + _Offset[i];
+          const double * const v = v1  + _Offset[i];
+          if (_NumberOfComponents[i] == 3) {
+            dp = s[0] * v[0] + s[1] * v[1] + s[2] * v[2];
+            if (dp < .0) {
+              s[0] -= w * v[0];
+              s[1] -= w * v[1];
+              s[2] -= w * v[2];
             } else {
-              for (j = 0; j < ia->GetNumberOfComponents(); ++j, ++sum) {
-                (*sum) += w * ia->GetComponent(adjPtId, j);
-              }
+              s[0] += w * v[0];
+              s[1] += w * v[1];
+              s[2] += w * v[2];
+            }
+          } else {
+            for (j = 0; j < _NumberOfComponents[i]; ++j) {
+              s[j] += w * v[j];
             }
           }
         }
@@ -331,63 +399,43 @@ struct SmoothData
       // Normalize weights and compute output data
       if (norm > .0) alpha = 1.0 - _Lambda, beta = _Lambda / norm;
       else           alpha = 1.0,           beta = .0;
-      if (alpha) {
-        if (smooth_points) {
-          _OutputPoints->SetPoint(ptId, alpha * p0[0] + beta * p[0],
-                                        alpha * p0[1] + beta * p[1],
-                                        alpha * p0[2] + beta * p[2]);
-        }
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            ia = (*_InputArrays )[i];
-            oa = (*_OutputArrays)[i];
-            for (j = 0, sum = data[i]; j < oa->GetNumberOfComponents(); ++j, ++sum) {
-              oa->SetComponent(ptId, j, alpha * ia->GetComponent(ptId, j) + beta * (*sum));
-            }
-          }
-        }
-      } else {
-        if (smooth_points) {
-          _OutputPoints->SetPoint(ptId, beta * p[0], beta * p[1], beta * p[2]);
-        }
-        if (smooth_data) {
-          for (i = 0; i < _InputArrays->size(); ++i) {
-            oa  = (*_OutputArrays)[i];
-            for (j = 0, sum = data[i]; j < oa->GetNumberOfComponents(); ++j, ++sum) {
-              oa->SetComponent(ptId, j, beta * (*sum));
-            }
-          }
-        }
+      if (_OutputPoints) {
+        double * const q = _OutputPoints + 3 * ptId;
+        q[0] = alpha * p0[0] + beta * p[0];
+        q[1] = alpha * p0[1] + beta * p[1];
+        q[2] = alpha * p0[2] + beta * p[2];
+      }
+      double * const o = _OutputData + _Stride * ptId;
+      for (j = 0; j < _Stride; ++j) {
+        o[j] = alpha * v0[j] + beta * sum[j];
       }
-    }
-
-    if (smooth_data) {
-      for (i = 0; i < _InputArrays->size(); ++i) delete[] data[i];
-      delete[] data;
     }
   }
 
-  static void Run(vtkDataArray     *mask,
+  static void Run(SmoothingBuffers &buffers,
                   const EdgeTable  *edgeTable,
-                  vtkPoints        *input_points,
-                  vtkPoints        *output_points,
-                  const DataArrays &input_arrays,
-                  const DataArrays &output_arrays,
                   TKernel           kernel,
                   double            lambda,
                   bool              incl_node)
   {
+    const int ibuf = buffers._Input;
+    const int obuf = 1 - ibuf;
+    const bool smooth_points = !buffers._Points[1].empty();
     SmoothData<TKernel> body;
-    body._Mask           = mask;
-    body._EdgeTable      = edgeTable;
-    body._InputPoints    = input_points;
-    body._OutputPoints   = output_points;
-    body._InputArrays    = &input_arrays;
-    body._OutputArrays   = &output_arrays;
-    body._WeightFunction = kernel;
-    body._Lambda         = lambda;
-    body._InclNodeItself = incl_node;
-    blocked_range<vtkIdType> ptIds(0, input_points->GetNumberOfPoints());
+    body._Mask               = (buffers._Mask.empty() ? nullptr : buffers._Mask.data());
+    body._EdgeTable          = edgeTable;
+    body._InputPoints        = buffers._Points[smooth_points ? ibuf : 0].data();
+    body._OutputPoints       = (smooth_points ? buffers._Points[obuf].data() : nullptr);
+    body._InputData          = buffers._Data[ibuf].data();
+    body._OutputData         = buffers._Data[obuf].data();
+    body._Offset             = buffers._Offset.data();
+    body._NumberOfComponents = buffers._NumberOfComponents.data();
+    body._NumberOfArrays     = static_cast<int>(buffers._Offset.size());
+    body._Stride             = buffers._Stride;
+    body._WeightFunction     = kernel;
+    body._Lambda             = lambda;
+    body._InclNodeItself     = incl_node;
+    blocked_range<vtkIdType> ptIds(0, buffers._NumberOfPoints);
     parallel_for(ptIds, body);
   }
 };
@@ -1070,13 +1118,19 @@ void PolyDataSmoothing::Execute()
     }
   }
 
+  // Copy input to contiguous buffers when data magnitude/sign is not considered
+  const bool use_buffers = (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing));
+  SmoothingBuffers buffers;
+  if (use_buffers) buffers.Initialize(_Mask, ip, ia, _SmoothPoints);
+
+  MIRTK_START_TIMING();
   for (int iter = 1; iter <= _NumberOfIterations; ++iter) {
     if (_Verbose) {
       cout << "Smoothing iteration " << iter << " out of " << _NumberOfIterations << "...";
       cout.flush();
     }
     // Make copy of previously smoothed outputs
-    if (iter > 1) {
+    if (iter > 1 && !use_buffers) {
       if (_SmoothPoints) {
         if (iter == 2) ip = vtkSmartPointer<vtkPoints>::NewInstance(ip);
         ip->DeepCopy(_Output->GetPoints());
@@ -1093,8 +1147,8 @@ void PolyDataSmoothing::Execute()
     switch (_Weighting) {
       case Combinatorial: {
         typedef UniformWeightKernel Kernel;
-        if (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing)) {
-          SmoothData<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(), lambda, incl_node);
+        if (use_buffers) {
+          SmoothData<Kernel>::Run(buffers, _EdgeTable, Kernel(), lambda, incl_node);
         } else if (_SmoothMagnitude && !_SignedSmoothing) {
           SmoothDataMagnitude<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(), lambda, incl_node);
         } else if (_SmoothMagnitude && _SignedSmoothing) {
@@ -1105,8 +1159,8 @@ void PolyDataSmoothing::Execute()
       } break;
       case InverseDistance: {
         typedef InverseDistanceKernel Kernel;
-        if (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing)) {
-          SmoothData<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(_Sigma), lambda, incl_node);
+        if (use_buffers) {
+          SmoothData<Kernel>::Run(buffers, _EdgeTable, Kernel(_Sigma), lambda, incl_node);
         } else if (_SmoothMagnitude && !_SignedSmoothing) {
           SmoothDataMagnitude<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(_Sigma), lambda, incl_node);
         } else if (_SmoothMagnitude && _SignedSmoothing) {
@@ -1118,8 +1172,8 @@ void PolyDataSmoothing::Execute()
       case Default:
       case Gaussian: {
         typedef GaussianKernel Kernel;
-        if (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing)) {
-          SmoothData<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(sigma1), lambda, incl_node);
+        if (use_buffers) {
+          SmoothData<Kernel>::Run(buffers, _EdgeTable, Kernel(sigma1), lambda, incl_node);
         } else if (_SmoothMagnitude && !_SignedSmoothing) {
           SmoothDataMagnitude<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, Kernel(sigma1), lambda, incl_node);
         } else if (_SmoothMagnitude && _SignedSmoothing) {
@@ -1133,8 +1187,8 @@ void PolyDataSmoothing::Execute()
         vtkPointData * const pd = _Input->GetPointData();
         if (!_GeometryTensorName.empty()) {
           Kernel kernel(pd->GetArray(_GeometryTensorName.c_str()), sigma1, sigma2);
-          if (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing)) {
-            SmoothData<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, kernel, lambda, incl_node);
+          if (use_buffers) {
+            SmoothData<Kernel>::Run(buffers, _EdgeTable, kernel, lambda, incl_node);
           } else if (_SmoothMagnitude && !_SignedSmoothing) {
             SmoothDataMagnitude<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, kernel, lambda, incl_node);
           } else if (_SmoothMagnitude && _SignedSmoothing) {
@@ -1147,8 +1201,8 @@ void PolyDataSmoothing::Execute()
                         pd->GetArray(_MinimumDirectionName.c_str()),
                         pd->GetArray(_MaximumDirectionName.c_str()),
                         sigma1, sigma2);
-          if (_SmoothArrays.empty() || (!_SmoothMagnitude && !_SignedSmoothing)) {
-            SmoothData<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, kernel, lambda, incl_node);
+          if (use_buffers) {
+            SmoothData<Kernel>::Run(buffers, _EdgeTable, kernel, lambda, incl_node);
           } else if (_SmoothMagnitude && !_SignedSmoothing) {
             SmoothDataMagnitude<Kernel>::Run(_Mask, _EdgeTable, ip, op, ia, oa, kernel, lambda, incl_node);
           } else if (_SmoothMagnitude && _SignedSmoothing) {
@@ -1159,8 +1213,13 @@ void PolyDataSmoothing::Execute()
         }
       } break;
     }
+    // Output of this iteration is input of next iteration
+    if (use_buffers) buffers.Swap();
     if (_Verbose) cout << " done" << endl;
   }
+  if (use_buffers) buffers.Finalize(op, oa);
+  MIRTK_DEBUG_TIMING(3, _NumberOfIterations << " smoothing iterations of "
+                        << _Input->GetNumberOfPoints() << " points");
 }
 
 // -----------------------------------------------------------------------------
@@ -37,6 +37,7 @@
 #include "vtkDataArray.h"
 #include "vtkIdTypeArray.h"
 #include "vtkFloatArray.h"
+#include "vtkDoubleArray.h"
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkStructuredGrid.h"
@@ -60,49 +61,68 @@ typedef GenericLinearInterpolateImageFunction<GenericImage<double> > Displacemen
 
 // -----------------------------------------------------------------------------
 /// Copy VTK points to MIRTK point set
+///
+/// When the points are stored in double precision, which is the case for the
+/// output points of a transformed point set, the coordinates are copied
+/// directly from the contiguous VTK array.
 class CopyVtkPointsToIrtkPointSet
 {
-  vtkPoints *_Input;
-  PointSet  *_Output;
+  vtkPoints    *_Input;
+  const double *_Coords;
+  PointSet     *_Output;
 
 public:
 
   CopyVtkPointsToIrtkPointSet(vtkPoints *in, PointSet &out)
   :
-    _Input(in), _Output(&out)
-  {}
+    _Input(in), _Coords(NULL), _Output(&out)
+  {
+    vtkDoubleArray *data = vtkDoubleArray::SafeDownCast(in->GetData());
+    if (data) _Coords = data->GetPointer(0);
+  }
 
   void operator ()(const blocked_range<int> &re) const
   {
-    double p[3];
-    for (int i = re.begin(); i != re.end(); ++i) {
-      _Input ->GetPoint(i, p);
-      _Output->SetPoint(i, p);
+    if (_Coords) {
+      const double *p = _Coords + 3 * re.begin();
+      for (int i = re.begin(); i != re.end(); ++i, p += 3) {
+        _Output->SetPoint(i, p);
+      }
+    } else {
+      double p[3];
+      for (int i = re.begin(); i != re.end(); ++i) {
+        _Input ->GetPoint(i, p);
+        _Output->SetPoint(i, p);
+      }
     }
   }
 };
 
 // -----------------------------------------------------------------------------
 /// Update points of extracted point set surface
+///
+/// Operates directly on the double precision coordinates stored by VTK
+/// for the output point set and its surface, respectively.
 class UpdateSurfacePoints
 {
-  vtkPoints      *_Points;
-  vtkPolyData    *_Surface;
-  vtkIdTypeArray *_PtIds;
+  const double    *_Points;
+  double          *_SurfacePoints;
+  const vtkIdType *_PtIds;
 
 public:
 
-  UpdateSurfacePoints(vtkPoints *points, vtkPolyData *surface, vtkIdTypeArray *ptIds)
+  UpdateSurfacePoints(const double *points, double *surface, const vtkIdType *ptIds)
   :
-    _Points(points), _Surface(surface), _PtIds(ptIds)
+    _Points(points), _SurfacePoints(surface), _PtIds(ptIds)
   {}
 
   void operator ()(const blocked_range<vtkIdType> &re) const
   {
-    double p[3];
-    for (vtkIdType ptId = re.begin(); ptId != re.end(); ++ptId) {
-      _Points->GetPoint(_PtIds->GetComponent(ptId, 0), p);
-      _Surface->GetPoints()->SetPoint(ptId, p);
+    const double *p;
+    double       *q = _SurfacePoints + 3 * re.begin();
+    for (vtkIdType ptId = re.begin(); ptId != re.end(); ++ptId, q += 3) {
+      p = _Points + 3 * _PtIds[ptId];
+      q[0] = p[0], q[1] = p[1], q[2] = p[2];
     }
   }
 };
@@ -112,15 +132,15 @@ public:
 class UpdateSurfacePointData
 {
   vtkPointData *_PointData;
-  vtkPolyData  *_Surface;
-  vtkDataArray *_PtIds;
-  int           _MaxNumberOfComponents;
+  vtkPolyData     *_Surface;
+  const vtkIdType *_PtIds;
+  int              _MaxNumberOfComponents;
 
 public:
 
   UpdateSurfacePointData(vtkPointData *pd, vtkPolyData *surface, vtkIdTypeArray *ptIds)
   :
-    _PointData(pd), _Surface(surface), _PtIds(ptIds)
+    _PointData(pd), _Surface(surface), _PtIds(ptIds->GetPointer(0))
   {
     mirtkAssert(_PointData->GetNumberOfArrays() == _Surface->GetPointData()->GetNumberOfArrays(),
                 "surface has expected number of point data arrays");
@@ -138,7 +158,7 @@ public:
     vtkIdType origPtId;
     double *tuple = new double[_MaxNumberOfComponents];
     for (vtkIdType ptId = re.begin(); ptId != re.end(); ++ptId) {
-      origPtId = static_cast<vtkIdType>(_PtIds->GetComponent(ptId, 0));
+      origPtId = _PtIds[ptId];
       for (vtkIdType i = 0; i < _PointData->GetNumberOfArrays(); ++i) {
         _PointData->GetArray(i)->GetTuple(origPtId, tuple);
         _Surface->GetPointData()->GetArray(i)->SetTuple(ptId, tuple);
@@ -150,20 +170,24 @@ public:
 
 // -----------------------------------------------------------------------------
 /// Transform each point by applying the transformation evaluated at this point
+///
+/// The input points are read from the contiguous copy kept by the registered
+/// point set and the result is written directly into the double precision
+/// coordinates array of the output vtkPoints, i.e., without VTK accessors.
 struct TransformPoint
 {
-  vtkPoints            *_InputPoints;
-  vtkPoints            *_OutputPoints;
+  const class PointSet *_InputPoints;
+  double               *_OutputPoints;
   const Transformation *_Transformation;
   double                _t, _t0;
 
   void operator ()(const blocked_range<vtkIdType> &ids) const
   {
-    double p[3];
-    for (vtkIdType id = ids.begin(); id != ids.end(); ++id) {
-      _InputPoints->GetPoint(id, p);
+    double *p = _OutputPoints + 3 * ids.begin();
+    for (vtkIdType id = ids.begin(); id != ids.end(); ++id, p += 3) {
+      const Point &q = _InputPoints->GetPoint(static_cast<int>(id));
+      p[0] = q._x, p[1] = q._y, p[2] = q._z;
       _Transformation->Transform(p[0], p[1], p[2], _t, _t0);
-      _OutputPoints->SetPoint(id, p);
     }
   }
 };
@@ -172,20 +196,19 @@ struct TransformPoint
 /// Transform each point by applying the displacement interpolated at this point
 struct TransformPointUsingInterpolatedDisplacements
 {
-  vtkPoints                      *_InputPoints;
-  vtkPoints                      *_OutputPoints;
+  const class PointSet           *_InputPoints;
+  double                         *_OutputPoints;
   const DisplacementInterpolator *_Displacement;
 
   void operator ()(const blocked_range<vtkIdType> &ids) const
   {
-    double p[3], d[3];
-    for (vtkIdType id = ids.begin(); id != ids.end(); ++id) {
-      _InputPoints->GetPoint(id, p);
-      memcpy(d, p, 3 * sizeof(double));
+    double d[3], *p = _OutputPoints + 3 * ids.begin();
+    for (vtkIdType id = ids.begin(); id != ids.end(); ++id, p += 3) {
+      const Point &q = _InputPoints->GetPoint(static_cast<int>(id));
+      d[0] = q._x, d[1] = q._y, d[2] = q._z;
       _Displacement->WorldToImage(d[0], d[1], d[2]);
       _Displacement->Evaluate(d, d[0], d[1], d[2]);
-      p[0] += d[0], p[1] += d[1], p[2] += d[2];
-      _OutputPoints->SetPoint(id, p);
+      p[0] = q._x + d[0], p[1] = q._y + d[1], p[2] = q._z + d[2];
     }
   }
 };
@@ -761,23 +784,29 @@ void RegisteredPointSet::Update(bool force)
   // Transform points
   if (_Transformation) {
     // Update points of output point set
+    //
+    // The transformed coordinates are written directly into the contiguous
+    // double precision array owned by the output vtkPoints. The input points
+    // are read from the MIRTK copy made by InputPointsChanged.
     vtkPoints *inputPoints  = _InputPointSet ->GetPoints();
     vtkPoints *outputPoints = _OutputPointSet->GetPoints();
     const vtkIdType npoints = inputPoints->GetNumberOfPoints();
-    if (outputPoints == inputPoints) {
+    if (outputPoints == inputPoints || outputPoints->GetDataType() != VTK_DOUBLE) {
       vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+      points->SetDataTypeToDouble();
       _OutputPointSet->SetPoints(points);
       outputPoints = points;
     }
     outputPoints->SetNumberOfPoints(npoints);
+    double *outputCoords = vtkDoubleArray::SafeDownCast(outputPoints->GetData())->GetPointer(0);
     if (_ExternalDisplacement) {
       MIRTK_START_TIMING();
       DisplacementInterpolator disp;
       disp.Input(_ExternalDisplacement);
       disp.Initialize();
       TransformPointUsingInterpolatedDisplacements transform;
-      transform._InputPoints  = inputPoints;
-      transform._OutputPoints = outputPoints;
+      transform._InputPoints  = &_InputPoints;
+      transform._OutputPoints = outputCoords;
       transform._Displacement = &disp;
       parallel_for(blocked_range<vtkIdType>(0, npoints), transform);
       MIRTK_DEBUG_TIMING(7, "transforming points");
@@ -792,32 +821,38 @@ void RegisteredPointSet::Update(bool force)
       MIRTK_DEBUG_TIMING(7, "caching displacements");
       MIRTK_RESET_TIMING();
       TransformPointUsingInterpolatedDisplacements transform;
-      transform._InputPoints  = inputPoints;
-      transform._OutputPoints = outputPoints;
+      transform._InputPoints  = &_InputPoints;
+      transform._OutputPoints = outputCoords;
       transform._Displacement = &disp;
       parallel_for(blocked_range<vtkIdType>(0, npoints), transform);
       MIRTK_DEBUG_TIMING(7, "transforming points");
     } else {
       MIRTK_START_TIMING();
       TransformPoint transform;
-      transform._InputPoints    = inputPoints;
-      transform._OutputPoints   = outputPoints;
+      transform._InputPoints    = &_InputPoints;
+      transform._OutputPoints   = outputCoords;
       transform._Transformation = _Transformation;
       transform._t              = _Time;
       transform._t0             = _InputTime;
       parallel_for(blocked_range<vtkIdType>(0, npoints), transform);
       MIRTK_DEBUG_TIMING(7, "transforming points");
     }
+    outputPoints->Modified();
     // Update points of output point set surface
     if (_OutputSurface->GetPoints() != outputPoints) {
-      if (_OutputSurface->GetPoints() == _InputSurface->GetPoints()) {
+      vtkPoints *surfacePoints = _OutputSurface->GetPoints();
+      if (surfacePoints == _InputSurface->GetPoints() || surfacePoints->GetDataType() != VTK_DOUBLE) {
         vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        points->SetDataTypeToDouble();
         _OutputSurface->SetPoints(points);
+        surfacePoints = points;
       }
       const vtkIdType nspoints = _InputSurface->GetNumberOfPoints();
-      _OutputSurface->GetPoints()->SetNumberOfPoints(nspoints);
-      UpdateSurfacePoints update(outputPoints, _OutputSurface, OriginalSurfacePointIds());
+      surfacePoints->SetNumberOfPoints(nspoints);
+      double *surfaceCoords = vtkDoubleArray::SafeDownCast(surfacePoints->GetData())->GetPointer(0);
+      UpdateSurfacePoints update(outputCoords, surfaceCoords, OriginalSurfacePointIds()->GetPointer(0));
       parallel_for(blocked_range<vtkIdType>(0, nspoints), update);
+      surfacePoints->Modified();
     }
     // Invalidate cached attributes which are recomputed on demand only
     PointsChanged();
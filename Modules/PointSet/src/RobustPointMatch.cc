@@ -190,6 +190,7 @@ public:
             weight->second *= exp(- PointCorrespondence::Distance2BetweenPoints(p1+3, p2+3, _NumberOfFeatures-3) / _VarianceOfFeatures);
           }
         }
+        sort(_CorrWeights[i].begin(), _CorrWeights[i].end());
       }
     }
     Deallocate(p1);
@@ -246,7 +247,6 @@ public:
     locator->BuildLocator();
     body._Locator = locator;
     parallel_for(blocked_range<int>(0, m), body);
-    for (int i = 0; i < m; ++i) sort(corrw[i].begin(), corrw[i].end());
     MIRTK_DEBUG_TIMING(7, "calculating weight for each pair of points");
   }
 };
@@ -675,9 +675,11 @@ void RobustPointMatch::CalculateWeights()
   const int m = _M + 1;
   const int n = _N + 1;
 
-  // Allocate lists for non-zero weight entries
+  // Reuse lists for non-zero weight entries of previous annealing step
   const int nentries = (_Weight.Layout() == WeightMatrix::CRS ? m : n);
-  WeightMatrix::Entries *entries = new WeightMatrix::Entries[nentries];
+  _WeightEntries.resize(nentries);
+  for (int i = 0; i < nentries; ++i) _WeightEntries[i].clear();
+  WeightMatrix::Entries *entries = _WeightEntries.data();
 
   // Calculate correspondence weights
   CalculateCorrespondenceWeights::Run(_Target, _TargetSample, &_TargetFeatures,
@@ -717,7 +719,6 @@ void RobustPointMatch::CalculateWeights()
   // Initialize correspondence matrix
   MIRTK_RESET_TIMING();
   _Weight.Initialize(m, n, entries, true);
-  delete[] entries;
   MIRTK_DEBUG_TIMING(7, "copying sparse matrix entries (NNZ=" << _Weight.NNZ() << ")");
 }
 
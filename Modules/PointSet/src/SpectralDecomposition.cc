@@ -860,6 +860,22 @@ void NormalizedLaplacian(SparseMatrix &L, const SparseMatrix &A,
 // -----------------------------------------------------------------------------
 void Laplacian(SparseMatrix &L, vtkPolyData *dataset,
                FeatureWeights edge_weights, FeatureWeights node_weights)
+{
+  Vector D;
+  Laplacian(L, D, dataset, edge_weights, node_weights);
+}
+
+// -----------------------------------------------------------------------------
+void Laplacian(SparseMatrix &L, Vector &D, vtkPolyData *dataset,
+               FeatureWeights edge_weights, FeatureWeights node_weights)
+{
+  Vector G;
+  Laplacian(L, D, G, dataset, edge_weights, node_weights);
+}
+
+// -----------------------------------------------------------------------------
+void Laplacian(SparseMatrix &L, Vector &D, Vector &G, vtkPolyData *dataset,
+               FeatureWeights edge_weights, FeatureWeights node_weights)
 {
   mirtkAssert(dataset->GetNumberOfPoints() > 1, "dataset must have at least two points");
 
@@ -890,7 +906,7 @@ void Laplacian(SparseMatrix &L, vtkPolyData *dataset,
   AdjacencyMatrix(L, dataset, edge_weights);
 
   // Node weighting
-  Vector D, G;
+  G.Clear();
   Degree(D, L);
   if (!node_weights.empty()) {
     const int n = dataset->GetNumberOfPoints();
@@ -940,10 +956,21 @@ void Laplacian(SparseMatrix &L, vtkPolyData *dataset,
 // =============================================================================
 
 // -----------------------------------------------------------------------------
-int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v)
+int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v,
+                      EigenSolver solver, const Vector *D, const Matrix *m0)
 {
   MIRTK_START_TIMING();
 
+  if (solver == EigenSolver_Default) {
+    #if MIRTK_Numerics_WITH_eigs
+      solver = EigenSolver_ARPACK;
+    #else
+      solver = EigenSolver_LOBPCG;
+    #endif
+  }
+  if (D && D->Rows() == 0) D = NULL;
+  if (m0 && m0->Rows() != L.Rows()) m0 = NULL;
+
   // Repeat eigen decomposition until enough eigenmodes are found
   const double     eps     = 1e-10; // Discard eigenvectors with eigenvalue below
   int              niter   = 0;     // Number of iterations
@@ -953,6 +980,7 @@ int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v)
   Array<int> idx;             // Ascending order of eigenvalues
   Matrix           vec;             // Eigenvectors
   Vector           val;             // Eigenvalues
+  Matrix           vec0;            // Initial eigenvectors
 
   do {
 
@@ -960,7 +988,19 @@ int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v)
     nev = k + fiedler;
 
     // Perform iterative eigen decomposition
-    nconv = L.Eigenvectors(vec, val, nev, "sm");
+    if (solver == EigenSolver_LOBPCG) {
+      if (m0) {
+        // Constant null vector followed by given eigenmodes
+        vec0.Initialize(L.Rows(), min(nev, fiedler + m0->Cols()));
+        for (int c = 0; c < vec0.Cols(); ++c)
+        for (int r = 0; r < vec0.Rows(); ++r) {
+          vec0(r, c) = (c < fiedler ? 1.0 : m0->Get(r, c - fiedler));
+        }
+      }
+      nconv = L.SmallestEigenvectors(vec, val, nev, D, m0 ? &vec0 : NULL);
+    } else {
+      nconv = L.Eigenvectors(vec, val, nev, "sm");
+    }
 
     // Determine ascending order
     idx.resize(nconv);
@@ -1002,27 +1042,34 @@ int ComputeEigenmodes(const SparseMatrix &L, int k, Matrix &m, Vector &v)
     v(j) = val(c);
   }
 
-  MIRTK_DEBUG_TIMING(7, "calculating the eigenmodes (#iter=" << niter << ")");
+  MIRTK_DEBUG_TIMING(7, "calculating the eigenmodes using " << ToString(solver)
+                        << " (#iter=" << niter << ")");
   return k;
 }
 
 // -----------------------------------------------------------------------------
 int ComputeEigenmodes(vtkPolyData *d, int k, Matrix &m, Vector &v,
-                      FeatureWeights ew, FeatureWeights nw)
+                      FeatureWeights ew, FeatureWeights nw,
+                      EigenSolver s, const Matrix *m0)
 {
   SparseMatrix L(SparseMatrix::CCS);
-  Laplacian(L, d, ew, nw);
-  return ComputeEigenmodes(L, k, m, v);
+  Vector       D, G;
+  Laplacian(L, D, G, d, ew, nw);
+  // L = G D^-1 (D - A) is self-adjoint w.r.t. the inner product weighted by D/G
+  if (G.Rows() == D.Rows()) {
+    for (int i = 0; i < D.Rows(); ++i) {
+      if (G(i) > .0) D(i) /= G(i);
+    }
+  }
+  return ComputeEigenmodes(L, k, m, v, s, &D, m0);
 }
 
 // -----------------------------------------------------------------------------
 int ComputeEigenmodes(vtkPolyData *d, int k, FeatureWeights ew, FeatureWeights nw)
 {
-  SparseMatrix L(SparseMatrix::CCS);
-  Laplacian(L, d, ew, nw);
   Matrix m;
   Vector v;
-  k = ComputeEigenmodes(L, k, m, v);
+  k = ComputeEigenmodes(d, k, m, v, ew, nw);
   if (k > 0) SetEigenmodes(d, m);
   return k;
 }
@@ -26,19 +26,19 @@
 #include "mirtk/PointLocator.h"
 #include "mirtk/Parallel.h"
 #include "mirtk/Profiling.h"
+#include "mirtk/Algorithm.h"
 #include "mirtk/VtkMath.h"
 
 #include "vtkPlane.h"
 #include "vtkTriangle.h"
 
 #include "vtkPolyData.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkDataArray.h"
 #include "vtkFloatArray.h"
 #include "vtkUnsignedCharArray.h"
 
-#include "vtkAbstractPointLocator.h"
-#include "vtkOctreePointLocator.h"
 #include "vtkIntersectionPolyDataFilter.h"
 
 
@@ -108,6 +108,130 @@ public:
   }
 };
 
+// -----------------------------------------------------------------------------
+/// Compare cells by coordinate of their center along given axis
+struct CompareCellCenters
+{
+  const double *_Center;
+  int           _Axis;
+
+  bool operator ()(int a, int b) const
+  {
+    return _Center[3 * a + _Axis] < _Center[3 * b + _Axis];
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Recursively split cells at median of their centers along the longest axis
+///
+/// Nodes are appended in pre-order, i.e., the index of each child node is
+/// greater than the index of its parent. The node bounds are set by RefitBVH.
+int BuildBVHNode(Array<SurfaceCollisions::BVHNode> &bvh, Array<int> &cellIds,
+                 const double *center, int first, int count)
+{
+  const int max_leaf_size = 4;
+
+  SurfaceCollisions::BVHNode node;
+  node._Left  = node._Right = -1;
+  node._First = first;
+  node._Count = count;
+  const int idx = static_cast<int>(bvh.size());
+  bvh.push_back(node);
+
+  if (count > max_leaf_size) {
+    const double inf = numeric_limits<double>::infinity();
+    double bounds[6] = { +inf, -inf, +inf, -inf, +inf, -inf };
+    for (int i = first; i < first + count; ++i) {
+      const double *c = center + 3 * cellIds[i];
+      for (int d = 0; d < 3; ++d) {
+        if (c[d] < bounds[2*d  ]) bounds[2*d  ] = c[d];
+        if (c[d] > bounds[2*d+1]) bounds[2*d+1] = c[d];
+      }
+    }
+    CompareCellCenters cmp;
+    cmp._Center = center;
+    cmp._Axis   = 0;
+    for (int d = 1; d < 3; ++d) {
+      if (bounds[2*d+1] - bounds[2*d] > bounds[2*cmp._Axis+1] - bounds[2*cmp._Axis]) {
+        cmp._Axis = d;
+      }
+    }
+    const int half = count / 2;
+    nth_element(cellIds.begin() + first, cellIds.begin() + first + half,
+                cellIds.begin() + first + count, cmp);
+    const int left  = BuildBVHNode(bvh, cellIds, center, first, half);
+    const int right = BuildBVHNode(bvh, cellIds, center, first + half, count - half);
+    bvh[idx]._Left  = left;
+    bvh[idx]._Right = right;
+    bvh[idx]._First = -1;
+    bvh[idx]._Count = 0;
+  }
+
+  return idx;
+}
+
+// -----------------------------------------------------------------------------
+/// Compute bounds of triangles referenced by leaf nodes of BVH
+class RefitBVHLeaves
+{
+  vtkPolyData                *_Surface;
+  SurfaceCollisions::BVHNode *_Nodes;
+  const int                  *_CellIds;
+
+public:
+
+  RefitBVHLeaves(vtkPolyData *surface, SurfaceCollisions::BVHNode *nodes, const int *cellIds)
+  :
+    _Surface(surface), _Nodes(nodes), _CellIds(cellIds)
+  {}
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    const double inf = numeric_limits<double>::infinity();
+
+    vtkIdType npts, *pts;
+    double    p[3];
+
+    for (int n = re.begin(); n != re.end(); ++n) {
+      SurfaceCollisions::BVHNode &node = _Nodes[n];
+      if (node._Left != -1) continue;
+      double *bounds = node._Bounds;
+      bounds[0] = bounds[2] = bounds[4] = +inf;
+      bounds[1] = bounds[3] = bounds[5] = -inf;
+      for (int i = node._First; i < node._First + node._Count; ++i) {
+        _Surface->GetCellPoints(_CellIds[i], npts, pts);
+        for (vtkIdType j = 0; j < npts; ++j) {
+          _Surface->GetPoint(pts[j], p);
+          for (int d = 0; d < 3; ++d) {
+            if (p[d] < bounds[2*d  ]) bounds[2*d  ] = p[d];
+            if (p[d] > bounds[2*d+1]) bounds[2*d+1] = p[d];
+          }
+        }
+      }
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Update bounds of BVH nodes given the current positions of the triangles
+void RefitBVH(vtkPolyData *surface, Array<SurfaceCollisions::BVHNode> &bvh, const Array<int> &cellIds)
+{
+  const int nnodes = static_cast<int>(bvh.size());
+  if (nnodes == 0) return;
+  RefitBVHLeaves leaves(surface, bvh.data(), cellIds.data());
+  parallel_for(blocked_range<int>(0, nnodes), leaves);
+  for (int n = nnodes - 1; n >= 0; --n) {
+    SurfaceCollisions::BVHNode &node = bvh[n];
+    if (node._Left == -1) continue;
+    const double *a = bvh[node._Left ]._Bounds;
+    const double *b = bvh[node._Right]._Bounds;
+    for (int d = 0; d < 6; d += 2) {
+      node._Bounds[d  ] = min(a[d  ], b[d  ]);
+      node._Bounds[d+1] = max(a[d+1], b[d+1]);
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 /// Check for collisions such as self-intersections and faces too close
 class FindCollisions
@@ -118,8 +242,11 @@ class FindCollisions
   typedef SurfaceCollisions::CollisionsArray    CollisionsArray;
   typedef SurfaceCollisions::CollisionInfo      CollisionInfo;
 
+  typedef SurfaceCollisions::BVHNode            BVHNode;
+
   SurfaceCollisions       *_Filter;
-  vtkAbstractPointLocator *_Locator;
+  const Array<BVHNode>    *_BVH;
+  const Array<int>        *_BVHCellIds;
   IntersectionsArray      *_Intersections;
   CollisionsArray         *_Collisions;
   double                   _MaxRadius;
@@ -127,6 +254,55 @@ class FindCollisions
   double                   _MinBackfaceDistance;
   double                   _MinAngleCos;
 
+  /// Squared distance of point to axis-aligned bounding box
+  static inline double Distance2ToBounds(const double p[3], const double bounds[6])
+  {
+    double d, d2 = .0;
+    for (int i = 0; i < 3; ++i) {
+      if      (p[i] < bounds[2*i  ]) d = bounds[2*i  ] - p[i];
+      else if (p[i] > bounds[2*i+1]) d = p[i] - bounds[2*i+1];
+      else continue;
+      d2 += d * d;
+    }
+    return d2;
+  }
+
+  /// Find triangles with at least one corner within search radius
+  void FindCellsWithinRadius(vtkPolyData *surface, vtkIdType cellId,
+                             const double c[3], double radius,
+                             Array<int> &stack, Array<int> &cellIds) const
+  {
+    const double r2 = radius * radius;
+    vtkIdType    npts, *pts, otherCellId;
+    double       p[3];
+
+    cellIds.clear();
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+      const BVHNode &node = (*_BVH)[stack.back()];
+      stack.pop_back();
+      if (Distance2ToBounds(c, node._Bounds) > r2) continue;
+      if (node._Left != -1) {
+        stack.push_back(node._Right);
+        stack.push_back(node._Left);
+        continue;
+      }
+      for (int i = node._First; i < node._First + node._Count; ++i) {
+        otherCellId = (*_BVHCellIds)[i];
+        if (otherCellId == cellId) continue;
+        surface->GetCellPoints(otherCellId, npts, pts);
+        for (vtkIdType j = 0; j < npts; ++j) {
+          surface->GetPoint(pts[j], p);
+          if (vtkMath::Distance2BetweenPoints(p, c) <= r2) {
+            cellIds.push_back(static_cast<int>(otherCellId));
+            break;
+          }
+        }
+      }
+    }
+  }
+
   /// Check whether point c is on the "left" of the line defined by a and b
   inline int IsLeft(const double a[2], const double b[2], const double c[2]) const
   {
@@ -152,13 +328,10 @@ public:
     double         tri1[3][3], tri2[3][3], tri1_2D[3][2], tri2_2D[3][2];
     double         n1[3], n2[3], p1[3], p2[3], r1, c1[3], v[3], search_radius, dot;
     int            tri12[3], i1, i2, shared_vertex1, shared_vertex2, coplanar, s1, s2;
-    vtkIdType      npts, *pts1, *pts2, *cells, cellId1, cellId2;
-    unsigned short ncells;
+    vtkIdType      npts, *pts1, *pts2, cellId1, cellId2;
     CollisionInfo  collision;
     CollisionType  type;
-
-    vtkSmartPointer<vtkIdList> ptIds   = vtkSmartPointer<vtkIdList>::New();
-    vtkSmartPointer<vtkIdList> cellIds = vtkSmartPointer<vtkIdList>::New();
+    Array<int>     stack, cellIds;
 
     for (cellId1 = re.begin(); cellId1 != re.end(); ++cellId1) {
 
@@ -183,18 +356,11 @@ public:
 
       // Find other triangles within search radius
       search_radius = min(max(_Filter->MinSearchRadius(), r1 + R), _Filter->MaxSearchRadius());
-      _Locator->FindPointsWithinRadius(search_radius, c1, ptIds);
-      cellIds->Reset();
-      for (vtkIdType i = 0; i < ptIds->GetNumberOfIds(); ++i) {
-        surface->GetPointCells(ptIds->GetId(i), ncells, cells);
-        for (unsigned short j = 0; j < ncells; ++j) {
-          if (cells[j] != cellId1) cellIds->InsertUniqueId(cells[j]);
-        }
-      }
+      FindCellsWithinRadius(surface, cellId1, c1, search_radius, stack, cellIds);
 
       // Check for collisions between this triangle and the found nearby triangles
-      for (vtkIdType i = 0; i < cellIds->GetNumberOfIds(); ++i) {
-        cellId2 = cellIds->GetId(i);
+      for (size_t i = 0; i < cellIds.size(); ++i) {
+        cellId2 = cellIds[i];
 
         // Get vertex positions of nearby candidate triangle
         surface->GetCellPoints(cellId2, npts, pts2);
@@ -369,13 +535,10 @@ public:
                   CollisionsArray    *collisions)
   {
     vtkDataArray *radius = filter->GetRadiusArray();
-    vtkSmartPointer<vtkAbstractPointLocator> locator;
-    locator = vtkSmartPointer<vtkOctreePointLocator>::New();
-    locator->SetDataSet(filter->Output());
-    locator->BuildLocator();
     FindCollisions body;
     body._Filter               = filter;
-    body._Locator              = locator;
+    body._BVH                  = &filter->BVH();
+    body._BVHCellIds           = &filter->BVHCellIds();
     body._Intersections        = intersections;
     body._Collisions           = collisions;
     body._MaxRadius            = radius->GetRange(0)[1];
@@ -411,7 +574,8 @@ SurfaceCollisions::SurfaceCollisions()
   _FrontfaceCollisionTest(false),
   _BackfaceCollisionTest(false),
   _StoreIntersectionDetails(true),
-  _StoreCollisionDetails(true)
+  _StoreCollisionDetails(true),
+  _BVHPolysMTime(0)
 {
 }
 
@@ -539,6 +703,35 @@ void SurfaceCollisions::Initialize()
   }
 }
 
+// -----------------------------------------------------------------------------
+void SurfaceCollisions::UpdateBVH()
+{
+  vtkCellArray * const polys = _Output->GetPolys();
+  const int ncells = static_cast<int>(_Output->GetNumberOfCells());
+  if (_BVH.empty() || _BVHPolys != polys || _BVHPolysMTime != polys->GetMTime() ||
+      static_cast<int>(_BVHCellIds.size()) != ncells) {
+    MIRTK_START_TIMING();
+    vtkDataArray * const center = GetCenterArray();
+    Array<double> centers(3 * ncells);
+    for (int cellId = 0; cellId < ncells; ++cellId) {
+      center->GetTuple(cellId, &centers[3 * cellId]);
+    }
+    _BVHCellIds.resize(ncells);
+    for (int cellId = 0; cellId < ncells; ++cellId) {
+      _BVHCellIds[cellId] = cellId;
+    }
+    _BVH.clear();
+    _BVH.reserve(ncells > 0 ? 2 * ncells : 0);
+    BuildBVHNode(_BVH, _BVHCellIds, centers.data(), 0, ncells);
+    _BVHPolys      = polys;
+    _BVHPolysMTime = polys->GetMTime();
+    MIRTK_DEBUG_TIMING(6, "building bounding volume hierarchy");
+  }
+  MIRTK_START_TIMING();
+  RefitBVH(_Output, _BVH, _BVHCellIds);
+  MIRTK_DEBUG_TIMING(6, "refitting bounding volume hierarchy");
+}
+
 // -----------------------------------------------------------------------------
 void SurfaceCollisions::Run()
 {
@@ -548,6 +741,7 @@ void SurfaceCollisions::Run()
     MIRTK_DEBUG_TIMING(6, "initializing collision detection");
   }
   if (_Output->GetNumberOfCells() > 0) {
+    UpdateBVH();
     MIRTK_START_TIMING();
     FindCollisions::Run(this, _StoreIntersectionDetails ? &_Intersections : NULL,
                               _StoreCollisionDetails    ? &_Collisions    : NULL);
@@ -0,0 +1,186 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2016 Imperial College London
+ * Copyright 2016 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mirtk/Common.h"
+#include "mirtk/PointSetIO.h"
+
+#include "vtkSmartPointer.h"
+#include "vtkPolyData.h"
+#include "vtkPoints.h"
+#include "vtkCellArray.h"
+#include "vtkPointData.h"
+#include "vtkCellData.h"
+#include "vtkFloatArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIntArray.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+using namespace mirtk;
+
+
+// =============================================================================
+// Auxiliaries
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Name of temporary file written by tests
+static const char *msc_name = "testPointSetIO.msc";
+
+// -----------------------------------------------------------------------------
+/// Square of two triangles with a line and point and cell data arrays
+static vtkSmartPointer<vtkPolyData> NewSurface()
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->InsertNextPoint(0., 0., 0.);
+  points->InsertNextPoint(1., 0., 0.);
+  points->InsertNextPoint(1., 1., 0.);
+  points->InsertNextPoint(0., 1., .5);
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  const vtkIdType tri1[3] = {0, 1, 2}, tri2[3] = {0, 2, 3};
+  polys->InsertNextCell(3, tri1);
+  polys->InsertNextCell(3, tri2);
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  const vtkIdType line[2] = {1, 3};
+  lines->InsertNextCell(2, line);
+
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->SetPoints(points);
+  surface->SetLines(lines);
+  surface->SetPolys(polys);
+
+  vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(4);
+  for (vtkIdType i = 0; i < 4; ++i) scalars->SetValue(i, .5f * i);
+  surface->GetPointData()->SetScalars(scalars);
+
+  vtkSmartPointer<vtkDoubleArray> vectors = vtkSmartPointer<vtkDoubleArray>::New();
+  vectors->SetName("vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(4);
+  for (vtkIdType i = 0; i < 4; ++i) vectors->SetTuple3(i, i, -1. * i, .25 * i);
+  surface->GetPointData()->AddArray(vectors);
+
+  vtkSmartPointer<vtkIntArray> labels = vtkSmartPointer<vtkIntArray>::New();
+  labels->SetName("labels");
+  labels->SetNumberOfTuples(3);
+  for (vtkIdType i = 0; i < 3; ++i) labels->SetValue(i, static_cast<int>(10 * i + 1));
+  surface->GetCellData()->AddArray(labels);
+
+  return surface;
+}
+
+// -----------------------------------------------------------------------------
+/// Compare data arrays element by element
+static void ExpectEqualArrays(vtkDataArray *expected, vtkDataArray *actual)
+{
+  ASSERT_TRUE(actual != nullptr);
+  EXPECT_EQ(expected->GetDataType(),           actual->GetDataType());
+  EXPECT_EQ(expected->GetNumberOfComponents(), actual->GetNumberOfComponents());
+  ASSERT_EQ(expected->GetNumberOfTuples(),     actual->GetNumberOfTuples());
+  for (vtkIdType i = 0; i < expected->GetNumberOfTuples(); ++i)
+  for (int j = 0; j < expected->GetNumberOfComponents(); ++j) {
+    EXPECT_EQ(expected->GetComponent(i, j), actual->GetComponent(i, j));
+  }
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+TEST(PointSetIO, BinarySurfaceCacheRoundTrip)
+{
+  vtkSmartPointer<vtkPolyData> surface = NewSurface();
+  ASSERT_TRUE(WriteMSC(msc_name, surface));
+  vtkSmartPointer<vtkPolyData> output = ReadMSC(msc_name, true);
+  std::remove(msc_name);
+
+  ASSERT_EQ(surface->GetNumberOfPoints(), output->GetNumberOfPoints());
+  ExpectEqualArrays(surface->GetPoints()->GetData(), output->GetPoints()->GetData());
+
+  ASSERT_EQ(surface->GetNumberOfLines(), output->GetNumberOfLines());
+  ASSERT_EQ(surface->GetNumberOfPolys(), output->GetNumberOfPolys());
+  EXPECT_EQ(0, output->GetNumberOfVerts());
+  EXPECT_EQ(0, output->GetNumberOfStrips());
+  vtkIdType npts1, *pts1, npts2, *pts2;
+  for (vtkIdType cellId = 0; cellId < surface->GetNumberOfCells(); ++cellId) {
+    surface->GetCellPoints(cellId, npts1, pts1);
+    output ->GetCellPoints(cellId, npts2, pts2);
+    ASSERT_EQ(npts1, npts2);
+    for (vtkIdType i = 0; i < npts1; ++i) EXPECT_EQ(pts1[i], pts2[i]);
+  }
+
+  ASSERT_EQ(2, output->GetPointData()->GetNumberOfArrays());
+  ASSERT_EQ(1, output->GetCellData ()->GetNumberOfArrays());
+  ExpectEqualArrays(surface->GetPointData()->GetArray("scalars"), output->GetPointData()->GetScalars());
+  ExpectEqualArrays(surface->GetPointData()->GetArray("vectors"), output->GetPointData()->GetArray("vectors"));
+  ExpectEqualArrays(surface->GetCellData ()->GetArray("labels"),  output->GetCellData ()->GetArray("labels"));
+}
+
+// -----------------------------------------------------------------------------
+TEST(PointSetIO, BinarySurfaceCacheSkipsArraysOfWrongSize)
+{
+  vtkSmartPointer<vtkPolyData> surface = NewSurface();
+  vtkSmartPointer<vtkFloatArray> partial = vtkSmartPointer<vtkFloatArray>::New();
+  partial->SetName("partial");
+  partial->SetNumberOfTuples(2);
+  partial->FillComponent(0, 1.f);
+  surface->GetPointData()->AddArray(partial);
+  surface->GetCellData ()->AddArray(partial);
+
+  ASSERT_TRUE(WriteMSC(msc_name, surface));
+  vtkSmartPointer<vtkPolyData> output = ReadMSC(msc_name);
+  std::remove(msc_name);
+
+  ASSERT_EQ(surface->GetNumberOfPoints(), output->GetNumberOfPoints());
+  EXPECT_EQ(surface->GetNumberOfCells(), output->GetNumberOfCells());
+  EXPECT_TRUE(output->GetPointData()->GetArray("partial") == nullptr);
+  EXPECT_TRUE(output->GetCellData ()->GetArray("partial") == nullptr);
+  ExpectEqualArrays(surface->GetPointData()->GetArray("vectors"), output->GetPointData()->GetArray("vectors"));
+  ExpectEqualArrays(surface->GetCellData ()->GetArray("labels"),  output->GetCellData ()->GetArray("labels"));
+}
+
+// -----------------------------------------------------------------------------
+TEST(PointSetIO, BinarySurfaceCacheInvalidFile)
+{
+  FILE *fp = fopen(msc_name, "wb");
+  ASSERT_TRUE(fp != nullptr);
+  fputs("not a surface cache", fp);
+  fclose(fp);
+  vtkSmartPointer<vtkPolyData> output = ReadMSC(msc_name);
+  std::remove(msc_name);
+  EXPECT_EQ(0, output->GetNumberOfPoints());
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
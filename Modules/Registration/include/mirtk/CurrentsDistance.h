@@ -55,6 +55,13 @@ class CurrentsDistance : public PointSetDistance
   /// Sigma value of currents kernel
   mirtkPublicAttributeMacro(double, Sigma);
 
+  /// Radius in units of sigma beyond which the currents kernel is truncated
+  ///
+  /// Controls the trade-off between accuracy and speed of the evaluation.
+  /// At the default of 2.5 sigma, the kernel is truncated at exp(-6.25),
+  /// i.e., about 0.2% of its maximum value.
+  mirtkPublicAttributeMacro(double, KernelCutoff);
+
   /// Whether to ensure symmetry of currents dot product
   mirtkPublicAttributeMacro(bool, Symmetric);
 
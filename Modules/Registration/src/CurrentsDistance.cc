@@ -20,6 +20,7 @@
 #include "mirtk/CurrentsDistance.h"
 
 #include "mirtk/Math.h"
+#include "mirtk/Array.h"
 #include "mirtk/Memory.h"
 #include "mirtk/Vector3D.h"
 #include "mirtk/Parallel.h"
@@ -33,12 +34,6 @@
 #include "vtkFloatArray.h"
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
-// Due to a bug in vtkKdTreePointLocator, calling BuildLocator
-// is not sufficient to make FindClosestPoint thread-safe as it does
-// not call vtkBSPIntersections::BuildRegionsList
-// (cf. http://www.vtk.org/Bug/view.php?id=15206 ).
-// Therefore, use Octree instead of Kd-tree in the meantime.
-#include "vtkOctreePointLocator.h"
 
 
 namespace mirtk {
@@ -57,6 +52,7 @@ CurrentsDistance::CurrentsDistance(const char *name, double weight)
 :
   PointSetDistance(name, weight),
   _Sigma(-0.05),
+  _KernelCutoff(2.5),
   _Symmetric(true),
   _TargetNormSquared(.0)
 {
@@ -66,6 +62,9 @@ CurrentsDistance::CurrentsDistance(const char *name, double weight)
 CurrentsDistance::CurrentsDistance(const CurrentsDistance &other)
 :
   PointSetDistance(other),
+  _Sigma(other._Sigma),
+  _KernelCutoff(other._KernelCutoff),
+  _Symmetric(other._Symmetric),
   _TargetNormSquared(other._TargetNormSquared)
 {
   if (other._TargetCurrent) {
@@ -82,6 +81,9 @@ CurrentsDistance::CurrentsDistance(const CurrentsDistance &other)
 CurrentsDistance &CurrentsDistance::operator =(const CurrentsDistance &other)
 {
   PointSetDistance::operator =(other);
+  _Sigma             = other._Sigma;
+  _KernelCutoff      = other._KernelCutoff;
+  _Symmetric         = other._Symmetric;
   _TargetNormSquared = other._TargetNormSquared;
   if (other._TargetCurrent) {
     _TargetCurrent = vtkSmartPointer<vtkPolyData>::New();
@@ -165,28 +167,161 @@ vtkSmartPointer<vtkPolyData> CurrentsDistance::ToCurrent(vtkPointSet *data)
   return SurfaceToCurrent(surface);
 }
 
+// -----------------------------------------------------------------------------
+/// Uniform grid of currents centers with cells at least as large as the radius
+/// beyond which the currents kernel is truncated, such that all centers within
+/// this radius of a query point are found in the 3x3x3 neighbouring cells
+///
+/// The centers and weights are copied into contiguous arrays sorted by grid
+/// cell, which makes range queries considerably cheaper than the octree of
+/// vtkOctreePointLocator, which has to be rebuilt at every evaluation anyway.
+class CurrentsDistanceGrid
+{
+  Array<double> _Centers; ///< Centers of currents sorted by grid cell
+  Array<double> _Weights; ///< Weights of currents sorted by grid cell
+  Array<int>    _Start;   ///< Index of first center of each grid cell
+  double        _Origin[3];
+  double        _Spacing;
+  int           _Size[3];
+  double        _Radius2;
+
+public:
+
+  /// Maximum number of grid cells
+  static const int MaxNumberOfCells = 1 << 24;
+
+  /// Initialize grid for given centers and weights of currents
+  void Initialize(vtkPoints *centers, vtkDataArray *weights, double radius)
+  {
+    const int n = static_cast<int>(centers->GetNumberOfPoints());
+    const int m = weights->GetNumberOfComponents();
+    double    p[3], bounds[6] = {.0, .0, .0, .0, .0, .0};
+
+    _Radius2 = radius * radius;
+    if (n > 0) centers->GetBounds(bounds);
+    _Origin[0] = bounds[0], _Origin[1] = bounds[2], _Origin[2] = bounds[4];
+
+    // Cell size equal to radius unless this results in too many empty cells,
+    // where the number of cells is computed in floating point arithmetic as
+    // it may exceed the range of int for a small radius
+    const double max_cells = min(8.0 * n + 8.0, static_cast<double>(MaxNumberOfCells));
+    double size[3];
+    _Spacing = (radius > .0 ? radius : 1.0);
+    while (true) {
+      size[0] = floor((bounds[1] - bounds[0]) / _Spacing) + 1.0;
+      size[1] = floor((bounds[3] - bounds[2]) / _Spacing) + 1.0;
+      size[2] = floor((bounds[5] - bounds[4]) / _Spacing) + 1.0;
+      if (size[0] * size[1] * size[2] <= max_cells) break;
+      _Spacing *= 2.0;
+    }
+    _Size[0] = static_cast<int>(size[0]);
+    _Size[1] = static_cast<int>(size[1]);
+    _Size[2] = static_cast<int>(size[2]);
+    const int ncells = _Size[0] * _Size[1] * _Size[2];
+
+    // Sort currents by grid cell (counting sort)
+    Array<int> cell(n);
+    _Start.clear();
+    _Start.resize(ncells + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      centers->GetPoint(i, p);
+      cell[i] = CellIndex(p);
+      ++_Start[cell[i] + 1];
+    }
+    for (int c = 0; c < ncells; ++c) _Start[c + 1] += _Start[c];
+
+    Array<int> pos(_Start.begin(), _Start.end() - 1);
+    double     w[3];
+    _Centers.resize(3 * n);
+    _Weights.resize(3 * n);
+    for (int i = 0; i < n; ++i) {
+      double *c = &_Centers[3 * pos[cell[i]]];
+      double *d = &_Weights[3 * pos[cell[i]]];
+      centers->GetPoint(i, c);
+      w[0] = w[1] = w[2] = .0;
+      weights->GetTuple(i, w);
+      d[0] = w[0], d[1] = (m > 1 ? w[1] : .0), d[2] = (m > 2 ? w[2] : .0);
+      ++pos[cell[i]];
+    }
+  }
+
+  /// Find centers within the kernel cut-off radius of a given point
+  ///
+  /// \param[in]  p   Query point.
+  /// \param[out] ids Indices of the found centers, cf. Center and Weight.
+  void FindPointsWithinRadius(const double p[3], Array<int> &ids) const
+  {
+    ids.clear();
+    int i1, i2, j1, j2, k1, k2;
+    if (!CellRange(p[0] - _Origin[0], _Size[0], i1, i2) ||
+        !CellRange(p[1] - _Origin[1], _Size[1], j1, j2) ||
+        !CellRange(p[2] - _Origin[2], _Size[2], k1, k2)) return;
+    const double *c;
+    double        dx, dy, dz;
+    for (int k = k1; k <= k2; ++k)
+    for (int j = j1; j <= j2; ++j) {
+      const int row = (k * _Size[1] + j) * _Size[0];
+      for (int idx = _Start[row + i1]; idx < _Start[row + i2 + 1]; ++idx) {
+        c  = &_Centers[3 * idx];
+        dx = c[0] - p[0], dy = c[1] - p[1], dz = c[2] - p[2];
+        if (dx * dx + dy * dy + dz * dz <= _Radius2) ids.push_back(idx);
+      }
+    }
+  }
+
+  /// Center of i-th current in cell order
+  const double *Center(int i) const { return &_Centers[3 * i]; }
+
+  /// Weight of i-th current in cell order
+  const double *Weight(int i) const { return &_Weights[3 * i]; }
+
+private:
+
+  /// Index of grid cell containing a given point
+  int CellIndex(const double p[3]) const
+  {
+    int i = static_cast<int>((p[0] - _Origin[0]) / _Spacing);
+    int j = static_cast<int>((p[1] - _Origin[1]) / _Spacing);
+    int k = static_cast<int>((p[2] - _Origin[2]) / _Spacing);
+    i = max(0, min(i, _Size[0] - 1));
+    j = max(0, min(j, _Size[1] - 1));
+    k = max(0, min(k, _Size[2] - 1));
+    return (k * _Size[1] + j) * _Size[0] + i;
+  }
+
+  /// Range of grid cells intersected by the ball around a given point
+  bool CellRange(double x, int n, int &i1, int &i2) const
+  {
+    const double c = floor(x / _Spacing);
+    if (c < -1.0 || c > static_cast<double>(n)) return false;
+    i1 = max(0,     static_cast<int>(c) - 1);
+    i2 = min(n - 1, static_cast<int>(c) + 1);
+    return true;
+  }
+};
+
 // -----------------------------------------------------------------------------
 class CurrentsDistanceDotProduct
 {
 private:
 
-  vtkPoints               *_CentersA;
-  vtkFloatArray           *_WeightsA;
-  vtkPoints               *_CentersB;
-  vtkFloatArray           *_WeightsB;
-  vtkAbstractPointLocator *_LocatorB;
-  double                   _Variance;
-  double                   _Radius;
-  vtkDataArray            *_Value;
-  double                   _Sum;
+  vtkPoints                  *_CentersA;
+  vtkFloatArray              *_WeightsA;
+  vtkPoints                  *_CentersB;
+  vtkFloatArray              *_WeightsB;
+  const CurrentsDistanceGrid *_GridB;
+  double                      _Variance;
+  double                      _Radius;
+  vtkDataArray               *_Value;
+  double                      _Sum;
 
 public:
 
-  CurrentsDistanceDotProduct(double sigma)
+  CurrentsDistanceDotProduct(double sigma, double cutoff = 2.5)
   :
     _CentersA(NULL), _WeightsA(NULL),
-    _CentersB(NULL), _WeightsB(NULL), _LocatorB(NULL),
-    _Variance(sigma * sigma), _Radius(2.5 * sigma),
+    _CentersB(NULL), _WeightsB(NULL), _GridB(NULL),
+    _Variance(sigma * sigma), _Radius(cutoff * sigma),
     _Value(NULL), _Sum(.0)
   {}
 
@@ -215,17 +350,16 @@ public:
       cerr << "Cannot compute inner product between different types of currents" << endl;
       exit(1);
     }
-    // Initialize point locator
-    _LocatorB = vtkOctreePointLocator::New();
-    _LocatorB->SetDataSet(b);
-    _LocatorB->BuildLocator();
+    // Initialize spatial grid
+    CurrentsDistanceGrid grid;
+    grid.Initialize(_CentersB, _WeightsB, _Radius);
+    _GridB = &grid;
     // Evaluate inner product
     _Value = value;
     _Sum   = .0;
     blocked_range<vtkIdType> cellsA(0, _CentersA->GetNumberOfPoints());
     parallel_reduce(cellsA, *this);
-    // Free point locator
-    _LocatorB->Delete(), _LocatorB = NULL;
+    _GridB = NULL;
     MIRTK_DEBUG_TIMING(3, "evaluation of dot product of currents");
     return _Sum;
   }
@@ -238,7 +372,7 @@ public:
     _WeightsA(other._WeightsA),
     _CentersB(other._CentersB),
     _WeightsB(other._WeightsB),
-    _LocatorB(other._LocatorB),
+    _GridB   (other._GridB),
     _Variance(other._Variance),
     _Radius  (other._Radius),
     _Value   (other._Value),
@@ -250,29 +384,30 @@ public:
     _Sum += other._Sum;
   }
 
-  inline double EvaluateKernel(double ca[3], double cb[3])
+  inline double EvaluateKernel(const double ca[3], const double cb[3])
   {
     return exp(- vtkMath::Distance2BetweenPoints(ca, cb) / _Variance);
   }
 
   void operator ()(const blocked_range<vtkIdType> &re)
   {
-    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+    Array<int> ids;
     // In case of point clouds, the _Weights(A|B) arrays contain
     // scalar tuples only, i.e., GetTuple does not change the second
-    // and third component of da and db, respectively. The dot product
-    // <da, db> is thus equal to the scalar product of the point weights.
-    double ca[3], cb[3], da[3] = {1.0, .0, .0}, db[3] = {1.0, .0, .0};
+    // and third component of da, and the grid sets those of db to zero.
+    // The dot product <da, db> is thus equal to the scalar product of
+    // the point weights.
+    double ca[3], da[3] = {1.0, .0, .0};
+    const double *cb, *db;
     for (vtkIdType i = re.begin(); i != re.end(); ++i) {
       _CentersA->GetPoint(i, ca);
       _WeightsA->GetTuple(i, da);
-      _LocatorB->FindPointsWithinRadius(_Radius, ca, ids);
+      _GridB->FindPointsWithinRadius(ca, ids);
       double value = .0;
-      for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
-        vtkIdType j = ids->GetId(k);
-        _CentersB->GetPoint(j, cb);
-        _WeightsB->GetTuple(j, db);
-        value += EvaluateKernel(ca, cb) * vtkMath::Dot(da, db);
+      for (size_t k = 0; k < ids.size(); ++k) {
+        cb = _GridB->Center(ids[k]);
+        db = _GridB->Weight(ids[k]);
+        value += EvaluateKernel(ca, cb) * (da[0] * db[0] + da[1] * db[1] + da[2] * db[2]);
       }
       if (_Value) _Value->SetTuple1(i, _Value->GetTuple1(i) + value);
       _Sum += value;
@@ -285,25 +420,25 @@ class CurrentsDistanceGradient
 {
 private:
 
-  vtkPointSet             *_SurfaceA;
-  vtkPoints               *_CentersA;
-  vtkFloatArray           *_WeightsA;
-  vtkAbstractPointLocator *_LocatorA;
-  vtkPointSet             *_SurfaceB;
-  vtkPoints               *_CentersB;
-  vtkFloatArray           *_WeightsB;
-  vtkAbstractPointLocator *_LocatorB;
-  double                   _Variance;
-  double                   _Radius;
-  Vector3D<double>        *_Gradient;
+  vtkPointSet                *_SurfaceA;
+  vtkPoints                  *_CentersA;
+  vtkFloatArray              *_WeightsA;
+  const CurrentsDistanceGrid *_GridA;
+  vtkPointSet                *_SurfaceB;
+  vtkPoints                  *_CentersB;
+  vtkFloatArray              *_WeightsB;
+  const CurrentsDistanceGrid *_GridB;
+  double                      _Variance;
+  double                      _Radius;
+  Vector3D<double>           *_Gradient;
 
 public:
 
-  CurrentsDistanceGradient(double sigma)
+  CurrentsDistanceGradient(double sigma, double cutoff = 2.5)
   :
-    _SurfaceA(NULL), _CentersA(NULL), _WeightsA(NULL), _LocatorA(NULL),
-    _SurfaceB(NULL), _CentersB(NULL), _WeightsB(NULL), _LocatorB(NULL),
-    _Variance(sigma * sigma), _Radius(2.5 * sigma), _Gradient(NULL)
+    _SurfaceA(NULL), _CentersA(NULL), _WeightsA(NULL), _GridA(NULL),
+    _SurfaceB(NULL), _CentersB(NULL), _WeightsB(NULL), _GridB(NULL),
+    _Variance(sigma * sigma), _Radius(cutoff * sigma), _Gradient(NULL)
   {}
 
   inline void EvaluateGradient(vtkPointSet *sa, vtkPolyData *ca,
@@ -335,13 +470,12 @@ public:
       cerr << "Cannot compute inner product between different types of currents" << endl;
       exit(1);
     }
-    // Initialize point locators
-    _LocatorA = vtkOctreePointLocator::New();
-    _LocatorA->SetDataSet(ca);
-    _LocatorA->BuildLocator();
-    _LocatorB = vtkOctreePointLocator::New();
-    _LocatorB->SetDataSet(cb);
-    _LocatorB->BuildLocator();
+    // Initialize spatial grids
+    CurrentsDistanceGrid grid_a, grid_b;
+    grid_a.Initialize(_CentersA, _WeightsA, _Radius);
+    grid_b.Initialize(_CentersB, _WeightsB, _Radius);
+    _GridA = &grid_a;
+    _GridB = &grid_b;
     // Evaluate gradient of currents distance measure
     _Gradient = g;
     for (int i = 0; i < _SurfaceA->GetNumberOfPoints(); ++i) {
@@ -349,9 +483,7 @@ public:
     }
     blocked_range<vtkIdType> cellsA(0, _SurfaceA->GetNumberOfCells());
     parallel_reduce(cellsA, *this);
-    // Free point locators
-    _LocatorA->Delete(), _LocatorA = NULL;
-    _LocatorB->Delete(), _LocatorB = NULL;
+    _GridA = _GridB = NULL;
     MIRTK_DEBUG_TIMING(3, "evaluation of gradient of currents distance");
   }
 
@@ -362,11 +494,11 @@ public:
     _SurfaceA(other._SurfaceA),
     _CentersA(other._CentersA),
     _WeightsA(other._WeightsA),
-    _LocatorA(other._LocatorA),
+    _GridA   (other._GridA),
     _SurfaceB(other._SurfaceB),
     _CentersB(other._CentersB),
     _WeightsB(other._WeightsB),
-    _LocatorB(other._LocatorB),
+    _GridB   (other._GridB),
     _Variance(other._Variance),
     _Radius  (other._Radius),
     _Gradient(other._Gradient)
@@ -377,11 +509,11 @@ public:
     _SurfaceA(lhs._SurfaceA),
     _CentersA(lhs._CentersA),
     _WeightsA(lhs._WeightsA),
-    _LocatorA(lhs._LocatorA),
+    _GridA   (lhs._GridA),
     _SurfaceB(lhs._SurfaceB),
     _CentersB(lhs._CentersB),
     _WeightsB(lhs._WeightsB),
-    _LocatorB(lhs._LocatorB),
+    _GridB   (lhs._GridB),
     _Variance(lhs._Variance),
     _Radius  (lhs._Radius)
   {
@@ -396,12 +528,12 @@ public:
     Deallocate(rhs._Gradient);
   }
 
-  inline double EvaluateKernel(double ca[3], double cb[3])
+  inline double EvaluateKernel(const double ca[3], const double cb[3])
   {
     return exp(- vtkMath::Distance2BetweenPoints(ca, cb) / _Variance);
   }
 
-  inline void EvaluateKernelGradient(double g[3], double ca[3], double cb[3])
+  inline void EvaluateKernelGradient(double g[3], const double ca[3], const double cb[3])
   {
     const double w = -2.0 * EvaluateKernel(ca, cb) / _Variance;
     g[0] = w * (ca[0] - cb[0]);
@@ -416,25 +548,27 @@ public:
 
   void operator ()(const blocked_range<vtkIdType> &re)
   {
-    vtkIdType j, i1, i2, i3;       // vertex indices
+    vtkIdType i1, i2, i3;          // vertex indices
     double    v1[3], v2[3], v3[3]; // vertex coordinates
     double    e1[3], e2[3], e3[3]; // edge vectors
-    double    c1[3], c2[3];        // center coordinates
-    double    n1[3], n2[3];        // surface normals
+    double    c1[3];               // center coordinates
+    double    n1[3];               // surface normals
+    const double *c2, *n2;
     double    kws[3], dks[3][3], kwt[3], dkt[3][3], kw[3];
     double    w, g[3];
 
     const double _2over3 = 2.0 / 3.0;
 
-    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+    vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+    Array<int>                 ids;
 
     // Loop over transformed triangles
     for (vtkIdType i = re.begin(); i != re.end(); ++i) {
       // Get vertex indices
-      _SurfaceA->GetCellPoints(i, ids);
-      i1 = ids->GetId(0);
-      i2 = ids->GetId(1);
-      i3 = ids->GetId(2);
+      _SurfaceA->GetCellPoints(i, ptIds);
+      i1 = ptIds->GetId(0);
+      i2 = ptIds->GetId(1);
+      i3 = ptIds->GetId(2);
       Vector3D<double> &g1 = _Gradient[i1];
       Vector3D<double> &g2 = _Gradient[i2];
       Vector3D<double> &g3 = _Gradient[i3];
@@ -447,13 +581,12 @@ public:
       _WeightsA->GetTuple(i, n1);
       // Compute kds = KtauS and dks = gradKtauS.transpose()
       // (cf. Deformetrica 2.0 OrientedSurfaceMesh::ComputeMatchGradient)
-      _LocatorA->FindPointsWithinRadius(_Radius, c1, ids);
+      _GridA->FindPointsWithinRadius(c1, ids);
       memset(kws, 0, 3 * sizeof(double));
       memset(dks, 0, 9 * sizeof(double));
-      for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
-        j = ids->GetId(k);
-        _CentersA->GetPoint(j, c2);
-        _WeightsA->GetTuple(j, n2);
+      for (size_t k = 0; k < ids.size(); ++k) {
+        c2 = _GridA->Center(ids[k]);
+        n2 = _GridA->Weight(ids[k]);
         w = EvaluateKernel(c1, c2);
         EvaluateKernelGradient(g, c1, c2);
         for (int d = 0; d < 3; ++d) {
@@ -465,13 +598,12 @@ public:
       }
       // Compute kwt = KtauT and dkt = gradKtauT.transpose()
       // (cf. Deformetrica 2.0 OrientedSurfaceMesh::ComputeMatchGradient)
-      _LocatorB->FindPointsWithinRadius(_Radius, c1, ids);
+      _GridB->FindPointsWithinRadius(c1, ids);
       memset(kwt, 0, 3 * sizeof(double));
       memset(dkt, 0, 9 * sizeof(double));
-      for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
-        j = ids->GetId(k);
-        _CentersB->GetPoint(j, c2);
-        _WeightsB->GetTuple(j, n2);
+      for (size_t k = 0; k < ids.size(); ++k) {
+        c2 = _GridB->Center(ids[k]);
+        n2 = _GridB->Weight(ids[k]);
         w = EvaluateKernel(c1, c2);
         EvaluateKernelGradient(g, c1, c2);
         for (int d = 0; d < 3; ++d) {
@@ -528,7 +660,7 @@ void CurrentsDistance::Init()
 
   // Compute squared norm of fixed current(s)
   _TargetNormSquared = .0;
-  CurrentsDistanceDotProduct dot_product(_Sigma);
+  CurrentsDistanceDotProduct dot_product(_Sigma, _KernelCutoff);
   if (!_Target->Transformation()) {
     _TargetNormSquared += dot_product.Evaluate(_TargetCurrent, _TargetCurrent);
   }
@@ -565,6 +697,9 @@ bool CurrentsDistance::SetWithPrefix(const char *param, const char *value)
   if (strcmp(param, "Currents kernel width") == 0) {
     return FromString(value, _Sigma) && _Sigma != .0;
   }
+  if (strcmp(param, "Currents kernel cutoff") == 0) {
+    return FromString(value, _KernelCutoff) && _KernelCutoff > .0;
+  }
   if (strcmp(param, "Symmetric currents distance") == 0) {
     return FromString(value, _Symmetric);
   }
@@ -577,6 +712,9 @@ bool CurrentsDistance::SetWithoutPrefix(const char *param, const char *value)
   if (strcmp(param, "Kernel width") == 0) {
     return FromString(value, _Sigma) && _Sigma != .0;
   }
+  if (strcmp(param, "Kernel cutoff") == 0) {
+    return FromString(value, _KernelCutoff) && _KernelCutoff > .0;
+  }
   if (strcmp(param, "Symmetric") == 0) {
     return FromString(value, _Symmetric);
   }
@@ -588,6 +726,7 @@ ParameterList CurrentsDistance::Parameter() const
 {
   ParameterList params = PointSetDistance::Parameter();
   InsertWithPrefix(params, "Kernel width", _Sigma);
+  InsertWithPrefix(params, "Kernel cutoff", _KernelCutoff);
   InsertWithPrefix(params, "Symmetric",    _Symmetric);
   return params;
 }
@@ -614,7 +753,7 @@ double CurrentsDistance::Evaluate()
 {
   MIRTK_START_TIMING();
   double d = _TargetNormSquared;
-  CurrentsDistanceDotProduct dot_product(_Sigma);
+  CurrentsDistanceDotProduct dot_product(_Sigma, _KernelCutoff);
   if (_Target->Transformation()) {
     d += dot_product.Evaluate(_TargetCurrent, _TargetCurrent);
   }
@@ -640,7 +779,7 @@ void CurrentsDistance::NonParametricGradient(const RegisteredPointSet *target,
   vtkPointSet *sb = _Source->PointSet();
   vtkPolyData *cb = _SourceCurrent;
   if (target == _Source) swap(sa, sb), swap(ca, cb);
-  CurrentsDistanceGradient d(_Sigma);
+  CurrentsDistanceGradient d(_Sigma, _KernelCutoff);
   d.EvaluateGradient(sa, ca, sb, cb, gradient);
 }
 
@@ -667,7 +806,7 @@ void CurrentsDistance::WriteDataSets(const char *p, const char *suffix, bool all
   if (_Target->Transformation() || all) {
     vtkSmartPointer<vtkFloatArray> dist;
     if (_Target->Transformation()) {
-      CurrentsDistanceDotProduct dot_product(_Sigma);
+      CurrentsDistanceDotProduct dot_product(_Sigma, _KernelCutoff);
       dist = vtkSmartPointer<vtkFloatArray>::New();
       dist->SetName("distance");
       dist->SetNumberOfComponents(1);
@@ -684,7 +823,7 @@ void CurrentsDistance::WriteDataSets(const char *p, const char *suffix, bool all
   if (_Source->Transformation() || all) {
     vtkSmartPointer<vtkFloatArray> dist;
     if (_Source->Transformation()) {
-      CurrentsDistanceDotProduct dot_product(_Sigma);
+      CurrentsDistanceDotProduct dot_product(_Sigma, _KernelCutoff);
       dist = vtkSmartPointer<vtkFloatArray>::New();
       dist->SetName("distance");
       dist->SetNumberOfComponents(1);
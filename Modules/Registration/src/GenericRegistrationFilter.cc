@@ -25,6 +25,7 @@
 #include "mirtk/Utils.h"
 #include "mirtk/Math.h"
 #include "mirtk/Memory.h"
+#include "mirtk/MemoryPool.h"
 #include "mirtk/Version.h"
 #include "mirtk/Matrix.h"
 #include "mirtk/Parallel.h"
@@ -2314,6 +2315,7 @@ void GenericRegistrationFilter::Run()
   // Initialize image resolution pyramid
   this->InitializePyramid();
   this->InitializePointSets();
+  MemoryPool::Instance().Clear();
 
   // Make initial guess of transformation if none provided
   const Transformation * const dofin = _InitialGuess;
@@ -2378,6 +2380,9 @@ void GenericRegistrationFilter::MultiResolutionOptimization()
     this->Finalize();
     Broadcast(FinishEvent, &level);
 
+    // Free image memory kept for reuse, images of next level differ in size
+    MemoryPool::Instance().Clear();
+
     MIRTK_DEBUG_TIMING(2, "registration at level " << level.Iter());
     ++level;
   }
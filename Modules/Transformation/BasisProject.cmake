@@ -62,6 +62,7 @@ basis_project (
     VTK-7|6{vtkCommonCore,vtkCommonDataModel}
     #<optional-dependency>
   TEST_DEPENDS
+    GTest
     #<test-dependency>
   OPTIONAL_TEST_DEPENDS
     #<optional-test-dependency>
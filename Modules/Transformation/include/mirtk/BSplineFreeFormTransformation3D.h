@@ -242,6 +242,9 @@ public:
   /// Transforms a single point using the local transformation component only
   virtual void LocalTransform(double &, double &, double &, double = 0, double = -1) const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   /// Whether this transformation implements a more efficient update of a given
   /// displacement field given the desired change of a transformation parameter
   virtual bool CanModifyDisplacement(int = -1) const;
@@ -435,6 +438,12 @@ inline void BSplineFreeFormTransformation3D
   x += dx, y += dy, z += dz;
 }
 
+// -----------------------------------------------------------------------------
+inline bool BSplineFreeFormTransformation3D::HasNumericalInverse() const
+{
+  return true;
+}
+
 // =============================================================================
 // Derivatives
 // =============================================================================
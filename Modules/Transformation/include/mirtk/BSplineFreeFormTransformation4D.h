@@ -214,6 +214,9 @@ public:
   /// Transforms a single point using the local transformation component only
   virtual void LocalTransform(double &, double &, double &, double, double = -1) const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   // ---------------------------------------------------------------------------
   // Derivatives
 
@@ -392,6 +395,12 @@ inline void BSplineFreeFormTransformation4D
   x += dx, y += dy, z += dz;
 }
 
+// -----------------------------------------------------------------------------
+inline bool BSplineFreeFormTransformation4D::HasNumericalInverse() const
+{
+  return true;
+}
+
 // =============================================================================
 // Derivatives
 // =============================================================================
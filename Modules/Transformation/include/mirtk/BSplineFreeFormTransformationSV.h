@@ -237,6 +237,7 @@ public:
 
 public:
 
+  using BSplineFreeFormTransformation3D::Transform;
   using BSplineFreeFormTransformation3D::Displacement;
 
 protected:
@@ -269,6 +270,16 @@ public:
   /// \param[in] T Upper integration limit, i.e., length of time interval.
   void IntegrateVelocities(double &, double &, double &, double T = 1.0) const;
 
+  /// Transforms a batch of points using a Runge-Kutta integration which
+  /// advances all points of the batch together
+  ///
+  /// \param[in] n Number of points.
+  /// \param[in] T Upper integration limit, i.e., length of time interval.
+  void IntegrateVelocities(int n, double *, double *, double *, double T = 1.0) const;
+
+  /// Transforms a batch of points using the local transformation component only
+  void LocalTransform(int, double *, double *, double *, double, double) const;
+
   /// Compute displacement field using the scaling and squaring (SS) method
   ///
   /// \attention If an input/output displacement field is provided, the resulting
@@ -321,9 +332,15 @@ public:
   /// Transforms a single point using the local transformation component only
   virtual void LocalTransform(double &, double &, double &, double = 0, double = -1) const;
 
+  /// Transforms the given points in parallel batches
+  virtual void Transform(int, double *, double *, double *, double = 0, double = -1) const;
+
   /// Transforms a single point using the inverse of the local transformation only
   virtual bool LocalInverse(double &, double &, double &, double = 0, double = -1) const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   /// Calculates the displacement vectors for a whole image domain
   ///
   /// \attention The displacements are computed at the positions after applying the
@@ -725,6 +742,13 @@ inline bool BSplineFreeFormTransformationSV::RequiresCachingOfDisplacements() co
   return (_IntegrationMethod == FFDIM_SS || _IntegrationMethod == FFDIM_FastSS);
 }
 
+// -----------------------------------------------------------------------------
+inline bool BSplineFreeFormTransformationSV::HasNumericalInverse() const
+{
+  // Inverse is obtained by integrating the negated velocity field
+  return false;
+}
+
 // -----------------------------------------------------------------------------
 inline double BSplineFreeFormTransformationSV::UpperIntegrationLimit(double t, double t0) const
 {
@@ -133,14 +133,49 @@ public:
 
   // ---------------------------------------------------------------------------
   // Point transformation
+  using BSplineFreeFormTransformation4D::Transform;
   using BSplineFreeFormTransformation4D::Displacement;
 
   /// Transforms a single point
   virtual void LocalTransform(double &, double &, double &, double, double) const;
 
+  /// Transforms a batch of points using the batch Runge-Kutta integration
+  /// which advances all points of the batch together
+  void LocalTransform(int, double *, double *, double *, double, double) const;
+
+  /// Transforms the given points in parallel batches
+  virtual void Transform(int, double *, double *, double *, double = 0, double = -1) const;
+
+  /// Calculates the displacement vectors for a whole image domain
+  ///
+  /// The velocities are integrated for all voxels of an image row together.
+  ///
+  /// \attention The displacements are computed at the positions after applying the
+  ///            current displacements at each voxel. These displacements are then
+  ///            added to the current displacements. Therefore, set the input
+  ///            displacements to zero if only interested in the displacements of
+  ///            this transformation at the voxel positions.
+  virtual void Displacement(GenericImage<double> &, double, double = -1,
+                            const WorldCoordsImage * = NULL) const;
+
+  /// Calculates the displacement vectors for a whole image domain
+  ///
+  /// The velocities are integrated for all voxels of an image row together.
+  ///
+  /// \attention The displacements are computed at the positions after applying the
+  ///            current displacements at each voxel. These displacements are then
+  ///            added to the current displacements. Therefore, set the input
+  ///            displacements to zero if only interested in the displacements of
+  ///            this transformation at the voxel positions.
+  virtual void Displacement(GenericImage<float> &, double, double = -1,
+                            const WorldCoordsImage * = NULL) const;
+
   /// Transforms a single point using the inverse transformation
   virtual bool LocalInverse(double &, double &, double &, double, double) const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   // ---------------------------------------------------------------------------
   // Derivatives
   using BSplineFreeFormTransformation4D::JacobianDOFs;
@@ -234,6 +269,13 @@ inline bool BSplineFreeFormTransformationTD
   return true;
 }
 
+// -----------------------------------------------------------------------------
+inline bool BSplineFreeFormTransformationTD::HasNumericalInverse() const
+{
+  // Inverse is obtained by integrating the velocity field backwards in time
+  return false;
+}
+
 // =============================================================================
 // Derivatives
 // =============================================================================
@@ -216,6 +216,9 @@ public:
   /// Transforms a single point using the inverse of the transformation
   virtual bool Inverse(int, int, double &, double &, double &, double = 0, double = -1) const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   /// Calculates the displacement vectors for a whole image domain
   ///
   /// \attention The displacements are computed at the positions after applying the
@@ -328,6 +331,17 @@ inline  const AffineTransformation *FluidFreeFormTransformation::GetAffineTransf
   return &_AffineTransformation;
 }
 
+// =============================================================================
+// Point transformation
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+inline bool FluidFreeFormTransformation::HasNumericalInverse() const
+{
+  // Inverse is obtained by inverting each level in reverse order
+  return false;
+}
+
 // =============================================================================
 // Bounding box
 // =============================================================================
@@ -125,6 +125,21 @@ class ImageTransformation : public Object
   /// Interpolator for cached displacements
   mirtkComponentMacro(InterpolateImageFunction, DisplacementField);
 
+  /// Maximum number of output slices for which displacements are cached at
+  /// once when the cache is allocated by this filter (0: all slices)
+  ///
+  /// A slab must have at least two slices, such that it is not processed as
+  /// a 2D image. Initialize fails for a tile size of one or a negative value.
+  ///
+  /// When the output image has more slices, it is processed slab by slab,
+  /// where the displacements of each slab are computed right before the
+  /// resampling of its voxels. This bounds the memory required by the cache
+  /// at the expense of recomputing the displacements with every Run.
+  mirtkPublicAttributeMacro(int, TileSize);
+
+  /// Whether output is processed slab by slab (cf. TileSize)
+  mirtkAttributeMacro(bool, Tiled);
+
   /// Number of points for which the required inverse transformation was invalid
   mirtkReadOnlyAttributeMacro(int, NumberOfSingularPoints);
 
@@ -162,6 +177,9 @@ protected:
   /// Initialize filter
   virtual void Initialize();
 
+  /// Compute cached displacements for output slices [k1, k2)
+  virtual void UpdateCache(int k1, int k2);
+
 };
 
 
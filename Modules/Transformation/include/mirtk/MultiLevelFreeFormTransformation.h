@@ -22,6 +22,8 @@
 #define MIRTK_MultiLevelFreeFormTransformation_H
 
 #include "mirtk/MultiLevelTransformation.h"
+#include "mirtk/BSplineFreeFormTransformation3D.h"
+#include "mirtk/Array.h"
 
 
 namespace mirtk {
@@ -36,6 +38,21 @@ class MultiLevelFreeFormTransformation : public MultiLevelTransformation
 {
   mirtkTransformationMacro(MultiLevelFreeFormTransformation);
 
+  // ---------------------------------------------------------------------------
+  // Attributes
+
+  /// Cubic B-spline FFD which interpolates the sum of the local displacements
+  mutable BSplineFreeFormTransformation3D *_Flattened;
+
+  /// Lattice bounding box within which the flattened FFD is used
+  double _FlattenedBounds[6];
+
+  /// Local transformations summed up by the flattened FFD
+  mutable Array<const FreeFormTransformation *> _FlattenedLevels;
+
+  /// Parameters of the local transformations summed up by the flattened FFD
+  mutable Array<double> _FlattenedDOFs;
+
   // ---------------------------------------------------------------------------
   // Construction/Destruction
 
@@ -56,9 +73,43 @@ public:
   /// Destructor
   virtual ~MultiLevelFreeFormTransformation();
 
+  // ---------------------------------------------------------------------------
+  // Transformation parameters (DOFs)
+
+  /// Copy active transformation parameters (DoFs) from given transformation
+  /// if possible and return \c false, otherwise
+  virtual bool CopyFrom(const Transformation *);
+
+  /// Resets the transformation
+  virtual void Reset();
+
+  /// Resets the transformation and removes all local transformations
+  virtual void Clear();
+
   // ---------------------------------------------------------------------------
   // Levels
 
+  // Do not hide base class methods
+  using MultiLevelTransformation::GetLocalTransformation;
+
+  /// Gets local transformation for modification, discards flattened FFD
+  virtual FreeFormTransformation *GetLocalTransformation(int);
+
+  /// Put local transformation and return pointer to previous one (needs to be deleted if not used)
+  virtual FreeFormTransformation *PutLocalTransformation(FreeFormTransformation *, int);
+
+  /// Push local transformation on stack (append transformation)
+  virtual void PushLocalTransformation(FreeFormTransformation *);
+
+  /// Insert local transformation
+  virtual void InsertLocalTransformation(FreeFormTransformation *, int = 0);
+
+  /// Pop local transformation from stack (remove last transformation)
+  virtual FreeFormTransformation *PopLocalTransformation();
+
+  /// Remove local transformation and return the pointer (need to be deleted if not used)
+  virtual FreeFormTransformation *RemoveLocalTransformation(int = 0);
+
   /// Combine local transformations on stack
   virtual void CombineLocalTransformation();
 
@@ -66,6 +117,51 @@ public:
   /// FFD and incorporate it with any existing local transformation
   virtual void MergeGlobalIntoLocalDisplacement();
 
+  // ---------------------------------------------------------------------------
+  // Flattened evaluation
+
+  /// Evaluate the sum of all local transformations through a single cubic
+  /// B-spline FFD, which interpolates the summed local displacements at the
+  /// control points of the finest level
+  ///
+  /// The flattened FFD is only computed when all local transformations are
+  /// cubic B-spline FFDs and the maximum error of the flattened displacements
+  /// at the centres of the lattice cells does not exceed the given bound.
+  /// It is a snapshot of the current levels, which is discarded when the
+  /// levels are modified through this transformation or when a level is
+  /// accessed for modification. Dense displacement fields are furthermore
+  /// evaluated without the flattened FFD when the parameters of a level
+  /// changed since flattening. This function must be called again to
+  /// flatten the modified levels.
+  ///
+  /// \param[in] maxerr Maximum error in mm.
+  ///
+  /// \returns Whether the local transformations are flattened.
+  bool Flatten(double maxerr = .01);
+
+  /// Discard flattened FFD and evaluate the local transformations separately
+  void Unflatten();
+
+  /// Whether the local transformations are evaluated by a flattened FFD
+  bool IsFlattened() const;
+
+  /// Flattened FFD or NULL if the local transformations are not flattened
+  const BSplineFreeFormTransformation3D *Flattened() const;
+
+protected:
+
+  /// Whether the local transformations are unchanged since the last flattening
+  bool FlattenedLevelsUnchanged() const;
+
+  /// Discard flattened FFD when the local transformations changed since flattening
+  void UpdateFlattened() const;
+
+  /// Convert world coordinates to lattice coordinates of the flattened FFD
+  /// and check whether these are within the region where it is used
+  bool IsInsideFlattened(double &, double &, double &) const;
+
+public:
+
   // ---------------------------------------------------------------------------
   // Bounding box
 
@@ -278,6 +374,13 @@ public:
   /// Prints the parameters of the transformation
   virtual void Print(Indent = 0) const;
 
+protected:
+
+  /// Reads transformation parameters from a file stream
+  virtual Cifstream &ReadDOFs(Cifstream &, TransformationType);
+
+public:
+
   // ---------------------------------------------------------------------------
   // Backwards compatibility
 
@@ -290,6 +393,33 @@ public:
 // Inline definitions
 ////////////////////////////////////////////////////////////////////////////////
 
+// =============================================================================
+// Flattened evaluation
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+inline bool MultiLevelFreeFormTransformation::IsFlattened() const
+{
+  return _Flattened != NULL;
+}
+
+// -----------------------------------------------------------------------------
+inline const BSplineFreeFormTransformation3D *
+MultiLevelFreeFormTransformation::Flattened() const
+{
+  return _Flattened;
+}
+
+// -----------------------------------------------------------------------------
+inline bool MultiLevelFreeFormTransformation
+::IsInsideFlattened(double &x, double &y, double &z) const
+{
+  _Flattened->WorldToLattice(x, y, z);
+  return _FlattenedBounds[0] <= x && x <= _FlattenedBounds[1] &&
+         _FlattenedBounds[2] <= y && y <= _FlattenedBounds[3] &&
+         _FlattenedBounds[4] <= z && z <= _FlattenedBounds[5];
+}
+
 // =============================================================================
 // Bounding box
 // =============================================================================
@@ -145,6 +145,9 @@ public:
   /// for the scaling and squaring method.
   virtual bool RequiresCachingOfDisplacements() const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
 protected:
 
   /// Upper integration limit used given the temporal origin of both target
@@ -441,6 +444,13 @@ inline bool MultiLevelStationaryVelocityTransformation
   return this->UseScalingAndSquaring();
 }
 
+// -----------------------------------------------------------------------------
+inline bool MultiLevelStationaryVelocityTransformation::HasNumericalInverse() const
+{
+  // Inverse is obtained by integrating the negated velocity field
+  return false;
+}
+
 // -----------------------------------------------------------------------------
 template <class VectorType>
 void MultiLevelStationaryVelocityTransformation
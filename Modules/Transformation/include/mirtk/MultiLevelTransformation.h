@@ -322,6 +322,9 @@ public:
   /// for the scaling and squaring method.
   virtual bool RequiresCachingOfDisplacements() const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   /// Transforms a single point using the global transformation component only
   virtual void GlobalTransform(double &, double &, double &, double = 0, double = -1) const;
 
@@ -748,6 +751,12 @@ inline bool MultiLevelTransformation::RequiresCachingOfDisplacements() const
   return false;
 }
 
+// -----------------------------------------------------------------------------
+inline bool MultiLevelTransformation::HasNumericalInverse() const
+{
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 inline void MultiLevelTransformation::GlobalTransform(double &x, double &y, double &z, double t, double t0) const
 {
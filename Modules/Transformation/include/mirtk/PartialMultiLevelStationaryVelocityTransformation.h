@@ -174,6 +174,9 @@ public:
   /// for the scaling and squaring method.
   virtual bool RequiresCachingOfDisplacements() const;
 
+  /// Whether the inverse of this transformation is found by iterative root finding
+  virtual bool HasNumericalInverse() const;
+
   /// Transforms a single point using the global transformation component only
   virtual void GlobalTransform(double &, double &, double &, double = 0, double = 1) const;
 
@@ -414,6 +414,12 @@ public:
                                           double t, double t0 = -1,
                                           const WorldCoordsImage *i2w = NULL) const;
 
+  /// Whether the inverse of this transformation is found by the generic iterative
+  /// root finding of the base class. In this case, the inverse displacement field
+  /// is computed by initializing the solution at each voxel with the inverse
+  /// displacement found at a neighbouring voxel.
+  virtual bool HasNumericalInverse() const;
+
   /// Transforms a single point using the inverse of the global transformation only
   virtual void GlobalInverse(double &, double &, double &, double = 0, double = -1) const;
 
@@ -792,6 +798,12 @@ inline bool Transformation::RequiresCachingOfDisplacements() const
   return false;
 }
 
+// -----------------------------------------------------------------------------
+inline bool Transformation::HasNumericalInverse() const
+{
+  return false;
+}
+
 // -----------------------------------------------------------------------------
 inline void Transformation::Transform(Point &p, double t, double t0) const
 {
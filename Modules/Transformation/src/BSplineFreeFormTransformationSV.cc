@@ -954,6 +954,30 @@ void BSplineFreeFormTransformationSV::IntegrateVelocities(double &x, double &y,
   }
 }
 
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationSV
+::IntegrateVelocities(int n, double *x, double *y, double *z, double T) const
+{
+  const double dt = StepLengthForIntervalLength(T);
+  if (dt) {
+    if      (_IntegrationMethod == FFDIM_FastSS ||
+             _IntegrationMethod == FFDIM_SS     ||
+             _IntegrationMethod == FFDIM_RKE1)   RKE1  ::Transform(this, n, x, y, z, .0, T, dt);
+    else if (_IntegrationMethod == FFDIM_RKE2)   RKE2  ::Transform(this, n, x, y, z, .0, T, dt);
+    else if (_IntegrationMethod == FFDIM_RKH2)   RKH2  ::Transform(this, n, x, y, z, .0, T, dt);
+    else if (_IntegrationMethod == FFDIM_RK4)    RK4   ::Transform(this, n, x, y, z, .0, T, dt);
+    else if (_IntegrationMethod == FFDIM_RKEH12) RKEH12::Transform(this, n, x, y, z, .0, T, 0.5 * dt, 2.0 * dt, SVFFD_RKTOL);
+    else if (_IntegrationMethod == FFDIM_RKBS23) RKBS23::Transform(this, n, x, y, z, .0, T, 0.5 * dt, 2.0 * dt, SVFFD_RKTOL);
+    else if (_IntegrationMethod == FFDIM_RKF45)  RKF45 ::Transform(this, n, x, y, z, .0, T, 0.5 * dt, 2.0 * dt, SVFFD_RKTOL);
+    else if (_IntegrationMethod == FFDIM_RKCK45) RKCK45::Transform(this, n, x, y, z, .0, T, 0.5 * dt, 2.0 * dt, SVFFD_RKTOL);
+    else if (_IntegrationMethod == FFDIM_RKDP45) RKDP45::Transform(this, n, x, y, z, .0, T, 0.5 * dt, 2.0 * dt, SVFFD_RKTOL);
+    else {
+      cerr << "BSplineFreeFormTransformationSV::IntegrateVelocities: Unknown integration method: " << _IntegrationMethod << endl;
+      exit(1);
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 void BSplineFreeFormTransformationSV
 ::LocalTransform(double &x, double &y, double &z, double t, double t0) const
@@ -961,6 +985,22 @@ void BSplineFreeFormTransformationSV
   IntegrateVelocities(x, y, z, + UpperIntegrationLimit(t, t0));
 }
 
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationSV
+::LocalTransform(int n, double *x, double *y, double *z, double t, double t0) const
+{
+  IntegrateVelocities(n, x, y, z, + UpperIntegrationLimit(t, t0));
+}
+
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationSV
+::Transform(int n, double *x, double *y, double *z, double t, double t0) const
+{
+  if (UpperIntegrationLimit(t, t0)) {
+    FreeFormTransformationBatchTransformPoints(this, n, x, y, z, t, t0);
+  }
+}
+
 // -----------------------------------------------------------------------------
 bool BSplineFreeFormTransformationSV
 ::LocalInverse(double &x, double &y, double &z, double t, double t0) const
@@ -1122,9 +1162,9 @@ void BSplineFreeFormTransformationSV
     if ((_IntegrationMethod == FFDIM_SS || _IntegrationMethod == FFDIM_FastSS) &&
         ((_z <= 1 && d.Z() <= 1) || (_z > 1 && d.Z() > 1))) {
       ScalingAndSquaring(&d, T, wc);
-    // Evaluate transformation at each voxel separately using numerical integration
+    // Integrate velocities along trajectories of all voxels of an image row together
     } else {
-      Transformation::Displacement(d, t, t0, wc);
+      FreeFormTransformationBatchDisplacementField(this, d, t, t0, wc);
     }
     MIRTK_DEBUG_TIMING(3, "computation of exp(" << T << "*v)");
   }
@@ -1141,9 +1181,9 @@ void BSplineFreeFormTransformationSV
     if ((_IntegrationMethod == FFDIM_SS || _IntegrationMethod == FFDIM_FastSS) &&
         ((_z <= 1 && d.Z() <= 1) || (_z > 1 && d.Z() > 1))) {
       ScalingAndSquaring(&d, T, wc);
-    // Evaluate transformation at each voxel separately using numerical integration
+    // Integrate velocities along trajectories of all voxels of an image row together
     } else {
-      Transformation::Displacement(d, t, t0, wc);
+      FreeFormTransformationBatchDisplacementField(this, d, t, t0, wc);
     }
     MIRTK_DEBUG_TIMING(3, "computation of exp(" << T << "*v)");
   }
@@ -21,6 +21,7 @@
 
 #include "mirtk/Math.h"
 #include "mirtk/Memory.h"
+#include "mirtk/Profiling.h"
 #include "mirtk/DisplacementToVelocityFieldBCH.h"
 #include "mirtk/ImageToInterpolationCoefficients.h"
 
@@ -341,6 +342,50 @@ void BSplineFreeFormTransformationTD::LocalTransform(double &x, double &y, doubl
   }
 }
 
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationTD
+::LocalTransform(int n, double *x, double *y, double *z, double t, double t0) const
+{
+  if      (_IntegrationMethod == FFDIM_RKE1)   RKE1  ::Transform(this, n, x, y, z, t0, t, _MinTimeStep);
+  else if (_IntegrationMethod == FFDIM_RKE2)   RKE2  ::Transform(this, n, x, y, z, t0, t, _MinTimeStep);
+  else if (_IntegrationMethod == FFDIM_RKH2)   RKH2  ::Transform(this, n, x, y, z, t0, t, _MinTimeStep);
+  else if (_IntegrationMethod == FFDIM_RK4)    RK4   ::Transform(this, n, x, y, z, t0, t, _MinTimeStep);
+  else if (_IntegrationMethod == FFDIM_RKEH12) RKEH12::Transform(this, n, x, y, z, t0, t, _MinTimeStep, _MaxTimeStep, _Tolerance);
+  else if (_IntegrationMethod == FFDIM_RKBS23) RKBS23::Transform(this, n, x, y, z, t0, t, _MinTimeStep, _MaxTimeStep, _Tolerance);
+  else if (_IntegrationMethod == FFDIM_RKF45)  RKF45 ::Transform(this, n, x, y, z, t0, t, _MinTimeStep, _MaxTimeStep, _Tolerance);
+  else if (_IntegrationMethod == FFDIM_RKCK45) RKCK45::Transform(this, n, x, y, z, t0, t, _MinTimeStep, _MaxTimeStep, _Tolerance);
+  else if (_IntegrationMethod == FFDIM_RKDP45) RKDP45::Transform(this, n, x, y, z, t0, t, _MinTimeStep, _MaxTimeStep, _Tolerance);
+  else {
+    cerr << "BSplineFreeFormTransformationTD::LocalTransform: Unknown integration method: " << _IntegrationMethod << endl;
+    exit(1);
+  }
+}
+
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationTD
+::Transform(int n, double *x, double *y, double *z, double t, double t0) const
+{
+  FreeFormTransformationBatchTransformPoints(this, n, x, y, z, t, t0);
+}
+
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationTD
+::Displacement(GenericImage<double> &d, double t, double t0, const WorldCoordsImage *wc) const
+{
+  MIRTK_START_TIMING();
+  FreeFormTransformationBatchDisplacementField(this, d, t, t0, wc);
+  MIRTK_DEBUG_TIMING(3, "batch integration of velocities");
+}
+
+// -----------------------------------------------------------------------------
+void BSplineFreeFormTransformationTD
+::Displacement(GenericImage<float> &d, double t, double t0, const WorldCoordsImage *wc) const
+{
+  MIRTK_START_TIMING();
+  FreeFormTransformationBatchDisplacementField(this, d, t, t0, wc);
+  MIRTK_DEBUG_TIMING(3, "batch integration of velocities");
+}
+
 // -----------------------------------------------------------------------------
 void BSplineFreeFormTransformationTD::TransformAndJacobian(Matrix &jac, double &x, double &y, double &z, double t, double t0) const
 {
@@ -31,6 +31,169 @@
 // Runge-Kutta integration methods
 #include "FreeFormTransformationRungeKutta.h"
 
+#include "mirtk/Array.h"
+#include "mirtk/GenericImage.h"
+#include "mirtk/Parallel.h"
+
+// ============================================================================
+// Batch integration
+// ============================================================================
+
+namespace mirtk {
+
+
+// ----------------------------------------------------------------------------
+/// Body of batch point transformation by an FFD parameterized by velocities
+///
+/// The FFD type must implement the non-virtual batch transformation method
+/// LocalTransform(int, double *, double *, double *, double, double).
+template <class TFreeFormTransformation>
+class FreeFormTransformationBatchTransform
+{
+  const TFreeFormTransformation *_Transformation;
+  double                        *_x, *_y, *_z, _t, _t0;
+
+public:
+
+  FreeFormTransformationBatchTransform(const TFreeFormTransformation *ffd,
+                                       double *x, double *y, double *z,
+                                       double t, double t0)
+  :
+    _Transformation(ffd), _x(x), _y(y), _z(z), _t(t), _t0(t0)
+  {}
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    const int i = re.begin();
+    _Transformation->LocalTransform(re.end() - i, _x + i, _y + i, _z + i, _t, _t0);
+  }
+};
+
+// ----------------------------------------------------------------------------
+/// Body of dense displacement field computation by an FFD parameterized by velocities
+///
+/// All voxels of an image row are integrated together as one batch.
+/// The FFD type must implement the non-virtual batch transformation method
+/// LocalTransform(int, double *, double *, double *, double, double).
+template <class TFreeFormTransformation, class TReal>
+class FreeFormTransformationBatchDisplacement
+{
+  const TFreeFormTransformation *_Transformation;
+  GenericImage<TReal>           *_Displacement;
+  const WorldCoordsImage        *_WorldCoords;
+  double                         _t, _t0;
+
+public:
+
+  FreeFormTransformationBatchDisplacement(const TFreeFormTransformation *ffd,
+                                          GenericImage<TReal> *disp,
+                                          const WorldCoordsImage *wc,
+                                          double t, double t0)
+  :
+    _Transformation(ffd), _Displacement(disp), _WorldCoords(wc), _t(t), _t0(t0)
+  {}
+
+  void operator ()(const blocked_range<int> &re) const
+  {
+    const int  nx  = _Displacement->X();
+    const int  ny  = _Displacement->Y();
+    const int  nvox = _Displacement->NumberOfSpatialVoxels();
+    const bool vec3 = (_Displacement->T() == 3);
+
+    Array<double> x(nx), y(nx), z(nx), x0(nx), y0(nx), z0(nx);
+    const double *wx, *wy, *wz;
+    TReal        *dx, *dy, *dz;
+
+    for (int r = re.begin(); r != re.end(); ++r) {
+      const int j = r % ny;
+      const int k = r / ny;
+      dx = _Displacement->Data(0, j, k);
+      dy = dx + nvox;
+      dz = dy + nvox;
+      // World coordinates of row voxels
+      if (_WorldCoords) {
+        wx = _WorldCoords->Data(0, j, k);
+        wy = wx + nvox;
+        wz = wy + nvox;
+        for (int i = 0; i < nx; ++i) {
+          x0[i] = wx[i], y0[i] = wy[i], z0[i] = (vec3 ? wz[i] : .0);
+        }
+      } else {
+        for (int i = 0; i < nx; ++i) {
+          x0[i] = i, y0[i] = j, z0[i] = (vec3 ? k : 0);
+          _Displacement->ImageToWorld(x0[i], y0[i], z0[i]);
+        }
+      }
+      // Apply current displacement
+      for (int i = 0; i < nx; ++i) {
+        x0[i] += static_cast<double>(dx[i]);
+        y0[i] += static_cast<double>(dy[i]);
+      }
+      if (vec3) {
+        for (int i = 0; i < nx; ++i) z0[i] += static_cast<double>(dz[i]);
+      }
+      // Integrate velocities along trajectories of all row voxels
+      for (int i = 0; i < nx; ++i) {
+        x[i] = x0[i], y[i] = y0[i], z[i] = z0[i];
+      }
+      _Transformation->LocalTransform(nx, x.data(), y.data(), z.data(), _t, _t0);
+      // Update displacement
+      for (int i = 0; i < nx; ++i) {
+        dx[i] += static_cast<TReal>(x[i] - x0[i]);
+        dy[i] += static_cast<TReal>(y[i] - y0[i]);
+      }
+      if (vec3) {
+        for (int i = 0; i < nx; ++i) dz[i] += static_cast<TReal>(z[i] - z0[i]);
+      }
+    }
+  }
+};
+
+// ----------------------------------------------------------------------------
+/// Transform points by FFD parameterized by velocities in batches
+template <class TFreeFormTransformation>
+void FreeFormTransformationBatchTransformPoints(const TFreeFormTransformation *ffd, int n,
+                                                double *x, double *y, double *z,
+                                                double t, double t0)
+{
+  typedef FreeFormTransformationRungeKutta RK;
+  FreeFormTransformationBatchTransform<TFreeFormTransformation> body(ffd, x, y, z, t, t0);
+  parallel_for(blocked_range<int>(0, n, RK::MaxBatchSize), body);
+}
+
+// ----------------------------------------------------------------------------
+/// Compute dense displacement field of FFD parameterized by velocities in batches
+///
+/// \attention The displacements are computed at the positions after applying
+///            the current displacements at each voxel. These displacements
+///            are then added to the current displacements.
+template <class TFreeFormTransformation, class TReal>
+void FreeFormTransformationBatchDisplacementField(const TFreeFormTransformation *ffd,
+                                                  GenericImage<TReal> &disp,
+                                                  double t, double t0,
+                                                  const WorldCoordsImage *wc)
+{
+  if (disp.T() < 2 || disp.T() > 3) {
+    cerr << ffd->NameOfClass() << "::Displacement: Input/output image must have either 2 or 3 vector components (_t)" << endl;
+    exit(1);
+  }
+  if (wc) {
+    if (wc->T() != disp.T()) {
+      cerr << ffd->NameOfClass() << "::Displacement: Coordinate map must have as many vector components (_t) as the displacement field" << endl;
+      exit(1);
+    }
+    if (wc->X() != disp.X() || wc->Y() != disp.Y() || wc->Z() != disp.Z()) {
+      cerr << ffd->NameOfClass() << "::Displacement: Coordinate map must have the same size as the input/output image" << endl;
+      exit(1);
+    }
+  }
+  FreeFormTransformationBatchDisplacement<TFreeFormTransformation, TReal> body(ffd, &disp, wc, t, t0);
+  parallel_for(blocked_range<int>(0, disp.Y() * disp.Z()), body);
+}
+
+
+} // namespace mirtk
+
 // ============================================================================
 // Auxiliary macros
 // ============================================================================
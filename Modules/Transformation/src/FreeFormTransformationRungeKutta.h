@@ -44,6 +44,16 @@ namespace mirtk {
  */
 class FreeFormTransformationRungeKutta
 {
+public:
+
+  /// Maximum number of points integrated together by the batch methods
+  ///
+  /// The stage vectors of a batch are kept on the stack in structure of
+  /// arrays layout such that the arithmetic of each Runge-Kutta stage is
+  /// performed by simple loops over contiguous arrays which the compiler
+  /// can vectorize.
+  static const int MaxBatchSize = 64;
+
 protected:
 
   // -------------------------------------------------------------------------
@@ -148,6 +158,81 @@ public:
     }
   }
 
+  // -------------------------------------------------------------------------
+  /// Integrate batch of points with common sequence of time steps
+  ///
+  /// The velocities of all points of a batch are evaluated stage by stage,
+  /// i.e., neighboring points (e.g., the voxels of an image row) query the
+  /// same control point coefficients one after another. The result is
+  /// identical to calling Transform for each point separately.
+  static void Transform(const TFreeFormTransformation *v, int n,
+                        double *x, double *y, double *z,
+                        double t1, double t2, double dt)
+  {
+    if (t1 == t2 || n <= 0) return;
+
+    double       kx[BT::s][MaxBatchSize];        // Intermediate evaluations
+    double       ky[BT::s][MaxBatchSize];
+    double       kz[BT::s][MaxBatchSize];
+    const double d = copysign(1.0, t2 - t1);     // Direction of integration
+    double       h, t, l;                        // Step size, time, temporal lattice coordinate
+    int          i, j, b, nb;                    // Butcher tableau and batch indices
+
+    for (int m = 0; m < n; m += MaxBatchSize, x += MaxBatchSize, y += MaxBatchSize, z += MaxBatchSize) {
+      nb = n - m;
+      if (nb > MaxBatchSize) nb = MaxBatchSize;
+      h  = d * abs(dt);
+      // Integrate from t=t1 to t=t2
+      t = t1;
+      while (d * t < d * t2) {
+        // Ensure that last step ends at t2
+        if (d * (t + h) > d * t2) h = t2 - t;
+        // Evaluate velocities at intermediate steps
+        if (BT::fsal && t != t1) {
+          for (b = 0; b < nb; ++b) {
+            kx[0][b] = kx[BT::s - 1][b];
+            ky[0][b] = ky[BT::s - 1][b];
+            kz[0][b] = kz[BT::s - 1][b];
+          }
+          i = 1;
+        } else {
+          i = 0;
+        }
+        for (/*i = 0|1*/; i < BT::s; ++i) {
+          // Intermediate points of this stage
+          for (b = 0; b < nb; ++b) {
+            kx[i][b] = x[b], ky[i][b] = y[b], kz[i][b] = z[b];
+          }
+          for (j = 0; j < i; ++j) {
+            for (b = 0; b < nb; ++b) {
+              kx[i][b] += kx[j][b] * BT::a[i][j];
+              ky[i][b] += ky[j][b] * BT::a[i][j];
+              kz[i][b] += kz[j][b] * BT::a[i][j];
+            }
+          }
+          // Evaluate velocities at intermediate points
+          l = v->TimeToLattice(t + BT::c[i] * h);
+          for (b = 0; b < nb; ++b) {
+            v->WorldToLattice(kx[i][b], ky[i][b], kz[i][b]);
+            v->Evaluate      (kx[i][b], ky[i][b], kz[i][b], l);
+          }
+          for (b = 0; b < nb; ++b) {
+            kx[i][b] *= h, ky[i][b] *= h, kz[i][b] *= h;
+          }
+        }
+        // Perform step
+        for (i = 0; i < BT::s; ++i) {
+          for (b = 0; b < nb; ++b) {
+            x[b] += kx[i][b] * BT::b[i];
+            y[b] += ky[i][b] * BT::b[i];
+            z[b] += kz[i][b] * BT::b[i];
+          }
+        }
+        t += h;
+      }
+    }
+  }
+
   // -------------------------------------------------------------------------
   static void Jacobian(const TFreeFormTransformation *v,
                        Matrix &jac,
@@ -440,6 +525,131 @@ public:
     }
   }
 
+  // -------------------------------------------------------------------------
+  /// Integrate batch of points with adaptive step size control of each point
+  ///
+  /// Each point (lane) of a batch has its own current time and step size.
+  /// A sweep attempts one step for all lanes which have not yet reached the
+  /// upper integration limit, evaluating the velocities stage by stage for
+  /// all active lanes. Steps whose local error exceeds the tolerance are
+  /// repeated with a smaller step size in the next sweep.
+  ///
+  /// The sequence of steps of each lane, including the reuse of the last
+  /// stage of a first-same-as-last tableau, is the same as the one taken by
+  /// Transform for a single point. The result is therefore identical to
+  /// calling Transform for each point separately.
+  static void Transform(const TFreeFormTransformation *v, int n,
+                        double *x, double *y, double *z,
+                        double t1, double t2, double mindt, double maxdt, double tol)
+  {
+    if (t1 == t2 || n <= 0) return;
+
+    double       kx[BT::s][MaxBatchSize];              // k_i = h * v(t + c_i * h, x + sum_{j=0}^{i-1} a_j * k_j)
+    double       ky[BT::s][MaxBatchSize];
+    double       kz[BT::s][MaxBatchSize];
+    double       nx[MaxBatchSize];                     // Solution of order p
+    double       ny[MaxBatchSize];
+    double       nz[MaxBatchSize];
+    double       t [MaxBatchSize];                     // Current time of each lane
+    double       h [MaxBatchSize];                     // Current step size of each lane
+    double       hnext[MaxBatchSize];                  // Next step size of each lane
+    bool         accept[MaxBatchSize];                 // Whether step of lane is accepted
+    int          active[MaxBatchSize];                 // Indices of lanes with t != t2
+    double       error, l;                             // Local error estimate, temporal lattice coordinate
+    const double d = copysign(1.0, t2 - t1);           // Direction of integration
+    const double e = 1.0 / static_cast<double>(BT::p); // Exponent for step size scaling factor
+    const bool   adaptive = (mindt < maxdt);           // Whether to adapt step size
+    double       h0 = t2 - t1;                         // Initial step size
+    int          i, j, a, b, na, nb;                   // Butcher tableau and batch indices
+
+    // Decrease initial step size if necessary
+    if (abs(h0) > maxdt) h0 = copysign(maxdt, d);
+
+    for (int m = 0; m < n; m += MaxBatchSize, x += MaxBatchSize, y += MaxBatchSize, z += MaxBatchSize) {
+      nb = n - m;
+      if (nb > MaxBatchSize) nb = MaxBatchSize;
+      for (b = 0; b < nb; ++b) {
+        t[b] = t1, h[b] = h0;
+      }
+      while (true) {
+        // Collect lanes which did not yet reach t2
+        na = 0;
+        for (b = 0; b < nb; ++b) {
+          if (d * t[b] < d * t2) {
+            // Ensure that last step ends at t2
+            if (d * (t[b] + h[b]) > d * t2) h[b] = t2 - t[b];
+            active[na++] = b;
+          }
+        }
+        if (na == 0) break;
+        // Evaluate velocities at intermediate steps
+        for (i = 0; i < BT::s; ++i) {
+          for (a = 0; a < na; ++a) {
+            b = active[a];
+            if (i == 0 && BT::fsal && t[b] != t1) {
+              kx[0][b] = kx[BT::s - 1][b];
+              ky[0][b] = ky[BT::s - 1][b];
+              kz[0][b] = kz[BT::s - 1][b];
+              continue;
+            }
+            kx[i][b] = x[b], ky[i][b] = y[b], kz[i][b] = z[b];
+            for (j = 0; j < i; ++j) {
+              kx[i][b] += kx[j][b] * BT::a[i][j];
+              ky[i][b] += ky[j][b] * BT::a[i][j];
+              kz[i][b] += kz[j][b] * BT::a[i][j];
+            }
+            v->WorldToLattice(kx[i][b], ky[i][b], kz[i][b]);
+            l = v->TimeToLattice(t[b] + BT::c[i] * h[b]);
+            v->Evaluate(kx[i][b], ky[i][b], kz[i][b], l);
+            kx[i][b] *= h[b], ky[i][b] *= h[b], kz[i][b] *= h[b];
+          }
+        }
+        // Calculate solution of order p and adapt step sizes
+        for (a = 0; a < na; ++a) {
+          b = active[a];
+          nx[b] = x[b], ny[b] = y[b], nz[b] = z[b];
+          for (i = 0; i < BT::s; ++i) {
+            nx[b] += kx[i][b] * BT::b[1][i];
+            ny[b] += ky[i][b] * BT::b[1][i];
+            nz[b] += kz[i][b] * BT::b[1][i];
+          }
+          accept[b] = true;
+          hnext [b] = h[b];
+          if (adaptive) {
+            // Estimate local error using solution of order p-1
+            double ex = x[b], ey = y[b], ez = z[b];
+            for (i = 0; i < BT::s; ++i) {
+              ex += kx[i][b] * BT::b[0][i];
+              ey += ky[i][b] * BT::b[0][i];
+              ez += kz[i][b] * BT::b[0][i];
+            }
+            error = max(max(abs(nx[b] - ex), abs(ny[b] - ey)), abs(nz[b] - ez));
+            // If local error exceeds tolerance, decrease step size and redo step
+            if (abs(h[b]) > mindt && error > tol) {
+              h[b] *= 0.8 * pow(tol / error, e);
+              if (abs(h[b]) < mindt) h[b] = copysign(mindt, d);
+              accept[b] = false;
+            // Otherwise, increase step size
+            } else {
+              hnext[b] = 0.8 * pow(tol / error, e) * h[b];
+              if      (abs(hnext[b]) < mindt) hnext[b] = copysign(mindt, d);
+              else if (abs(hnext[b]) > maxdt) hnext[b] = copysign(maxdt, d);
+            }
+          }
+        }
+        // Perform accepted steps with local extrapolation
+        for (a = 0; a < na; ++a) {
+          b = active[a];
+          if (accept[b]) {
+            x[b] = nx[b], y[b] = ny[b], z[b] = nz[b];
+            t[b] += h[b];
+            h[b]  = hnext[b];
+          }
+        }
+      }
+    }
+  }
+
   // -------------------------------------------------------------------------
   static void Jacobian(const TFreeFormTransformation *v,
                        Matrix &jac, double &x, double &y, double &z,
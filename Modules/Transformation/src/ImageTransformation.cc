@@ -61,6 +61,9 @@ struct ApplyTransformation
   double _InputTimeOffset;
   double _OutputTimeOffset;
 
+  int _FirstSlice;
+  int _LastSlice;
+
   mutable int    _OutputFrame;
   mutable double _OutputTime;
   mutable int    _InputFrame;
@@ -87,6 +90,8 @@ struct ApplyTransformation
     _SourcePaddingValue(-1),
     _InputTimeOffset   (0),
     _OutputTimeOffset  (0),
+    _FirstSlice        (0),
+    _LastSlice         (-1),
     _OutputFrame       (0),
     _OutputTime        (-1),
     _InputFrame        (0),
@@ -113,6 +118,8 @@ struct ApplyTransformation
     _SourcePaddingValue(other._SourcePaddingValue),
     _InputTimeOffset   (other._InputTimeOffset),
     _OutputTimeOffset  (other._OutputTimeOffset),
+    _FirstSlice        (other._FirstSlice),
+    _LastSlice         (other._LastSlice),
     _OutputFrame       (other._OutputFrame),
     _OutputTime        (other._OutputTime),
     _InputFrame        (other._InputFrame),
@@ -190,8 +197,12 @@ struct ApplyTransformation
 
   // ---------------------------------------------------------------------------
   /// Applies the given transformation for the given range of output frames
+  /// and slices [_FirstSlice, _LastSlice), where _LastSlice < 0 denotes the
+  /// number of output slices
   void operator() ()
   {
+    const int k1 = _FirstSlice;
+    const int k2 = (_LastSlice < 0 ? _Output->Z() : _LastSlice);
     _NumberOfSingularPoints = 0;
     for (_OutputFrame = 0; _OutputFrame < _Output->T(); ++_OutputFrame) {
       _OutputTime = _Output->ImageToTime(_OutputFrame);
@@ -202,14 +213,14 @@ struct ApplyTransformation
       _InputTime  += _InputTimeOffset;
 
       if (0 <= _InputFrame && _InputFrame < _Input->T()) {
-        blocked_range3d<int> voxels(0, _Output->Z(),
-                                    0, _Output->Y(),
-                                    0, _Output->X());
+        blocked_range3d<int> voxels(k1, k2,
+                                    0,  _Output->Y(),
+                                    0,  _Output->X());
         ApplyTransformation body(*this);
         parallel_reduce(voxels, body);
         _NumberOfSingularPoints += body._NumberOfSingularPoints;
       } else {
-        for (int k = 0; k < _Output->Z(); ++k)
+        for (int k = k1; k < k2; ++k)
         for (int j = 0; j < _Output->Y(); ++j)
         for (int i = 0; i < _Output->X(); ++i) {
           _Output->PutAsDouble(i, j, k, _OutputFrame, _SourcePaddingValue);
@@ -331,6 +342,8 @@ ImageTransformation::ImageTransformation()
   _CacheInterpolation(Interpolation_Linear),
   _CacheExtrapolation(Extrapolation_Const),
   _DisplacementField(NULL),
+  _TileSize(0),
+  _Tiled(false),
   _NumberOfSingularPoints(0)
 {
 }
@@ -412,31 +425,34 @@ void ImageTransformation::Initialize()
     exit(1);
   }
 
+  if (_TileSize < 0 || _TileSize == 1) {
+    cerr << "ImageTransformation::Initialize: Tile size must be at least 2 slices, or 0 for all slices" << endl;
+    exit(1);
+  }
+
   _NumberOfSingularPoints = 0;
 
+  // Process output slab by slab if displacements are cached by this filter
+  _Tiled = (_Transformation->RequiresCachingOfDisplacements() &&
+            (!_Cache || _CacheOwner) && 0 < _TileSize && _TileSize < _Output->Z());
+
   if (_Transformation->RequiresCachingOfDisplacements() && !_Cache) {
     _CacheOwner = true;
     _Cache      = new ImageTransformationCache();
-    _Cache->Initialize(_Output->Attributes(), 3);
+  }
+  if (_CacheOwner) {
+    ImageAttributes attr = _Output->Attributes();
+    if (_Tiled) attr._z = _TileSize;
+    if (_Cache->Attributes() != attr || _Cache->T() != 3) {
+      _Cache->Initialize(attr, 3);
+      _Cache->Modified(true);
+    }
   }
 
   if (_Cache && !_Cache->IsEmpty()) {
 
     // Compute and cache displacements
-    if (_Cache->Modified()) {
-      // TODO: Cache displacements for multiple time intervals.
-      const double t0 = _Cache->GetTOrigin();
-      const double t  = _Input->GetTOrigin();
-
-      _Cache->Initialize();
-      if (_Invert) {
-        _NumberOfSingularPoints = _Transformation->InverseDisplacement(*_Cache, t, t0);
-      } else {
-        _Transformation->Displacement(*_Cache, t, t0);
-      }
-
-      _Cache->Modified(false);
-    }
+    if (!_Tiled) this->UpdateCache(0, _Output->Z());
 
     // Initialize cache interpolator
     _DisplacementField = InterpolateImageFunction::New(_CacheInterpolation,
@@ -451,6 +467,46 @@ void ImageTransformation::Initialize()
   _Interpolator->Initialize();
 }
 
+// -----------------------------------------------------------------------------
+void ImageTransformation::UpdateCache(int k1, int k2)
+{
+  if (_Tiled) {
+    // Move cache lattice to output slab [k1, k2)
+    const ImageAttributes &output = _Output->Attributes();
+    ImageAttributes        attr   = output;
+    const double offset = (.5 * (k1 + k2 - 1) - .5 * (output._z - 1)) * output._dz;
+    attr._z        = k2 - k1;
+    attr._xorigin += offset * output._zaxis[0];
+    attr._yorigin += offset * output._zaxis[1];
+    attr._zorigin += offset * output._zaxis[2];
+    if (_Cache->Attributes() != attr) {
+      if (_Cache->Z() != attr._z) _Cache->Initialize(attr, 3);
+      else                        _Cache->PutOrigin(attr._xorigin, attr._yorigin, attr._zorigin);
+    }
+    _Cache->Modified(true);
+  }
+
+  if (_Cache->Modified()) {
+    // TODO: Cache displacements for multiple time intervals.
+    const double t0 = _Cache->GetTOrigin();
+    const double t  = _Input->GetTOrigin();
+
+    _Cache->Initialize();
+    if (_Invert) {
+      _NumberOfSingularPoints += _Transformation->InverseDisplacement(*_Cache, t, t0);
+    } else {
+      _Transformation->Displacement(*_Cache, t, t0);
+    }
+
+    _Cache->Modified(false);
+  }
+
+  if (_Tiled && _DisplacementField) {
+    _DisplacementField->Input(_Cache);
+    _DisplacementField->Initialize();
+  }
+}
+
 // -----------------------------------------------------------------------------
 void ImageTransformation::Run()
 {
@@ -495,7 +551,20 @@ void ImageTransformation::Run()
     run._SourcePaddingValue = _SourcePaddingValue;
     run._InputTimeOffset    = _InputTimeOffset;
     run._OutputTimeOffset   = _OutputTimeOffset;
-    run();
+    if (_Tiled) {
+      for (int k1 = 0, k2; k1 < _Output->Z(); k1 = k2) {
+        k2 = min(k1 + _TileSize, _Output->Z());
+        if (k2 == _Output->Z() - 1) ++k2;
+        this->UpdateCache(k1, k2);
+        run._FirstSlice = k1;
+        run._LastSlice  = k2;
+        run();
+      }
+      // Cache only contains displacements of last slab
+      _Cache->Modified(true);
+    } else {
+      run();
+    }
     if (_Invert && !_DisplacementField) {
       _NumberOfSingularPoints = run._NumberOfSingularPoints;
     }
@@ -21,6 +21,8 @@
 #include "mirtk/MultiLevelFreeFormTransformation.h"
 
 #include "mirtk/Memory.h"
+#include "mirtk/Math.h"
+#include "mirtk/Profiling.h"
 
 #include "TransformationUtils.h"
 
@@ -34,39 +36,126 @@ namespace mirtk {
 
 // -----------------------------------------------------------------------------
 MultiLevelFreeFormTransformation::MultiLevelFreeFormTransformation()
+:
+  _Flattened(NULL)
 {
 }
 
 // -----------------------------------------------------------------------------
 MultiLevelFreeFormTransformation::MultiLevelFreeFormTransformation(const RigidTransformation &t)
 :
-  MultiLevelTransformation(t)
+  MultiLevelTransformation(t),
+  _Flattened(NULL)
 {
 }
 
 // -----------------------------------------------------------------------------
 MultiLevelFreeFormTransformation::MultiLevelFreeFormTransformation(const AffineTransformation &t)
 :
-  MultiLevelTransformation(t)
+  MultiLevelTransformation(t),
+  _Flattened(NULL)
 {
 }
 
 // -----------------------------------------------------------------------------
 MultiLevelFreeFormTransformation::MultiLevelFreeFormTransformation(const MultiLevelFreeFormTransformation &t)
 :
-  MultiLevelTransformation(t)
+  MultiLevelTransformation(t),
+  _Flattened(NULL),
+  _FlattenedLevels(t._FlattenedLevels.size(), NULL),
+  _FlattenedDOFs(t._FlattenedDOFs)
 {
+  if (t._Flattened) {
+    _Flattened = new BSplineFreeFormTransformation3D(*t._Flattened);
+    memcpy(_FlattenedBounds, t._FlattenedBounds, 6 * sizeof(double));
+    for (size_t l = 0; l < _FlattenedLevels.size(); ++l) {
+      _FlattenedLevels[l] = _LocalTransformation[l];
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 MultiLevelFreeFormTransformation::~MultiLevelFreeFormTransformation()
 {
+  delete _Flattened;
+}
+
+// =============================================================================
+// Transformation parameters (DOFs)
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+bool MultiLevelFreeFormTransformation::CopyFrom(const Transformation *other)
+{
+  this->Unflatten();
+  return MultiLevelTransformation::CopyFrom(other);
+}
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation::Reset()
+{
+  this->Unflatten();
+  MultiLevelTransformation::Reset();
+}
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation::Clear()
+{
+  this->Unflatten();
+  MultiLevelTransformation::Clear();
 }
 
 // =============================================================================
 // Levels
 // =============================================================================
 
+// -----------------------------------------------------------------------------
+FreeFormTransformation *MultiLevelFreeFormTransformation::GetLocalTransformation(int i)
+{
+  // Level may be modified by the caller, including the DoF setters of the
+  // base class which access the levels through this function
+  this->Unflatten();
+  return MultiLevelTransformation::GetLocalTransformation(i);
+}
+
+// -----------------------------------------------------------------------------
+FreeFormTransformation *MultiLevelFreeFormTransformation
+::PutLocalTransformation(FreeFormTransformation *transformation, int i)
+{
+  this->Unflatten();
+  return MultiLevelTransformation::PutLocalTransformation(transformation, i);
+}
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation
+::PushLocalTransformation(FreeFormTransformation *transformation)
+{
+  this->Unflatten();
+  MultiLevelTransformation::PushLocalTransformation(transformation);
+}
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation
+::InsertLocalTransformation(FreeFormTransformation *transformation, int pos)
+{
+  this->Unflatten();
+  MultiLevelTransformation::InsertLocalTransformation(transformation, pos);
+}
+
+// -----------------------------------------------------------------------------
+FreeFormTransformation *MultiLevelFreeFormTransformation::PopLocalTransformation()
+{
+  this->Unflatten();
+  return MultiLevelTransformation::PopLocalTransformation();
+}
+
+// -----------------------------------------------------------------------------
+FreeFormTransformation *MultiLevelFreeFormTransformation::RemoveLocalTransformation(int pos)
+{
+  this->Unflatten();
+  return MultiLevelTransformation::RemoveLocalTransformation(pos);
+}
+
 // -----------------------------------------------------------------------------
 void MultiLevelFreeFormTransformation::CombineLocalTransformation()
 {
@@ -118,6 +207,155 @@ void MultiLevelFreeFormTransformation::MergeGlobalIntoLocalDisplacement()
   delete ffdCopy;
 }
 
+// =============================================================================
+// Flattened evaluation
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation::Unflatten()
+{
+  delete _Flattened;
+  _Flattened = NULL;
+  _FlattenedLevels.clear();
+  _FlattenedDOFs.clear();
+}
+
+// -----------------------------------------------------------------------------
+bool MultiLevelFreeFormTransformation::FlattenedLevelsUnchanged() const
+{
+  if (static_cast<int>(_FlattenedLevels.size()) != _NumberOfLevels) return false;
+  size_t i = 0;
+  for (int l = 0; l < _NumberOfLevels; ++l) {
+    const FreeFormTransformation *ffd = _LocalTransformation[l];
+    if (_FlattenedLevels[l] != ffd) return false;
+    if (i + ffd->NumberOfDOFs() > _FlattenedDOFs.size()) return false;
+    for (int dof = 0; dof < ffd->NumberOfDOFs(); ++dof, ++i) {
+      if (_FlattenedDOFs[i] != ffd->Get(dof)) return false;
+    }
+  }
+  return i == _FlattenedDOFs.size();
+}
+
+// -----------------------------------------------------------------------------
+void MultiLevelFreeFormTransformation::UpdateFlattened() const
+{
+  if (_Flattened && !FlattenedLevelsUnchanged()) {
+    delete _Flattened;
+    _Flattened = NULL;
+    _FlattenedLevels.clear();
+    _FlattenedDOFs.clear();
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool MultiLevelFreeFormTransformation::Flatten(double maxerr)
+{
+  // Number of control points by which the flattened lattice is padded such
+  // that the boundary conditions of the B-spline interpolation do not affect
+  // the flattened displacements within the lattice bounds of the levels
+  const int pad = 4;
+
+  this->Unflatten();
+
+  MIRTK_START_TIMING();
+
+  // Nothing to gain unless there are at least two cubic B-spline FFD levels
+  if (_NumberOfLevels < 2) return false;
+  int finest = -1;
+  double min_volume = numeric_limits<double>::infinity(), volume;
+  for (int l = 0; l < _NumberOfLevels; ++l) {
+    const FreeFormTransformation *ffd = _LocalTransformation[l];
+    if (strcmp(ffd->NameOfClass(), BSplineFreeFormTransformation3D::NameOfType()) != 0) {
+      return false;
+    }
+    volume = ffd->Attributes()._dx * ffd->Attributes()._dy * ffd->Attributes()._dz;
+    if (volume < min_volume) finest = l, min_volume = volume;
+  }
+
+  // Lattice of finest level enlarged to contain the lattices of all levels
+  ImageAttributes lattice = _LocalTransformation[finest]->Attributes();
+  const bool is2d = (lattice._z == 1);
+  double bounds[6] = {.0, lattice._x - 1.0, .0, lattice._y - 1.0, .0, lattice._z - 1.0};
+  for (int l = 0; l < _NumberOfLevels; ++l) {
+    const FreeFormTransformation *ffd = _LocalTransformation[l];
+    for (int c = 0; c < 8; ++c) {
+      double x = (c & 1 ? ffd->X() - 1 : 0);
+      double y = (c & 2 ? ffd->Y() - 1 : 0);
+      double z = (c & 4 ? ffd->Z() - 1 : 0);
+      ffd->LatticeToWorld(x, y, z);
+      lattice.WorldToLattice(x, y, z);
+      bounds[0] = min(bounds[0], x), bounds[1] = max(bounds[1], x);
+      bounds[2] = min(bounds[2], y), bounds[3] = max(bounds[3], y);
+      bounds[4] = min(bounds[4], z), bounds[5] = max(bounds[5], z);
+    }
+  }
+  if (is2d && (bounds[4] < -1e-6 || bounds[5] > 1e-6)) return false;
+  bounds[0] = floor(bounds[0] - 1e-6), bounds[1] = ceil(bounds[1] + 1e-6);
+  bounds[2] = floor(bounds[2] - 1e-6), bounds[3] = ceil(bounds[3] + 1e-6);
+  bounds[4] = floor(bounds[4] - 1e-6), bounds[5] = ceil(bounds[5] + 1e-6);
+
+  // Padded lattice of flattened FFD
+  double x = .5 * (bounds[0] + bounds[1]);
+  double y = .5 * (bounds[2] + bounds[3]);
+  double z = .5 * (bounds[4] + bounds[5]);
+  lattice.LatticeToWorld(x, y, z);
+  lattice._xorigin = x;
+  lattice._yorigin = y;
+  lattice._zorigin = z;
+  lattice._x = static_cast<int>(bounds[1] - bounds[0]) + 1 + 2 * pad;
+  lattice._y = static_cast<int>(bounds[3] - bounds[2]) + 1 + 2 * pad;
+  lattice._z = (is2d ? 1 : static_cast<int>(bounds[5] - bounds[4]) + 1 + 2 * pad);
+
+  _FlattenedBounds[0] = pad, _FlattenedBounds[1] = lattice._x - 1 - pad;
+  _FlattenedBounds[2] = pad, _FlattenedBounds[3] = lattice._y - 1 - pad;
+  if (is2d) _FlattenedBounds[4] = -.5, _FlattenedBounds[5] = .5;
+  else      _FlattenedBounds[4] = pad, _FlattenedBounds[5] = lattice._z - 1 - pad;
+
+  // Interpolate sum of local displacements at control points
+  const int ncps = lattice.NumberOfSpatialPoints();
+  GenericImage<double> disp(lattice, 3);
+  this->Displacement(0, _NumberOfLevels, disp, disp.GetTOrigin());
+  BSplineFreeFormTransformation3D *flat = new BSplineFreeFormTransformation3D();
+  flat->Initialize(lattice);
+  flat->Interpolate(disp.Data(), disp.Data(ncps), disp.Data(2 * ncps));
+
+  // Check error at centres of lattice cells within used region
+  ImageAttributes cells = lattice;
+  cells._x = max(1, lattice._x - 2 * pad - 1);
+  cells._y = max(1, lattice._y - 2 * pad - 1);
+  cells._z = (is2d ? 1 : max(1, lattice._z - 2 * pad - 1));
+  const int ncells = cells.NumberOfSpatialPoints();
+  GenericImage<double> exact(cells, 3), approx(cells, 3);
+  this->Displacement(0, _NumberOfLevels, exact, exact.GetTOrigin());
+  flat->Displacement(approx);
+  const double *e = exact.Data(), *a = approx.Data();
+  double dx, dy, dz, maxerr2 = .0;
+  for (int idx = 0; idx < ncells; ++idx) {
+    dx = e[idx] - a[idx];
+    dy = e[idx + ncells] - a[idx + ncells];
+    dz = e[idx + 2 * ncells] - a[idx + 2 * ncells];
+    maxerr2 = max(maxerr2, dx * dx + dy * dy + dz * dz);
+  }
+
+  MIRTK_DEBUG_TIMING(3, "flattening of local transformations");
+  if (maxerr2 > maxerr * maxerr) {
+    delete flat;
+    return false;
+  }
+
+  // Snapshot of flattened levels
+  _FlattenedLevels.resize(_NumberOfLevels);
+  for (int l = 0; l < _NumberOfLevels; ++l) {
+    const FreeFormTransformation *ffd = _LocalTransformation[l];
+    _FlattenedLevels[l] = ffd;
+    for (int dof = 0; dof < ffd->NumberOfDOFs(); ++dof) {
+      _FlattenedDOFs.push_back(ffd->Get(dof));
+    }
+  }
+  _Flattened = flat;
+  return true;
+}
+
 // =============================================================================
 // Approximation
 // =============================================================================
@@ -473,14 +711,19 @@ void MultiLevelFreeFormTransformation
   const int l1 = (m < 0 ? 0 : m);
 
   // Sum displacements of local transformations
-  double u, v, w, dx = 0, dy = 0, dz = 0;
+  double u = x, v = y, w = z, dx = 0, dy = 0, dz = 0;
 
-  for (int l = l1; l < n; ++l) {
-    u = x, v = y, w = z;
-    _LocalTransformation[l]->Transform(u, v, w, t, t0);
-    dx += (u - x);
-    dy += (v - y);
-    dz += (w - z);
+  if (l1 == 0 && n == _NumberOfLevels && _Flattened && IsInsideFlattened(u, v, w)) {
+    _Flattened->Evaluate(u, v, w);
+    dx = u, dy = v, dz = w;
+  } else {
+    for (int l = l1; l < n; ++l) {
+      u = x, v = y, w = z;
+      _LocalTransformation[l]->Transform(u, v, w, t, t0);
+      dx += (u - x);
+      dy += (v - y);
+      dz += (w - z);
+    }
   }
 
   // Apply local displacements
@@ -495,14 +738,19 @@ void MultiLevelFreeFormTransformation
   const int l1 = (m < 0 ? 0 : m);
 
   // Sum displacements of local transformations
-  double u, v, w, dx = 0, dy = 0, dz = 0;
+  double u = x, v = y, w = z, dx = 0, dy = 0, dz = 0;
 
-  for (int l = l1; l < n; ++l) {
-    u = x, v = y, w = z;
-    _LocalTransformation[l]->Transform(u, v, w, t, t0);
-    dx += (u - x);
-    dy += (v - y);
-    dz += (w - z);
+  if (l1 == 0 && n == _NumberOfLevels && _Flattened && IsInsideFlattened(u, v, w)) {
+    _Flattened->Evaluate(u, v, w);
+    dx = u, dy = v, dz = w;
+  } else {
+    for (int l = l1; l < n; ++l) {
+      u = x, v = y, w = z;
+      _LocalTransformation[l]->Transform(u, v, w, t, t0);
+      dx += (u - x);
+      dy += (v - y);
+      dz += (w - z);
+    }
   }
 
   // Global transformation
@@ -516,6 +764,7 @@ void MultiLevelFreeFormTransformation
 void MultiLevelFreeFormTransformation
 ::Displacement(int m, int n, GenericImage<double> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
+  this->UpdateFlattened();
   if (!this->RequiresCachingOfDisplacements()) {
     MultiLevelTransformation::Displacement(m, n, disp, t, t0, wc);
     return;
@@ -548,6 +797,7 @@ void MultiLevelFreeFormTransformation
 void MultiLevelFreeFormTransformation
 ::Displacement(int m, int n, GenericImage<float> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
+  this->UpdateFlattened();
   if (!this->RequiresCachingOfDisplacements()) {
     MultiLevelTransformation::Displacement(m, n, disp, t, t0, wc);
     return;
@@ -605,6 +855,7 @@ void MultiLevelFreeFormTransformation
 int MultiLevelFreeFormTransformation
 ::InverseDisplacement(int m, int n, GenericImage<double> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
+  this->UpdateFlattened();
   if (m < 0 || !this->RequiresCachingOfDisplacements()) {
     return MultiLevelTransformation::InverseDisplacement(m, n, disp, t, t0, wc);
   }
@@ -633,6 +884,7 @@ int MultiLevelFreeFormTransformation
 int MultiLevelFreeFormTransformation
 ::InverseDisplacement(int m, int n, GenericImage<float> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
+  this->UpdateFlattened();
   if (m < 0 || !this->RequiresCachingOfDisplacements()) {
     return MultiLevelTransformation::InverseDisplacement(m, n, disp, t, t0, wc);
   }
@@ -678,6 +930,16 @@ void MultiLevelFreeFormTransformation
   }
 
   // Compute local jacobian
+  double u = x, v = y, w = z;
+  if (l1 == 0 && n == _NumberOfLevels && _Flattened && IsInsideFlattened(u, v, w)) {
+    _Flattened->Jacobian(tmp, x, y, z, t, t0);
+    tmp(0, 0) -= 1;
+    tmp(1, 1) -= 1;
+    tmp(2, 2) -= 1;
+    jac += tmp;
+    return;
+  }
+
   for (int l = l1; l < n; ++l) {
 
     // Calculate jacobian
@@ -774,5 +1036,12 @@ void MultiLevelFreeFormTransformation::Print(Indent indent) const
   MultiLevelTransformation::Print(indent + 1);
 }
 
+// -----------------------------------------------------------------------------
+Cifstream &MultiLevelFreeFormTransformation::ReadDOFs(Cifstream &from, TransformationType format)
+{
+  this->Unflatten();
+  return MultiLevelTransformation::ReadDOFs(from, format);
+}
+
 
 } // namespace mirtk
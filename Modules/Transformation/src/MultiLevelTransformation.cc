@@ -26,6 +26,8 @@
 #include "mirtk/Parallel.h"
 #include "mirtk/Profiling.h"
 
+#include "TransformationInverse.h"
+
 
 namespace mirtk {
 
@@ -80,9 +82,14 @@ MultiLevelTransformation::MultiLevelTransformation(const AffineTransformation &t
 // -----------------------------------------------------------------------------
 MultiLevelTransformation::MultiLevelTransformation(const MultiLevelTransformation &t)
 :
-  Transformation(t),
+  Transformation(t, 0),
+  _GlobalTransformation(t._GlobalTransformation),
   _NumberOfLevels(t._NumberOfLevels)
 {
+  for (int l = _NumberOfLevels; l < MAX_TRANS; ++l) {
+    _LocalTransformation      [l] = NULL;
+    _LocalTransformationStatus[l] = Passive;
+  }
   for (int l = 0; l < _NumberOfLevels; ++l) {
     _LocalTransformation[l] = dynamic_cast<FreeFormTransformation *>(Transformation::New(t._LocalTransformation[l]));
     if (_LocalTransformation[l] == NULL) {
@@ -870,13 +877,28 @@ void MultiLevelTransformation::Displacement(int m, int n, GenericImage<float> &d
 }
 
 // -----------------------------------------------------------------------------
-int MultiLevelTransformation::InverseDisplacement(int m, int n, GenericImage<double> &disp, double t, double t0, const WorldCoordsImage *) const
+int MultiLevelTransformation::InverseDisplacement(int m, int n, GenericImage<double> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
   if (disp.T() < 2 || disp.T() > 3) {
     cerr << "MultiLevelTransformation::InverseDisplacement: Input/output image must have either 2 or 3 vector components (_t)" << endl;
     exit(1);
   }
 
+  if (wc && (wc->X() != disp.X() || wc->Y() != disp.Y() || wc->Z() != disp.Z())) {
+    cerr << "MultiLevelTransformation::InverseDisplacement: Coordinate map must have the same size as the input/output image" << endl;
+    exit(1);
+  }
+
+  if (this->HasNumericalInverse()) {
+    MultiLevelTransformationInverseFunction inv;
+    inv._Transformation = this;
+    inv._M              = m;
+    inv._N              = n;
+    inv._t              = t;
+    inv._t0             = t0;
+    return EvaluateInverseDisplacement(inv, disp, wc);
+  }
+
   MultiLevelTransformationToInverseDisplacementField<double> eval;
   eval._Transformation = this;
   eval._Output         = &disp;
@@ -897,13 +919,28 @@ int MultiLevelTransformation::InverseDisplacement(int m, int n, GenericImage<dou
 }
 
 // -----------------------------------------------------------------------------
-int MultiLevelTransformation::InverseDisplacement(int m, int n, GenericImage<float> &disp, double t, double t0, const WorldCoordsImage *) const
+int MultiLevelTransformation::InverseDisplacement(int m, int n, GenericImage<float> &disp, double t, double t0, const WorldCoordsImage *wc) const
 {
   if (disp.T() < 2 || disp.T() > 3) {
     cerr << "MultiLevelTransformation::InverseDisplacement: Input/output image must have either 2 or 3 vector components (_t)" << endl;
     exit(1);
   }
 
+  if (wc && (wc->X() != disp.X() || wc->Y() != disp.Y() || wc->Z() != disp.Z())) {
+    cerr << "MultiLevelTransformation::InverseDisplacement: Coordinate map must have the same size as the input/output image" << endl;
+    exit(1);
+  }
+
+  if (this->HasNumericalInverse()) {
+    MultiLevelTransformationInverseFunction inv;
+    inv._Transformation = this;
+    inv._M              = m;
+    inv._N              = n;
+    inv._t              = t;
+    inv._t0             = t0;
+    return EvaluateInverseDisplacement(inv, disp, wc);
+  }
+
   MultiLevelTransformationToInverseDisplacementField<float> eval;
   eval._Transformation = this;
   eval._Output         = &disp;
@@ -226,6 +226,12 @@ bool PartialMultiLevelStationaryVelocityTransformation::RequiresCachingOfDisplac
   return _Transformation->RequiresCachingOfDisplacements();
 }
 
+// -----------------------------------------------------------------------------
+bool PartialMultiLevelStationaryVelocityTransformation::HasNumericalInverse() const
+{
+  return false;
+}
+
 // -----------------------------------------------------------------------------
 void PartialMultiLevelStationaryVelocityTransformation::GlobalTransform(double &x, double &y, double &z, double t, double t0) const
 {
@@ -33,6 +33,7 @@
 #include "mirtk/Transformations.h"
 
 #include "TransformationUtils.h"
+#include "TransformationInverse.h"
 
 
 namespace mirtk {
@@ -1559,6 +1560,14 @@ int Transformation::InverseDisplacement(GenericImage<double> &disp, double t, do
     }
   }
 
+  if (this->HasNumericalInverse()) {
+    TransformationInverseFunction inv;
+    inv._Transformation = this;
+    inv._t              = t;
+    inv._t0             = t0;
+    return EvaluateInverseDisplacement(inv, disp, i2w);
+  }
+
   TransformationToInverseDisplacementImage vf;
   vf._Displacement   = &disp;
   vf._Transformation = this;
@@ -1590,6 +1599,14 @@ int Transformation::InverseDisplacement(GenericImage<float> &disp, double t, dou
     }
   }
 
+  if (this->HasNumericalInverse()) {
+    TransformationInverseFunction inv;
+    inv._Transformation = this;
+    inv._t              = t;
+    inv._t0             = t0;
+    return EvaluateInverseDisplacement(inv, disp, i2w);
+  }
+
   TransformationToInverseDisplacementImage vf;
   vf._Displacement   = &disp;
   vf._Transformation = this;
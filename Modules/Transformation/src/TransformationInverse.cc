@@ -21,6 +21,7 @@
 #include "mirtk/Transformation.h"
 #include "mirtk/MultiLevelTransformation.h"
 #include "mirtk/Matrix.h"
+#include "mirtk/Math.h"
 
 #include "boost/cstdint.hpp"
 #include "boost/config/no_tr1/cmath.hpp"
@@ -353,4 +354,163 @@ bool EvaluateInverse(const MultiLevelTransformation *T, int m, int n,
 }
 
 
+// =============================================================================
+// Inverse transformation initialized with an estimate of the solution
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Maximum number of Newton-Raphson iterations
+static const int MaxInverseNewtonIterations = 20;
+
+/// Maximum number of fixed-point iterations used when Newton-Raphson fails
+static const int MaxInverseFixedPointIterations = 100;
+
+/// Maximum squared residual distance |T(x) - y|^2 of an accepted inverse
+///
+/// \note Free-form deformations evaluate the B-spline kernel using a lookup
+///       table, which limits the attainable accuracy of the inverse.
+static const double MaxInverseSquaredResidual = 1e-6;
+
+// -----------------------------------------------------------------------------
+/// Evaluates transformation and its Jacobian for the inverse iteration
+struct InverseTransformEvaluator
+{
+  const Transformation *_Transformation;
+  double _t, _t0;
+
+  void Transform(double &x, double &y, double &z) const
+  {
+    _Transformation->Transform(x, y, z, _t, _t0);
+  }
+
+  void Jacobian(Matrix &J, double x, double y, double z) const
+  {
+    _Transformation->Jacobian(J, x, y, z, _t, _t0);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Evaluates transformation levels and their Jacobian for the inverse iteration
+struct InverseMultiLevelTransformEvaluator
+{
+  const MultiLevelTransformation *_Transformation;
+  int    _M, _N;
+  double _t, _t0;
+
+  void Transform(double &x, double &y, double &z) const
+  {
+    _Transformation->Transform(_M, _N, x, y, z, _t, _t0);
+  }
+
+  void Jacobian(Matrix &J, double x, double y, double z) const
+  {
+    _Transformation->Jacobian(_M, _N, J, x, y, z, _t, _t0);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Compute residual r = T(p) - y and return its squared norm
+template <class TEvaluator>
+inline double InverseResidual(const TEvaluator &f, double px, double py, double pz,
+                              double x, double y, double z,
+                              double &rx, double &ry, double &rz)
+{
+  rx = px, ry = py, rz = pz;
+  f.Transform(rx, ry, rz);
+  rx -= x, ry -= y, rz -= z;
+  return rx * rx + ry * ry + rz * rz;
+}
+
+// -----------------------------------------------------------------------------
+/// Find point p such that T(p) = (x, y, z) starting at (x0, y0, z0)
+///
+/// A Newton-Raphson iteration with step halving is performed first. When it
+/// fails to converge, the fixed-point iteration p = p - (T(p) - y) is started
+/// at the best Newton-Raphson iterate. When neither converges, the point with
+/// the smallest residual is returned.
+template <class TEvaluator>
+int SolveInverse(const TEvaluator &f, double &x, double &y, double &z,
+                 double x0, double y0, double z0)
+{
+  Matrix J(3, 3);
+  double px = x0, py = y0, pz = z0, rx, ry, rz, r2;
+  double qx, qy, qz, sx, sy, sz, s2;
+  double dx, dy, dz, det, step;
+
+  r2 = InverseResidual(f, px, py, pz, x, y, z, rx, ry, rz);
+
+  // Newton-Raphson iteration
+  for (int iter = 0; iter < MaxInverseNewtonIterations && r2 > MaxInverseSquaredResidual; ++iter) {
+    f.Jacobian(J, px, py, pz);
+    det = J(0, 0) * (J(1, 1) * J(2, 2) - J(1, 2) * J(2, 1))
+        - J(0, 1) * (J(1, 0) * J(2, 2) - J(1, 2) * J(2, 0))
+        + J(0, 2) * (J(1, 0) * J(2, 1) - J(1, 1) * J(2, 0));
+    if (fabs(det) < 1e-12) break;
+    // Solve J * d = r using Cramer's rule
+    dx = (rx    * (J(1, 1) * J(2, 2) - J(1, 2) * J(2, 1))
+        - J(0, 1) * (ry      * J(2, 2) - J(1, 2) * rz     )
+        + J(0, 2) * (ry      * J(2, 1) - J(1, 1) * rz     )) / det;
+    dy = (J(0, 0) * (ry      * J(2, 2) - J(1, 2) * rz     )
+        - rx      * (J(1, 0) * J(2, 2) - J(1, 2) * J(2, 0))
+        + J(0, 2) * (J(1, 0) * rz      - ry      * J(2, 0))) / det;
+    dz = (J(0, 0) * (J(1, 1) * rz      - ry      * J(2, 1))
+        - J(0, 1) * (J(1, 0) * rz      - ry      * J(2, 0))
+        + rx      * (J(1, 0) * J(2, 1) - J(1, 1) * J(2, 0))) / det;
+    // Halve step length until residual decreases
+    s2 = r2, step = 1.0;
+    for (int n = 0; n < 5; ++n, step *= .5) {
+      qx = px - step * dx, qy = py - step * dy, qz = pz - step * dz;
+      s2 = InverseResidual(f, qx, qy, qz, x, y, z, sx, sy, sz);
+      if (s2 < r2) break;
+    }
+    if (!(s2 < r2)) break;
+    px = qx, py = qy, pz = qz;
+    rx = sx, ry = sy, rz = sz, r2 = s2;
+  }
+  if (r2 <= MaxInverseSquaredResidual) {
+    x = px, y = py, z = pz;
+    return 0;
+  }
+
+  // Fixed-point iteration
+  double bx = px, by = py, bz = pz, b2 = r2;
+  for (int iter = 0; iter < MaxInverseFixedPointIterations; ++iter) {
+    px -= rx, py -= ry, pz -= rz;
+    r2 = InverseResidual(f, px, py, pz, x, y, z, rx, ry, rz);
+    if (IsNaN(r2)) break;
+    if (r2 < b2) {
+      bx = px, by = py, bz = pz, b2 = r2;
+      if (b2 <= MaxInverseSquaredResidual) break;
+    }
+  }
+  x = bx, y = by, z = bz;
+  return (b2 <= MaxInverseSquaredResidual ? 1 : -1);
+}
+
+// -----------------------------------------------------------------------------
+int EvaluateInverse(const Transformation *T, double &x, double &y, double &z,
+                    double t, double t0, double x0, double y0, double z0)
+{
+  InverseTransformEvaluator f;
+  f._Transformation = T;
+  f._t  = t;
+  f._t0 = t0;
+  return SolveInverse(f, x, y, z, x0, y0, z0);
+}
+
+// -----------------------------------------------------------------------------
+int EvaluateInverse(const MultiLevelTransformation *T, int m, int n,
+                    double &x, double &y, double &z, double t, double t0,
+                    double x0, double y0, double z0)
+{
+  InverseMultiLevelTransformEvaluator f;
+  f._Transformation = T;
+  f._M  = m;
+  f._N  = n;
+  f._t  = t;
+  f._t0 = t0;
+  return SolveInverse(f, x, y, z, x0, y0, z0);
+}
+
+
 } // namespace mirtk
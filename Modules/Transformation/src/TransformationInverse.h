@@ -0,0 +1,199 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2008-2015 Imperial College London
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MIRTK_TransformationInverse_H
+#define MIRTK_TransformationInverse_H
+
+#include "mirtk/Transformation.h"
+#include "mirtk/MultiLevelTransformation.h"
+#include "mirtk/GenericImage.h"
+#include "mirtk/Parallel.h"
+#include "mirtk/Options.h"
+
+
+namespace mirtk {
+
+
+// =============================================================================
+// Declaration of inverse transformation (cf. TransformationInverse.cc)
+// =============================================================================
+
+/// Find the point which is mapped by the transformation onto (x, y, z)
+/// starting the iteration at (x0, y0, z0)
+///
+/// \returns 0 if the Newton-Raphson iteration converged, 1 if the fixed-point
+///          iteration used as fallback converged, and -1 otherwise.
+int EvaluateInverse(const Transformation *, double &, double &, double &,
+                    double, double, double, double, double);
+
+/// Find the point which is mapped by the transformation levels [m, n) onto
+/// (x, y, z) starting the iteration at (x0, y0, z0)
+///
+/// \returns 0 if the Newton-Raphson iteration converged, 1 if the fixed-point
+///          iteration used as fallback converged, and -1 otherwise.
+int EvaluateInverse(const MultiLevelTransformation *, int, int, double &, double &, double &,
+                    double, double, double, double, double);
+
+// =============================================================================
+// Dense inverse displacement field
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+/// Inverse of transformation with initial estimate
+struct TransformationInverseFunction
+{
+  const Transformation *_Transformation;
+  double _t, _t0;
+
+  int operator ()(double &x, double &y, double &z, double x0, double y0, double z0) const
+  {
+    return EvaluateInverse(_Transformation, x, y, z, _t, _t0, x0, y0, z0);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Inverse of multi-level transformation with initial estimate
+struct MultiLevelTransformationInverseFunction
+{
+  const MultiLevelTransformation *_Transformation;
+  int    _M, _N;
+  double _t, _t0;
+
+  int operator ()(double &x, double &y, double &z, double x0, double y0, double z0) const
+  {
+    return EvaluateInverse(_Transformation, _M, _N, x, y, z, _t, _t0, x0, y0, z0);
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Evaluates inverse displacement field block by block, where the iterative
+/// solution at each voxel is initialized with the inverse displacement found
+/// at the preceding voxel of the same row, or the first voxel of the previous
+/// row of the block, respectively
+template <class TReal, class TInverse>
+class InverseDisplacementFieldBody
+{
+  const TInverse         *_Inverse;
+  GenericImage<TReal>    *_Displacement;
+  const WorldCoordsImage *_WorldCoords;
+  int                     _X, _Y, _Z;
+
+public:
+
+  int _NumberOfFallbacks; ///< Number of voxels at which fixed-point iteration was used
+  int _NumberOfFailures;  ///< Number of voxels at which inversion did not converge
+
+  // ---------------------------------------------------------------------------
+  /// Constructor
+  InverseDisplacementFieldBody(const TInverse *inv, GenericImage<TReal> *disp,
+                               const WorldCoordsImage *wc = NULL)
+  :
+    _Inverse(inv), _Displacement(disp), _WorldCoords(wc),
+    _X(disp->X()), _Y(disp->Y()), _Z(disp->Z()),
+    _NumberOfFallbacks(0), _NumberOfFailures(0)
+  {}
+
+  // ---------------------------------------------------------------------------
+  /// Split constructor
+  InverseDisplacementFieldBody(const InverseDisplacementFieldBody &other, split)
+  :
+    _Inverse(other._Inverse), _Displacement(other._Displacement),
+    _WorldCoords(other._WorldCoords),
+    _X(other._X), _Y(other._Y), _Z(other._Z),
+    _NumberOfFallbacks(0), _NumberOfFailures(0)
+  {}
+
+  // ---------------------------------------------------------------------------
+  /// Join results
+  void join(const InverseDisplacementFieldBody &other)
+  {
+    _NumberOfFallbacks += other._NumberOfFallbacks;
+    _NumberOfFailures  += other._NumberOfFailures;
+  }
+
+  // ---------------------------------------------------------------------------
+  /// Evaluate inverse displacement at voxels of block
+  void operator ()(const blocked_range3d<int> &r)
+  {
+    const int  nvox = _X * _Y * _Z;
+    const bool is3d = (_Displacement->T() > 2);
+
+    TReal        *dx = _Displacement->Data(), *dy = dx + nvox, *dz = dy + nvox;
+    const double *wx = NULL, *wy = NULL, *wz = NULL;
+    if (_WorldCoords) {
+      wx = _WorldCoords->Data(), wy = wx + nvox;
+      wz = (_WorldCoords->T() > 2 ? wy + nvox : NULL);
+    }
+
+    double x, y, z, x0, y0, z0, ux, uy, uz, rx = .0, ry = .0, rz = .0;
+    int    idx, status;
+
+    for (int k = r.pages().begin(); k != r.pages().end(); ++k)
+    for (int j = r.rows ().begin(); j != r.rows ().end(); ++j) {
+      ux = rx, uy = ry, uz = rz;
+      for (int i = r.cols().begin(); i != r.cols().end(); ++i) {
+        idx = (k * _Y + j) * _X + i;
+        // Transform point into world coordinates
+        if (wx) {
+          x = wx[idx], y = wy[idx], z = (wz ? wz[idx] : .0);
+        } else {
+          x = i, y = j, z = (is3d ? k : .0);
+          _Displacement->ImageToWorld(x, y, z);
+        }
+        // Apply current displacement
+        x += static_cast<double>(dx[idx]);
+        y += static_cast<double>(dy[idx]);
+        if (is3d) z += static_cast<double>(dz[idx]);
+        // Calculate inverse displacement starting with the one of the neighbour
+        x0 = x, y0 = y, z0 = z;
+        status = (*_Inverse)(x, y, z, x0 + ux, y0 + uy, z0 + uz);
+        if      (status > 0) ++_NumberOfFallbacks;
+        else if (status < 0) ++_NumberOfFailures;
+        ux = x - x0, uy = y - y0, uz = z - z0;
+        if (i == r.cols().begin()) rx = ux, ry = uy, rz = uz;
+        // Update displacement
+        dx[idx] += static_cast<TReal>(ux);
+        dy[idx] += static_cast<TReal>(uy);
+        if (is3d) dz[idx] += static_cast<TReal>(uz);
+      }
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+/// Evaluate inverse displacement field in parallel
+///
+/// \returns Number of voxels at which the inverse iteration did not converge.
+template <class TReal, class TInverse>
+int EvaluateInverseDisplacement(const TInverse &inv, GenericImage<TReal> &disp,
+                                const WorldCoordsImage *wc = NULL)
+{
+  InverseDisplacementFieldBody<TReal, TInverse> body(&inv, &disp, wc);
+  blocked_range3d<int> voxels(0, disp.Z(), 0, disp.Y(), 0, disp.X());
+  parallel_reduce(voxels, body);
+  if (debug && (body._NumberOfFallbacks > 0 || body._NumberOfFailures > 0)) {
+    cout << "Inverse displacement: Fixed-point iteration used at " << body._NumberOfFallbacks
+         << " voxels, no convergence at " << body._NumberOfFailures << " voxels" << endl;
+  }
+  return body._NumberOfFailures;
+}
+
+
+} // namespace mirtk
+
+#endif // MIRTK_TransformationInverse_H
@@ -0,0 +1,137 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "mirtk/Math.h"
+#include "mirtk/GenericImage.h"
+#include "mirtk/BSplineFreeFormTransformationSV.h"
+#include "mirtk/BSplineFreeFormTransformationTD.h"
+
+using namespace mirtk;
+
+// ===========================================================================
+// Auxiliaries
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+/// Integration methods which are used by the batch integration
+static const FFDIntegrationMethod IntegrationMethods[] = {
+  FFDIM_RKE1,   FFDIM_RKE2,   FFDIM_RKH2,  FFDIM_RK4,
+  FFDIM_RKEH12, FFDIM_RKBS23, FFDIM_RKF45, FFDIM_RKDP45, FFDIM_RKCK45
+};
+
+// ---------------------------------------------------------------------------
+/// Image domain on which displacements are evaluated
+static ImageAttributes Domain()
+{
+  ImageAttributes attr;
+  attr._x  = 9,  attr._y  = 7,  attr._z  = 4;
+  attr._dx = 2.5, attr._dy = 2.5, attr._dz = 3.;
+  return attr;
+}
+
+// ---------------------------------------------------------------------------
+/// Set parameters of FFD to a smooth deterministic velocity field
+static void InitializeVelocities(Transformation &T, double magnitude)
+{
+  for (int dof = 0; dof < T.NumberOfDOFs(); ++dof) {
+    T.Put(dof, magnitude * sin(.7 * dof) * cos(.13 * dof));
+  }
+}
+
+// ---------------------------------------------------------------------------
+/// Compare displacement field and batch point transformation to transformation
+/// of each point separately
+static void ExpectBatchEqualsPointwise(const Transformation &T, double t, double t0)
+{
+  const ImageAttributes attr = Domain();
+  // Dense displacement field computed with batch integration
+  GenericImage<double> disp(attr, 3);
+  T.Displacement(disp, t, t0);
+  // Batch point transformation
+  const int n = attr.NumberOfSpatialPoints();
+  Array<double> bx(n), by(n), bz(n);
+  for (int idx = 0; idx < n; ++idx) {
+    int i, j, k;
+    disp.IndexToVoxel(idx, i, j, k);
+    bx[idx] = i, by[idx] = j, bz[idx] = k;
+    disp.ImageToWorld(bx[idx], by[idx], bz[idx]);
+  }
+  T.Transform(n, bx.data(), by.data(), bz.data(), t, t0);
+  // Compare to transformation of each point separately
+  int i, j, k;
+  double x, y, z, x0, y0, z0;
+  for (int idx = 0; idx < n; ++idx) {
+    disp.IndexToVoxel(idx, i, j, k);
+    x = i, y = j, z = k;
+    disp.ImageToWorld(x, y, z);
+    x0 = x, y0 = y, z0 = z;
+    T.Transform(x, y, z, t, t0);
+    ASSERT_DOUBLE_EQ(x, bx[idx]);
+    ASSERT_DOUBLE_EQ(y, by[idx]);
+    ASSERT_DOUBLE_EQ(z, bz[idx]);
+    ASSERT_DOUBLE_EQ(x - x0, disp(i, j, k, 0));
+    ASSERT_DOUBLE_EQ(y - y0, disp(i, j, k, 1));
+    ASSERT_DOUBLE_EQ(z - z0, disp(i, j, k, 2));
+  }
+}
+
+// ===========================================================================
+// Tests
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+TEST(BSplineFreeFormTransformationSV, BatchIntegration)
+{
+  BSplineFreeFormTransformationSV ffd(Domain(), 4., 4., 4.);
+  InitializeVelocities(ffd, 4.);
+  for (size_t m = 0; m < sizeof(IntegrationMethods) / sizeof(IntegrationMethods[0]); ++m) {
+    SCOPED_TRACE(ToString(IntegrationMethods[m]));
+    ffd.IntegrationMethod(IntegrationMethods[m]);
+    ExpectBatchEqualsPointwise(ffd, 1., 0.);
+    ExpectBatchEqualsPointwise(ffd, 0., 1.);
+  }
+}
+
+// ---------------------------------------------------------------------------
+TEST(BSplineFreeFormTransformationTD, BatchIntegration)
+{
+  ImageAttributes attr = Domain();
+  attr._t = 5, attr._dt = .25;
+  BSplineFreeFormTransformationTD ffd(attr, 4., 4., 4., .25);
+  InitializeVelocities(ffd, 8.);
+  for (size_t m = 0; m < sizeof(IntegrationMethods) / sizeof(IntegrationMethods[0]); ++m) {
+    SCOPED_TRACE(ToString(IntegrationMethods[m]));
+    ffd.IntegrationMethod(IntegrationMethods[m]);
+    ExpectBatchEqualsPointwise(ffd, 1., 0.);
+    ExpectBatchEqualsPointwise(ffd, .2, .9);
+  }
+}
+
+// ===========================================================================
+// Main
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
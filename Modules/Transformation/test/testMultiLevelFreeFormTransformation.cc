@@ -0,0 +1,198 @@
+/*
+ * Medical Image Registration ToolKit (MIRTK)
+ *
+ * Copyright 2013-2015 Imperial College London
+ * Copyright 2013-2015 Andreas Schuh
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "mirtk/Math.h"
+#include "mirtk/Matrix.h"
+#include "mirtk/GenericImage.h"
+#include "mirtk/BSplineFreeFormTransformation3D.h"
+#include "mirtk/BSplineFreeFormTransformationSV.h"
+#include "mirtk/MultiLevelFreeFormTransformation.h"
+
+using namespace mirtk;
+
+// ===========================================================================
+// Auxiliaries
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+/// Image domain on which displacements are evaluated
+static ImageAttributes Domain()
+{
+  ImageAttributes attr;
+  attr._x  = 24, attr._y  = 20, attr._z  = 16;
+  attr._dx = 2., attr._dy = 2., attr._dz = 2.;
+  return attr;
+}
+
+// ---------------------------------------------------------------------------
+/// Add smooth deterministic displacements to parameters of FFD
+static void AddDisplacements(FreeFormTransformation *ffd, double magnitude)
+{
+  for (int dof = 0; dof < ffd->NumberOfDOFs(); ++dof) {
+    ffd->Put(dof, ffd->Get(dof) + magnitude * sin(.7 * dof) * cos(.13 * dof));
+  }
+}
+
+// ---------------------------------------------------------------------------
+/// Multi-level FFD with three levels obtained by dyadic subdivision
+static void InitializeLevels(MultiLevelFreeFormTransformation &mffd)
+{
+  BSplineFreeFormTransformation3D *ffd;
+  ffd = new BSplineFreeFormTransformation3D(Domain(), 16., 16., 16.);
+  AddDisplacements(ffd, 4.);
+  mffd.PushLocalTransformation(ffd);
+  for (int l = 1; l < 3; ++l) {
+    ffd = new BSplineFreeFormTransformation3D(*ffd);
+    ffd->Subdivide();
+    ffd->Reset();
+    AddDisplacements(ffd, 4. / (l + 1));
+    mffd.PushLocalTransformation(ffd);
+  }
+}
+
+// ---------------------------------------------------------------------------
+/// Compare dense displacements, point transformations, and Jacobians
+static void ExpectNear(const MultiLevelFreeFormTransformation &flat,
+                       const MultiLevelFreeFormTransformation &mffd, double maxerr)
+{
+  const ImageAttributes attr = Domain();
+  GenericImage<double> d1(attr, 3), d2(attr, 3);
+  flat.Displacement(d1);
+  mffd.Displacement(d2);
+  for (int idx = 0; idx < d1.NumberOfVoxels(); ++idx) {
+    EXPECT_NEAR(d2.Data()[idx], d1.Data()[idx], maxerr);
+  }
+  Matrix j1, j2;
+  double x1, y1, z1, x2, y2, z2;
+  for (int k = 0; k < attr._z; k += 3)
+  for (int j = 0; j < attr._y; j += 3)
+  for (int i = 0; i < attr._x; i += 3) {
+    x1 = i, y1 = j, z1 = k;
+    d1.ImageToWorld(x1, y1, z1);
+    x2 = x1, y2 = y1, z2 = z1;
+    flat.Jacobian(j1, x1, y1, z1);
+    mffd.Jacobian(j2, x2, y2, z2);
+    for (int r = 0; r < 3; ++r)
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(j2(r, c), j1(r, c), .01);
+    }
+    flat.Transform(x1, y1, z1);
+    mffd.Transform(x2, y2, z2);
+    EXPECT_NEAR(x2, x1, maxerr);
+    EXPECT_NEAR(y2, y1, maxerr);
+    EXPECT_NEAR(z2, z1, maxerr);
+  }
+}
+
+// ===========================================================================
+// Tests
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+TEST(MultiLevelFreeFormTransformation, FlattenedEqualsLevels)
+{
+  const double maxerr = .01;
+  MultiLevelFreeFormTransformation mffd;
+  InitializeLevels(mffd);
+  EXPECT_FALSE(mffd.IsFlattened());
+  MultiLevelFreeFormTransformation flat(mffd);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  EXPECT_TRUE(flat.IsFlattened());
+  ExpectNear(flat, mffd, maxerr);
+  MultiLevelFreeFormTransformation copy(flat);
+  EXPECT_TRUE(copy.IsFlattened());
+  ExpectNear(copy, mffd, maxerr);
+}
+
+// ---------------------------------------------------------------------------
+TEST(MultiLevelFreeFormTransformation, FlattenAfterModification)
+{
+  const double maxerr = .01;
+  MultiLevelFreeFormTransformation mffd;
+  InitializeLevels(mffd);
+  MultiLevelFreeFormTransformation flat(mffd);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  AddDisplacements(mffd .GetLocalTransformation(1), 1.);
+  AddDisplacements(flat.GetLocalTransformation(1), 1.);
+  EXPECT_FALSE(flat.IsFlattened());
+  ExpectNear(flat, mffd, .0);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  ExpectNear(flat, mffd, maxerr);
+}
+
+// ---------------------------------------------------------------------------
+TEST(MultiLevelFreeFormTransformation, FlattenThenModifyDOFs)
+{
+  const double maxerr = .01;
+  MultiLevelFreeFormTransformation mffd;
+  InitializeLevels(mffd);
+  MultiLevelFreeFormTransformation flat(mffd);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  const int dof = mffd.NumberOfDOFs() / 2;
+  mffd.Put(dof, mffd.Get(dof) + 2.);
+  flat.Put(dof, flat.Get(dof) + 2.);
+  EXPECT_FALSE(flat.IsFlattened());
+  ExpectNear(flat, mffd, .0);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  delete flat.PopLocalTransformation();
+  delete mffd.PopLocalTransformation();
+  EXPECT_FALSE(flat.IsFlattened());
+  ExpectNear(flat, mffd, .0);
+}
+
+// ---------------------------------------------------------------------------
+TEST(MultiLevelFreeFormTransformation, FlattenThenModifyLevelPointer)
+{
+  const double maxerr = .01;
+  MultiLevelFreeFormTransformation mffd;
+  InitializeLevels(mffd);
+  MultiLevelFreeFormTransformation flat(mffd);
+  FreeFormTransformation *level = flat.GetLocalTransformation(2);
+  ASSERT_TRUE(flat.Flatten(maxerr));
+  AddDisplacements(mffd.GetLocalTransformation(2), 1.);
+  AddDisplacements(level, 1.);
+  ExpectNear(flat, mffd, .0);
+  EXPECT_FALSE(flat.IsFlattened());
+}
+
+// ---------------------------------------------------------------------------
+TEST(MultiLevelFreeFormTransformation, FlattenOnlyCubicBSplineFFDs)
+{
+  MultiLevelFreeFormTransformation mffd;
+  InitializeLevels(mffd);
+  BSplineFreeFormTransformationSV *svffd;
+  svffd = new BSplineFreeFormTransformationSV(Domain(), 8., 8., 8.);
+  AddDisplacements(svffd, 1.);
+  mffd.PushLocalTransformation(svffd);
+  EXPECT_FALSE(mffd.Flatten());
+  EXPECT_FALSE(mffd.IsFlattened());
+}
+
+// ===========================================================================
+// Main
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}